@@ -1,30 +1,96 @@
 #pragma once
 
+#include <functional>
+#include <future>
 #include <string>
 #include <vector>
 #include <memory>
 
 #include "runtime/data/tensor.h"
+#include "runtime/data/tensor_spec.h"
 #include "engine_config.h"
 
 namespace ptk::perception {
 
+    // Completion of an InferAsync call: whether it succeeded, and the outputs,
+    // valid only for the duration of the call.
+    using InferCallback = std::function<void(bool ok, const std::vector<data::TensorView>& outputs)>;
+
     class Engine {
         public:
             virtual ~Engine() = default;
 
             virtual bool Load(const std::string& model_path) = 0;
 
+            // Outputs that were not preallocated are views of storage the
+            // engine or its caller's thread owns. An engine's own buffers stay
+            // valid until its next Infer; EnginePool and DynamicBatcher copy
+            // into storage owned by the calling thread and shared by all of
+            // them, valid only until the thread's next Infer on any pool or
+            // batcher.
             virtual bool Infer(const std::vector<data::TensorView>& inputs,std::vector<data::TensorView>& outputs) = 0;
 
+            // Starts inference and returns without waiting; done runs once
+            // when it finishes, possibly on an engine thread. If outputs holds
+            // one preallocated view per model output, results are written
+            // there. Inputs and preallocated outputs must stay valid until
+            // done runs. Returns false, without calling done, if the run could
+            // not be started. This default runs Infer on the calling thread.
+            virtual bool InferAsync(const std::vector<data::TensorView>& inputs,
+                                    const std::vector<data::TensorView>& outputs, InferCallback done) {
+                std::vector<data::TensorView> results = outputs;
+                const bool ok = Infer(inputs, results);
+                done(ok, results);
+                return true;
+            }
+
+            // Future form of InferAsync for preallocated outputs: one thread
+            // can keep several frames in flight and prepare the next input
+            // meanwhile. The future is false if the run failed.
+            std::future<bool> InferAsync(const std::vector<data::TensorView>& inputs,
+                                         const std::vector<data::TensorView>& outputs) {
+                auto promise = std::make_shared<std::promise<bool>>();
+                std::future<bool> result = promise->get_future();
+                if (!InferAsync(inputs, outputs, [promise](bool ok, const std::vector<data::TensorView>&) {
+                        promise->set_value(ok);
+                    })) {
+                    promise->set_value(false);
+                }
+                return result;
+            }
+
             virtual std::vector<std::string> InputNames() const = 0;
             virtual std::vector<std::string> OutputNames() const = 0;
 
+            // Declared dtype and shape of each input and output, in name order,
+            // available once Load succeeded, so buffers and preprocessing can
+            // be set up before the first Infer. Engines that cannot introspect
+            // their model report names only (TensorSpec::known() is false).
+            virtual std::vector<data::TensorSpec> InputSpecs() const {
+                return SpecsFromNames(InputNames());
+            }
+            virtual std::vector<data::TensorSpec> OutputSpecs() const {
+                return SpecsFromNames(OutputNames());
+            }
+
+            // Thread settings the engine runs with, after any auto-tuning.
+            virtual const ThreadingConfig& threading() const {
+                return config_.threading;
+            }
+
             virtual void SetConfig(const EngineConfig& config){
                 config_ = config;
             }
 
         protected:
+            static std::vector<data::TensorSpec> SpecsFromNames(const std::vector<std::string>& names) {
+                std::vector<data::TensorSpec> specs(names.size());
+                for (size_t i = 0; i < names.size(); i++) {
+                    specs[i].name = names[i];
+                }
+                return specs;
+            }
+
             EngineConfig config_;
     };
 }
\ No newline at end of file
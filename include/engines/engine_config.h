@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace ptk::perception {
 
@@ -21,6 +23,63 @@ namespace ptk::perception {
         INT8
     };
 
+    enum class OnnxGraphOptimization {
+        Disabled,
+        Basic,
+        Extended,
+        All
+    };
+
+    enum class GraphExecutionMode {
+        Sequential, // one node at a time, parallelism only inside ops
+        Parallel    // independent branches run on the inter-op pool
+    };
+
+    enum class TuneObjective {
+        Latency,   // fastest single request
+        Throughput // most requests per second with concurrent callers
+    };
+
+    struct ThreadingConfig {
+        // Threads inside one op. 0 lets ONNX Runtime pick one per physical core.
+        int intra_op_threads = 1;
+        // Threads running independent graph branches; only used by Parallel.
+        int inter_op_threads = 1;
+        GraphExecutionMode execution_mode = GraphExecutionMode::Sequential;
+
+        // Idle pool threads busy-wait for the next op. Lower latency, but
+        // burns cores other pipeline stages could use.
+        bool allow_spinning = true;
+
+        // Logical processors per intra-op thread, in ONNX Runtime's
+        // session.intra_op_thread_affinities format: one entry per thread
+        // after the first, ';' separated, e.g. "1;2;3" or "1-2;3-4". Empty
+        // leaves placement to the OS.
+        std::string intra_op_affinity;
+
+        // Benchmark candidate thread settings on the loaded model at Load
+        // and keep the best one for tune_objective; the fields above are
+        // replaced by the winner. Spinning is kept as given, the affinity
+        // only for candidates with the configured thread count.
+        bool auto_tune = false;
+        TuneObjective tune_objective = TuneObjective::Latency;
+        int tune_iterations = 20; // timed runs per candidate
+        // Cores the tuned settings may use; 0 means all hardware threads.
+        // EnginePool sets this to its share per session.
+        int tune_cores = 0;
+    };
+
+    struct EnginePoolConfig {
+        // Engines loaded from the same model. Above 1, CreateEngine returns an
+        // EnginePool that callers on any thread can Infer on concurrently;
+        // size threading.intra_op_threads so sessions * threads fits the cores.
+        int sessions = 1;
+        // Callers that may wait for a free engine; Infer fails fast beyond that.
+        int max_queue = 64;
+        // How long a queued caller waits before failing; 0 waits indefinitely.
+        int queue_timeout_ms = 0;
+    };
+
     struct EngineConfig {
         EngineBackend backend = EngineBackend::OnnxRuntime;
 
@@ -33,6 +92,25 @@ namespace ptk::perception {
         size_t trt_workspace_size_mb = 1024;
         bool verbose = false;
         std::string trt_engine_path;
+
+        OnnxGraphOptimization onnx_graph_optimization = OnnxGraphOptimization::Extended;
+
+        // Directory for ONNX Runtime's optimized models, keyed by model
+        // content, ONNX Runtime version, the options that shape the graph and
+        // the host CPU's instruction set, so it can be shared between hosts.
+        // A hit skips graph optimization at Load. Content hashes are kept
+        // there too, by model path, size and modification time, so Load only
+        // reads a model again once it changed. Empty disables the cache.
+        std::string onnx_optimized_model_cache_dir;
+
+        // Synthetic inferences Load runs before returning, so the first real
+        // Infer does not pay for lazy initialization or buffer allocation.
+        int warmup_runs = 0;
+        // Input shapes for warmup and auto-tuning, one per model input. Empty
+        // uses the model's shapes with symbolic dims taken as 1.
+        std::vector<std::vector<int64_t>> warmup_input_shapes;
+        ThreadingConfig threading;
+        EnginePoolConfig pool;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "engine.h"
+#include "engine_config.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::perception {
+
+    // config.pool.sessions engines of one model behind the Engine interface.
+    // Infer is thread safe: each call runs on a free engine, and callers queue
+    // (up to pool.max_queue) while all are busy.
+    class EnginePool : public Engine {
+        public:
+            // Exclusive use of one engine until destroyed, e.g. to read an
+            // engine's zero-copy outputs before another caller reuses it.
+            class Lease {
+                public:
+                    Lease() = default;
+                    Lease(Lease&& other) noexcept;
+                    Lease& operator=(Lease&& other) noexcept;
+                    ~Lease();
+
+                    explicit operator bool() const { return pool_ != nullptr; }
+                    Engine& engine() const;
+                    Engine* operator->() const { return &engine(); }
+
+                private:
+                    friend class EnginePool;
+                    Lease(EnginePool* pool, int index) : pool_(pool), index_(index) {}
+
+                    EnginePool* pool_ = nullptr;
+                    int index_ = -1;
+            };
+
+            explicit EnginePool(const EngineConfig& config);
+            ~EnginePool() override;
+
+            // Creates and loads every engine; fails if any of them fails.
+            bool Load(const std::string& model_path) override;
+
+            // Runs on the next free engine. Preallocated outputs (one non-empty
+            // view per model output) are written in place; otherwise outputs
+            // are copied into the calling thread's storage (see Engine::Infer).
+            // Returns false when the queue is full or the wait times out.
+            bool Infer(const std::vector<data::TensorView>& inputs, std::vector<data::TensorView>& outputs) override;
+
+            std::vector<std::string> InputNames() const override { return input_names_; }
+            std::vector<std::string> OutputNames() const override { return output_names_; }
+
+            std::vector<data::TensorSpec> InputSpecs() const override { return input_specs_; }
+            std::vector<data::TensorSpec> OutputSpecs() const override { return output_specs_; }
+
+            // Shared by every engine; tuned once, by the first, when
+            // threading.auto_tune is set.
+            const ThreadingConfig& threading() const override {
+                return engines_.empty() ? config_.threading : engines_.front()->threading();
+            }
+
+            // Blocks like Infer; an empty lease means the queue was full or the
+            // wait timed out.
+            Lease Acquire();
+
+            int size() const { return static_cast<int>(engines_.size()); }
+
+        private:
+            int AcquireIndex();
+            void Release(int index);
+
+            std::vector<std::unique_ptr<Engine>> engines_;
+            std::vector<std::string> input_names_;
+            std::vector<std::string> output_names_;
+            std::vector<data::TensorSpec> input_specs_;
+            std::vector<data::TensorSpec> output_specs_;
+            std::vector<int> free_;
+            int waiting_ = 0;
+            std::mutex mu_;
+            std::condition_variable cv_;
+    };
+}
@@ -3,6 +3,9 @@
 #include "engine.h"
 #include "engine_config.h"
 #include <onnxruntime_cxx_api.h>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <vector>
 #include <string>
 #include <memory>
@@ -18,19 +21,117 @@ namespace ptk::perception {
 
             bool Load(const std::string& model_path) override;
 
+            // Runs through an IoBinding: inputs are bound in place and outputs
+            // are written straight into their final buffers. If outputs holds
+            // one preallocated view per model output (e.g. from a pool), those
+            // are bound; otherwise outputs are set to views of engine-owned
+            // buffers that stay valid until the next Infer. Steady state does
+            // no allocation and no output copy.
             bool Infer(const std::vector<data::TensorView>& inputs, std::vector<data::TensorView>& outputs) override;
 
+            using Engine::InferAsync;
+
+            // Runs through ORT's RunAsync, so several calls can be in flight
+            // from one thread; done runs on an intra-op pool thread. RunAsync
+            // needs that pool to have workers, so with
+            // threading.intra_op_threads == 1 this runs Infer synchronously.
+            // Outputs that are not preallocated are allocated per call.
+            bool InferAsync(const std::vector<data::TensorView>& inputs,
+                            const std::vector<data::TensorView>& outputs, InferCallback done) override;
+
             std::vector<std::string> InputNames() const override { return input_names_; }
             std::vector<std::string> OutputNames() const override { return output_names_; }
 
+            std::vector<data::TensorSpec> InputSpecs() const override { return input_specs_; }
+            std::vector<data::TensorSpec> OutputSpecs() const override { return output_specs_; }
+
+            // Thread settings the session runs with; after auto-tuning these
+            // are the winning candidate's.
+            const ThreadingConfig& threading() const override { return config_.threading; }
+
         private:
+            // One model output. Static shapes are allocated at Load; shapes
+            // with symbolic dims are learned from the first run (ORT allocates
+            // that once) and preallocated for later runs with the same input
+            // shapes.
+            struct OutputSlot
+            {
+                ONNXTensorElementDataType onnx_type = ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
+                bool dynamic = false;     // model shape has symbolic dims
+                bool shape_known = false;
+                std::vector<int64_t> shape;
+                std::vector<std::uint8_t> storage;
+                Ort::Value value{nullptr}; // wraps storage, or holds an ORT-allocated result
+                bool wraps_storage = false;
+                void* data = nullptr;      // what the last outputs view points at
+            };
+
             Ort::Env env_;
             std::unique_ptr<Ort::Session> session_;
-            Ort::SessionOptions session_options_;
             std::vector<std::string> input_names_;
             std::vector<std::string> output_names_;
+            std::vector<data::TensorSpec> input_specs_;
+            std::vector<data::TensorSpec> output_specs_;
             EngineConfig config_;
 
+            // What an input name is bound to; Infer skips rebinding inputs
+            // whose buffer and shape did not change.
+            struct BoundInput
+            {
+                const void* data = nullptr;
+                size_t bytes = 0;
+                core::DataType dtype = core::DataType::kUnknown;
+            };
+
+            std::string session_model_path_; // the file session_ was created from
+            bool from_cache_ = false;        // session_model_path_ is an optimized cache entry
+
+            Ort::MemoryInfo memory_info_;
+            Ort::RunOptions run_options_;
+            std::unique_ptr<Ort::IoBinding> binding_;
+            std::vector<OutputSlot> output_slots_;
+            bool outputs_bound_ = false; // binding holds every slot's storage
+            std::vector<BoundInput> bound_inputs_;
+            // Input shapes the slots' learned shapes belong to.
+            std::vector<std::vector<int64_t>> input_shapes_;
+
+            // Creates session_ from model_path, or from its optimized copy in
+            // the model cache, writing that copy on a miss.
+            bool OpenSession(const std::string& model_path);
+            Ort::SessionOptions SessionOptionsFor(const ThreadingConfig& threading) const;
+
+            // Times thread settings on zero-filled inputs and keeps the best
+            // session. The session Load created is the first candidate.
+            bool AutoTune();
+
+            // config_.warmup_runs synthetic Infer calls.
+            bool Warmup();
+
+            // One InferAsync call: owns its ORT values until done has run.
+            struct AsyncCall
+            {
+                OnnxEngine* engine = nullptr;
+                std::vector<Ort::Value> inputs;
+                std::vector<Ort::Value> outputs;
+                std::vector<data::TensorView> views; // preallocated outputs, or filled on completion
+                bool preallocated = false;
+                InferCallback done;
+            };
+
+            static void OnAsyncDone(void* user_data, OrtValue** outputs, size_t num_outputs, OrtStatusPtr status);
+
+            // Name arrays for RunAsync, pointing into input_names_/output_names_.
+            std::vector<const char*> input_names_c_;
+            std::vector<const char*> output_names_c_;
+
+            // The destructor waits for in-flight async calls.
+            std::mutex async_mu_;
+            std::condition_variable async_cv_;
+            int in_flight_ = 0;
+
+            bool PrepareOutputSlots();
+            void AllocateSlot(OutputSlot& slot);
+
             // Helper: convert TensorView to Ort::Value (CPU zero-copy)
             Ort::Value CreateOrtTensorFromPtk(const data::TensorView& tv);
     };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <onnxruntime_cxx_api.h>
+#include <cstddef>
 #include "runtime/core/types.h"
 
 namespace ptk::onnx
@@ -11,6 +12,10 @@ namespace ptk::onnx
         {
         case core::DataType::kUint8:
             return ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8;
+        case core::DataType::kInt8:
+            return ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8;
+        case core::DataType::kUint16:
+            return ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16;
         case core::DataType::kInt32:
             return ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32;
         case core::DataType::kInt64:
@@ -19,6 +24,10 @@ namespace ptk::onnx
             return ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
         case core::DataType::kFloat64:
             return ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE;
+        case core::DataType::kFloat16:
+            return ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+        case core::DataType::kBFloat16:
+            return ONNX_TENSOR_ELEMENT_DATA_TYPE_BFLOAT16;
         default:
             return ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
         }
@@ -30,6 +39,10 @@ namespace ptk::onnx
         {
         case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
             return core::DataType::kUint8;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
+            return core::DataType::kInt8;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16:
+            return core::DataType::kUint16;
         case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
             return core::DataType::kInt32;
         case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
@@ -38,8 +51,35 @@ namespace ptk::onnx
             return core::DataType::kFloat32;
         case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE:
             return core::DataType::kFloat64;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+            return core::DataType::kFloat16;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_BFLOAT16:
+            return core::DataType::kBFloat16;
         default:
             return core::DataType::kUnknown;
         }
     }
+
+    // Bytes per element, 0 for types the engines do not exchange.
+    inline std::size_t OnnxElementSize(ONNXTensorElementDataType t)
+    {
+        switch (t)
+        {
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
+            return 1;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_BFLOAT16:
+            return 2;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+            return 4;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE:
+            return 8;
+        default:
+            return 0;
+        }
+    }
 }
\ No newline at end of file
@@ -17,6 +17,8 @@ namespace ptk::trt
         {
         case core::DataType::kFloat32:
             return nvinfer1::DataType::kFLOAT;
+        case core::DataType::kFloat16:
+            return nvinfer1::DataType::kHALF;
         case core::DataType::kInt32:
             return nvinfer1::DataType::kINT32;
         case core::DataType::kInt8:
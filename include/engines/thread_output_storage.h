@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "runtime/data/tensor.h"
+
+namespace ptk::perception {
+
+    // Buffers that EnginePool and DynamicBatcher copy outputs into for
+    // callers without preallocated outputs (see Engine::Infer). One set per
+    // thread, shared by every pool and batcher, and reused so steady state
+    // only copies.
+    inline std::vector<std::vector<std::uint8_t>>& ThreadOutputStorage() {
+        thread_local std::vector<std::vector<std::uint8_t>> storage;
+        return storage;
+    }
+
+    // Whether tv is a view handed back from the calling thread's storage,
+    // i.e. the outputs of an earlier call rather than caller buffers.
+    inline bool PointsIntoThreadStorage(const data::TensorView& tv) {
+        for (const auto& buf : ThreadOutputStorage()) {
+            if (!buf.empty() && tv.buffer().data() == buf.data()) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
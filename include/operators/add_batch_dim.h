@@ -5,5 +5,6 @@
 
 namespace ptk::operators
 {
+    // Makes dst a view of src with a leading batch dim of 1. No data is copied.
     core::Status AddBatchDim(const data::TensorView &src, data::TensorView *dst);
 }
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/frame.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+
+    struct BatchAssemblerConfig
+    {
+        int max_batch_size = 1;
+        core::TensorLayout layout = core::TensorLayout::kNchw; // kNchw or kNhwc
+        core::DataType data_type = core::DataType::kFloat32;
+        int channels = 3;
+        int height = 0;
+        int width = 0;
+    };
+
+    // Where a batch slot's data came from.
+    struct BatchEntry
+    {
+        std::int64_t frame_index = 0;
+        std::int64_t timestamp_ns = 0;
+        int camera_id = 0;
+    };
+
+    // Stacks frames into one preallocated [N,C,H,W] or [N,H,W,C] tensor.
+    // AcquireSlot hands out a view of the next batch slice so operators write
+    // straight into the batch instead of into a per-frame buffer.
+    class BatchAssembler
+    {
+    public:
+        BatchAssembler();
+
+        BatchAssembler(const BatchAssembler &) = delete;
+        BatchAssembler &operator=(const BatchAssembler &) = delete;
+
+        core::Status Init(const BatchAssemblerConfig &config);
+
+        // Drops all slots. Storage is kept for the next batch.
+        void Reset();
+
+        // Reserves the next slot for frame and returns a [C,H,W] or [H,W,C]
+        // view of it. The frame's image is not read.
+        core::Status AcquireSlot(const data::Frame &frame, data::TensorView *slot);
+
+        // Copies a contiguous per-frame tensor into the next slot.
+        core::Status Add(const data::Frame &frame, const data::TensorView &image);
+
+        // Returns the batch view. A partial batch has N = size() unless
+        // pad_to_max is set, in which case unused slots are zeroed and N is
+        // the max batch size.
+        core::Status Finalize(bool pad_to_max, data::TensorView *batch);
+
+        int size() const { return static_cast<int>(entries_.size()); }
+        int capacity() const { return config_.max_batch_size; }
+        bool full() const { return size() >= capacity(); }
+        bool empty() const { return entries_.empty(); }
+
+        // entries()[i] describes the frame in batch index i.
+        const std::vector<BatchEntry> &entries() const { return entries_; }
+
+    private:
+        std::vector<std::int64_t> SlotDims() const;
+
+        BatchAssemblerConfig config_;
+        bool initialized_;
+        std::size_t slot_bytes_;
+        std::vector<std::uint8_t> storage_;
+        std::vector<BatchEntry> entries_;
+    };
+
+} // namespace ptk::operators
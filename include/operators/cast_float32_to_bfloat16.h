@@ -0,0 +1,9 @@
+#pragma once
+
+#include "runtime/core/status.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+    core::Status CastFloat32ToBFloat16(const data::TensorView &src, data::TensorView *dst);
+}
\ No newline at end of file
@@ -1,9 +1,17 @@
 #pragma once
 
 #include "runtime/core/status.h"
+#include "runtime/core/types.h"
 #include "runtime/data/tensor.h"
 
 namespace ptk::operators
 {
-    core::Status CenterCrop(const data::TensorView &src, int crop_h, int crop_w, data::TensorView *dst);
-}
\ No newline at end of file
+    // Copies the centered crop_h x crop_w window of src into dst, one row memcpy at a time.
+    core::Status CenterCrop(const data::TensorView &src, int crop_h, int crop_w, data::TensorView *dst,
+                            core::TensorLayout layout = core::TensorLayout::kHwc);
+
+    // Points view at the centered window of src without copying. The result is a
+    // strided view that aliases src and is only valid while src's buffer is.
+    core::Status CenterCropView(const data::TensorView &src, int crop_h, int crop_w, data::TensorView *view,
+                                core::TensorLayout layout = core::TensorLayout::kHwc);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+    // A region of an image in pixel coordinates, [x0, x1) x [y0, y1). Edges may
+    // be fractional and may lie outside the image; samples there repeat the
+    // border pixels.
+    struct CropBox
+    {
+        float x0 = 0.0f;
+        float y0 = 0.0f;
+        float x1 = 0.0f;
+        float y1 = 0.0f;
+    };
+
+    // Bilinearly resamples box of a uint8 [H,W,C] src (C in [1,4]) to fill a
+    // packed uint8 [OH,OW,C] dst, using pixel-center alignment and Q8 weights.
+    // src may be a strided view (e.g. a flip), but its pixels must be packed.
+    // Runs on the calling thread: crops are small, so callers parallelize
+    // across boxes instead.
+    core::Status CropResize(const data::TensorView &src, const CropBox &box, data::TensorView *dst);
+}
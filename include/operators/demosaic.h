@@ -0,0 +1,36 @@
+#pragma once
+
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+    enum class DemosaicMethod
+    {
+        kBilinear = 0, // average of the nearest samples of each color
+        kEdgeAware,    // green interpolated along the smoother direction, less zippering on edges
+    };
+
+    struct DemosaicParams
+    {
+        DemosaicMethod method = DemosaicMethod::kBilinear;
+        int bit_depth = 0; // significant bits of uint16 input (10, 12 or 16); 0 means 16
+    };
+
+    // Reconstructs a packed [H, W, 3] RGB or BGR image from a kBayer* mosaic
+    // of the same size. H and W must be even and at least 2; borders are
+    // mirrored. dst is uint8 (uint16 input is scaled down by its bit depth) or,
+    // for uint16 input, uint16 at the input bit depth.
+    core::Status Demosaic(const data::TensorView &src, core::PixelFormat src_format,
+                          data::TensorView *dst, core::PixelFormat dst_format,
+                          const DemosaicParams &params = DemosaicParams());
+
+    // Demosaics and downscales in one pass: dst is [H / f, W / f, 3] for an
+    // even factor f, and each output pixel averages the red, green and blue
+    // samples of its f x f block. Nothing is interpolated, so at f = 2 every
+    // sensor value is read once and used once. params.method is ignored.
+    core::Status DemosaicBinned(const data::TensorView &src, core::PixelFormat src_format,
+                                data::TensorView *dst, core::PixelFormat dst_format,
+                                const DemosaicParams &params = DemosaicParams());
+}
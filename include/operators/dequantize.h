@@ -0,0 +1,11 @@
+#pragma once
+
+#include "operators/quantization_params.h"
+#include "runtime/core/status.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+    // int8 or uint8 src to float32 dst: (q - zero_point) * scale.
+    core::Status Dequantize(const data::TensorView &src, const QuantizationParams &params, data::TensorView *dst);
+}
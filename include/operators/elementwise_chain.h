@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "operators/normalization_params.h"
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+    // Records per-pixel operations on an HWC image and runs them as one pass.
+    // Nothing executes while the chain is built: Compile folds channel moves
+    // into a source channel map and consecutive affine ops into one scale and
+    // bias per channel (for uint8 input, everything into a 256-entry table per
+    // channel). Run then walks the image in row tiles that fit in L2, applies
+    // the folded ops in float and writes only the final tensor.
+    //
+    //     ElementwiseChain chain;
+    //     chain.SwapRB().Normalize(params).ToLayout(core::TensorLayout::kChw).Cast(core::DataType::kFloat16);
+    //     chain.Compile();
+    //     chain.Run(frame.image, &input_tensor);
+    class ElementwiseChain
+    {
+    public:
+        ElementwiseChain();
+
+        // Output element type: float32 (default), float16, bfloat16 or uint8.
+        // Values stay float inside the chain and are converted once on store;
+        // uint8 rounds to nearest and saturates.
+        ElementwiseChain &Cast(core::DataType dtype);
+
+        // Swaps channels 0 and 2 (RGB <-> BGR, RGBA <-> BGRA).
+        ElementwiseChain &SwapRB();
+
+        // Output channel c takes input channel order[c]; order.size() must
+        // equal the image channel count.
+        ElementwiseChain &PermuteChannels(const std::vector<int> &order);
+
+        // (x - mean[c]) / std[c]; the image must have params.num_channels channels.
+        ElementwiseChain &Normalize(const NormalizationParams &params);
+
+        // x * scale + bias on every channel.
+        ElementwiseChain &Affine(float scale, float bias);
+
+        ElementwiseChain &Clamp(float lo, float hi);
+
+        // Output layout, kHwc (default) or kChw. A leading batch dimension of 1
+        // on dst is accepted either way.
+        ElementwiseChain &ToLayout(core::TensorLayout layout);
+
+        // Folds the recorded ops. Must be called again after recording more.
+        core::Status Compile();
+
+        bool compiled() const { return compiled_; }
+
+        // src is a uint8 or float32 [H,W,C] image, C in [1,4], with packed rows
+        // (crop views are fine); dst must match the configured type and layout.
+        core::Status Run(const data::TensorView &src, data::TensorView *dst) const;
+
+    private:
+        static constexpr int kMaxChannels = 4;
+
+        enum class OpKind
+        {
+            kPermute,
+            kAffine,
+            kClamp,
+        };
+
+        struct Op
+        {
+            OpKind kind;
+            int order[kMaxChannels];
+            int channels; // channel count the op is defined for, 0 for any
+            float scale[kMaxChannels];
+            float bias[kMaxChannels];
+            float lo;
+            float hi;
+        };
+
+        // Affine followed by an optional clamp, per output channel.
+        struct Stage
+        {
+            float scale[kMaxChannels];
+            float bias[kMaxChannels];
+            bool clamp;
+            float lo;
+            float hi;
+        };
+
+        std::vector<Op> ops_;
+        core::DataType out_dtype_;
+        core::TensorLayout out_layout_;
+        std::string error_; // first invalid recording, reported by Compile
+
+        bool compiled_;
+        int exact_channels_; // 0 if any count is allowed
+        int min_channels_;
+        int channel_map_[kMaxChannels];
+        std::vector<Stage> stages_;
+        float lut_[kMaxChannels][256];
+    };
+}
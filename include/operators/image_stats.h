@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "runtime/core/status.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+    // Region of an [H,W,C] image. Zero width or height means the full frame.
+    struct ImageRoi
+    {
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+    };
+
+    struct StatsOptions
+    {
+        ImageRoi roi;
+        // Every sample_stride-th row and column is read; above 1 the results
+        // are approximate but cost about 1 / sample_stride^2 of a full pass.
+        int sample_stride = 1;
+    };
+
+    // Running moments of one channel. Partials over disjoint pixels (row
+    // chunks, tiles, frames) combine exactly with Merge.
+    struct ChannelStats
+    {
+        std::int64_t count = 0;
+        double sum = 0.0;
+        double sum_sq = 0.0;
+        double min = 0.0; // valid when count > 0
+        double max = 0.0;
+
+        double mean() const;
+        double stddev() const; // population standard deviation
+
+        void Merge(const ChannelStats &other);
+    };
+
+    struct ImageStats
+    {
+        int channels = 0;
+        ChannelStats channel[4];
+
+        void Merge(const ImageStats &other);
+    };
+
+    // Per-channel count, sum, sum of squares, min and max of a uint8 or
+    // float32 [H,W,C] image, C in [1, 4], with packed rows (crop and
+    // vertical-flip views are fine). Rows are reduced with SIMD in parallel
+    // chunks whose partials are merged; float sums may differ in the last
+    // bits between runs.
+    core::Status ComputeImageStats(const data::TensorView &src, const StatsOptions &options, ImageStats *stats);
+
+    // bins equal-width bins over [lo, hi); values outside land in the first
+    // or last bin. The default maps every uint8 value to its own bin.
+    struct HistogramParams
+    {
+        int bins = 256;
+        float lo = 0.0f;
+        float hi = 256.0f;
+    };
+
+    struct ImageHistogram
+    {
+        int channels = 0;
+        HistogramParams params;
+        std::vector<std::uint32_t> counts; // [channels][bins]
+
+        std::uint32_t count(int c, int bin) const
+        {
+            return counts[static_cast<std::size_t>(c * params.bins + bin)];
+        }
+
+        // Adds counts of a histogram with the same channels and params.
+        void Merge(const ImageHistogram &other);
+    };
+
+    // Per-channel histogram of the same inputs ComputeImageStats takes.
+    core::Status ComputeHistogram(const data::TensorView &src, const HistogramParams &params,
+                                  const StatsOptions &options, ImageHistogram *histogram);
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+
+#include "operators/simd.h"
+
+#if defined(PTK_SIMD_NEON)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSSE3)
+#include <tmmintrin.h>
+#endif
+
+namespace ptk::operators
+{
+        namespace detail
+        {
+            // Writes W pixels of three byte planes as packed 3-channel pixels.
+            inline void Interleave3(const std::uint8_t *s0, const std::uint8_t *s1, const std::uint8_t *s2,
+                                    std::uint8_t *dst, std::int64_t W)
+            {
+                std::int64_t w = 0;
+#if defined(PTK_SIMD_NEON)
+                for (; w + 16 <= W; w += 16)
+                {
+                    uint8x16x3_t px;
+                    px.val[0] = vld1q_u8(s0 + w);
+                    px.val[1] = vld1q_u8(s1 + w);
+                    px.val[2] = vld1q_u8(s2 + w);
+                    vst3q_u8(dst + w * 3, px);
+                }
+#elif defined(PTK_SIMD_SSSE3)
+                // Output byte j of the 48 byte block is channel j % 3 of pixel
+                // j / 3; mask m<k><c> places plane c's lanes into output register k.
+                const __m128i m00 = _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5);
+                const __m128i m01 = _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1);
+                const __m128i m02 = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+                const __m128i m10 = _mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1);
+                const __m128i m11 = _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10);
+                const __m128i m12 = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1);
+                const __m128i m20 = _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1);
+                const __m128i m21 = _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1);
+                const __m128i m22 = _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15);
+                for (; w + 16 <= W; w += 16)
+                {
+                    const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s0 + w));
+                    const __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s1 + w));
+                    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s2 + w));
+                    std::uint8_t *p = dst + w * 3;
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(p),
+                                     _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, m00), _mm_shuffle_epi8(g, m01)),
+                                                  _mm_shuffle_epi8(b, m02)));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 16),
+                                     _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, m10), _mm_shuffle_epi8(g, m11)),
+                                                  _mm_shuffle_epi8(b, m12)));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 32),
+                                     _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, m20), _mm_shuffle_epi8(g, m21)),
+                                                  _mm_shuffle_epi8(b, m22)));
+                }
+#endif
+                for (; w < W; ++w)
+                {
+                    dst[w * 3 + 0] = s0[w];
+                    dst[w * 3 + 1] = s1[w];
+                    dst[w * 3 + 2] = s2[w];
+                }
+            }
+
+            // Splits W packed 3-channel pixels into three byte planes.
+            inline void Deinterleave3(const std::uint8_t *src, std::uint8_t *d0, std::uint8_t *d1,
+                                      std::uint8_t *d2, std::int64_t W)
+            {
+                std::int64_t w = 0;
+#if defined(PTK_SIMD_NEON)
+                for (; w + 16 <= W; w += 16)
+                {
+                    const uint8x16x3_t px = vld3q_u8(src + w * 3);
+                    vst1q_u8(d0 + w, px.val[0]);
+                    vst1q_u8(d1 + w, px.val[1]);
+                    vst1q_u8(d2 + w, px.val[2]);
+                }
+#elif defined(PTK_SIMD_SSSE3)
+                // Byte i of channel c lives at 3 * i + c of the 48 byte block;
+                // each mask pulls the lanes one source register holds.
+                const __m128i m00 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+                const __m128i m01 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+                const __m128i m02 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+                const __m128i m10 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+                const __m128i m11 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+                const __m128i m12 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+                const __m128i m20 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+                const __m128i m21 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+                const __m128i m22 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+                for (; w + 16 <= W; w += 16)
+                {
+                    const std::uint8_t *p = src + w * 3;
+                    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16));
+                    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 32));
+                    const __m128i r = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m00), _mm_shuffle_epi8(b, m01)),
+                                                   _mm_shuffle_epi8(c, m02));
+                    const __m128i g = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m10), _mm_shuffle_epi8(b, m11)),
+                                                   _mm_shuffle_epi8(c, m12));
+                    const __m128i bl = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, m20), _mm_shuffle_epi8(b, m21)),
+                                                    _mm_shuffle_epi8(c, m22));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(d0 + w), r);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(d1 + w), g);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(d2 + w), bl);
+                }
+#endif
+                for (; w < W; ++w)
+                {
+                    d0[w] = src[w * 3 + 0];
+                    d1[w] = src[w * 3 + 1];
+                    d2[w] = src[w * 3 + 2];
+                }
+            }
+
+            // Splits W packed 4-channel pixels into four byte planes.
+            inline void Deinterleave4(const std::uint8_t *src, std::uint8_t *d0, std::uint8_t *d1,
+                                      std::uint8_t *d2, std::uint8_t *d3, std::int64_t W)
+            {
+                std::int64_t w = 0;
+#if defined(PTK_SIMD_NEON)
+                for (; w + 16 <= W; w += 16)
+                {
+                    const uint8x16x4_t px = vld4q_u8(src + w * 4);
+                    vst1q_u8(d0 + w, px.val[0]);
+                    vst1q_u8(d1 + w, px.val[1]);
+                    vst1q_u8(d2 + w, px.val[2]);
+                    vst1q_u8(d3 + w, px.val[3]);
+                }
+#elif defined(PTK_SIMD_SSSE3)
+                // Gather each register's four pixels channel by channel, then
+                // transpose the 4x4 grid of 32-bit channel groups.
+                const __m128i m = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+                for (; w + 16 <= W; w += 16)
+                {
+                    const __m128i *p = reinterpret_cast<const __m128i *>(src + w * 4);
+                    const __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(p), m);
+                    const __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(p + 1), m);
+                    const __m128i c = _mm_shuffle_epi8(_mm_loadu_si128(p + 2), m);
+                    const __m128i d = _mm_shuffle_epi8(_mm_loadu_si128(p + 3), m);
+                    const __m128i ab_lo = _mm_unpacklo_epi32(a, b);
+                    const __m128i cd_lo = _mm_unpacklo_epi32(c, d);
+                    const __m128i ab_hi = _mm_unpackhi_epi32(a, b);
+                    const __m128i cd_hi = _mm_unpackhi_epi32(c, d);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(d0 + w), _mm_unpacklo_epi64(ab_lo, cd_lo));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(d1 + w), _mm_unpackhi_epi64(ab_lo, cd_lo));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(d2 + w), _mm_unpacklo_epi64(ab_hi, cd_hi));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(d3 + w), _mm_unpackhi_epi64(ab_hi, cd_hi));
+                }
+#endif
+                for (; w < W; ++w)
+                {
+                    d0[w] = src[w * 4 + 0];
+                    d1[w] = src[w * 4 + 1];
+                    d2[w] = src[w * 4 + 2];
+                    d3[w] = src[w * 4 + 3];
+                }
+            }
+        } // namespace detail
+} // namespace ptk::operators
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+#include "runtime/core/types.h"
+
+namespace ptk::operators
+{
+    // Kernels are templates on element type, layout and channel count so the
+    // common cases compile to unrolled, vectorizable loops; the Dispatch*
+    // helpers turn the runtime tensor description into those template
+    // arguments once per call, outside any loop.
+
+    // Channel count known at compile time. Channels<0> is the generic
+    // instantiation that reads the count at run time.
+    template <int N>
+    using Channels = std::integral_constant<int, N>;
+
+    template <core::TensorLayout L>
+    using Layout = std::integral_constant<core::TensorLayout, L>;
+
+    template <typename T>
+    struct TypeTag
+    {
+        using type = T;
+    };
+
+    template <typename T>
+    struct DataTypeOf;
+    template <>
+    struct DataTypeOf<std::uint8_t> : std::integral_constant<core::DataType, core::DataType::kUint8>
+    {
+    };
+    template <>
+    struct DataTypeOf<std::int8_t> : std::integral_constant<core::DataType, core::DataType::kInt8>
+    {
+    };
+    template <>
+    struct DataTypeOf<std::uint16_t> : std::integral_constant<core::DataType, core::DataType::kUint16>
+    {
+    };
+    template <>
+    struct DataTypeOf<std::int32_t> : std::integral_constant<core::DataType, core::DataType::kInt32>
+    {
+    };
+    template <>
+    struct DataTypeOf<std::int64_t> : std::integral_constant<core::DataType, core::DataType::kInt64>
+    {
+    };
+    template <>
+    struct DataTypeOf<float> : std::integral_constant<core::DataType, core::DataType::kFloat32>
+    {
+    };
+    template <>
+    struct DataTypeOf<double> : std::integral_constant<core::DataType, core::DataType::kFloat64>
+    {
+    };
+
+    // Channel count a kernel instantiated for Channels<N> loops over.
+    template <int N>
+    constexpr std::int64_t ChannelCount(std::int64_t runtime_channels)
+    {
+        return N > 0 ? N : runtime_channels;
+    }
+
+    // Calls fn(Channels<C>{}) for C in [1, 4] and fn(Channels<0>{}) otherwise.
+    template <typename Fn>
+    decltype(auto) DispatchChannels(std::int64_t channels, Fn &&fn)
+    {
+        switch (channels)
+        {
+        case 1:
+            return fn(Channels<1>{});
+        case 2:
+            return fn(Channels<2>{});
+        case 3:
+            return fn(Channels<3>{});
+        case 4:
+            return fn(Channels<4>{});
+        default:
+            return fn(Channels<0>{});
+        }
+    }
+
+    // Calls fn(TypeTag<T>{}) for the T in Ts whose DataTypeOf is dtype. Only
+    // the listed types are instantiated; returns false if none matches.
+    template <typename... Ts, typename Fn>
+    bool DispatchDType(core::DataType dtype, Fn &&fn)
+    {
+        bool matched = false;
+        ((!matched && dtype == DataTypeOf<Ts>::value ? (fn(TypeTag<Ts>{}), matched = true) : false), ...);
+        return matched;
+    }
+
+    // Calls fn(Layout<L>{}) for L in Ls equal to layout; returns false if none is.
+    template <core::TensorLayout... Ls, typename Fn>
+    bool DispatchLayout(core::TensorLayout layout, Fn &&fn)
+    {
+        bool matched = false;
+        ((!matched && layout == Ls ? (fn(Layout<Ls>{}), matched = true) : false), ...);
+        return matched;
+    }
+}
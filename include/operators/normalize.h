@@ -7,5 +7,32 @@
 
 namespace ptk::operators
 {
+    // Precomputes (x - mean) / std as x * scale + bias per channel, plus a
+    // 256-entry table per channel for uint8 input. Build once, apply per frame.
+    class Normalizer
+    {
+    public:
+        Normalizer();
+
+        core::Status Init(const NormalizationParams &params);
+
+        // In place on a float32 tensor.
+        core::Status Apply(data::TensorView *tensor, core::TensorLayout layout) const;
+
+        // uint8 src to float32 dst of the same shape and layout in one pass.
+        core::Status Apply(const data::TensorView &src, data::TensorView *dst, core::TensorLayout layout) const;
+
+        bool initialized() const { return num_channels_ > 0; }
+
+    private:
+        int num_channels_;
+        float scale_[4];
+        float bias_[4];
+        float lut_[4][256];
+    };
+
     core::Status Normalize(data::TensorView *tensor, const NormalizationParams &params, core::TensorLayout layout);
-}
\ No newline at end of file
+
+    core::Status NormalizeUint8(const data::TensorView &src, const NormalizationParams &params,
+                                core::TensorLayout layout, data::TensorView *dst);
+}
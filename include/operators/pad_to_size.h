@@ -1,9 +1,13 @@
 #pragma once
 
 #include "runtime/core/status.h"
+#include "runtime/core/types.h"
 #include "runtime/data/tensor.h"
 
 namespace ptk::operators
 {
-    core::Status PadToSize(const data::TensorView &src, int target_h, int target_w, data::TensorView *dst);
-}
\ No newline at end of file
+    // Centers src inside a target_h x target_w dst. Source rows are copied once and
+    // only the pad margins are filled with pad_value.
+    core::Status PadToSize(const data::TensorView &src, int target_h, int target_w, data::TensorView *dst,
+                           core::TensorLayout layout = core::TensorLayout::kHwc, float pad_value = 0.0f);
+}
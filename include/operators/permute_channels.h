@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+#include "runtime/core/status.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+    // dst channel c takes src channel order[c]. src and dst are contiguous
+    // [..., C] tensors of the same type (uint8 or float32) with equal leading
+    // dimensions; src has 1 to 4 channels and dst has order.size() channels,
+    // also 1 to 4, so the same call swaps, selects or drops channels.
+    //
+    // dst may alias src when it has no more channels than src: swaps run in
+    // place row-parallel, channel drops compact the buffer on the calling
+    // thread. Pixels are moved with one byte shuffle (pshufb / tbl) per 16
+    // bytes where the CPU has it.
+    core::Status PermuteChannels(const data::TensorView &src, const std::vector<int> &order,
+                                 data::TensorView *dst);
+
+    // [..., 4] to [..., 3], dropping alpha.
+    core::Status RgbaToRgb(const data::TensorView &src, data::TensorView *dst);
+
+    // [..., 4] BGRA to [..., 3] RGB.
+    core::Status BgraToRgb(const data::TensorView &src, data::TensorView *dst);
+}
@@ -3,8 +3,17 @@
 #include "runtime/components/component_interface.h"
 #include "runtime/core/port.h"
 #include "runtime/data/frame.h"
+#include "runtime/data/tensor_spec.h"
 #include "runtime/core/types.h"
+#include "operators/demosaic.h"
+#include "operators/elementwise_chain.h"
 #include "operators/normalization_params.h"
+#include "operators/normalize.h"
+#include "operators/quantization_params.h"
+#include "operators/quantize.h"
+#include "operators/remap.h"
+#include "operators/rotate_flip.h"
+#include "operators/yuv_to_rgb.h"
 
 namespace ptk {
 
@@ -20,13 +29,38 @@ namespace ptk {
         bool convert_rgb_to_bgr;
         bool normalize;
         bool add_batch_dimension;
-        bool to_grayscale;
+        bool to_grayscale;                   // RGB/BGR frames become one luma channel (BT.601)
         operators::NormalizationParams norm;
+        operators::QuantizationParams quant; // used when output_type is kInt8
+        operators::YuvConversionParams yuv;  // used for YUYV, NV12 and I420 frames
+        operators::DemosaicParams bayer;     // used for kBayer* frames
+        int bayer_downscale = 0;             // even factor binned while demosaicing; 0 or 1 for full size
+        bool undistort = false;              // remove lens distortion from HWC uint8 frames
+        operators::CameraIntrinsics camera;
+        operators::DistortionCoefficients distortion;
+        // Applied after undistortion, the flip before the clockwise rotation
+        // (for cameras mounted sideways or upside down).
+        operators::FlipMode flip = operators::FlipMode::kNone;
+        operators::Rotation rotation = operators::Rotation::kNone;
 
-        int target_height;
-        int target_width;
+        int target_height = 0;
+        int target_width = 0;
+
+        // Expected camera frame size in pixels, 0 if unknown. When set, Init
+        // reserves every scratch buffer so the first frame does not allocate.
+        int input_height = 0;
+        int input_width = 0;
     };
 
+    // Sets the output side of config from a model input spec (see
+    // Engine::InputSpecs): output_type from its dtype, output_layout and
+    // add_batch_dimension from its rank, target size from static spatial dims
+    // and grayscale output for one channel. Rank 3 or 4 specs whose channel
+    // dim comes first (1 or 3, with the last dim not) are taken as CHW/NCHW.
+    // Fails for other channel counts and for a static batch above 1, since
+    // each tick produces a single frame.
+    core::Status ConfigureFromModelInput(const data::TensorSpec& spec, PreprocessorConfig* config);
+
     class Preprocessor : public components::ComponentInterface {
         public:
             explicit Preprocessor(const PreprocessorConfig& config);
@@ -45,9 +79,17 @@ namespace ptk {
             core::InputPort<data::Frame>* input_;
             core::OutputPort<data::Frame>* output_;
             PreprocessorConfig config_;
+            operators::Normalizer normalizer_;
+            operators::ImageQuantizer quantizer_;
+            operators::ElementwiseChain chain_; // compiled only for HWC input and float output
+            operators::Remapper undistorter_;   // built for the first frame size seen
 
             std::vector<float> float_buffer_;
             std::vector<std::uint8_t> uint8_temp_;
+            std::vector<std::uint8_t> color_temp_;
+            std::vector<std::uint8_t> gray_temp_;
+            std::vector<std::uint8_t> undistort_temp_;
+            std::vector<std::uint8_t> orient_temp_;
 
             data::Frame output_frame_;
     };
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "runtime/core/status.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+        // Affine quantization q = saturate(round(x / scale) + zero_point), with
+        // round half to even as in ONNX QuantizeLinear. One scale means
+        // per-tensor; otherwise there is one scale per index of dim `axis`.
+        struct QuantizationParams
+        {
+            std::vector<float> scales;
+            std::vector<std::int32_t> zero_points;
+            int axis = 0;
+        };
+
+        // Views shape as [outer, channels, inner] around params.axis and checks
+        // that params fit it. Per-tensor params give channels = inner = 1 and
+        // outer = the element count.
+        core::Status ResolveQuantizationAxis(const data::TensorShape &shape, const QuantizationParams &params,
+                                             std::int64_t *outer, std::int64_t *channels, std::int64_t *inner);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+#include "operators/normalization_params.h"
+#include "operators/quantization_params.h"
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+    // float32 src to int8 or uint8 dst of the same shape.
+    core::Status Quantize(const data::TensorView &src, const QuantizationParams &params, data::TensorView *dst);
+
+    // Normalizes and quantizes a uint8 image in one step through a 256-entry
+    // table per channel, so a QDQ model's input is written at one byte per
+    // element without a float intermediate. Build once, apply per frame.
+    class ImageQuantizer
+    {
+    public:
+        ImageQuantizer();
+
+        // params holds one scale, or one per image channel. dtype is kInt8 or
+        // kUint8. norm and params are in output channel order; swap_rb makes
+        // output channels 0 and 2 read each other's source channel (RGB <-> BGR).
+        core::Status Init(const NormalizationParams &norm, const QuantizationParams &params,
+                          core::DataType dtype, bool swap_rb = false);
+
+        // src is a uint8 HWC or CHW image; crop views with packed rows are
+        // accepted. dst is the same image in dst_layout (kHwc or kChw), with
+        // an optional leading batch dim of 1, in the Init dtype.
+        core::Status Apply(const data::TensorView &src, data::TensorView *dst, core::TensorLayout layout,
+                           core::TensorLayout dst_layout) const;
+
+        bool initialized() const { return num_channels_ > 0; }
+
+    private:
+        int num_channels_;
+        core::DataType dtype_;
+        int channel_map_[4];       // source channel of each output channel
+        std::uint8_t lut_[4][256]; // quantized values as raw bytes
+    };
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "runtime/core/status.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+    // Pinhole camera matrix, in pixels.
+    struct CameraIntrinsics
+    {
+        float fx = 0.0f;
+        float fy = 0.0f;
+        float cx = 0.0f;
+        float cy = 0.0f;
+    };
+
+    // Radial (k1, k2, k3) and tangential (p1, p2) lens distortion, in the
+    // same convention as OpenCV's five-coefficient model.
+    struct DistortionCoefficients
+    {
+        float k1 = 0.0f;
+        float k2 = 0.0f;
+        float p1 = 0.0f;
+        float p2 = 0.0f;
+        float k3 = 0.0f;
+    };
+
+    // Resamples images through a map computed once. Each output pixel stores
+    // the index of its top-left source pixel and its x/y fraction in 1/32
+    // steps (6 bytes per pixel, independent of the channel count), and Apply
+    // blends the 2x2 neighbourhood with fixed-point weights. Build once,
+    // apply per frame.
+    class Remapper
+    {
+    public:
+        Remapper();
+
+        // Map that undistorts a src_height x src_width frame into an
+        // out_height x out_width one. Without new_camera the output camera is
+        // `camera` scaled to the output size, so undistortion and resize happen
+        // in the same pass.
+        core::Status InitUndistort(const CameraIntrinsics &camera, const DistortionCoefficients &distortion,
+                                   int src_height, int src_width, int out_height, int out_width,
+                                   const CameraIntrinsics *new_camera = nullptr);
+
+        // Arbitrary map: output pixel (y, x) samples source coordinates
+        // (map_y[i], map_x[i]), i = y * out_width + x.
+        core::Status Init(const std::vector<float> &map_x, const std::vector<float> &map_y,
+                          int src_height, int src_width, int out_height, int out_width);
+
+        // src is a contiguous uint8 [src_height, src_width, C] image, C in
+        // [1, 4]; dst is [out_height, out_width, C]. Pixels that map outside
+        // the source are written as 0.
+        core::Status Apply(const data::TensorView &src, data::TensorView *dst) const;
+
+        bool initialized() const { return out_height_ > 0; }
+        int src_height() const { return src_height_; }
+        int src_width() const { return src_width_; }
+
+    private:
+        int src_height_;
+        int src_width_;
+        int out_height_;
+        int out_width_;
+        std::vector<std::int32_t> offsets_;  // source pixel index, -1 if outside
+        std::vector<std::uint16_t> weights_; // fy * 33 + fx, fractions in [0, 32]
+        std::uint32_t table_[33 * 33][2];    // Q14 weights (w00 | w01 << 16, w10 | w11 << 16)
+    };
+}
@@ -5,5 +5,7 @@
 
 namespace ptk::operators
 {
+    // Swaps channels 0 and 2 of a uint8 or float32 [..., 3] or [..., 4]
+    // tensor (alpha stays last). dst may be src for an in-place swap.
     core::Status RgbToBgr(const data::TensorView &src, data::TensorView *dst);
-}
\ No newline at end of file
+}
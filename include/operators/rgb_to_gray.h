@@ -5,5 +5,18 @@
 
 namespace ptk::operators
 {
-    core::Status RgbToGray(const data::TensorView &src, data::TensorView *dst);
-}
\ No newline at end of file
+    enum class LumaWeights
+    {
+        kBt601 = 0, // 0.299 R + 0.587 G + 0.114 B
+        kBt709,     // 0.2126 R + 0.7152 G + 0.0722 B
+    };
+
+    // [H,W,3] to [H,W,1], both uint8 or both float32. The uint8 path is
+    // integer only: one pass reading three bytes and writing one per pixel.
+    core::Status RgbToGray(const data::TensorView &src, data::TensorView *dst,
+                           LumaWeights weights = LumaWeights::kBt601);
+
+    // Same as RgbToGray for BGR channel order.
+    core::Status BgrToGray(const data::TensorView &src, data::TensorView *dst,
+                           LumaWeights weights = LumaWeights::kBt601);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+    enum class FlipMode
+    {
+        kNone = 0,
+        kHorizontal, // mirror left-right
+        kVertical,   // mirror top-bottom
+        kBoth,       // same as a 180 degree rotation
+    };
+
+    // Clockwise rotation.
+    enum class Rotation
+    {
+        kNone = 0,
+        k90,  // [H,W,C] -> [W,H,C]
+        k180,
+        k270, // [H,W,C] -> [W,H,C]
+    };
+
+    // Points view at src flipped, without copying: the view has negative
+    // strides on the flipped axes and its buffer starts at the element that
+    // becomes index 0. A vertical flip keeps rows packed, so operators that
+    // take crop views (ElementwiseChain, ImageQuantizer, CastUint8ToFloat32,
+    // PadToSize) read it directly; horizontal flips need a strided reader or
+    // Flip. The view aliases src and is only valid while src's buffer is.
+    core::Status FlipView(const data::TensorView &src, FlipMode mode, data::TensorView *view);
+
+    // Same as FlipView for rotations; 90 and 270 degrees swap H and W.
+    core::Status RotateView(const data::TensorView &src, Rotation rotation, data::TensorView *view);
+
+    // Materializing versions: src is a uint8 or float32 [H,W,C] tensor, C in
+    // [1, 4], with any strides (crop and flip views included); dst is
+    // contiguous of the flipped or rotated shape. Flips copy or reverse whole
+    // rows, rotations go through a cache-blocked transpose, so either costs
+    // about one pass over the image. Flip with kNone packs src as is, e.g. a
+    // composition of FlipView and RotateView.
+    core::Status Flip(const data::TensorView &src, FlipMode mode, data::TensorView *dst);
+
+    core::Status Rotate(const data::TensorView &src, Rotation rotation, data::TensorView *dst);
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// Instruction sets the operator kernels may use, from the compiler's target
+// flags. Kernels test these instead of the compiler's own macros, so building
+// with PTK_NO_SIMD defined compiles only their portable scalar paths; the
+// tests run both builds against the same references.
+#if !defined(PTK_NO_SIMD)
+#if defined(__ARM_NEON)
+#define PTK_SIMD_NEON 1
+#if defined(__aarch64__)
+#define PTK_SIMD_NEON64 1 // A64-only NEON (tbl, horizontal adds, fp16 conversions)
+#endif
+#endif
+#if defined(__SSE2__)
+#define PTK_SIMD_SSE2 1
+#endif
+#if defined(__SSSE3__)
+#define PTK_SIMD_SSSE3 1
+#endif
+#if defined(__F16C__)
+#define PTK_SIMD_F16C 1
+#endif
+#if defined(__AVX512F__)
+#define PTK_SIMD_AVX512F 1
+#endif
+#if defined(__AVX512BF16__)
+#define PTK_SIMD_AVX512BF16 1
+#endif
+#endif
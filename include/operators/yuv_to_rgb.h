@@ -0,0 +1,35 @@
+#pragma once
+
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+    enum class YuvMatrix
+    {
+        kBt601 = 0, // SD video and most USB camera output
+        kBt709,     // HD video
+    };
+
+    struct YuvConversionParams
+    {
+        YuvMatrix matrix = YuvMatrix::kBt601;
+        bool full_range = false; // limited (studio) range puts Y in [16, 235]
+    };
+
+    // Converts a uint8 YUYV, NV12 or I420 image into a packed uint8 RGB, BGR
+    // or Gray image of the same height and width, using fixed-point math.
+    // src shape follows core::PixelFormat; dst is [H, W, 3] or [H, W, 1].
+    // H and W must be even.
+    core::Status YuvToRgb(const data::TensorView &src, core::PixelFormat src_format,
+                          data::TensorView *dst, core::PixelFormat dst_format,
+                          const YuvConversionParams &params = YuvConversionParams());
+
+    // Same as YuvToRgb but dst may have any height and width: each output pixel
+    // is sampled bilinearly from the Y and chroma planes and converted directly,
+    // so the full-resolution RGB image is never materialized.
+    core::Status YuvToRgbResized(const data::TensorView &src, core::PixelFormat src_format,
+                                 data::TensorView *dst, core::PixelFormat dst_format,
+                                 const YuvConversionParams &params = YuvConversionParams());
+}
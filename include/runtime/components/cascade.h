@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "engines/engine.h"
+#include "operators/batch_assembler.h"
+#include "operators/elementwise_chain.h"
+#include "operators/normalization_params.h"
+#include "runtime/components/component_interface.h"
+#include "runtime/core/port.h"
+#include "runtime/core/status.h"
+#include "runtime/data/detection.h"
+#include "runtime/data/frame.h"
+
+namespace ptk::components
+{
+
+        // Turns detector outputs into boxes in detector input pixels. Only box,
+        // score and class_id are read from the results.
+        using DetectionDecoder =
+            std::function<core::Status(const std::vector<data::TensorView> &outputs, std::vector<data::Detection> *)>;
+
+        // Default decoder: output 0 is float32 [N,K] or [1,N,K], K >= 6, with
+        // rows x0, y0, x1, y1, score, class (the usual post-NMS export).
+        core::Status DecodeBoxRows(const std::vector<data::TensorView> &outputs, std::vector<data::Detection> *out);
+
+        struct CascadeConfig
+        {
+            // Boxes classified per frame, highest scores first. Further boxes
+            // are still published, without second-stage results.
+            int max_rois = 16;
+            // Lower-scoring boxes, and boxes with no area, are dropped.
+            float min_score = 0.25f;
+            // Each box grows by this fraction of its size on every side before
+            // cropping, for classifiers trained with context.
+            float roi_padding = 0.0f;
+
+            // Classifier preprocessing of the RGB crops; layout, size and
+            // element type come from the classifier's input spec.
+            bool swap_rb = false;
+            bool normalize = false;
+            operators::NormalizationParams norm{};
+
+            // Classifier output attached to each box as its attributes.
+            int classifier_output = 0;
+
+            DetectionDecoder decode = DecodeBoxRows;
+        };
+
+        struct CascadeStats
+        {
+            std::uint64_t frames = 0;
+            std::uint64_t rois = 0;    // boxes classified
+            std::uint64_t capped = 0;  // boxes over max_rois
+            std::uint64_t failures = 0;
+            std::int64_t last_latency_ns = 0;
+        };
+
+        // Detector followed by a per-box classifier in one stage. Each tick runs
+        // the detector on the preprocessed frame, crop-resizes every kept box
+        // from the source frame into a uint8 crop, converts that crop into its
+        // slot of one classifier batch (both in parallel across boxes), runs
+        // the classifier once for all of them and publishes the boxes with
+        // their results. All buffers are sized at Init from the classifier's
+        // input spec.
+        class CascadeComponent : public ComponentInterface
+        {
+        public:
+            // Engines are not owned and must be loaded before Init. The
+            // classifier's input must have static height, width and channels.
+            CascadeComponent(perception::Engine *detector, perception::Engine *classifier,
+                             const CascadeConfig &config);
+            ~CascadeComponent() override = default;
+
+            // The full-resolution uint8 [H,W,C] RGB frame boxes are cropped from.
+            void BindSource(core::InputPort<data::Frame> *in);
+            // The same frame preprocessed for the detector. Boxes are mapped to
+            // source pixels through both frames' to_source transforms, which
+            // Preprocessor keeps up to date.
+            void BindDetectorInput(core::InputPort<data::Frame> *in);
+            void BindOutput(core::OutputPort<data::DetectionList> *out);
+
+            core::Status Init(core::RuntimeContext *context) override;
+            core::Status Start() override;
+            core::Status Stop() override;
+            void Tick() override;
+
+            const CascadeStats &stats() const { return stats_; }
+
+        private:
+            core::Status RunDetector(const data::Frame &source, const data::Frame &detector_input);
+            core::Status RunClassifier(const data::Frame &source);
+
+            perception::Engine *detector_;
+            perception::Engine *classifier_;
+            CascadeConfig config_;
+            core::RuntimeContext *context_;
+            core::InputPort<data::Frame> *source_;
+            core::InputPort<data::Frame> *detector_input_;
+            core::OutputPort<data::DetectionList> *output_;
+
+            std::size_t detector_rank_ = 0;
+            bool pad_batch_ = false;            // classifier batch dim is fixed
+            int crop_height_ = 0;
+            int crop_width_ = 0;
+            int crop_channels_ = 0;
+            operators::BatchAssembler batch_;
+            operators::ElementwiseChain chain_;
+            std::vector<std::uint8_t> crop_storage_; // one crop per ROI
+
+            std::vector<data::Detection> detections_;
+            std::vector<data::TensorView> detector_inputs_;
+            std::vector<data::TensorView> detector_outputs_;
+            std::vector<data::TensorView> slots_;
+            std::vector<core::Status> crop_status_;
+            std::vector<data::TensorView> classifier_inputs_;
+            std::vector<data::TensorView> classifier_outputs_;
+            CascadeStats stats_;
+        };
+
+} // namespace ptk::components
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "engines/engine.h"
+#include "runtime/components/component_interface.h"
+#include "runtime/core/status.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::components
+{
+
+        struct DynamicBatcherConfig
+        {
+            int max_batch_size = 8;
+            // A batch runs once it is full or its oldest request has waited
+            // this long.
+            int max_wait_us = 2000;
+            // Requests that may be pending; Infer fails fast beyond that.
+            int max_queue = 256;
+            // Zero-fill partial batches up to max_batch_size, for models with
+            // a fixed batch dimension.
+            bool pad_to_max_batch = false;
+            // Run batches on a worker thread started by Start. Without it
+            // Tick runs every batch that is due, so producers must then call
+            // Infer from threads other than the scheduler's.
+            bool own_thread = true;
+        };
+
+        struct DynamicBatcherStats
+        {
+            std::uint64_t requests = 0;
+            std::uint64_t batches = 0;
+            std::uint64_t rejected = 0;
+            // batch_size[n]: batches of n requests, n in [1, max_batch_size].
+            std::vector<std::uint64_t> batch_size;
+            // queue_delay_us[b]: requests that waited [2^b, 2^(b+1)) us before
+            // their batch started; bucket 0 also holds waits under 1 us.
+            std::vector<std::uint64_t> queue_delay_us;
+        };
+
+        // Groups single-sample requests from many producer threads into
+        // batches and runs one Engine::Infer per batch. Every model input and
+        // output has a leading batch dimension; requests pass one sample
+        // without it, and get their slice of each output back.
+        class DynamicBatcher : public ComponentInterface
+        {
+        public:
+            // engine is not owned and is only used by the batching thread.
+            DynamicBatcher(perception::Engine *engine, const DynamicBatcherConfig &config);
+            ~DynamicBatcher() override;
+
+            core::Status Init(core::RuntimeContext *context) override;
+            core::Status Start() override;
+            core::Status Stop() override;
+            void Tick() override;
+
+            // Thread safe, blocks until the request's batch ran. inputs are
+            // contiguous samples; requests batch together while their shapes
+            // match. Preallocated outputs (one non-empty view per model output)
+            // receive the slices; otherwise outputs are set to views of the
+            // calling thread's storage (see perception::Engine::Infer).
+            core::Status Infer(const std::vector<data::TensorView> &inputs, std::vector<data::TensorView> &outputs);
+
+            DynamicBatcherStats stats() const;
+
+        private:
+            struct Request
+            {
+                const std::vector<data::TensorView> *inputs = nullptr;
+                std::vector<data::TensorView> *outputs = nullptr;
+                std::vector<std::vector<std::uint8_t>> *storage = nullptr; // when outputs are not preallocated
+                std::chrono::steady_clock::time_point enqueued;
+                core::Status status;
+                bool done = false;
+            };
+
+            using Clock = std::chrono::steady_clock;
+
+            void WorkerLoop();
+            void Shutdown();
+
+            // Runs the batch in batch_ with mu_ released, then completes its
+            // requests. Requires lock to hold mu_.
+            void RunTaken(std::unique_lock<std::mutex> &lock);
+
+            // Pops up to max_batch_size requests of matching shapes. Requires mu_.
+            void TakeBatch(std::vector<Request *> *batch);
+            void RunBatch(const std::vector<Request *> &batch);
+            core::Status GatherInputs(const std::vector<Request *> &batch);
+            void ScatterOutputs(const std::vector<Request *> &batch);
+
+            perception::Engine *engine_;
+            DynamicBatcherConfig config_;
+            core::RuntimeContext *context_;
+            std::size_t num_inputs_;
+            std::size_t num_outputs_;
+
+            mutable std::mutex mu_;
+            std::condition_variable queue_cv_; // worker: requests arrived or stop
+            std::condition_variable done_cv_;  // producers: a batch finished
+            std::deque<Request *> queue_;
+            bool running_;
+            std::thread worker_;
+            DynamicBatcherStats stats_;
+
+            // Used by the batching thread only; reused across batches.
+            std::vector<std::vector<std::uint8_t>> batch_storage_;
+            std::vector<data::TensorView> batch_inputs_;
+            std::vector<data::TensorView> batch_outputs_;
+            std::vector<Request *> batch_;
+        };
+
+} // namespace ptk::components
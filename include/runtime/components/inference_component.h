@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engines/engine.h"
+#include "runtime/components/component_interface.h"
+#include "runtime/core/port.h"
+#include "runtime/core/status.h"
+#include "runtime/data/frame.h"
+#include "runtime/data/tensor_packet.h"
+#include "runtime/data/tensor_spec.h"
+
+namespace ptk::components
+{
+
+        struct InferenceComponentConfig
+        {
+            // Sets of output buffers rotated across ticks. A published tensor
+            // stays valid for this many ticks, so consumers that run later in
+            // the schedule, or keep the previous result, never see it
+            // overwritten.
+            int output_buffers = 2;
+        };
+
+        struct InferenceStats
+        {
+            std::uint64_t frames = 0;
+            std::uint64_t failures = 0;
+            std::int64_t last_latency_ns = 0;
+            std::int64_t total_latency_ns = 0;
+        };
+
+        // Runs a single-input engine on each preprocessed frame and publishes
+        // every model output on its own port. Outputs whose shape the model
+        // fixes (given the frame's shape) are written by the engine straight
+        // into pooled buffers; others are copied there from the engine's
+        // views. Buffers only grow, so steady state does not allocate.
+        class InferenceComponent : public ComponentInterface
+        {
+        public:
+            // engine is not owned and must be loaded before Init.
+            InferenceComponent(perception::Engine *engine, const InferenceComponentConfig &config);
+            ~InferenceComponent() override = default;
+
+            // The frame's image is the model input. A rank one below the
+            // model's gets a leading batch dim of 1.
+            void BindInput(core::InputPort<data::Frame> *in);
+            // index follows Engine::OutputNames(); unbound outputs are still
+            // computed but not published.
+            void BindOutput(std::size_t index, core::OutputPort<data::TensorPacket> *out);
+            // By output name; false if the model has no such output.
+            bool BindOutput(const std::string &name, core::OutputPort<data::TensorPacket> *out);
+
+            core::Status Init(core::RuntimeContext *context) override;
+            core::Status Start() override;
+            core::Status Stop() override;
+            void Tick() override;
+
+            const InferenceStats &stats() const { return stats_; }
+
+        private:
+            // Output shapes for this input shape, with symbolic dims filled
+            // from same-named input dims. False if any output stays symbolic.
+            bool ResolveOutputShapes(const data::TensorShape &input_shape);
+            void Publish(const data::Frame &frame);
+
+            perception::Engine *engine_;
+            InferenceComponentConfig config_;
+            core::RuntimeContext *context_;
+            core::InputPort<data::Frame> *input_;
+            std::vector<core::OutputPort<data::TensorPacket> *> outputs_;
+            std::vector<std::string> output_names_;
+
+            data::TensorSpec input_spec_;
+            std::vector<data::TensorSpec> output_specs_;
+
+            // Output shapes resolved for resolved_input_; empty when they
+            // depend on the run.
+            std::vector<data::TensorShape> resolved_shapes_;
+            std::vector<std::int64_t> resolved_input_;
+            bool resolved_ = false;
+
+            // buffers_[slot][output]
+            std::vector<std::vector<std::vector<std::uint8_t>>> buffers_;
+            std::size_t slot_ = 0;
+
+            std::vector<data::TensorView> inputs_;
+            std::vector<data::TensorView> results_;
+            InferenceStats stats_;
+        };
+
+} // namespace ptk::components
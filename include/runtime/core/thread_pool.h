@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ptk::core
+{
+
+        // Fixed set of worker threads for data-parallel operator loops. The
+        // calling thread always takes part, so a pool of N threads starts N - 1
+        // workers.
+        class ThreadPool
+        {
+        public:
+            explicit ThreadPool(int num_threads);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool &) = delete;
+            ThreadPool &operator=(const ThreadPool &) = delete;
+
+            int num_threads() const { return static_cast<int>(workers_.size()) + 1; }
+
+            // Splits [begin, end) into at most num_threads() chunks of at least
+            // min_chunk items and runs fn(chunk_begin, chunk_end) on each. Returns
+            // once every chunk is done. Calls made from inside a pool task run
+            // inline to avoid deadlock.
+            void ParallelFor(std::int64_t begin, std::int64_t end, std::int64_t min_chunk,
+                             const std::function<void(std::int64_t, std::int64_t)> &fn);
+
+            // Process-wide pool sized to the hardware concurrency.
+            static ThreadPool &Default();
+
+        private:
+            void WorkerLoop();
+            void RunChunks();
+
+            std::vector<std::thread> workers_;
+
+            std::mutex run_mu_; // serializes ParallelFor callers
+            std::mutex mu_;
+            std::condition_variable work_cv_;
+            std::condition_variable done_cv_;
+
+            // Current job, guarded by mu_ except for next_chunk_.
+            const std::function<void(std::int64_t, std::int64_t)> *fn_;
+            std::int64_t begin_;
+            std::int64_t end_;
+            std::int64_t chunk_size_;
+            std::int64_t num_chunks_;
+            std::atomic<std::int64_t> next_chunk_;
+            int active_workers_;
+            std::uint64_t generation_;
+            bool stop_;
+        };
+
+} // namespace ptk::core
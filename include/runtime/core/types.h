@@ -19,6 +19,10 @@ namespace ptk::core
             kInt64,
             kFloat32,
             kFloat64,
+            kFloat16,  // IEEE 754 binary16, stored as uint16_t
+            kBFloat16, // upper half of a float32, stored as uint16_t
+            kInt8,
+            kUint16,
         };
 
         enum class TensorLayout
@@ -39,6 +43,16 @@ namespace ptk::core
             kRgb8,  // 3 channels
             kBgr8,  // 3 channels
             kRgba8, // 4 channels
+            kYuyv,  // packed 4:2:2, [H, W, 2] as Y0 U Y1 V
+            kNv12,  // 4:2:0, [H * 3 / 2, W, 1]: Y plane then interleaved UV
+            kI420,  // 4:2:0, [H * 3 / 2, W, 1]: Y, U and V planes
+
+            // Raw sensor mosaics, [H, W, 1]: uint8, or uint16 holding 10 to 16
+            // significant bits in the low bits. Named by the top-left 2x2 cell.
+            kBayerRggb,
+            kBayerBggr,
+            kBayerGrbg,
+            kBayerGbrg,
         };
 
 } // namespace ptk::core
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ptk::data
+{
+  // An object box in source frame pixels, [x0, x1) x [y0, y1).
+  struct Detection
+  {
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+    float score;
+    int class_id;
+
+    // Second-stage results, set when the box was classified.
+    int label;                     // argmax of attributes, -1 if not classified
+    float label_score;
+    std::vector<float> attributes; // the second-stage output row for this box
+
+    Detection()
+        : x0(0.0f),
+          y0(0.0f),
+          x1(0.0f),
+          y1(0.0f),
+          score(0.0f),
+          class_id(0),
+          label(-1),
+          label_score(0.0f),
+          attributes() {}
+  };
+
+  struct DetectionList
+  {
+    std::vector<Detection> detections; // by descending score
+    int classified;                    // leading detections with second-stage results
+    int64_t timestamp_ns;              // of the source frame
+    int64_t frame_index;
+    int camera_id;
+
+    DetectionList()
+        : detections(),
+          classified(0),
+          timestamp_ns(0),
+          frame_index(0),
+          camera_id(0) {}
+  };
+} // namespace ptk::data
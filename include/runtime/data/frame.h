@@ -3,6 +3,7 @@
 #include <cstdint>
 
 #include "runtime/core/types.h"
+#include "runtime/data/pixel_transform.h"
 #include "runtime/data/tensor.h"
 
 namespace ptk::data
@@ -15,6 +16,9 @@ namespace ptk::data
     int64_t timestamp_ns; // timestamp in from context
     int64_t frame_index;  // optional sequential index
     int camera_id;        // optional identifier
+    // image pixels to the camera frame's, through any crop, pad, flip,
+    // rotation or binning applied since capture
+    PixelTransform to_source;
 
     Frame()
         : image(),
@@ -22,6 +26,7 @@ namespace ptk::data
           layout(core::TensorLayout::kUnknown),
           timestamp_ns(0),
           frame_index(0),
-          camera_id(0) {}
+          camera_id(0),
+          to_source() {}
   };
 } // namespace ptk::data
\ No newline at end of file
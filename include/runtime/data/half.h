@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace ptk::data
+{
+
+        // Scalar conversions for the 16-bit float dtypes. Both round to nearest
+        // even and keep NaN quiet. The vector kernels in src/operators match them.
+
+        inline std::uint16_t FloatToHalf(float value)
+        {
+            std::uint32_t x;
+            std::memcpy(&x, &value, sizeof(x));
+            const std::uint32_t sign = (x >> 16) & 0x8000u;
+            std::uint32_t abs_x = x & 0x7fffffffu;
+
+            if (abs_x >= 0x7f800000u) // inf or NaN
+            {
+                return static_cast<std::uint16_t>(
+                    sign | 0x7c00u | (abs_x > 0x7f800000u ? 0x0200u | ((abs_x >> 13) & 0x3ffu) : 0u));
+            }
+            if (abs_x >= 0x477ff000u) // rounds past 65504
+            {
+                return static_cast<std::uint16_t>(sign | 0x7c00u);
+            }
+            if (abs_x < 0x38800000u) // half subnormal or zero
+            {
+                // Adding 0.5 puts the float's unit in the last place at 2^-24,
+                // so the FPU does the rounding.
+                float f;
+                std::memcpy(&f, &abs_x, sizeof(f));
+                f += 0.5f;
+                std::uint32_t r;
+                std::memcpy(&r, &f, sizeof(r));
+                return static_cast<std::uint16_t>(sign | (r - 0x3f000000u));
+            }
+
+            // Rebias the exponent from 127 to 15 and round the dropped 13 bits.
+            abs_x += 0xc8000fffu + ((abs_x >> 13) & 1u);
+            return static_cast<std::uint16_t>(sign | (abs_x >> 13));
+        }
+
+        inline float HalfToFloat(std::uint16_t value)
+        {
+            const std::uint32_t sign = static_cast<std::uint32_t>(value & 0x8000u) << 16;
+            const std::uint32_t abs_h = value & 0x7fffu;
+            std::uint32_t bits;
+
+            if (abs_h == 0x7c00u) // inf
+            {
+                bits = 0x7f800000u;
+            }
+            else if (abs_h > 0x7c00u) // NaN
+            {
+                bits = 0x7fc00000u | ((abs_h & 0x3ffu) << 13);
+            }
+            else if (abs_h >= 0x0400u) // normal
+            {
+                bits = (abs_h << 13) + 0x38000000u;
+            }
+            else // subnormal or zero: abs_h * 2^-24
+            {
+                const float f = static_cast<float>(abs_h) * 5.9604644775390625e-08f;
+                std::memcpy(&bits, &f, sizeof(bits));
+            }
+
+            bits |= sign;
+            float out;
+            std::memcpy(&out, &bits, sizeof(out));
+            return out;
+        }
+
+        inline std::uint16_t FloatToBFloat16(float value)
+        {
+            std::uint32_t x;
+            std::memcpy(&x, &value, sizeof(x));
+            if ((x & 0x7fffffffu) > 0x7f800000u)
+            {
+                return static_cast<std::uint16_t>((x >> 16) | 0x40u);
+            }
+            x += 0x7fffu + ((x >> 16) & 1u);
+            return static_cast<std::uint16_t>(x >> 16);
+        }
+
+        inline float BFloat16ToFloat(std::uint16_t value)
+        {
+            const std::uint32_t bits = static_cast<std::uint32_t>(value) << 16;
+            float out;
+            std::memcpy(&out, &bits, sizeof(out));
+            return out;
+        }
+
+} // namespace ptk::data
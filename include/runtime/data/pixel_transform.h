@@ -0,0 +1,60 @@
+#pragma once
+
+namespace ptk::data
+{
+  // Affine map between the pixel coordinates of two images, in continuous
+  // coordinates where pixel (x, y) covers [x, x + 1) x [y, y + 1):
+  //   x' = m[0] x + m[1] y + m[2]
+  //   y' = m[3] x + m[4] y + m[5]
+  // Crops, pads, flips, quarter turns and scales are all of this form.
+  struct PixelTransform
+  {
+    double m[6];
+
+    PixelTransform() : m{1.0, 0.0, 0.0, 0.0, 1.0, 0.0} {}
+
+    PixelTransform(double a, double b, double c, double d, double e, double f)
+        : m{a, b, c, d, e, f} {}
+
+    static PixelTransform Translate(double dx, double dy)
+    {
+      return PixelTransform(1.0, 0.0, dx, 0.0, 1.0, dy);
+    }
+
+    static PixelTransform Scale(double sx, double sy)
+    {
+      return PixelTransform(sx, 0.0, 0.0, 0.0, sy, 0.0);
+    }
+
+    void Apply(double x, double y, double *out_x, double *out_y) const
+    {
+      *out_x = m[0] * x + m[1] * y + m[2];
+      *out_y = m[3] * x + m[4] * y + m[5];
+    }
+
+    // False if the map is singular.
+    bool Invert(PixelTransform *inverse) const
+    {
+      const double det = m[0] * m[4] - m[1] * m[3];
+      if (det == 0.0)
+      {
+        return false;
+      }
+      const double a = m[4] / det;
+      const double b = -m[1] / det;
+      const double d = -m[3] / det;
+      const double e = m[0] / det;
+      *inverse = PixelTransform(a, b, -(a * m[2] + b * m[5]), d, e, -(d * m[2] + e * m[5]));
+      return true;
+    }
+  };
+
+  // outer after inner: maps p to outer(inner(p)).
+  inline PixelTransform Compose(const PixelTransform &outer, const PixelTransform &inner)
+  {
+    const double *o = outer.m;
+    const double *i = inner.m;
+    return PixelTransform(o[0] * i[0] + o[1] * i[3], o[0] * i[1] + o[1] * i[4], o[0] * i[2] + o[1] * i[5] + o[2],
+                          o[3] * i[0] + o[4] * i[3], o[3] * i[1] + o[4] * i[4], o[3] * i[2] + o[4] * i[5] + o[5]);
+  }
+} // namespace ptk::data
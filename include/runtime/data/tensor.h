@@ -45,10 +45,16 @@ namespace ptk::data
         class TensorView
         {
         public:
-            TensorView() : buffer_view_(), data_type_(core::DataType::kUnknown), shape_() {}
+            TensorView() : buffer_view_(), data_type_(core::DataType::kUnknown), shape_(), strides_() {}
 
             TensorView(const BufferView &buffer_view, core::DataType data_type, const TensorShape &shape)
-                : buffer_view_(buffer_view), data_type_(data_type), shape_(shape) {}
+                : buffer_view_(buffer_view), data_type_(data_type), shape_(shape), strides_() {}
+
+            // Strided view: strides are in elements, one per dim, and may be
+            // negative. The buffer view points at the element at index 0.
+            TensorView(const BufferView &buffer_view, core::DataType data_type, const TensorShape &shape,
+                       const std::vector<std::int64_t> &strides)
+                : buffer_view_(buffer_view), data_type_(data_type), shape_(shape), strides_(strides) {}
 
             core::DataType dtype() const { return data_type_; }
 
@@ -62,6 +68,42 @@ namespace ptk::data
 
             core::DeviceType device_type() const { return buffer_view_.device_type(); }
 
+            // Element stride of dim index. Tensors without explicit strides are
+            // dense row-major.
+            std::int64_t stride(std::size_t index) const
+            {
+                if (!strides_.empty())
+                {
+                    return strides_[index];
+                }
+                std::int64_t s = 1;
+                for (std::size_t i = index + 1; i < shape_.rank(); ++i)
+                {
+                    s *= shape_.dim(i);
+                }
+                return s;
+            }
+
+            const std::vector<std::int64_t> &strides() const { return strides_; }
+
+            bool is_contiguous() const
+            {
+                if (strides_.empty())
+                {
+                    return true;
+                }
+                std::int64_t expected = 1;
+                for (std::size_t i = shape_.rank(); i-- > 0;)
+                {
+                    if (shape_.dim(i) != 1 && strides_[i] != expected)
+                    {
+                        return false;
+                    }
+                    expected *= shape_.dim(i);
+                }
+                return true;
+            }
+
             bool empty() const { return buffer_view_.empty() || data_type_ == core::DataType::kUnknown; }
 
             std::size_t num_elements() const { return shape_.num_elements(); }
@@ -71,6 +113,7 @@ namespace ptk::data
                 switch (data_type_)
                 {
                 case core::DataType::kUint8:
+                case core::DataType::kInt8:
                     return 1;
                 case core::DataType::kInt32:
                     return 4;
@@ -80,6 +123,10 @@ namespace ptk::data
                     return 4;
                 case core::DataType::kFloat64:
                     return 8;
+                case core::DataType::kFloat16:
+                case core::DataType::kBFloat16:
+                case core::DataType::kUint16:
+                    return 2;
                 default:
                     return 0;
                 }
@@ -94,6 +141,7 @@ namespace ptk::data
             BufferView buffer_view_;
             core::DataType data_type_;
             TensorShape shape_;
+            std::vector<std::int64_t> strides_;
         };
 
 } // namespace ptk::data
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+#include "runtime/data/tensor.h"
+
+namespace ptk::data
+{
+  // A tensor computed from one frame, carrying that frame's metadata.
+  struct TensorPacket
+  {
+    TensorView tensor;
+    int64_t timestamp_ns; // of the source frame
+    int64_t frame_index;
+    int camera_id;
+
+    TensorPacket()
+        : tensor(),
+          timestamp_ns(0),
+          frame_index(0),
+          camera_id(0) {}
+  };
+} // namespace ptk::data
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::data
+{
+
+        // A model input or output as declared by the model. Dims that are only
+        // fixed at inference time (batch, sequence length, detections) are -1.
+        struct TensorSpec
+        {
+            std::string name;
+            core::DataType dtype = core::DataType::kUnknown;
+            std::vector<std::int64_t> dims;
+            // Per dim, the model's name for a symbolic dim ("batch", "N");
+            // empty for fixed dims and for unnamed symbolic ones.
+            std::vector<std::string> dim_names;
+
+            bool known() const { return dtype != core::DataType::kUnknown && !dims.empty(); }
+
+            bool is_static() const
+            {
+                for (std::int64_t d : dims)
+                {
+                    if (d < 0)
+                    {
+                        return false;
+                    }
+                }
+                return !dims.empty();
+            }
+
+            // The declared shape with every symbolic dim set to symbolic.
+            TensorShape Resolve(std::int64_t symbolic) const
+            {
+                std::vector<std::int64_t> resolved = dims;
+                for (std::int64_t &d : resolved)
+                {
+                    if (d < 0)
+                    {
+                        d = symbolic;
+                    }
+                }
+                return TensorShape(resolved);
+            }
+
+            // Bytes of a dense tensor of this dtype and shape.
+            std::size_t bytes(const TensorShape &shape) const
+            {
+                return TensorView(BufferView(), dtype, shape).bytes();
+            }
+        };
+
+} // namespace ptk::data
@@ -159,66 +159,12 @@ int main(int argc, char **argv)
         ptk::core::DataType::kUint8,
         rgb_shape);
 
-    // Allocate float32 RGB HWC buffer.
-    std::vector<float> rgb_float_storage(
-        static_cast<std::size_t>(num_rgb_elems), 0.0f);
-
-    ptk::data::BufferView rgb_float_buffer(
-        rgb_float_storage.data(),
-        static_cast<std::size_t>(num_rgb_elems) * sizeof(float),
-        ptk::core::DeviceType::kCpu);
-
-    ptk::data::TensorView rgb_float_tensor(
-        rgb_float_buffer,
-        ptk::core::DataType::kFloat32,
-        rgb_shape);
-
-    // Cast uint8 -> float32
-    {
-      ptk::core::Status s =
-          ptk::operators::CastUint8ToFloat32(rgb_u8_tensor, &rgb_float_tensor);
-      if (!s.ok())
-      {
-        std::cerr << "  CastUint8ToFloat32 failed: "
-                  << s.message() << "\n";
-        stbi_image_free(pixels);
-        continue;
-      }
-    }
-
-    // Prepare float32 gray tensor [H,W,1].
+    // Prepare uint8 gray tensor [H,W,1].
     const std::int64_t gray_elems = H * W;
-    std::vector<float> gray_float_storage(
-        static_cast<std::size_t>(gray_elems), 0.0f);
-
-    ptk::data::TensorShape gray_shape({H, W, 1});
-    ptk::data::BufferView gray_float_buffer(
-        gray_float_storage.data(),
-        static_cast<std::size_t>(gray_elems) * sizeof(float),
-        ptk::core::DeviceType::kCpu);
-
-    ptk::data::TensorView gray_float_tensor(
-        gray_float_buffer,
-        ptk::core::DataType::kFloat32,
-        gray_shape);
-
-    // RGB float -> Gray float
-    {
-      ptk::core::Status s =
-          ptk::operators::RgbToGray(rgb_float_tensor, &gray_float_tensor);
-      if (!s.ok())
-      {
-        std::cerr << "  RgbToGray failed: "
-                  << s.message() << "\n";
-        stbi_image_free(pixels);
-        continue;
-      }
-    }
-
-    // Cast float32 gray -> uint8 gray for saving.
     std::vector<std::uint8_t> gray_u8_storage(
         static_cast<std::size_t>(gray_elems), 0);
 
+    ptk::data::TensorShape gray_shape({H, W, 1});
     ptk::data::BufferView gray_u8_buffer(
         gray_u8_storage.data(),
         static_cast<std::size_t>(gray_elems) * sizeof(std::uint8_t),
@@ -229,12 +175,13 @@ int main(int argc, char **argv)
         ptk::core::DataType::kUint8,
         gray_shape);
 
+    // RGB uint8 -> Gray uint8 in one integer pass.
     {
       ptk::core::Status s =
-          ptk::operators::CastFloat32ToUint8(gray_float_tensor, &gray_u8_tensor);
+          ptk::operators::RgbToGray(rgb_u8_tensor, &gray_u8_tensor);
       if (!s.ok())
       {
-        std::cerr << "  CastFloat32ToUint8 failed: "
+        std::cerr << "  RgbToGray failed: "
                   << s.message() << "\n";
         stbi_image_free(pixels);
         continue;
@@ -1,4 +1,5 @@
 #include "engines/engine_builder.h"
+#include "engines/engine_pool.h"
 #include "engines/onnx_engine.h"
 #include "engines/trt_engine.h"
 
@@ -7,6 +8,12 @@ namespace ptk::perception
 
     std::unique_ptr<Engine> CreateEngine(const EngineConfig &config)
     {
+        if (config.pool.sessions > 1)
+        {
+            // The pool creates its members through here with sessions = 1.
+            return std::make_unique<EnginePool>(config);
+        }
+
         if (config.backend == EngineBackend::OnnxRuntime)
         {
             // Create OnnxEngine with the provided config
@@ -0,0 +1,203 @@
+#include "engines/engine_pool.h"
+#include "engines/engine_builder.h"
+#include "engines/thread_output_storage.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace ptk::perception
+{
+    EnginePool::Lease::Lease(Lease &&other) noexcept : pool_(other.pool_), index_(other.index_)
+    {
+        other.pool_ = nullptr;
+        other.index_ = -1;
+    }
+
+    EnginePool::Lease &EnginePool::Lease::operator=(Lease &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (pool_)
+            {
+                pool_->Release(index_);
+            }
+            pool_ = other.pool_;
+            index_ = other.index_;
+            other.pool_ = nullptr;
+            other.index_ = -1;
+        }
+        return *this;
+    }
+
+    EnginePool::Lease::~Lease()
+    {
+        if (pool_)
+        {
+            pool_->Release(index_);
+        }
+    }
+
+    Engine &EnginePool::Lease::engine() const
+    {
+        return *pool_->engines_[index_];
+    }
+
+    EnginePool::EnginePool(const EngineConfig &config) : Engine()
+    {
+        config_ = config;
+    }
+
+    EnginePool::~EnginePool() = default;
+
+    bool EnginePool::Load(const std::string &model_path)
+    {
+        EngineConfig member_config = config_;
+        member_config.pool.sessions = 1;
+
+        const int sessions = std::max(1, config_.pool.sessions);
+        // Only the first engine tunes, within its share of the cores; the
+        // rest load with its result, so sessions * threads still fits.
+        bool tune = member_config.threading.auto_tune;
+        if (tune && member_config.threading.tune_cores <= 0)
+        {
+            const int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+            member_config.threading.tune_cores = std::max(1, cores / sessions);
+        }
+
+        std::vector<std::unique_ptr<Engine>> engines;
+        for (int i = 0; i < sessions; i++)
+        {
+            std::unique_ptr<Engine> engine = CreateEngine(member_config);
+            if (!engine || !engine->Load(model_path))
+            {
+                std::cerr << "EnginePool: Failed to load engine " << i << " of " << sessions << "\n";
+                return false;
+            }
+            if (tune)
+            {
+                member_config.threading = engine->threading();
+                member_config.threading.auto_tune = false;
+                tune = false;
+            }
+            engines.push_back(std::move(engine));
+        }
+
+        std::lock_guard<std::mutex> lock(mu_);
+        input_names_ = engines.front()->InputNames();
+        output_names_ = engines.front()->OutputNames();
+        input_specs_ = engines.front()->InputSpecs();
+        output_specs_ = engines.front()->OutputSpecs();
+        engines_ = std::move(engines);
+        free_.clear();
+        for (int i = sessions - 1; i >= 0; i--)
+        {
+            free_.push_back(i);
+        }
+        return true;
+    }
+
+    int EnginePool::AcquireIndex()
+    {
+        std::unique_lock<std::mutex> lock(mu_);
+        if (engines_.empty())
+        {
+            std::cerr << "EnginePool: Not loaded\n";
+            return -1;
+        }
+        if (free_.empty())
+        {
+            if (waiting_ >= config_.pool.max_queue)
+            {
+                return -1;
+            }
+            waiting_++;
+            auto ready = [this]
+            { return !free_.empty(); };
+            bool ok = true;
+            if (config_.pool.queue_timeout_ms > 0)
+            {
+                ok = cv_.wait_for(lock, std::chrono::milliseconds(config_.pool.queue_timeout_ms), ready);
+            }
+            else
+            {
+                cv_.wait(lock, ready);
+            }
+            waiting_--;
+            if (!ok)
+            {
+                return -1;
+            }
+        }
+        // Last released first: its buffers are the most likely to be cached.
+        const int index = free_.back();
+        free_.pop_back();
+        return index;
+    }
+
+    void EnginePool::Release(int index)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            free_.push_back(index);
+        }
+        cv_.notify_one();
+    }
+
+    EnginePool::Lease EnginePool::Acquire()
+    {
+        const int index = AcquireIndex();
+        return index < 0 ? Lease() : Lease(this, index);
+    }
+
+    bool EnginePool::Infer(const std::vector<data::TensorView> &inputs,
+                           std::vector<data::TensorView> &outputs)
+    {
+        // A full queue is back-pressure, not an error worth logging per call.
+        Lease lease = Acquire();
+        if (!lease)
+        {
+            return false;
+        }
+
+        // Views from an earlier call hold that call's shapes, so they are
+        // refilled by copy rather than bound as caller buffers.
+        bool caller_buffers = outputs.size() == output_names_.size();
+        for (size_t i = 0; caller_buffers && i < outputs.size(); i++)
+        {
+            caller_buffers = !outputs[i].empty() && !PointsIntoThreadStorage(outputs[i]);
+        }
+        if (caller_buffers)
+        {
+            return lease->Infer(inputs, outputs);
+        }
+
+        outputs.clear();
+        std::vector<data::TensorView> engine_outputs;
+        if (!lease->Infer(inputs, engine_outputs))
+        {
+            return false;
+        }
+
+        // The engine's own buffers are reused by its next caller.
+        std::vector<std::vector<std::uint8_t>> &storage = ThreadOutputStorage();
+        storage.resize(engine_outputs.size());
+        outputs.reserve(engine_outputs.size());
+        for (size_t i = 0; i < engine_outputs.size(); i++)
+        {
+            const data::TensorView &src = engine_outputs[i];
+            const size_t total_bytes = src.buffer().size_bytes();
+            std::vector<std::uint8_t> &buf = storage[i];
+            buf.resize(total_bytes);
+            std::memcpy(buf.data(), src.buffer().data(), total_bytes);
+
+            data::BufferView bv(buf.data(), total_bytes, core::DeviceType::kCpu);
+            outputs.emplace_back(bv, src.dtype(), src.shape());
+        }
+        return true;
+    }
+
+} // namespace ptk::perception
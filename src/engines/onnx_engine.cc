@@ -1,72 +1,701 @@
 #include "engines/onnx_engine.h"
 #include "engines/onnx_utils.h"
 
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
-#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#elif defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
 
 namespace ptk::perception
 {
+    namespace
+    {
+        GraphOptimizationLevel ToOrtLevel(OnnxGraphOptimization level)
+        {
+            switch (level)
+            {
+            case OnnxGraphOptimization::Disabled:
+                return GraphOptimizationLevel::ORT_DISABLE_ALL;
+            case OnnxGraphOptimization::Basic:
+                return GraphOptimizationLevel::ORT_ENABLE_BASIC;
+            case OnnxGraphOptimization::All:
+                return GraphOptimizationLevel::ORT_ENABLE_ALL;
+            case OnnxGraphOptimization::Extended:
+            default:
+                return GraphOptimizationLevel::ORT_ENABLE_EXTENDED;
+            }
+        }
+
+        Ort::SessionOptions MakeSessionOptions(const EngineConfig &config, const ThreadingConfig &threading)
+        {
+            Ort::SessionOptions options;
+            options.SetGraphOptimizationLevel(ToOrtLevel(config.onnx_graph_optimization));
+            options.SetIntraOpNumThreads(threading.intra_op_threads);
+            options.SetInterOpNumThreads(threading.inter_op_threads);
+            options.SetExecutionMode(threading.execution_mode == GraphExecutionMode::Parallel ? ORT_PARALLEL
+                                                                                              : ORT_SEQUENTIAL);
+            const char *spin = threading.allow_spinning ? "1" : "0";
+            options.AddConfigEntry("session.intra_op.allow_spinning", spin);
+            options.AddConfigEntry("session.inter_op.allow_spinning", spin);
+            if (!threading.intra_op_affinity.empty())
+            {
+                options.AddConfigEntry("session.intra_op_thread_affinities", threading.intra_op_affinity.c_str());
+            }
+            return options;
+        }
+
+        // The configured settings first, then sequential runs with 1, 2, 4,
+        // ... threads up to the core count, then one parallel split.
+        std::vector<ThreadingConfig> TuneCandidates(const ThreadingConfig &base, int cores)
+        {
+            std::vector<ThreadingConfig> candidates{base};
+            auto add = [&](int intra, int inter, GraphExecutionMode mode)
+            {
+                ThreadingConfig t = base;
+                if (intra != base.intra_op_threads)
+                {
+                    // The affinity list is sized for the configured count.
+                    t.intra_op_affinity.clear();
+                }
+                t.intra_op_threads = intra;
+                t.inter_op_threads = inter;
+                t.execution_mode = mode;
+                for (const auto &c : candidates)
+                {
+                    if (c.intra_op_threads == intra && c.inter_op_threads == inter && c.execution_mode == mode)
+                    {
+                        return;
+                    }
+                }
+                candidates.push_back(t);
+            };
+            for (int n = 1; n < cores; n *= 2)
+            {
+                add(n, 1, GraphExecutionMode::Sequential);
+            }
+            add(cores, 1, GraphExecutionMode::Sequential);
+            if (cores >= 4)
+            {
+                add(cores / 2, 2, GraphExecutionMode::Parallel);
+            }
+            return candidates;
+        }
+
+        // Zero-filled inputs for auto-tuning and warmup.
+        struct SyntheticInputs
+        {
+            std::vector<const char *> input_names;
+            std::vector<const char *> output_names;
+            std::vector<std::vector<int64_t>> shapes;
+            std::vector<ONNXTensorElementDataType> types;
+            std::vector<std::vector<std::uint8_t>> storage;
+            std::vector<Ort::Value> values;
+        };
+
+        // Uses shapes when given (one per input), else the model's shapes
+        // with symbolic dims taken as 1.
+        bool MakeSyntheticInputs(Ort::Session &session, const std::vector<std::string> &input_names,
+                                 const std::vector<std::string> &output_names,
+                                 const std::vector<std::vector<int64_t>> &shapes, const Ort::MemoryInfo &memory_info,
+                                 SyntheticInputs *in)
+        {
+            for (const auto &name : input_names)
+            {
+                in->input_names.push_back(name.c_str());
+            }
+            for (const auto &name : output_names)
+            {
+                in->output_names.push_back(name.c_str());
+            }
+            if (!shapes.empty() && shapes.size() != input_names.size())
+            {
+                std::cerr << "OnnxEngine: Expected one synthetic input shape per input\n";
+                return false;
+            }
+
+            try
+            {
+                for (size_t i = 0; i < input_names.size(); i++)
+                {
+                    Ort::TypeInfo type_info = session.GetInputTypeInfo(i);
+                    auto info = type_info.GetTensorTypeAndShapeInfo();
+                    std::vector<int64_t> shape = shapes.empty() ? info.GetShape() : shapes[i];
+                    size_t elem_count = 1;
+                    for (auto &d : shape)
+                    {
+                        d = std::max<int64_t>(d, 1);
+                        elem_count *= static_cast<size_t>(d);
+                    }
+                    const size_t elem_size = ptk::onnx::OnnxElementSize(info.GetElementType());
+                    if (elem_size == 0)
+                    {
+                        std::cerr << "OnnxEngine: Unsupported type for synthetic input " << input_names[i] << "\n";
+                        return false;
+                    }
+                    in->storage.emplace_back(elem_count * elem_size, 0);
+                    in->values.push_back(Ort::Value::CreateTensor(memory_info, in->storage.back().data(),
+                                                                  in->storage.back().size(), shape.data(),
+                                                                  shape.size(), info.GetElementType()));
+                    in->shapes.push_back(shape);
+                    in->types.push_back(info.GetElementType());
+                }
+            }
+            catch (const Ort::Exception &e)
+            {
+                std::cerr << "OnnxEngine: Synthetic input setup failed: " << e.what() << "\n";
+                return false;
+            }
+            return true;
+        }
+
+        // The host's instruction set extensions. At Extended and All levels
+        // ONNX Runtime fuses and re-lays out nodes for the CPU it runs on, so
+        // a cached graph is only reused on hosts with the same features.
+        std::string HostCpuFingerprint()
+        {
+            char buf[128];
+#if defined(__x86_64__) || defined(__i386__)
+            unsigned int max_leaf = 0;
+            unsigned int vendor[3] = {0, 0, 0};
+            unsigned int unused = 0;
+            unsigned int leaf1[2] = {0, 0}; // ecx, edx
+            unsigned int leaf7[3] = {0, 0, 0}; // ebx, ecx, edx
+            if (__get_cpuid(0, &max_leaf, &vendor[0], &vendor[2], &vendor[1]))
+            {
+                __get_cpuid(1, &unused, &unused, &leaf1[0], &leaf1[1]);
+                if (max_leaf >= 7)
+                {
+                    __get_cpuid_count(7, 0, &unused, &leaf7[0], &leaf7[1], &leaf7[2]);
+                }
+            }
+            std::snprintf(buf, sizeof(buf), "x86:%.12s:%08x%08x:%08x%08x%08x", reinterpret_cast<const char *>(vendor),
+                          leaf1[0], leaf1[1], leaf7[0], leaf7[1], leaf7[2]);
+#elif defined(__aarch64__) && defined(__linux__)
+            std::snprintf(buf, sizeof(buf), "arm64:%lx:%lx", getauxval(AT_HWCAP), getauxval(AT_HWCAP2));
+#elif defined(__aarch64__)
+            std::snprintf(buf, sizeof(buf), "arm64");
+#else
+            std::snprintf(buf, sizeof(buf), "unknown");
+#endif
+            return buf;
+        }
+
+        constexpr std::uint64_t kFnvOffset = 14695981039346656037ull;
+        constexpr std::uint64_t kFnvPrime = 1099511628211ull;
+
+        // FNV-1a taking 64-bit words, with the bytes of a tail shorter than
+        // a word mixed one at a time.
+        void Mix(std::uint64_t *hash, const char *data, size_t n)
+        {
+            for (; n >= sizeof(std::uint64_t); data += sizeof(std::uint64_t), n -= sizeof(std::uint64_t))
+            {
+                std::uint64_t word;
+                std::memcpy(&word, data, sizeof(word));
+                *hash = (*hash ^ word) * kFnvPrime;
+            }
+            for (; n > 0; data++, n--)
+            {
+                *hash = (*hash ^ static_cast<std::uint8_t>(*data)) * kFnvPrime;
+            }
+        }
+
+        // Hash of the model file's bytes. Reading a large model costs more
+        // than loading its cached graph, so the hash is kept next to the
+        // cache entries, keyed by the model's path, size and modification
+        // time, and the file is only read again when one of those changed.
+        // False if the model cannot be read.
+        bool ModelContentHash(const std::string &model_path, const std::string &cache_dir, std::uint64_t *hash)
+        {
+            namespace fs = std::filesystem;
+            std::error_code ec;
+            const std::uintmax_t size = fs::file_size(model_path, ec);
+            const fs::file_time_type mtime = ec ? fs::file_time_type() : fs::last_write_time(model_path, ec);
+            if (ec)
+            {
+                return false;
+            }
+            const long long stamp = static_cast<long long>(mtime.time_since_epoch().count());
+
+            std::uint64_t path_hash = kFnvOffset;
+            const std::string absolute = fs::absolute(model_path, ec).string();
+            Mix(&path_hash, absolute.data(), absolute.size());
+            char memo_name[24];
+            std::snprintf(memo_name, sizeof(memo_name), ".%016llx.hash", static_cast<unsigned long long>(path_hash));
+            const fs::path memo = fs::path(cache_dir) / (fs::path(model_path).stem().string() + memo_name);
+
+            {
+                std::ifstream in(memo);
+                unsigned long long memo_size = 0;
+                long long memo_stamp = 0;
+                unsigned long long memo_hash = 0;
+                if (in >> memo_size >> memo_stamp >> std::hex >> memo_hash && memo_size == size &&
+                    memo_stamp == stamp)
+                {
+                    *hash = memo_hash;
+                    return true;
+                }
+            }
+
+            std::ifstream file(model_path, std::ios::binary);
+            if (!file)
+            {
+                return false;
+            }
+            *hash = kFnvOffset;
+            // A multiple of the word size, so only the file's tail is mixed
+            // bytewise.
+            std::vector<char> chunk(1 << 20);
+            while (file.read(chunk.data(), static_cast<std::streamsize>(chunk.size())) || file.gcount() > 0)
+            {
+                Mix(hash, chunk.data(), static_cast<size_t>(file.gcount()));
+            }
+
+            // Best effort, renamed into place like the cache entries.
+            fs::create_directories(cache_dir, ec);
+            const std::string temp =
+                memo.string() + ".tmp" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+            {
+                std::ofstream out(temp, std::ios::trunc);
+                out << static_cast<unsigned long long>(size) << " " << stamp << " " << std::hex
+                    << static_cast<unsigned long long>(*hash) << "\n";
+            }
+            fs::rename(temp, memo, ec);
+            if (ec)
+            {
+                fs::remove(temp, ec);
+            }
+            return true;
+        }
 
-    OnnxEngine::OnnxEngine(const EngineConfig &config) : Engine(), env_(ORT_LOGGING_LEVEL_WARNING, "ptk-onnx"), config_(config)
+        // <cache_dir>/<model stem>.<key>.onnx, where key is FNV-1a over the
+        // model's content hash followed by everything that shapes the
+        // optimized graph: ONNX Runtime version, level, provider options and
+        // host CPU features. Empty if the model cannot be read.
+        std::string OptimizedModelPath(const std::string &model_path, const EngineConfig &config)
+        {
+            std::uint64_t content = 0;
+            if (!ModelContentHash(model_path, config.onnx_optimized_model_cache_dir, &content))
+            {
+                return std::string();
+            }
+            std::uint64_t hash = kFnvOffset;
+            Mix(&hash, reinterpret_cast<const char *>(&content), sizeof(content));
+
+            const std::string options = Ort::GetVersionString() + "|" + std::to_string(ORT_API_VERSION) + "|" +
+                                        std::to_string(static_cast<int>(config.onnx_graph_optimization)) + "|" +
+                                        std::to_string(static_cast<int>(config.onnx_execution_provider)) + "|" +
+                                        std::to_string(config.device_id) + "|" +
+                                        std::to_string(static_cast<int>(config.tensorrt_precision_mode)) + "|" +
+                                        std::to_string(config.enable_dynamic_shapes) + "|" + HostCpuFingerprint();
+            Mix(&hash, options.data(), options.size());
+
+            char key[17];
+            std::snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash));
+            const std::filesystem::path name =
+                std::filesystem::path(model_path).stem().string() + "." + key + ".onnx";
+            return (std::filesystem::path(config.onnx_optimized_model_cache_dir) / name).string();
+        }
+
+        data::TensorSpec SpecFromTypeInfo(const std::string &name, const Ort::TypeInfo &type_info)
+        {
+            auto info = type_info.GetTensorTypeAndShapeInfo();
+            data::TensorSpec spec;
+            spec.name = name;
+            spec.dtype = ptk::onnx::PtkTypeFromOnnx(info.GetElementType());
+            spec.dims = info.GetShape();
+            spec.dim_names.resize(spec.dims.size());
+            const std::vector<const char *> symbolic = info.GetSymbolicDimensions();
+            for (size_t d = 0; d < spec.dims.size() && d < symbolic.size(); d++)
+            {
+                if (spec.dims[d] < 0 && symbolic[d] != nullptr)
+                {
+                    spec.dim_names[d] = symbolic[d];
+                }
+            }
+            return spec;
+        }
+
+        void RunOnce(Ort::Session &session, SyntheticInputs &in)
+        {
+            session.Run(Ort::RunOptions{nullptr}, in.input_names.data(), in.values.data(), in.values.size(),
+                        in.output_names.data(), in.output_names.size());
+        }
+
+        // Seconds per request: the median of single runs for Latency, wall
+        // time over requests with enough concurrent callers to fill the cores
+        // for Throughput. Lower is better either way.
+        double Measure(Ort::Session &session, SyntheticInputs &in, const ThreadingConfig &threading, int cores)
+        {
+            using Clock = std::chrono::steady_clock;
+            const int iterations = std::max(1, threading.tune_iterations);
+            for (int i = 0; i < 2; i++)
+            {
+                RunOnce(session, in);
+            }
+
+            if (threading.tune_objective == TuneObjective::Latency)
+            {
+                std::vector<double> times;
+                times.reserve(iterations);
+                for (int i = 0; i < iterations; i++)
+                {
+                    const auto t0 = Clock::now();
+                    RunOnce(session, in);
+                    times.push_back(std::chrono::duration<double>(Clock::now() - t0).count());
+                }
+                std::nth_element(times.begin(), times.begin() + iterations / 2, times.end());
+                return times[iterations / 2];
+            }
+
+            // Session::Run is thread safe, so callers share the session the
+            // way a pipeline's workers would.
+            const int per_request = threading.intra_op_threads > 0 ? threading.intra_op_threads : cores;
+            const int callers = std::max(1, cores / per_request);
+            const auto t0 = Clock::now();
+            std::vector<std::thread> workers;
+            for (int c = 0; c < callers; c++)
+            {
+                workers.emplace_back([&]
+                                     {
+                                         for (int i = 0; i < iterations; i++)
+                                         {
+                                             RunOnce(session, in);
+                                         } });
+            }
+            for (auto &w : workers)
+            {
+                w.join();
+            }
+            return std::chrono::duration<double>(Clock::now() - t0).count() / (callers * iterations);
+        }
+    } // namespace
+
+    OnnxEngine::OnnxEngine(const EngineConfig &config)
+        : Engine(), env_(ORT_LOGGING_LEVEL_WARNING, "ptk-onnx"), config_(config),
+          memory_info_(Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault))
+    {
+    }
+
+    OnnxEngine::~OnnxEngine()
     {
-        session_options_.SetIntraOpNumThreads(1);
-        session_options_.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+        std::unique_lock<std::mutex> lock(async_mu_);
+        async_cv_.wait(lock, [this]
+                       { return in_flight_ == 0; });
     }
 
-    OnnxEngine::~OnnxEngine() = default;
+    Ort::SessionOptions OnnxEngine::SessionOptionsFor(const ThreadingConfig &threading) const
+    {
+        Ort::SessionOptions options = MakeSessionOptions(config_, threading);
+        if (from_cache_)
+        {
+            // The cached model is already optimized for these options.
+            options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+        }
+        return options;
+    }
 
-    bool OnnxEngine::Load(const std::string &model_path)
+    bool OnnxEngine::OpenSession(const std::string &model_path)
     {
+        session_model_path_ = model_path;
+        from_cache_ = false;
+
+        std::string cached;
+        if (!config_.onnx_optimized_model_cache_dir.empty())
+        {
+            cached = OptimizedModelPath(model_path, config_);
+        }
+
+        std::error_code ec;
+        if (!cached.empty() && std::filesystem::exists(cached, ec))
+        {
+            try
+            {
+                from_cache_ = true;
+                session_ = std::make_unique<Ort::Session>(env_, cached.c_str(), SessionOptionsFor(config_.threading));
+                session_model_path_ = cached;
+                return true;
+            }
+            catch (const Ort::Exception &e)
+            {
+                std::cerr << "OnnxEngine: Discarding cached model " << cached << ": " << e.what() << "\n";
+                from_cache_ = false;
+                std::filesystem::remove(cached, ec);
+            }
+        }
+
         try
         {
-            session_ = std::make_unique<Ort::Session>(env_, model_path.c_str(), session_options_);
+            Ort::SessionOptions options = SessionOptionsFor(config_.threading);
+            std::string temp;
+            if (!cached.empty())
+            {
+                // Written under a temporary name and renamed once complete, so
+                // a crash or a concurrent writer never leaves a torn entry.
+                std::filesystem::create_directories(config_.onnx_optimized_model_cache_dir, ec);
+                temp = cached + ".tmp" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+                options.SetOptimizedModelFilePath(temp.c_str());
+            }
+            session_ = std::make_unique<Ort::Session>(env_, model_path.c_str(), options);
+            if (!temp.empty())
+            {
+                std::filesystem::rename(temp, cached, ec);
+                if (ec)
+                {
+                    std::filesystem::remove(temp, ec);
+                }
+                else
+                {
+                    session_model_path_ = cached;
+                    from_cache_ = true;
+                }
+            }
         }
         catch (const Ort::Exception &e)
         {
             std::cerr << "ONNX Load Error: " << e.what() << "\n";
             return false;
         }
+        return true;
+    }
+
+    bool OnnxEngine::Load(const std::string &model_path)
+    {
+        if (!OpenSession(model_path))
+        {
+            return false;
+        }
 
         Ort::AllocatorWithDefaultOptions allocator;
 
+        // The AllocatedStringPtr owns the name, so copy it before it goes out
+        // of scope.
         size_t num_inputs = session_->GetInputCount();
+        input_names_.clear();
         input_names_.reserve(num_inputs);
 
         for (size_t i = 0; i < num_inputs; i++)
         {
-            char *name = session_->GetInputNameAllocated(i, allocator).get();
+            Ort::AllocatedStringPtr name = session_->GetInputNameAllocated(i, allocator);
             if (name)
             {
-                input_names_.push_back(std::string(name));
+                input_names_.push_back(std::string(name.get()));
             }
         }
 
         size_t num_outputs = session_->GetOutputCount();
+        output_names_.clear();
         output_names_.reserve(num_outputs);
 
         for (size_t i = 0; i < num_outputs; i++)
         {
-            char *name = session_->GetOutputNameAllocated(i, allocator).get();
+            Ort::AllocatedStringPtr name = session_->GetOutputNameAllocated(i, allocator);
             if (name)
             {
-                output_names_.push_back(std::string(name));
+                output_names_.push_back(std::string(name.get()));
+            }
+        }
+
+        try
+        {
+            input_specs_.clear();
+            for (size_t i = 0; i < input_names_.size(); i++)
+            {
+                input_specs_.push_back(SpecFromTypeInfo(input_names_[i], session_->GetInputTypeInfo(i)));
+            }
+            output_specs_.clear();
+            for (size_t i = 0; i < output_names_.size(); i++)
+            {
+                output_specs_.push_back(SpecFromTypeInfo(output_names_[i], session_->GetOutputTypeInfo(i)));
+            }
+        }
+        catch (const Ort::Exception &e)
+        {
+            std::cerr << "ONNX Load Error: " << e.what() << "\n";
+            return false;
+        }
+
+        input_names_c_.clear();
+        for (const auto &name : input_names_)
+        {
+            input_names_c_.push_back(name.c_str());
+        }
+        output_names_c_.clear();
+        for (const auto &name : output_names_)
+        {
+            output_names_c_.push_back(name.c_str());
+        }
+
+        if (config_.threading.auto_tune && !AutoTune())
+        {
+            return false;
+        }
+
+        return PrepareOutputSlots() && Warmup();
+    }
+
+    bool OnnxEngine::Warmup()
+    {
+        if (config_.warmup_runs <= 0)
+        {
+            return true;
+        }
+        SyntheticInputs in;
+        if (!MakeSyntheticInputs(*session_, input_names_, output_names_, config_.warmup_input_shapes, memory_info_,
+                                 &in))
+        {
+            return false;
+        }
+
+        // Through Infer, so the binding and the output buffers for these
+        // shapes are in place before the first frame.
+        std::vector<data::TensorView> inputs;
+        for (size_t i = 0; i < in.storage.size(); i++)
+        {
+            data::BufferView bv(in.storage[i].data(), in.storage[i].size(), core::DeviceType::kCpu);
+            inputs.emplace_back(bv, ptk::onnx::PtkTypeFromOnnx(in.types[i]), data::TensorShape(in.shapes[i]));
+        }
+        std::vector<data::TensorView> outputs;
+        for (int r = 0; r < config_.warmup_runs; r++)
+        {
+            if (!Infer(inputs, outputs))
+            {
+                std::cerr << "OnnxEngine: Warmup run failed\n";
+                return false;
+            }
+        }
+        // The synthetic buffers go away; make the next Infer rebind inputs.
+        bound_inputs_.clear();
+        return true;
+    }
+
+    bool OnnxEngine::AutoTune()
+    {
+        SyntheticInputs in;
+        if (!MakeSyntheticInputs(*session_, input_names_, output_names_, config_.warmup_input_shapes, memory_info_,
+                                 &in))
+        {
+            return false;
+        }
+
+        const int cores = config_.threading.tune_cores > 0
+                              ? config_.threading.tune_cores
+                              : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        const std::vector<ThreadingConfig> candidates = TuneCandidates(config_.threading, cores);
+
+        double best_time = 0.0;
+        size_t best = candidates.size();
+        for (size_t c = 0; c < candidates.size(); c++)
+        {
+            const ThreadingConfig &t = candidates[c];
+            try
+            {
+                std::unique_ptr<Ort::Session> session =
+                    c == 0 ? std::move(session_)
+                           : std::make_unique<Ort::Session>(env_, session_model_path_.c_str(), SessionOptionsFor(t));
+                const double time = Measure(*session, in, t, cores);
+                if (config_.verbose)
+                {
+                    std::cerr << "OnnxEngine: intra=" << t.intra_op_threads << " inter=" << t.inter_op_threads
+                              << (t.execution_mode == GraphExecutionMode::Parallel ? " parallel" : " sequential")
+                              << ": " << time * 1e3 << " ms/request\n";
+                }
+                if (best == candidates.size() || time < best_time)
+                {
+                    best_time = time;
+                    best = c;
+                    session_ = std::move(session);
+                }
+            }
+            catch (const Ort::Exception &e)
+            {
+                std::cerr << "OnnxEngine: Skipping tune candidate: " << e.what() << "\n";
             }
         }
+        if (best == candidates.size() || !session_)
+        {
+            std::cerr << "OnnxEngine: Auto-tune found no working thread settings\n";
+            return false;
+        }
 
+        config_.threading = candidates[best];
         return true;
     }
 
-    Ort::Value OnnxEngine::CreateOrtTensorFromPtk(const data::TensorView &tv)
+    bool OnnxEngine::PrepareOutputSlots()
+    {
+        output_slots_.clear();
+        input_shapes_.clear();
+        bound_inputs_.clear();
+        outputs_bound_ = false;
+        try
+        {
+            binding_ = std::make_unique<Ort::IoBinding>(*session_);
+
+            output_slots_.resize(output_names_.size());
+            for (size_t i = 0; i < output_slots_.size(); i++)
+            {
+                OutputSlot &slot = output_slots_[i];
+                Ort::TypeInfo type_info = session_->GetOutputTypeInfo(i);
+                auto info = type_info.GetTensorTypeAndShapeInfo();
+                slot.onnx_type = info.GetElementType();
+                slot.shape = info.GetShape();
+                if (ptk::onnx::OnnxElementSize(slot.onnx_type) == 0)
+                {
+                    std::cerr << "OnnxEngine: Unsupported output element type for " << output_names_[i] << "\n";
+                    return false;
+                }
+                slot.dynamic = std::any_of(slot.shape.begin(), slot.shape.end(), [](int64_t d)
+                                           { return d < 0; });
+                if (!slot.dynamic)
+                {
+                    slot.shape_known = true;
+                    AllocateSlot(slot);
+                }
+            }
+        }
+        catch (const Ort::Exception &e)
+        {
+            std::cerr << "ONNX Load Error: " << e.what() << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    void OnnxEngine::AllocateSlot(OutputSlot &slot)
     {
-        Ort::MemoryInfo mem_info =
-            Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
+        size_t elem_count = 1;
+        for (int64_t d : slot.shape)
+        {
+            elem_count *= static_cast<size_t>(d);
+        }
+        const size_t total_bytes = elem_count * ptk::onnx::OnnxElementSize(slot.onnx_type);
+
+        // resize keeps capacity, so alternating between input sizes only
+        // allocates for the largest.
+        slot.storage.resize(total_bytes);
+        slot.value = Ort::Value::CreateTensor(memory_info_, slot.storage.data(), total_bytes, slot.shape.data(),
+                                              slot.shape.size(), slot.onnx_type);
+        slot.wraps_storage = true;
+    }
 
-        std::vector<int64_t> shape = tv.shape().dims();
+    Ort::Value OnnxEngine::CreateOrtTensorFromPtk(const data::TensorView &tv)
+    {
+        const std::vector<int64_t> &shape = tv.shape().dims();
         size_t total_bytes = tv.buffer().size_bytes();
         void *data_ptr = const_cast<void *>(tv.buffer().data());
 
-        return Ort::Value::CreateTensor(mem_info, data_ptr, total_bytes, shape.data(), shape.size(), ptk::onnx::OnnxTypeFromPtkType(tv.dtype()));
+        return Ort::Value::CreateTensor(memory_info_, data_ptr, total_bytes, shape.data(), shape.size(), ptk::onnx::OnnxTypeFromPtkType(tv.dtype()));
     }
 
     bool OnnxEngine::Infer(const std::vector<data::TensorView> &inputs,
@@ -77,95 +706,283 @@ namespace ptk::perception
             std::cerr << "OnnxEngine: Session not loaded\n";
             return false;
         }
-
-        std::vector<Ort::Value> ort_inputs;
-        ort_inputs.reserve(inputs.size());
-
-        for (const auto &tv : inputs)
+        if (inputs.size() != input_names_.size())
         {
-            ort_inputs.emplace_back(CreateOrtTensorFromPtk(tv));
+            std::cerr << "OnnxEngine: Expected " << input_names_.size() << " inputs, got " << inputs.size() << "\n";
+            return false;
         }
 
-        std::vector<const char *> input_names_c;
-        for (auto &s : input_names_)
-            input_names_c.push_back(s.c_str());
+        // Learned output shapes only hold for the input shapes they came from.
+        bool same_shapes = input_shapes_.size() == inputs.size();
+        for (size_t i = 0; same_shapes && i < inputs.size(); i++)
+        {
+            same_shapes = input_shapes_[i] == inputs[i].shape().dims();
+        }
+        if (!same_shapes)
+        {
+            input_shapes_.clear();
+            for (const auto &tv : inputs)
+            {
+                input_shapes_.push_back(tv.shape().dims());
+            }
+            for (auto &slot : output_slots_)
+            {
+                if (slot.dynamic)
+                {
+                    slot.shape_known = false;
+                    slot.wraps_storage = false;
+                    slot.value = Ort::Value(nullptr);
+                    outputs_bound_ = false;
+                }
+            }
+        }
 
-        std::vector<const char *> output_names_c;
-        for (auto &s : output_names_)
-            output_names_c.push_back(s.c_str());
+        // Caller buffers: one non-empty view per output that is not a view the
+        // engine handed out.
+        bool caller_buffers = outputs.size() == output_slots_.size();
+        for (size_t i = 0; caller_buffers && i < outputs.size(); i++)
+        {
+            caller_buffers = !outputs[i].empty() && outputs[i].buffer().data() != output_slots_[i].data;
+        }
 
-        std::vector<Ort::Value> ort_outputs;
         try
         {
-            ort_outputs = session_->Run(Ort::RunOptions{nullptr}, input_names_c.data(), ort_inputs.data(), ort_inputs.size(), output_names_c.data(), output_names_c.size());
+            // The binding keeps its values between runs, so only inputs whose
+            // buffer, dtype or shape changed are wrapped and bound again.
+            bound_inputs_.resize(inputs.size());
+            for (size_t i = 0; i < inputs.size(); i++)
+            {
+                const data::TensorView &tv = inputs[i];
+                BoundInput &bound = bound_inputs_[i];
+                if (bound.data == tv.buffer().data() && bound.bytes == tv.buffer().size_bytes() &&
+                    bound.dtype == tv.dtype() && same_shapes)
+                {
+                    continue;
+                }
+                if (!tv.is_contiguous())
+                {
+                    std::cerr << "OnnxEngine: Input " << input_names_[i] << " is not contiguous\n";
+                    bound = BoundInput();
+                    return false;
+                }
+                binding_->BindInput(input_names_[i].c_str(), CreateOrtTensorFromPtk(tv));
+                bound.data = tv.buffer().data();
+                bound.bytes = tv.buffer().size_bytes();
+                bound.dtype = tv.dtype();
+            }
+
+            if (caller_buffers)
+            {
+                for (size_t i = 0; i < output_slots_.size(); i++)
+                {
+                    binding_->BindOutput(output_names_[i].c_str(), CreateOrtTensorFromPtk(outputs[i]));
+                }
+                outputs_bound_ = false;
+            }
+            else if (!outputs_bound_)
+            {
+                bool all_known = true;
+                for (size_t i = 0; i < output_slots_.size(); i++)
+                {
+                    OutputSlot &slot = output_slots_[i];
+                    const char *name = output_names_[i].c_str();
+                    if (slot.shape_known && !slot.wraps_storage)
+                    {
+                        AllocateSlot(slot);
+                    }
+                    if (slot.shape_known)
+                    {
+                        binding_->BindOutput(name, slot.value);
+                    }
+                    else
+                    {
+                        // First run at these input shapes: ORT sizes the output.
+                        binding_->BindOutput(name, memory_info_);
+                        all_known = false;
+                    }
+                }
+                outputs_bound_ = all_known;
+            }
+
+            session_->Run(run_options_, *binding_);
         }
         catch (const Ort::Exception &e)
         {
             std::cerr << "ONNX Infer Error: " << e.what() << "\n";
+            bound_inputs_.clear();
             return false;
         }
 
-        outputs.clear();
-        outputs.reserve(ort_outputs.size());
-
-        for (size_t i = 0; i < ort_outputs.size(); i++)
+        if (caller_buffers)
         {
-            auto &v = ort_outputs[i];
-
-            Ort::TensorTypeAndShapeInfo info = v.GetTensorTypeAndShapeInfo();
-            auto shape_vec = info.GetShape();
-            ONNXTensorElementDataType elem_type = info.GetElementType();
-
-            size_t elem_count = info.GetElementCount();
-            size_t bytes_per_elem = 0;
+            return true;
+        }
 
-            if (elem_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT)
+        std::vector<Ort::Value> produced;
+        for (const auto &slot : output_slots_)
+        {
+            if (!slot.shape_known)
             {
-                bytes_per_elem = 4;
+                produced = binding_->GetOutputValues();
+                break;
             }
-            else if (elem_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE)
+        }
+
+        // Views handed back from the last run are still accurate when the
+        // slots did not move; rebuilding them would allocate shapes.
+        bool views_current = produced.empty() && outputs.size() == output_slots_.size();
+        for (size_t i = 0; views_current && i < outputs.size(); i++)
+        {
+            const OutputSlot &slot = output_slots_[i];
+            views_current = slot.data == slot.storage.data() && outputs[i].buffer().data() == slot.data &&
+                            outputs[i].shape().dims() == slot.shape;
+        }
+        if (views_current)
+        {
+            return true;
+        }
+
+        outputs.clear();
+        outputs.reserve(output_slots_.size());
+        for (size_t i = 0; i < output_slots_.size(); i++)
+        {
+            OutputSlot &slot = output_slots_[i];
+            size_t total_bytes = slot.storage.size();
+            if (!slot.shape_known)
             {
-                bytes_per_elem = 8;
+                // Keep ORT's buffer alive for the returned view; the next run
+                // at these input shapes binds a preallocated one instead.
+                slot.value = std::move(produced[i]);
+                slot.shape = slot.value.GetTensorTypeAndShapeInfo().GetShape();
+                slot.shape_known = true;
+                total_bytes = slot.value.GetTensorTypeAndShapeInfo().GetElementCount() *
+                              ptk::onnx::OnnxElementSize(slot.onnx_type);
+                slot.data = slot.value.GetTensorMutableRawData();
             }
-            else if (elem_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32)
+            else
             {
-                bytes_per_elem = 4;
+                slot.data = slot.storage.data();
             }
-            else if (elem_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64)
+
+            data::BufferView bv(slot.data, total_bytes, core::DeviceType::kCpu);
+            outputs.emplace_back(bv, ptk::onnx::PtkTypeFromOnnx(slot.onnx_type), data::TensorShape(slot.shape));
+        }
+
+        return true;
+    }
+
+    bool OnnxEngine::InferAsync(const std::vector<data::TensorView> &inputs,
+                                const std::vector<data::TensorView> &outputs, InferCallback done)
+    {
+        if (!session_)
+        {
+            std::cerr << "OnnxEngine: Session not loaded\n";
+            return false;
+        }
+        if (config_.threading.intra_op_threads == 1)
+        {
+            return Engine::InferAsync(inputs, outputs, std::move(done));
+        }
+        if (inputs.size() != input_names_.size())
+        {
+            std::cerr << "OnnxEngine: Expected " << input_names_.size() << " inputs, got " << inputs.size() << "\n";
+            return false;
+        }
+
+        auto call = std::make_unique<AsyncCall>();
+        call->engine = this;
+        call->done = std::move(done);
+        call->preallocated = outputs.size() == output_names_.size();
+        for (const auto &tv : outputs)
+        {
+            call->preallocated = call->preallocated && !tv.empty();
+        }
+
+        bool counted = false;
+        try
+        {
+            for (const auto &tv : inputs)
             {
-                bytes_per_elem = 8;
+                if (!tv.is_contiguous())
+                {
+                    std::cerr << "OnnxEngine: Async inputs must be contiguous\n";
+                    return false;
+                }
+                call->inputs.push_back(CreateOrtTensorFromPtk(tv));
             }
-            else if (elem_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8)
+            if (call->preallocated)
             {
-                bytes_per_elem = 1;
+                call->views = outputs;
+                for (const auto &tv : outputs)
+                {
+                    call->outputs.push_back(CreateOrtTensorFromPtk(tv));
+                }
             }
             else
             {
-                std::cerr << "OnnxEngine: Unsupported output element type\n";
-                return false;
+                // Null values: ORT allocates them and they live in the call.
+                for (size_t i = 0; i < output_names_.size(); i++)
+                {
+                    call->outputs.emplace_back(nullptr);
+                }
             }
 
-            size_t total_bytes = elem_count * bytes_per_elem;
-
-            void *buf = std::malloc(total_bytes);
-            if (!buf)
             {
-                std::cerr << "OnnxEngine: Failed to allocate output buffer\n";
-                return false;
+                std::lock_guard<std::mutex> lock(async_mu_);
+                in_flight_++;
+                counted = true;
             }
+            session_->RunAsync(run_options_, input_names_c_.data(), call->inputs.data(), call->inputs.size(),
+                               output_names_c_.data(), call->outputs.data(), call->outputs.size(), &OnAsyncDone,
+                               call.get());
+        }
+        catch (const Ort::Exception &e)
+        {
+            std::cerr << "ONNX InferAsync Error: " << e.what() << "\n";
+            if (counted)
+            {
+                std::lock_guard<std::mutex> lock(async_mu_);
+                in_flight_--;
+                async_cv_.notify_all();
+            }
+            return false;
+        }
 
-            const void *ort_data = v.GetTensorRawData();
-            std::memcpy(buf, ort_data, total_bytes);
+        // Owned by OnAsyncDone from here on.
+        call.release();
+        return true;
+    }
 
-            data::BufferView bv(buf, total_bytes, core::DeviceType::kCpu);
-            data::TensorShape ts(shape_vec);
-            core::DataType dtype = ptk::onnx::PtkTypeFromOnnx(elem_type);
+    void OnnxEngine::OnAsyncDone(void *user_data, OrtValue ** /*outputs*/, size_t /*num_outputs*/, OrtStatusPtr status)
+    {
+        // The outputs are call->outputs, filled in place by ORT.
+        std::unique_ptr<AsyncCall> call(static_cast<AsyncCall *>(user_data));
+        Ort::Status run_status(status);
+        bool ok = run_status.IsOK();
+        if (!ok)
+        {
+            std::cerr << "ONNX InferAsync Error: " << run_status.GetErrorMessage() << "\n";
+        }
 
-            data::TensorView tv(bv, dtype, ts);
-            outputs.push_back(tv);
+        if (ok && !call->preallocated)
+        {
+            call->views.reserve(call->outputs.size());
+            for (auto &v : call->outputs)
+            {
+                auto info = v.GetTensorTypeAndShapeInfo();
+                const size_t total_bytes = info.GetElementCount() * ptk::onnx::OnnxElementSize(info.GetElementType());
+                data::BufferView bv(v.GetTensorMutableRawData(), total_bytes, core::DeviceType::kCpu);
+                call->views.emplace_back(bv, ptk::onnx::PtkTypeFromOnnx(info.GetElementType()),
+                                         data::TensorShape(info.GetShape()));
+            }
         }
+        call->done(ok, call->views);
 
-        return true;
+        OnnxEngine *engine = call->engine;
+        call.reset();
+        std::lock_guard<std::mutex> lock(engine->async_mu_);
+        engine->in_flight_--;
+        engine->async_cv_.notify_all();
     }
 
-} // namespace ptk::perception
\ No newline at end of file
+} // namespace ptk::perception
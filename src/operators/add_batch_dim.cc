@@ -1,14 +1,42 @@
 #include "operators/add_batch_dim.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "runtime/core/status.h"
+#include "runtime/data/tensor.h"
 
 namespace ptk::operators
 {
-    // TODO: Implement AddBatchDim
-    // This function should add a batch dimension to the input tensor.
     core::Status AddBatchDim(const data::TensorView &src, data::TensorView *dst)
     {
-        return core::Status(core::StatusCode::kInternal, "AddBatchDim not yet implemented");
+        if (dst == nullptr)
+        {
+            return core::Status(core::StatusCode::kInvalidArgument,
+                                "AddBatchDim: dst is null");
+        }
+        if (src.shape().rank() == 0)
+        {
+            return core::Status(core::StatusCode::kInvalidArgument,
+                                "AddBatchDim: src has no dims");
+        }
+
+        std::vector<std::int64_t> dims;
+        dims.reserve(src.shape().rank() + 1);
+        dims.push_back(1);
+        dims.insert(dims.end(), src.shape().dims().begin(), src.shape().dims().end());
+
+        if (src.strides().empty())
+        {
+            *dst = data::TensorView(src.buffer(), src.dtype(), data::TensorShape(dims));
+            return core::Status::Ok();
+        }
+
+        std::vector<std::int64_t> strides;
+        strides.reserve(dims.size());
+        strides.push_back(src.shape().num_elements());
+        strides.insert(strides.end(), src.strides().begin(), src.strides().end());
+        *dst = data::TensorView(src.buffer(), src.dtype(), data::TensorShape(dims), strides);
+        return core::Status::Ok();
     }
 }
-
@@ -0,0 +1,157 @@
+#include "operators/batch_assembler.h"
+
+#include <cstring>
+
+#include "runtime/core/status.h"
+
+namespace ptk::operators
+{
+
+    BatchAssembler::BatchAssembler()
+        : config_(), initialized_(false), slot_bytes_(0), storage_(), entries_() {}
+
+    core::Status BatchAssembler::Init(const BatchAssemblerConfig &config)
+    {
+        if (config.max_batch_size <= 0)
+        {
+            return core::Status(core::StatusCode::kInvalidArgument,
+                                "BatchAssembler: max_batch_size must be positive");
+        }
+        if (config.layout != core::TensorLayout::kNchw &&
+            config.layout != core::TensorLayout::kNhwc)
+        {
+            return core::Status(core::StatusCode::kInvalidArgument,
+                                "BatchAssembler: layout must be NCHW or NHWC");
+        }
+        if (config.channels <= 0 || config.height <= 0 || config.width <= 0)
+        {
+            return core::Status(core::StatusCode::kInvalidArgument,
+                                "BatchAssembler: non positive frame dimension");
+        }
+
+        // Element size comes from TensorView so new dtypes need no change here.
+        const std::size_t elem =
+            data::TensorView(data::BufferView(), config.data_type, data::TensorShape()).element_size();
+        if (elem == 0)
+        {
+            return core::Status(core::StatusCode::kInvalidArgument,
+                                "BatchAssembler: unsupported data type");
+        }
+
+        config_ = config;
+        slot_bytes_ = static_cast<std::size_t>(config.channels) *
+                      static_cast<std::size_t>(config.height) *
+                      static_cast<std::size_t>(config.width) * elem;
+        storage_.assign(slot_bytes_ * static_cast<std::size_t>(config.max_batch_size), 0);
+        entries_.clear();
+        entries_.reserve(static_cast<std::size_t>(config.max_batch_size));
+        initialized_ = true;
+        return core::Status::Ok();
+    }
+
+    void BatchAssembler::Reset()
+    {
+        entries_.clear();
+    }
+
+    std::vector<std::int64_t> BatchAssembler::SlotDims() const
+    {
+        if (config_.layout == core::TensorLayout::kNchw)
+        {
+            return {config_.channels, config_.height, config_.width};
+        }
+        return {config_.height, config_.width, config_.channels};
+    }
+
+    core::Status BatchAssembler::AcquireSlot(const data::Frame &frame, data::TensorView *slot)
+    {
+        if (!initialized_)
+        {
+            return core::Status(core::StatusCode::kFailedPrecondition,
+                                "BatchAssembler: Init must be called first");
+        }
+        if (slot == nullptr)
+        {
+            return core::Status(core::StatusCode::kInvalidArgument,
+                                "BatchAssembler: slot is null");
+        }
+        if (full())
+        {
+            return core::Status(core::StatusCode::kFailedPrecondition,
+                                "BatchAssembler: batch is full");
+        }
+
+        std::uint8_t *base = storage_.data() + slot_bytes_ * entries_.size();
+        *slot = data::TensorView(data::BufferView(base, slot_bytes_, core::DeviceType::kCpu),
+                                 config_.data_type, data::TensorShape(SlotDims()));
+
+        BatchEntry entry;
+        entry.frame_index = frame.frame_index;
+        entry.timestamp_ns = frame.timestamp_ns;
+        entry.camera_id = frame.camera_id;
+        entries_.push_back(entry);
+        return core::Status::Ok();
+    }
+
+    core::Status BatchAssembler::Add(const data::Frame &frame, const data::TensorView &image)
+    {
+        if (image.dtype() != config_.data_type)
+        {
+            return core::Status(core::StatusCode::kInvalidArgument,
+                                "BatchAssembler: image dtype does not match batch");
+        }
+        if (image.shape().dims() != SlotDims())
+        {
+            return core::Status(core::StatusCode::kInvalidArgument,
+                                "BatchAssembler: image shape does not match batch slot");
+        }
+        if (!image.is_contiguous() || image.buffer().data() == nullptr)
+        {
+            return core::Status(core::StatusCode::kInvalidArgument,
+                                "BatchAssembler: image must be contiguous and non null");
+        }
+
+        data::TensorView slot;
+        core::Status s = AcquireSlot(frame, &slot);
+        if (!s.ok())
+        {
+            return s;
+        }
+        std::memcpy(slot.buffer().data(), image.buffer().data(), slot_bytes_);
+        return core::Status::Ok();
+    }
+
+    core::Status BatchAssembler::Finalize(bool pad_to_max, data::TensorView *batch)
+    {
+        if (!initialized_)
+        {
+            return core::Status(core::StatusCode::kFailedPrecondition,
+                                "BatchAssembler: Init must be called first");
+        }
+        if (batch == nullptr)
+        {
+            return core::Status(core::StatusCode::kInvalidArgument,
+                                "BatchAssembler: batch is null");
+        }
+        if (empty())
+        {
+            return core::Status(core::StatusCode::kFailedPrecondition,
+                                "BatchAssembler: batch is empty");
+        }
+
+        std::size_t n = entries_.size();
+        if (pad_to_max && n < static_cast<std::size_t>(capacity()))
+        {
+            std::memset(storage_.data() + slot_bytes_ * n, 0,
+                        slot_bytes_ * (static_cast<std::size_t>(capacity()) - n));
+            n = static_cast<std::size_t>(capacity());
+        }
+
+        std::vector<std::int64_t> dims = SlotDims();
+        dims.insert(dims.begin(), static_cast<std::int64_t>(n));
+        *batch = data::TensorView(data::BufferView(storage_.data(), slot_bytes_ * n, core::DeviceType::kCpu),
+                                  config_.data_type, data::TensorShape(dims));
+        return core::Status::Ok();
+    }
+
+} // namespace ptk::operators
@@ -0,0 +1,84 @@
+#include "operators/cast_float16_to_float32.h"
+#include "operators/simd.h"
+
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/half.h"
+#include "runtime/data/tensor.h"
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(PTK_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace ptk::operators
+{
+        core::Status CastFloat16ToFloat32(const data::TensorView &src, data::TensorView *dst)
+        {
+            if (dst == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat16ToFloat32: dst is null");
+            }
+            if (src.dtype() != core::DataType::kFloat16 ||
+                dst->dtype() != core::DataType::kFloat32)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat16ToFloat32: invalid data types");
+            }
+
+            if (src.shape().num_elements() != dst->shape().num_elements())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat16ToFloat32: shape mismatch");
+            }
+
+            if (!src.is_contiguous() || !dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat16ToFloat32: expects contiguous tensors");
+            }
+
+            const std::uint16_t *in =
+                static_cast<const std::uint16_t *>(src.buffer().data());
+            float *out =
+                static_cast<float *>(dst->buffer().data());
+
+            if (in == nullptr || out == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat16ToFloat32: null buffer data");
+            }
+
+            const std::size_t n =
+                static_cast<std::size_t>(src.shape().num_elements());
+            std::size_t i = 0;
+#if defined(PTK_SIMD_AVX512F)
+            for (; i + 16 <= n; i += 16)
+            {
+                const __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+                _mm512_storeu_ps(out + i, _mm512_cvtph_ps(h));
+            }
+#endif
+#if defined(PTK_SIMD_F16C)
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+                _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+            }
+#elif defined(PTK_SIMD_NEON64)
+            for (; i + 4 <= n; i += 4)
+            {
+                vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(in + i))));
+            }
+#endif
+            for (; i < n; ++i)
+            {
+                out[i] = data::HalfToFloat(in[i]);
+            }
+
+            return core::Status::Ok();
+        }
+} // namespace ptk::operators
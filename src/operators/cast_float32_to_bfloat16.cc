@@ -0,0 +1,114 @@
+#include "operators/cast_float32_to_bfloat16.h"
+#include "operators/simd.h"
+
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/half.h"
+#include "runtime/data/tensor.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(PTK_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace ptk::operators
+{
+        core::Status CastFloat32ToBFloat16(const data::TensorView &src, data::TensorView *dst)
+        {
+            if (dst == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat32ToBFloat16: dst is null");
+            }
+            if (src.dtype() != core::DataType::kFloat32 ||
+                dst->dtype() != core::DataType::kBFloat16)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat32ToBFloat16: invalid data types");
+            }
+
+            if (src.shape().num_elements() != dst->shape().num_elements())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat32ToBFloat16: shape mismatch");
+            }
+
+            if (!src.is_contiguous() || !dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat32ToBFloat16: expects contiguous tensors");
+            }
+
+            const float *in =
+                static_cast<const float *>(src.buffer().data());
+            std::uint16_t *out =
+                static_cast<std::uint16_t *>(dst->buffer().data());
+
+            if (in == nullptr || out == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat32ToBFloat16: null buffer data");
+            }
+
+            const std::size_t n =
+                static_cast<std::size_t>(src.shape().num_elements());
+            std::size_t i = 0;
+#if defined(PTK_SIMD_AVX512BF16)
+            // vcvtneps2bf16 flushes float32 denormals to zero, unlike the scalar
+            // path. Image and activation values never sit that close to zero.
+            for (; i + 16 <= n; i += 16)
+            {
+                const __m256bh h = _mm512_cvtneps_pbh(_mm512_loadu_ps(in + i));
+                std::memcpy(out + i, &h, sizeof(h));
+            }
+#endif
+#if defined(PTK_SIMD_SSE2)
+            // Round to nearest even on the raw bits: add 0x7fff plus the lsb of
+            // the kept half, then keep the top 16 bits. NaNs only get the quiet bit.
+            const __m128i bias = _mm_set1_epi32(0x7fff);
+            const __m128i one = _mm_set1_epi32(1);
+            const __m128i abs_mask = _mm_set1_epi32(0x7fffffff);
+            const __m128i inf = _mm_set1_epi32(0x7f800000);
+            const __m128i quiet = _mm_set1_epi32(0x00400000);
+            const auto convert = [&](__m128i x) {
+                const __m128i lsb = _mm_and_si128(_mm_srli_epi32(x, 16), one);
+                const __m128i rounded = _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(x, bias), lsb), 16);
+                const __m128i nan = _mm_cmpgt_epi32(_mm_and_si128(x, abs_mask), inf);
+                const __m128i quieted = _mm_srai_epi32(_mm_or_si128(x, quiet), 16);
+                return _mm_or_si128(_mm_and_si128(nan, quieted), _mm_andnot_si128(nan, rounded));
+            };
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m128i a = _mm_castps_si128(_mm_loadu_ps(in + i));
+                const __m128i b = _mm_castps_si128(_mm_loadu_ps(in + i + 4));
+                // The arithmetic shifts leave each lane in int16 range, so the
+                // saturating pack keeps the bits unchanged.
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packs_epi32(convert(a), convert(b)));
+            }
+#elif defined(PTK_SIMD_NEON)
+            const uint32x4_t bias = vdupq_n_u32(0x7fff);
+            const uint32x4_t one = vdupq_n_u32(1);
+            const uint32x4_t abs_mask = vdupq_n_u32(0x7fffffff);
+            const uint32x4_t inf = vdupq_n_u32(0x7f800000);
+            const uint32x4_t quiet = vdupq_n_u32(0x00400000);
+            for (; i + 4 <= n; i += 4)
+            {
+                const uint32x4_t x = vreinterpretq_u32_f32(vld1q_f32(in + i));
+                const uint32x4_t lsb = vandq_u32(vshrq_n_u32(x, 16), one);
+                uint32x4_t r = vaddq_u32(vaddq_u32(x, bias), lsb);
+                const uint32x4_t nan = vcgtq_u32(vandq_u32(x, abs_mask), inf);
+                r = vbslq_u32(nan, vorrq_u32(x, quiet), r);
+                vst1_u16(out + i, vshrn_n_u32(r, 16));
+            }
+#endif
+            for (; i < n; ++i)
+            {
+                out[i] = data::FloatToBFloat16(in[i]);
+            }
+
+            return core::Status::Ok();
+        }
+} // namespace ptk::operators
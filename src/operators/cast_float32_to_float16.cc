@@ -0,0 +1,85 @@
+#include "operators/cast_float32_to_float16.h"
+#include "operators/simd.h"
+
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/half.h"
+#include "runtime/data/tensor.h"
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(PTK_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace ptk::operators
+{
+        core::Status CastFloat32ToFloat16(const data::TensorView &src, data::TensorView *dst)
+        {
+            if (dst == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat32ToFloat16: dst is null");
+            }
+            if (src.dtype() != core::DataType::kFloat32 ||
+                dst->dtype() != core::DataType::kFloat16)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat32ToFloat16: invalid data types");
+            }
+
+            if (src.shape().num_elements() != dst->shape().num_elements())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat32ToFloat16: shape mismatch");
+            }
+
+            if (!src.is_contiguous() || !dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat32ToFloat16: expects contiguous tensors");
+            }
+
+            const float *in =
+                static_cast<const float *>(src.buffer().data());
+            std::uint16_t *out =
+                static_cast<std::uint16_t *>(dst->buffer().data());
+
+            if (in == nullptr || out == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat32ToFloat16: null buffer data");
+            }
+
+            const std::size_t n =
+                static_cast<std::size_t>(src.shape().num_elements());
+            std::size_t i = 0;
+#if defined(PTK_SIMD_AVX512F)
+            for (; i + 16 <= n; i += 16)
+            {
+                const __m256i h = _mm512_cvtps_ph(_mm512_loadu_ps(in + i),
+                                                  _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), h);
+            }
+#endif
+#if defined(PTK_SIMD_F16C)
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), h);
+            }
+#elif defined(PTK_SIMD_NEON64)
+            for (; i + 4 <= n; i += 4)
+            {
+                vst1_u16(out + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(in + i))));
+            }
+#endif
+            for (; i < n; ++i)
+            {
+                out[i] = data::FloatToHalf(in[i]);
+            }
+
+            return core::Status::Ok();
+        }
+} // namespace ptk::operators
@@ -27,17 +27,62 @@ namespace ptk::operators
                               "CastFloat32ToUint8: shape mismatch");
             }
 
-            const float *in =
+            if (!dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastFloat32ToUint8: dst must be contiguous");
+            }
+
+            // Strided sources (e.g. crop views) are accepted when the last
+            // dim is packed, so the cast doubles as the copy out: HWC crops
+            // are read a packed row at a time, CHW crops a plane row at a time.
+            std::int64_t planes = 1;
+            std::int64_t plane_stride = 0;
+            std::int64_t rows = 1;
+            std::int64_t row_len = src.shape().num_elements();
+            std::int64_t row_stride = row_len;
+            if (!src.is_contiguous())
+            {
+                const data::TensorShape &shape = src.shape();
+                if (shape.rank() != 3 || src.stride(2) != 1)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "CastFloat32ToUint8: src rows must be packed");
+                }
+                if (src.stride(1) == shape.dim(2))
+                {
+                    rows = shape.dim(0);
+                    row_len = shape.dim(1) * shape.dim(2);
+                    row_stride = src.stride(0);
+                }
+                else
+                {
+                    planes = shape.dim(0);
+                    plane_stride = src.stride(0);
+                    rows = shape.dim(1);
+                    row_len = shape.dim(2);
+                    row_stride = src.stride(1);
+                }
+            }
+
+            const float *src_data =
                 static_cast<const float *>(src.buffer().data());
             std::uint8_t *out =
                 static_cast<std::uint8_t *>(dst->buffer().data());
 
-            std::size_t n =
-                static_cast<std::size_t>(src.shape().num_elements());
-            for (std::size_t i = 0; i < n; ++i)
+            for (std::int64_t p = 0; p < planes; ++p)
             {
-                // No clamping here, assumes values already in [0,255]
-                out[i] = static_cast<std::uint8_t>(in[i]);
+                for (std::int64_t r = 0; r < rows; ++r)
+                {
+                    const float *in = src_data + p * plane_stride + r * row_stride;
+                    const std::size_t n = static_cast<std::size_t>(row_len);
+                    for (std::size_t i = 0; i < n; ++i)
+                    {
+                        // No clamping here, assumes values already in [0,255]
+                        out[i] = static_cast<std::uint8_t>(in[i]);
+                    }
+                    out += row_len;
+                }
             }
 
             return core::Status::Ok();
@@ -27,16 +27,61 @@ namespace ptk::operators
                               "CastUint8ToFloat32: shape mismatch");
             }
 
-            const std::uint8_t *in =
+            if (!dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CastUint8ToFloat32: dst must be contiguous");
+            }
+
+            // Strided sources (e.g. crop views) are accepted when the last
+            // dim is packed, so the cast doubles as the copy out: HWC crops
+            // are read a packed row at a time, CHW crops a plane row at a time.
+            std::int64_t planes = 1;
+            std::int64_t plane_stride = 0;
+            std::int64_t rows = 1;
+            std::int64_t row_len = src.shape().num_elements();
+            std::int64_t row_stride = row_len;
+            if (!src.is_contiguous())
+            {
+                const data::TensorShape &shape = src.shape();
+                if (shape.rank() != 3 || src.stride(2) != 1)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "CastUint8ToFloat32: src rows must be packed");
+                }
+                if (src.stride(1) == shape.dim(2))
+                {
+                    rows = shape.dim(0);
+                    row_len = shape.dim(1) * shape.dim(2);
+                    row_stride = src.stride(0);
+                }
+                else
+                {
+                    planes = shape.dim(0);
+                    plane_stride = src.stride(0);
+                    rows = shape.dim(1);
+                    row_len = shape.dim(2);
+                    row_stride = src.stride(1);
+                }
+            }
+
+            const std::uint8_t *src_data =
                 static_cast<const std::uint8_t *>(src.buffer().data());
             float *out =
                 static_cast<float *>(dst->buffer().data());
 
-            std::size_t n =
-                static_cast<std::size_t>(src.shape().num_elements());
-            for (std::size_t i = 0; i < n; ++i)
+            for (std::int64_t p = 0; p < planes; ++p)
             {
-                out[i] = static_cast<float>(in[i]);
+                for (std::int64_t r = 0; r < rows; ++r)
+                {
+                    const std::uint8_t *in = src_data + p * plane_stride + r * row_stride;
+                    const std::size_t n = static_cast<std::size_t>(row_len);
+                    for (std::size_t i = 0; i < n; ++i)
+                    {
+                        out[i] = static_cast<float>(in[i]);
+                    }
+                    out += row_len;
+                }
             }
 
             return core::Status::Ok();
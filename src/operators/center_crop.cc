@@ -1,13 +1,248 @@
 #include "operators/center_crop.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
 #include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
 
 namespace ptk::operators
 {
-        // TODO: Implement CenterCrop
-        core::Status CenterCrop(const data::TensorView &src, int crop_h, int crop_w, data::TensorView *dst)
+        namespace
+        {
+            // Resolves the H, W, C dims and their element strides for a rank 3 tensor.
+            core::Status ResolveDims(const data::TensorView &tensor, core::TensorLayout layout,
+                                     std::int64_t dims[3], std::int64_t strides[3])
+            {
+                if (tensor.shape().rank() != 3)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "CenterCrop: expects rank 3 tensor");
+                }
+
+                int h_axis = 0;
+                int w_axis = 0;
+                int c_axis = 0;
+                switch (layout)
+                {
+                case core::TensorLayout::kHwc:
+                    h_axis = 0;
+                    w_axis = 1;
+                    c_axis = 2;
+                    break;
+                case core::TensorLayout::kChw:
+                    c_axis = 0;
+                    h_axis = 1;
+                    w_axis = 2;
+                    break;
+                default:
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "CenterCrop: layout must be HWC or CHW");
+                }
+
+                dims[0] = tensor.shape().dim(h_axis);
+                dims[1] = tensor.shape().dim(w_axis);
+                dims[2] = tensor.shape().dim(c_axis);
+                strides[0] = tensor.stride(h_axis);
+                strides[1] = tensor.stride(w_axis);
+                strides[2] = tensor.stride(c_axis);
+                return core::Status::Ok();
+            }
+
+            core::Status ValidateCrop(const data::TensorView &src, int crop_h, int crop_w,
+                                      const std::int64_t dims[3])
+            {
+                if (src.dtype() != core::DataType::kUint8 &&
+                    src.dtype() != core::DataType::kFloat32)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "CenterCrop: expects uint8 or float32 tensor");
+                }
+                if (src.buffer().data() == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "CenterCrop: source tensor buffer data is null");
+                }
+                if (crop_h <= 0 || crop_w <= 0)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "CenterCrop: crop size must be positive");
+                }
+                if (crop_h > dims[0] || crop_w > dims[1])
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "CenterCrop: crop size exceeds source size");
+                }
+                return core::Status::Ok();
+            }
+        } // namespace
+
+        core::Status CenterCropView(const data::TensorView &src, int crop_h, int crop_w, data::TensorView *view,
+                                    core::TensorLayout layout)
+        {
+            if (view == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CenterCropView: view is null");
+            }
+
+            std::int64_t dims[3];
+            std::int64_t strides[3];
+            core::Status s = ResolveDims(src, layout, dims, strides);
+            if (!s.ok())
+            {
+                return s;
+            }
+            s = ValidateCrop(src, crop_h, crop_w, dims);
+            if (!s.ok())
+            {
+                return s;
+            }
+
+            const std::int64_t y0 = (dims[0] - crop_h) / 2;
+            const std::int64_t x0 = (dims[1] - crop_w) / 2;
+            const std::size_t elem = src.element_size();
+
+            const std::uint8_t *base = static_cast<const std::uint8_t *>(src.buffer().data());
+            const std::int64_t offset = y0 * strides[0] + x0 * strides[1];
+
+            // Bytes from the first to one past the last element addressed forward
+            // of it; flipped sources have negative strides that reach back instead.
+            const std::int64_t last = std::max<std::int64_t>(0, (crop_h - 1) * strides[0]) +
+                                      std::max<std::int64_t>(0, (crop_w - 1) * strides[1]) +
+                                      std::max<std::int64_t>(0, (dims[2] - 1) * strides[2]);
+
+            data::BufferView bv(const_cast<std::uint8_t *>(base) + offset * static_cast<std::int64_t>(elem),
+                                static_cast<std::size_t>(last + 1) * elem,
+                                src.device_type());
+
+            std::vector<std::int64_t> shape_dims(src.shape().dims());
+            std::vector<std::int64_t> view_strides(3);
+            if (layout == core::TensorLayout::kHwc)
+            {
+                shape_dims[0] = crop_h;
+                shape_dims[1] = crop_w;
+                view_strides = {strides[0], strides[1], strides[2]};
+            }
+            else
+            {
+                shape_dims[1] = crop_h;
+                shape_dims[2] = crop_w;
+                view_strides = {strides[2], strides[0], strides[1]};
+            }
+
+            *view = data::TensorView(bv, src.dtype(), data::TensorShape(shape_dims), view_strides);
+            return core::Status::Ok();
+        }
+
+        core::Status CenterCrop(const data::TensorView &src, int crop_h, int crop_w, data::TensorView *dst,
+                                core::TensorLayout layout)
         {
-            return core::Status(core::StatusCode::kInternal, "CenterCrop not yet implemented");
+            if (dst == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CenterCrop: dst is null");
+            }
+            if (dst->dtype() != src.dtype())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CenterCrop: src and dst dtype differ");
+            }
+            if (!dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CenterCrop: dst must be contiguous");
+            }
+
+            data::TensorView window;
+            core::Status s = CenterCropView(src, crop_h, crop_w, &window, layout);
+            if (!s.ok())
+            {
+                return s;
+            }
+
+            std::int64_t dims[3];
+            std::int64_t strides[3];
+            ResolveDims(window, layout, dims, strides);
+
+            std::int64_t ddims[3];
+            std::int64_t dstrides[3];
+            s = ResolveDims(*dst, layout, ddims, dstrides);
+            if (!s.ok())
+            {
+                return s;
+            }
+            if (ddims[0] != crop_h || ddims[1] != crop_w || ddims[2] != dims[2])
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CenterCrop: dst shape must match crop size");
+            }
+
+            std::uint8_t *out = static_cast<std::uint8_t *>(dst->buffer().data());
+            if (out == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "CenterCrop: destination tensor buffer data is null");
+            }
+
+            const std::uint8_t *in = static_cast<const std::uint8_t *>(window.buffer().data());
+            const std::int64_t elem = static_cast<std::int64_t>(src.element_size());
+            const std::int64_t H = dims[0];
+            const std::int64_t W = dims[1];
+            const std::int64_t C = dims[2];
+
+            if (layout == core::TensorLayout::kHwc)
+            {
+                const std::size_t row_bytes = static_cast<std::size_t>(W * C * elem);
+                const bool packed = strides[2] == 1 && strides[1] == C;
+                for (std::int64_t h = 0; h < H; ++h)
+                {
+                    const std::uint8_t *src_row = in + h * strides[0] * elem;
+                    std::uint8_t *dst_row = out + h * W * C * elem;
+                    if (packed)
+                    {
+                        std::memcpy(dst_row, src_row, row_bytes);
+                        continue;
+                    }
+                    for (std::int64_t w = 0; w < W; ++w)
+                    {
+                        for (std::int64_t c = 0; c < C; ++c)
+                        {
+                            std::memcpy(dst_row + (w * C + c) * elem,
+                                        src_row + (w * strides[1] + c * strides[2]) * elem,
+                                        static_cast<std::size_t>(elem));
+                        }
+                    }
+                }
+            }
+            else
+            {
+                const std::size_t row_bytes = static_cast<std::size_t>(W * elem);
+                const bool packed = strides[1] == 1;
+                for (std::int64_t c = 0; c < C; ++c)
+                {
+                    for (std::int64_t h = 0; h < H; ++h)
+                    {
+                        const std::uint8_t *src_row = in + (c * strides[2] + h * strides[0]) * elem;
+                        std::uint8_t *dst_row = out + (c * H + h) * W * elem;
+                        if (packed)
+                        {
+                            std::memcpy(dst_row, src_row, row_bytes);
+                            continue;
+                        }
+                        for (std::int64_t w = 0; w < W; ++w)
+                        {
+                            std::memcpy(dst_row + w * elem,
+                                        src_row + w * strides[1] * elem,
+                                        static_cast<std::size_t>(elem));
+                        }
+                    }
+                }
+            }
+
+            return core::Status::Ok();
         }
 } // namespace ptk::operators
-
@@ -1,11 +1,214 @@
 #include "operators/chw_to_hwc.h"
+#include "operators/interleave.h"
+#include "operators/kernel_dispatch.h"
+#include "operators/simd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 
 #include "runtime/core/status.h"
 #include "runtime/core/types.h"
 #include "runtime/data/tensor.h"
 
+#if defined(PTK_SIMD_NEON)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSE2)
+#include <emmintrin.h>
+#if defined(PTK_SIMD_SSSE3)
+#include <tmmintrin.h>
+#endif
+#endif
+
 namespace ptk::operators
 {
+        namespace
+        {
+            using detail::Interleave3;
+
+            // Pixels per tile in the generic path, sized so one tile of the
+            // C source runs and the destination row stay in L1.
+            constexpr std::int64_t kTileWidth = 256;
+
+            void Interleave3(const float *s0, const float *s1, const float *s2, float *dst, std::int64_t W)
+            {
+                std::int64_t w = 0;
+#if defined(PTK_SIMD_NEON)
+                for (; w + 4 <= W; w += 4)
+                {
+                    float32x4x3_t px;
+                    px.val[0] = vld1q_f32(s0 + w);
+                    px.val[1] = vld1q_f32(s1 + w);
+                    px.val[2] = vld1q_f32(s2 + w);
+                    vst3q_f32(dst + w * 3, px);
+                }
+#elif defined(PTK_SIMD_SSE2)
+                for (; w + 4 <= W; w += 4)
+                {
+                    // Produces a = r0 g0 b0 r1, b = g1 b1 r2 g2, c = b2 r3 g3 b3
+                    const __m128 r = _mm_loadu_ps(s0 + w);
+                    const __m128 g = _mm_loadu_ps(s1 + w);
+                    const __m128 b = _mm_loadu_ps(s2 + w);
+                    float *p = dst + w * 3;
+                    _mm_storeu_ps(p, _mm_shuffle_ps(_mm_shuffle_ps(r, g, _MM_SHUFFLE(0, 0, 0, 0)),
+                                                    _mm_shuffle_ps(b, r, _MM_SHUFFLE(1, 1, 0, 0)),
+                                                    _MM_SHUFFLE(2, 0, 2, 0)));
+                    _mm_storeu_ps(p + 4, _mm_shuffle_ps(_mm_shuffle_ps(g, b, _MM_SHUFFLE(1, 1, 1, 1)),
+                                                        _mm_shuffle_ps(r, g, _MM_SHUFFLE(2, 2, 2, 2)),
+                                                        _MM_SHUFFLE(2, 0, 2, 0)));
+                    _mm_storeu_ps(p + 8, _mm_shuffle_ps(_mm_shuffle_ps(b, r, _MM_SHUFFLE(3, 3, 2, 2)),
+                                                        _mm_shuffle_ps(g, b, _MM_SHUFFLE(3, 3, 3, 3)),
+                                                        _MM_SHUFFLE(2, 0, 2, 0)));
+                }
+#endif
+                for (; w < W; ++w)
+                {
+                    dst[w * 3 + 0] = s0[w];
+                    dst[w * 3 + 1] = s1[w];
+                    dst[w * 3 + 2] = s2[w];
+                }
+            }
+
+            void Interleave4(const std::uint8_t *s0, const std::uint8_t *s1, const std::uint8_t *s2,
+                             const std::uint8_t *s3, std::uint8_t *dst, std::int64_t W)
+            {
+                std::int64_t w = 0;
+#if defined(PTK_SIMD_NEON)
+                for (; w + 16 <= W; w += 16)
+                {
+                    uint8x16x4_t px;
+                    px.val[0] = vld1q_u8(s0 + w);
+                    px.val[1] = vld1q_u8(s1 + w);
+                    px.val[2] = vld1q_u8(s2 + w);
+                    px.val[3] = vld1q_u8(s3 + w);
+                    vst4q_u8(dst + w * 4, px);
+                }
+#elif defined(PTK_SIMD_SSSE3)
+                // Transpose the 4x4 grid of 32-bit channel groups, then spread
+                // each register's channel groups back into 4 pixels.
+                const __m128i spread = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+                for (; w + 16 <= W; w += 16)
+                {
+                    const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s0 + w));
+                    const __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s1 + w));
+                    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s2 + w));
+                    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s3 + w));
+                    const __m128i rg_lo = _mm_unpacklo_epi32(r, g);
+                    const __m128i rg_hi = _mm_unpackhi_epi32(r, g);
+                    const __m128i ba_lo = _mm_unpacklo_epi32(b, a);
+                    const __m128i ba_hi = _mm_unpackhi_epi32(b, a);
+                    std::uint8_t *p = dst + w * 4;
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(p),
+                                     _mm_shuffle_epi8(_mm_unpacklo_epi64(rg_lo, ba_lo), spread));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 16),
+                                     _mm_shuffle_epi8(_mm_unpackhi_epi64(rg_lo, ba_lo), spread));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 32),
+                                     _mm_shuffle_epi8(_mm_unpacklo_epi64(rg_hi, ba_hi), spread));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(p + 48),
+                                     _mm_shuffle_epi8(_mm_unpackhi_epi64(rg_hi, ba_hi), spread));
+                }
+#endif
+                for (; w < W; ++w)
+                {
+                    dst[w * 4 + 0] = s0[w];
+                    dst[w * 4 + 1] = s1[w];
+                    dst[w * 4 + 2] = s2[w];
+                    dst[w * 4 + 3] = s3[w];
+                }
+            }
+
+            void Interleave4(const float *s0, const float *s1, const float *s2, const float *s3,
+                             float *dst, std::int64_t W)
+            {
+                std::int64_t w = 0;
+#if defined(PTK_SIMD_NEON)
+                for (; w + 4 <= W; w += 4)
+                {
+                    float32x4x4_t px;
+                    px.val[0] = vld1q_f32(s0 + w);
+                    px.val[1] = vld1q_f32(s1 + w);
+                    px.val[2] = vld1q_f32(s2 + w);
+                    px.val[3] = vld1q_f32(s3 + w);
+                    vst4q_f32(dst + w * 4, px);
+                }
+#elif defined(PTK_SIMD_SSE2)
+                for (; w + 4 <= W; w += 4)
+                {
+                    __m128 r = _mm_loadu_ps(s0 + w);
+                    __m128 g = _mm_loadu_ps(s1 + w);
+                    __m128 b = _mm_loadu_ps(s2 + w);
+                    __m128 a = _mm_loadu_ps(s3 + w);
+                    _MM_TRANSPOSE4_PS(r, g, b, a);
+                    float *p = dst + w * 4;
+                    _mm_storeu_ps(p, r);
+                    _mm_storeu_ps(p + 4, g);
+                    _mm_storeu_ps(p + 8, b);
+                    _mm_storeu_ps(p + 12, a);
+                }
+#endif
+                for (; w < W; ++w)
+                {
+                    dst[w * 4 + 0] = s0[w];
+                    dst[w * 4 + 1] = s1[w];
+                    dst[w * 4 + 2] = s2[w];
+                    dst[w * 4 + 3] = s3[w];
+                }
+            }
+
+            // Each destination row is written once, reading C sequential plane
+            // runs, instead of scattering across the whole image per channel. N
+            // is the channel count when known at compile time.
+            template <typename T, int N>
+            void ChwToHwcImpl(const T *src, T *dst, std::int64_t runtime_channels, std::int64_t H, std::int64_t W)
+            {
+                const std::int64_t C = ChannelCount<N>(runtime_channels);
+                const std::int64_t plane = H * W;
+                if constexpr (N == 1)
+                {
+                    std::memcpy(dst, src, static_cast<std::size_t>(plane) * sizeof(T));
+                    return;
+                }
+
+                const T *planes[4];
+                for (std::int64_t h = 0; h < H; ++h)
+                {
+                    T *dst_row = dst + h * W * C;
+                    if constexpr (N == 3)
+                    {
+                        Interleave3(src + h * W, src + plane + h * W, src + 2 * plane + h * W, dst_row, W);
+                    }
+                    else if constexpr (N == 4)
+                    {
+                        Interleave4(src + h * W, src + plane + h * W, src + 2 * plane + h * W,
+                                    src + 3 * plane + h * W, dst_row, W);
+                    }
+                    else
+                    {
+                        for (std::int64_t c0 = 0; c0 < C; c0 += 4)
+                        {
+                            const std::int64_t n = std::min<std::int64_t>(4, C - c0);
+                            for (std::int64_t c = 0; c < n; ++c)
+                            {
+                                planes[c] = src + (c0 + c) * plane + h * W;
+                            }
+                            // Walk channels in groups of 4 so the plane pointers stay in registers.
+                            for (std::int64_t w0 = 0; w0 < W; w0 += kTileWidth)
+                            {
+                                const std::int64_t w1 = std::min(W, w0 + kTileWidth);
+                                for (std::int64_t c = 0; c < n; ++c)
+                                {
+                                    for (std::int64_t w = w0; w < w1; ++w)
+                                    {
+                                        dst_row[w * C + c0 + c] = planes[c][w];
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        } // namespace
+
         core::Status ChwToHwc(const data::TensorView &src, data::TensorView *dst)
         {
             if (dst == nullptr)
@@ -13,11 +216,17 @@ namespace ptk::operators
                 return core::Status(core::StatusCode::kInvalidArgument,
                               "ChwToHwc: dst is null");
             }
-            if (src.dtype() != core::DataType::kFloat32 ||
-                dst->dtype() != core::DataType::kFloat32)
+            if (src.dtype() != dst->dtype() ||
+                (src.dtype() != core::DataType::kFloat32 &&
+                 src.dtype() != core::DataType::kUint8))
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ChwToHwc: expects matching uint8 or float32 src and dst");
+            }
+            if (!src.is_contiguous() || !dst->is_contiguous())
             {
                 return core::Status(core::StatusCode::kInvalidArgument,
-                              "ChwToHwc: expects float32 src and dst");
+                              "ChwToHwc: expects contiguous tensors");
             }
 
             const data::TensorShape &sshape = src.shape();
@@ -41,10 +250,8 @@ namespace ptk::operators
                               "ChwToHwc: dst shape must be [H,W,C]");
             }
 
-            const float *src_data =
-                static_cast<const float *>(src.buffer().data());
-            float *dst_data =
-                static_cast<float *>(dst->buffer().data());
+            const void *src_data = src.buffer().data();
+            void *dst_data = dst->buffer().data();
 
             if (src_data == nullptr || dst_data == nullptr)
             {
@@ -52,25 +259,14 @@ namespace ptk::operators
                               "ChwToHwc: null buffer data");
             }
 
-            // CHW to HWC
-            // src: (c, h, w) -> (c * H + h) * W + w
-            // dst: (h, w, c) -> (h * W + w) * C + c
-            for (std::int64_t h = 0; h < H; ++h)
-            {
-                for (std::int64_t w = 0; w < W; ++w)
-                {
-                    for (std::int64_t c = 0; c < C; ++c)
-                    {
-                        const std::size_t src_idx =
-                            static_cast<std::size_t>((c * H + h) * W + w);
-                        const std::size_t dst_idx =
-                            static_cast<std::size_t>((h * W + w) * C + c);
-                        dst_data[dst_idx] = src_data[src_idx];
-                    }
-                }
-            }
+            DispatchDType<std::uint8_t, float>(src.dtype(), [&](auto type) {
+                using T = typename decltype(type)::type;
+                DispatchChannels(C, [&](auto channels) {
+                    ChwToHwcImpl<T, decltype(channels)::value>(static_cast<const T *>(src_data),
+                                                               static_cast<T *>(dst_data), C, H, W);
+                });
+            });
 
             return core::Status::Ok();
         }
 } // namespace ptk::operators
-
@@ -0,0 +1,122 @@
+#include "operators/crop_resize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+        namespace
+        {
+            constexpr int kMaxChannels = 4;
+
+            // Source indices and Q8 weight of the second sample for one output
+            // coordinate.
+            struct AxisSample
+            {
+                std::int32_t i0;
+                std::int32_t i1;
+                std::int32_t w;
+            };
+
+            // Maps dst_len output pixels onto [lo, hi) of a src_len axis.
+            void MakeAxis(float lo, float hi, std::int64_t src_len, std::int64_t dst_len,
+                          std::vector<AxisSample> *axis)
+            {
+                axis->resize(static_cast<std::size_t>(dst_len));
+                const double scale = (static_cast<double>(hi) - lo) / static_cast<double>(dst_len);
+                for (std::int64_t i = 0; i < dst_len; ++i)
+                {
+                    double s = lo + (static_cast<double>(i) + 0.5) * scale - 0.5;
+                    s = std::min(std::max(s, 0.0), static_cast<double>(src_len - 1));
+                    const std::int64_t i0 = static_cast<std::int64_t>(s);
+                    AxisSample &a = (*axis)[static_cast<std::size_t>(i)];
+                    a.i0 = static_cast<std::int32_t>(i0);
+                    a.i1 = static_cast<std::int32_t>(std::min(i0 + 1, src_len - 1));
+                    a.w = static_cast<std::int32_t>(std::lround((s - static_cast<double>(i0)) * 256.0));
+                }
+            }
+        } // namespace
+
+        core::Status CropResize(const data::TensorView &src, const CropBox &box, data::TensorView *dst)
+        {
+            if (dst == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "CropResize: dst is null");
+            }
+            if (src.dtype() != core::DataType::kUint8 || dst->dtype() != core::DataType::kUint8)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "CropResize: expects uint8 tensors");
+            }
+            if (src.shape().rank() != 3 || dst->shape().rank() != 3)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "CropResize: expects [H,W,C] tensors");
+            }
+            const std::int64_t H = src.shape().dim(0);
+            const std::int64_t W = src.shape().dim(1);
+            const std::int64_t C = src.shape().dim(2);
+            const std::int64_t OH = dst->shape().dim(0);
+            const std::int64_t OW = dst->shape().dim(1);
+            if (H <= 0 || W <= 0 || OH <= 0 || OW <= 0 || C < 1 || C > kMaxChannels)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                                    "CropResize: empty image or unsupported channel count");
+            }
+            if (dst->shape().dim(2) != C)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "CropResize: channel count mismatch");
+            }
+            if (src.stride(2) != 1 || src.stride(1) != C || !dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "CropResize: pixels must be packed");
+            }
+            if (!(box.x1 > box.x0) || !(box.y1 > box.y0))
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "CropResize: empty box");
+            }
+            if (dst->buffer().size_bytes() < dst->bytes())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "CropResize: dst buffer too small");
+            }
+
+            // Reused across calls on this thread; a cascade resamples many
+            // boxes per frame.
+            thread_local std::vector<AxisSample> xs;
+            thread_local std::vector<AxisSample> ys;
+            MakeAxis(box.x0, box.x1, W, OW, &xs);
+            MakeAxis(box.y0, box.y1, H, OH, &ys);
+
+            const std::uint8_t *in = static_cast<const std::uint8_t *>(src.buffer().data());
+            const std::int64_t row_step = src.stride(0);
+            std::uint8_t *out = static_cast<std::uint8_t *>(dst->buffer().data());
+
+            for (std::int64_t h = 0; h < OH; ++h)
+            {
+                const AxisSample &y = ys[static_cast<std::size_t>(h)];
+                const std::uint8_t *r0 = in + y.i0 * row_step;
+                const std::uint8_t *r1 = in + y.i1 * row_step;
+                std::uint8_t *dst_row = out + h * OW * C;
+                for (std::int64_t w = 0; w < OW; ++w)
+                {
+                    const AxisSample &x = xs[static_cast<std::size_t>(w)];
+                    const std::uint8_t *p00 = r0 + x.i0 * C;
+                    const std::uint8_t *p01 = r0 + x.i1 * C;
+                    const std::uint8_t *p10 = r1 + x.i0 * C;
+                    const std::uint8_t *p11 = r1 + x.i1 * C;
+                    for (std::int64_t c = 0; c < C; ++c)
+                    {
+                        const int top = p00[c] * (256 - x.w) + p01[c] * x.w;
+                        const int bottom = p10[c] * (256 - x.w) + p11[c] * x.w;
+                        dst_row[w * C + c] =
+                            static_cast<std::uint8_t>((top * (256 - y.w) + bottom * y.w + (1 << 15)) >> 16);
+                    }
+                }
+            }
+            return core::Status::Ok();
+        }
+} // namespace ptk::operators
@@ -0,0 +1,638 @@
+#include "operators/demosaic.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+#include "operators/interleave.h"
+#include "operators/simd.h"
+#include "runtime/core/status.h"
+#include "runtime/core/thread_pool.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+#if defined(PTK_SIMD_NEON)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace ptk::operators
+{
+        namespace
+        {
+            // Below this many output pixels a frame is demosaiced on the calling thread.
+            constexpr std::int64_t kMinParallelElements = 1 << 15;
+
+            // Output pixels interpolated into planar scratch at a time, so the
+            // scratch rows stay in L1.
+            constexpr std::int64_t kTileWidth = 256;
+
+            // Color filter layout. Every row holds green and one other color:
+            // red_row[y & 1] tells which, site[y & 1] is the column parity it
+            // sits on.
+            struct Cfa
+            {
+                bool red_row[2];
+                int site[2];
+            };
+
+            bool MakeCfa(core::PixelFormat format, Cfa *cfa)
+            {
+                switch (format)
+                {
+                case core::PixelFormat::kBayerRggb:
+                    *cfa = {{true, false}, {0, 1}};
+                    return true;
+                case core::PixelFormat::kBayerBggr:
+                    *cfa = {{false, true}, {0, 1}};
+                    return true;
+                case core::PixelFormat::kBayerGrbg:
+                    *cfa = {{true, false}, {1, 0}};
+                    return true;
+                case core::PixelFormat::kBayerGbrg:
+                    *cfa = {{false, true}, {1, 0}};
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            // Mirrors an index around the first and last sample, which keeps the
+            // color filter parity of the mirrored sample.
+            std::int64_t Reflect(std::int64_t i, std::int64_t n)
+            {
+                return i < 0 ? -i : (i >= n ? 2 * n - 2 - i : i);
+            }
+
+            template <typename T>
+            T Avg(T a, T b)
+            {
+                return static_cast<T>((static_cast<std::uint32_t>(a) + b + 1) >> 1);
+            }
+
+            template <typename T>
+            T AbsDiff(T a, T b)
+            {
+                return a > b ? static_cast<T>(a - b) : static_cast<T>(b - a);
+            }
+
+            // The vector ops the kernels need, for 8-bit and 16-bit lanes. Avg
+            // rounds up like pavg / vrhadd, so the scalar tails match exactly.
+            template <typename T>
+            struct Lanes;
+
+#if defined(PTK_SIMD_NEON)
+            template <>
+            struct Lanes<std::uint8_t>
+            {
+                using V = uint8x16_t;
+                static constexpr std::int64_t kCount = 16;
+                static V Load(const std::uint8_t *p) { return vld1q_u8(p); }
+                static void Store(std::uint8_t *p, V v) { vst1q_u8(p, v); }
+                static V Avg(V a, V b) { return vrhaddq_u8(a, b); }
+                static V AbsDiff(V a, V b) { return vabdq_u8(a, b); }
+                static V Less(V a, V b) { return vcltq_u8(a, b); }
+                static V Select(V m, V a, V b) { return vbslq_u8(m, a, b); }
+                static V SiteMask(int site) { return vreinterpretq_u8_u16(vdupq_n_u16(site == 0 ? 0x00FF : 0xFF00)); }
+            };
+
+            template <>
+            struct Lanes<std::uint16_t>
+            {
+                using V = uint16x8_t;
+                static constexpr std::int64_t kCount = 8;
+                static V Load(const std::uint16_t *p) { return vld1q_u16(p); }
+                static void Store(std::uint16_t *p, V v) { vst1q_u16(p, v); }
+                static V Avg(V a, V b) { return vrhaddq_u16(a, b); }
+                static V AbsDiff(V a, V b) { return vabdq_u16(a, b); }
+                static V Less(V a, V b) { return vcltq_u16(a, b); }
+                static V Select(V m, V a, V b) { return vbslq_u16(m, a, b); }
+                static V SiteMask(int site)
+                {
+                    return vreinterpretq_u16_u32(vdupq_n_u32(site == 0 ? 0x0000FFFFu : 0xFFFF0000u));
+                }
+            };
+#elif defined(PTK_SIMD_SSE2)
+            template <>
+            struct Lanes<std::uint8_t>
+            {
+                using V = __m128i;
+                static constexpr std::int64_t kCount = 16;
+                static V Load(const std::uint8_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+                static void Store(std::uint8_t *p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+                static V Avg(V a, V b) { return _mm_avg_epu8(a, b); }
+                static V AbsDiff(V a, V b) { return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a)); }
+                static V Less(V a, V b)
+                {
+                    const V zero = _mm_setzero_si128();
+                    return _mm_xor_si128(_mm_cmpeq_epi8(_mm_subs_epu8(b, a), zero), _mm_cmpeq_epi8(zero, zero));
+                }
+                static V Select(V m, V a, V b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+                static V SiteMask(int site) { return _mm_set1_epi16(site == 0 ? 0x00FF : static_cast<short>(0xFF00)); }
+            };
+
+            template <>
+            struct Lanes<std::uint16_t>
+            {
+                using V = __m128i;
+                static constexpr std::int64_t kCount = 8;
+                static V Load(const std::uint16_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+                static void Store(std::uint16_t *p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v); }
+                static V Avg(V a, V b) { return _mm_avg_epu16(a, b); }
+                static V AbsDiff(V a, V b) { return _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a)); }
+                static V Less(V a, V b)
+                {
+                    const V zero = _mm_setzero_si128();
+                    return _mm_xor_si128(_mm_cmpeq_epi16(_mm_subs_epu16(b, a), zero), _mm_cmpeq_epi16(zero, zero));
+                }
+                static V Select(V m, V a, V b) { return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b)); }
+                static V SiteMask(int site) { return _mm_set1_epi32(site == 0 ? 0x0000FFFF : static_cast<int>(0xFFFF0000u)); }
+            };
+#endif
+
+            // Interpolates one row of n pixels starting at an even column. up,
+            // cur and dn may be read at [-1, n]. Lanes on the row's non-green
+            // site (column parity `site`) get x = own sample, g = interpolated
+            // green, y = diagonal average of the other color; green lanes get
+            // x = horizontal average, g = own sample, y = vertical average.
+            template <typename T>
+            void InterpolateRow(const T *up, const T *cur, const T *dn, std::int64_t n, int site, bool edge_aware,
+                                T *x_plane, T *g_plane, T *y_plane)
+            {
+                std::int64_t x = 0;
+#if defined(PTK_SIMD_NEON) || defined(PTK_SIMD_SSE2)
+                using L = Lanes<T>;
+                const typename L::V mask = L::SiteMask(site);
+                for (; x + L::kCount <= n; x += L::kCount)
+                {
+                    const typename L::V c = L::Load(cur + x);
+                    const typename L::V l = L::Load(cur + x - 1);
+                    const typename L::V r = L::Load(cur + x + 1);
+                    const typename L::V u = L::Load(up + x);
+                    const typename L::V d = L::Load(dn + x);
+                    const typename L::V hor = L::Avg(l, r);
+                    const typename L::V ver = L::Avg(u, d);
+                    typename L::V green = L::Avg(hor, ver);
+                    if (edge_aware)
+                    {
+                        const typename L::V dh = L::AbsDiff(l, r);
+                        const typename L::V dv = L::AbsDiff(u, d);
+                        green = L::Select(L::Less(dh, dv), hor, L::Select(L::Less(dv, dh), ver, green));
+                    }
+                    const typename L::V diag = L::Avg(L::Avg(L::Load(up + x - 1), L::Load(up + x + 1)),
+                                                      L::Avg(L::Load(dn + x - 1), L::Load(dn + x + 1)));
+                    L::Store(x_plane + x, L::Select(mask, c, hor));
+                    L::Store(g_plane + x, L::Select(mask, green, c));
+                    L::Store(y_plane + x, L::Select(mask, diag, ver));
+                }
+#endif
+                for (; x < n; ++x)
+                {
+                    const T hor = Avg(cur[x - 1], cur[x + 1]);
+                    const T ver = Avg(up[x], dn[x]);
+                    if ((x & 1) != site)
+                    {
+                        x_plane[x] = hor;
+                        g_plane[x] = cur[x];
+                        y_plane[x] = ver;
+                        continue;
+                    }
+                    T green = Avg(hor, ver);
+                    if (edge_aware)
+                    {
+                        const T dh = AbsDiff(cur[x - 1], cur[x + 1]);
+                        const T dv = AbsDiff(up[x], dn[x]);
+                        green = dh < dv ? hor : (dv < dh ? ver : green);
+                    }
+                    x_plane[x] = cur[x];
+                    g_plane[x] = green;
+                    y_plane[x] = Avg(Avg(up[x - 1], up[x + 1]), Avg(dn[x - 1], dn[x + 1]));
+                }
+            }
+
+            // Splits n sample pairs into the even and odd columns.
+            template <typename T>
+            void SplitEvenOdd(const T *in, std::int64_t n, T *even, T *odd)
+            {
+                std::int64_t x = 0;
+#if defined(PTK_SIMD_NEON)
+                if constexpr (std::is_same<T, std::uint8_t>::value)
+                {
+                    for (; x + 16 <= n; x += 16)
+                    {
+                        const uint8x16x2_t v = vld2q_u8(in + 2 * x);
+                        vst1q_u8(even + x, v.val[0]);
+                        vst1q_u8(odd + x, v.val[1]);
+                    }
+                }
+                else
+                {
+                    for (; x + 8 <= n; x += 8)
+                    {
+                        const uint16x8x2_t v = vld2q_u16(in + 2 * x);
+                        vst1q_u16(even + x, v.val[0]);
+                        vst1q_u16(odd + x, v.val[1]);
+                    }
+                }
+#elif defined(PTK_SIMD_SSE2)
+                if constexpr (std::is_same<T, std::uint8_t>::value)
+                {
+                    const __m128i low = _mm_set1_epi16(0x00FF);
+                    for (; x + 16 <= n; x += 16)
+                    {
+                        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * x));
+                        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * x + 16));
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(even + x),
+                                         _mm_packus_epi16(_mm_and_si128(a, low), _mm_and_si128(b, low)));
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(odd + x),
+                                         _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8)));
+                    }
+                }
+                else
+                {
+                    // SSE2 only packs with signed saturation, so values are
+                    // biased into the signed range and back.
+                    const __m128i low = _mm_set1_epi32(0xFFFF);
+                    const __m128i bias32 = _mm_set1_epi32(0x8000);
+                    const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+                    auto pack = [&](__m128i a, __m128i b)
+                    {
+                        return _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(a, bias32), _mm_sub_epi32(b, bias32)),
+                                             bias16);
+                    };
+                    for (; x + 8 <= n; x += 8)
+                    {
+                        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * x));
+                        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * x + 8));
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(even + x),
+                                         pack(_mm_and_si128(a, low), _mm_and_si128(b, low)));
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(odd + x),
+                                         pack(_mm_srli_epi32(a, 16), _mm_srli_epi32(b, 16)));
+                    }
+                }
+#endif
+                for (; x < n; ++x)
+                {
+                    even[x] = in[2 * x];
+                    odd[x] = in[2 * x + 1];
+                }
+            }
+
+            template <typename T>
+            void AvgRow(const T *a, const T *b, std::int64_t n, T *out)
+            {
+                std::int64_t x = 0;
+#if defined(PTK_SIMD_NEON) || defined(PTK_SIMD_SSE2)
+                using L = Lanes<T>;
+                for (; x + L::kCount <= n; x += L::kCount)
+                {
+                    L::Store(out + x, L::Avg(L::Load(a + x), L::Load(b + x)));
+                }
+#endif
+                for (; x < n; ++x)
+                {
+                    out[x] = Avg(a[x], b[x]);
+                }
+            }
+
+            // uint16 samples to uint8 by dropping the low `shift` bits, saturating.
+            void NarrowRow(const std::uint16_t *in, std::int64_t n, int shift, std::uint8_t *out)
+            {
+                std::int64_t x = 0;
+#if defined(PTK_SIMD_NEON)
+                const int16x8_t count = vdupq_n_s16(static_cast<std::int16_t>(-shift));
+                for (; x + 16 <= n; x += 16)
+                {
+                    vst1q_u8(out + x, vcombine_u8(vqmovn_u16(vshlq_u16(vld1q_u16(in + x), count)),
+                                                  vqmovn_u16(vshlq_u16(vld1q_u16(in + x + 8), count))));
+                }
+#elif defined(PTK_SIMD_SSE2)
+                const __m128i count = _mm_cvtsi32_si128(shift);
+                for (; x + 16 <= n; x += 16)
+                {
+                    const __m128i a = _mm_srl_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x)), count);
+                    const __m128i b = _mm_srl_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x + 8)), count);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x), _mm_packus_epi16(a, b));
+                }
+#endif
+                for (; x < n; ++x)
+                {
+                    out[x] = static_cast<std::uint8_t>(std::min(in[x] >> shift, 255));
+                }
+            }
+
+            // Writes n pixels of three planes (at most kTileWidth) as packed pixels.
+            template <typename T, typename D>
+            void StoreRow(const T *p0, const T *p1, const T *p2, std::int64_t n, int shift, D *out)
+            {
+                if constexpr (std::is_same<T, std::uint8_t>::value)
+                {
+                    detail::Interleave3(p0, p1, p2, out, n);
+                }
+                else if constexpr (std::is_same<D, std::uint8_t>::value)
+                {
+                    std::uint8_t c0[kTileWidth];
+                    std::uint8_t c1[kTileWidth];
+                    std::uint8_t c2[kTileWidth];
+                    NarrowRow(p0, n, shift, c0);
+                    NarrowRow(p1, n, shift, c1);
+                    NarrowRow(p2, n, shift, c2);
+                    detail::Interleave3(c0, c1, c2, out, n);
+                }
+                else
+                {
+                    for (std::int64_t x = 0; x < n; ++x)
+                    {
+                        out[3 * x + 0] = p0[x];
+                        out[3 * x + 1] = p1[x];
+                        out[3 * x + 2] = p2[x];
+                    }
+                }
+            }
+
+            template <typename T, typename D>
+            void DemosaicRows(const T *src, std::int64_t H, std::int64_t W, const Cfa &cfa, bool bgr,
+                              bool edge_aware, int shift, D *dst, std::int64_t y0, std::int64_t y1)
+            {
+                T pad[3][kTileWidth + 2];
+                T x_plane[kTileWidth];
+                T g_plane[kTileWidth];
+                T y_plane[kTileWidth];
+                for (std::int64_t y = y0; y < y1; ++y)
+                {
+                    const T *rows[3] = {src + Reflect(y - 1, H) * W, src + y * W, src + Reflect(y + 1, H) * W};
+                    const bool red = cfa.red_row[y & 1];
+                    const int site = cfa.site[y & 1];
+                    for (std::int64_t x0 = 0; x0 < W; x0 += kTileWidth)
+                    {
+                        const std::int64_t n = std::min(kTileWidth, W - x0);
+                        const T *u = rows[0] + x0;
+                        const T *c = rows[1] + x0;
+                        const T *d = rows[2] + x0;
+                        if (x0 == 0 || x0 + n == W)
+                        {
+                            // Border tiles read through mirrored copies.
+                            for (int i = 0; i < 3; ++i)
+                            {
+                                for (std::int64_t k = 0; k < n + 2; ++k)
+                                {
+                                    pad[i][k] = rows[i][Reflect(x0 - 1 + k, W)];
+                                }
+                            }
+                            u = pad[0] + 1;
+                            c = pad[1] + 1;
+                            d = pad[2] + 1;
+                        }
+                        InterpolateRow(u, c, d, n, site, edge_aware, x_plane, g_plane, y_plane);
+                        const T *r = red ? x_plane : y_plane;
+                        const T *b = red ? y_plane : x_plane;
+                        StoreRow(bgr ? b : r, g_plane, bgr ? r : b, n, shift, dst + (y * W + x0) * 3);
+                    }
+                }
+            }
+
+            // 2x2 bins: the two green samples are averaged, red and blue copied.
+            template <typename T, typename D>
+            void BinRows2(const T *src, std::int64_t W, const Cfa &cfa, bool bgr, int shift, D *dst,
+                          std::int64_t y0, std::int64_t y1)
+            {
+                const std::int64_t OW = W / 2;
+                T cols[4][kTileWidth]; // even and odd columns of the two rows
+                T green[kTileWidth];
+                for (std::int64_t y = y0; y < y1; ++y)
+                {
+                    const T *row0 = src + 2 * y * W;
+                    const T *row1 = row0 + W;
+                    for (std::int64_t x0 = 0; x0 < OW; x0 += kTileWidth)
+                    {
+                        const std::int64_t n = std::min(kTileWidth, OW - x0);
+                        SplitEvenOdd(row0 + 2 * x0, n, cols[0], cols[1]);
+                        SplitEvenOdd(row1 + 2 * x0, n, cols[2], cols[3]);
+                        const T *a0 = cols[cfa.site[0]];
+                        const T *a1 = cols[2 + cfa.site[1]];
+                        AvgRow(cols[1 - cfa.site[0]], cols[3 - cfa.site[1]], n, green);
+                        const T *r = cfa.red_row[0] ? a0 : a1;
+                        const T *b = cfa.red_row[0] ? a1 : a0;
+                        StoreRow(bgr ? b : r, green, bgr ? r : b, n, shift, dst + (y * OW + x0) * 3);
+                    }
+                }
+            }
+
+            // f x f bins for even f > 2, averaged with rounding.
+            template <typename T, typename D>
+            void BinRows(const T *src, std::int64_t W, std::int64_t f, const Cfa &cfa, bool bgr, int shift, D *dst,
+                         std::int64_t y0, std::int64_t y1)
+            {
+                const std::int64_t OW = W / f;
+                const std::uint32_t n_rb = static_cast<std::uint32_t>(f * f / 4);
+                const std::uint32_t n_g = 2 * n_rb;
+                T planes[3][kTileWidth];
+                for (std::int64_t y = y0; y < y1; ++y)
+                {
+                    for (std::int64_t x0 = 0; x0 < OW; x0 += kTileWidth)
+                    {
+                        const std::int64_t n = std::min(kTileWidth, OW - x0);
+                        for (std::int64_t x = 0; x < n; ++x)
+                        {
+                            std::uint32_t sum[3] = {0, 0, 0};
+                            const T *block = src + y * f * W + (x0 + x) * f;
+                            for (std::int64_t dy = 0; dy < f; ++dy)
+                            {
+                                const T *row = block + dy * W;
+                                const int site = cfa.site[dy & 1];
+                                const int other = cfa.red_row[dy & 1] ? 0 : 2;
+                                for (std::int64_t dx = 0; dx < f; ++dx)
+                                {
+                                    sum[(dx & 1) == site ? other : 1] += row[dx];
+                                }
+                            }
+                            planes[0][x] = static_cast<T>((sum[0] + n_rb / 2) / n_rb);
+                            planes[1][x] = static_cast<T>((sum[1] + n_g / 2) / n_g);
+                            planes[2][x] = static_cast<T>((sum[2] + n_rb / 2) / n_rb);
+                        }
+                        StoreRow(planes[bgr ? 2 : 0], planes[1], planes[bgr ? 0 : 2], n, shift,
+                                 dst + (y * OW + x0) * 3);
+                    }
+                }
+            }
+
+            // Shared argument checks. On success fills the layout, the shift
+            // that brings samples to uint8 and the output dimensions implied by
+            // dst (the bin factor for DemosaicBinned).
+            core::Status CheckMosaic(const data::TensorView &src, core::PixelFormat src_format,
+                                     const data::TensorView *dst, core::PixelFormat dst_format,
+                                     const DemosaicParams &params, bool binned, const std::string &name,
+                                     Cfa *cfa, int *shift, std::int64_t *factor)
+            {
+                if (dst == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": dst is null");
+                }
+                if (!MakeCfa(src_format, cfa))
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": src_format must be a Bayer format");
+                }
+                if (dst_format != core::PixelFormat::kRgb8 && dst_format != core::PixelFormat::kBgr8)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": dst_format must be kRgb8 or kBgr8");
+                }
+
+                const core::DataType dtype = src.dtype();
+                if (dtype != core::DataType::kUint8 && dtype != core::DataType::kUint16)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects uint8 or uint16 src");
+                }
+                if (dst->dtype() != core::DataType::kUint8 && dst->dtype() != dtype)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": dst must be uint8 or the src type");
+                }
+                const int bits = dtype == core::DataType::kUint8 ? 8 : (params.bit_depth == 0 ? 16 : params.bit_depth);
+                if ((dtype == core::DataType::kUint8 && params.bit_depth != 0 && params.bit_depth != 8) ||
+                    (dtype == core::DataType::kUint16 && (bits < 9 || bits > 16)))
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": bit_depth must be 8 for uint8 and 9 to 16 for uint16 src");
+                }
+                *shift = dst->dtype() == dtype ? 0 : bits - 8;
+
+                const data::TensorShape &sshape = src.shape();
+                const data::TensorShape &dshape = dst->shape();
+                if (sshape.rank() != 3 || sshape.dim(2) != 1 || dshape.rank() != 3 || dshape.dim(2) != 3)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects [H,W,1] src and [H,W,3] dst");
+                }
+                if (!src.is_contiguous() || !dst->is_contiguous())
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects contiguous tensors");
+                }
+
+                const std::int64_t H = sshape.dim(0);
+                const std::int64_t W = sshape.dim(1);
+                if (H < 2 || W < 2 || H % 2 != 0 || W % 2 != 0)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": H and W must be even and at least 2");
+                }
+
+                const std::int64_t OH = dshape.dim(0);
+                const std::int64_t OW = dshape.dim(1);
+                *factor = OH > 0 ? H / OH : 0;
+                if (binned ? (*factor < 2 || *factor % 2 != 0 || OH * *factor != H || OW * *factor != W)
+                           : (OH != H || OW != W))
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  binned ? name + ": dst must be [H/f,W/f,3] for an even factor f"
+                                         : name + ": dst must be [H,W,3]");
+                }
+
+                if (src.buffer().data() == nullptr || dst->buffer().data() == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": null buffer data");
+                }
+                return core::Status::Ok();
+            }
+
+            // Calls fn(src, dst) with the typed pointers of a checked call.
+            template <typename Fn>
+            void DispatchMosaic(const data::TensorView &src, data::TensorView *dst, Fn &&fn)
+            {
+                const void *in = src.buffer().data();
+                void *out = dst->buffer().data();
+                if (src.dtype() == core::DataType::kUint8)
+                {
+                    fn(static_cast<const std::uint8_t *>(in), static_cast<std::uint8_t *>(out));
+                }
+                else if (dst->dtype() == core::DataType::kUint8)
+                {
+                    fn(static_cast<const std::uint16_t *>(in), static_cast<std::uint8_t *>(out));
+                }
+                else
+                {
+                    fn(static_cast<const std::uint16_t *>(in), static_cast<std::uint16_t *>(out));
+                }
+            }
+        } // namespace
+
+        core::Status Demosaic(const data::TensorView &src, core::PixelFormat src_format,
+                              data::TensorView *dst, core::PixelFormat dst_format,
+                              const DemosaicParams &params)
+        {
+            Cfa cfa;
+            int shift = 0;
+            std::int64_t factor = 0;
+            core::Status s = CheckMosaic(src, src_format, dst, dst_format, params, false, "Demosaic",
+                                         &cfa, &shift, &factor);
+            if (!s.ok())
+            {
+                return s;
+            }
+
+            const std::int64_t H = src.shape().dim(0);
+            const std::int64_t W = src.shape().dim(1);
+            const bool bgr = dst_format == core::PixelFormat::kBgr8;
+            const bool edge_aware = params.method == DemosaicMethod::kEdgeAware;
+
+            std::function<void(std::int64_t, std::int64_t)> fn;
+            DispatchMosaic(src, dst, [&](auto in, auto out)
+                           {
+                               fn = [=, &cfa](std::int64_t y0, std::int64_t y1)
+                               { DemosaicRows(in, H, W, cfa, bgr, edge_aware, shift, out, y0, y1); };
+                           });
+
+            const std::int64_t min_rows = W >= kMinParallelElements ? 1 : kMinParallelElements / W;
+            core::ThreadPool::Default().ParallelFor(0, H, min_rows, fn);
+
+            return core::Status::Ok();
+        }
+
+        core::Status DemosaicBinned(const data::TensorView &src, core::PixelFormat src_format,
+                                    data::TensorView *dst, core::PixelFormat dst_format,
+                                    const DemosaicParams &params)
+        {
+            Cfa cfa;
+            int shift = 0;
+            std::int64_t factor = 0;
+            core::Status s = CheckMosaic(src, src_format, dst, dst_format, params, true, "DemosaicBinned",
+                                         &cfa, &shift, &factor);
+            if (!s.ok())
+            {
+                return s;
+            }
+
+            const std::int64_t W = src.shape().dim(1);
+            const std::int64_t OH = dst->shape().dim(0);
+            const std::int64_t OW = dst->shape().dim(1);
+            const bool bgr = dst_format == core::PixelFormat::kBgr8;
+
+            std::function<void(std::int64_t, std::int64_t)> fn;
+            DispatchMosaic(src, dst, [&](auto in, auto out)
+                           {
+                               if (factor == 2)
+                               {
+                                   fn = [=, &cfa](std::int64_t y0, std::int64_t y1)
+                                   { BinRows2(in, W, cfa, bgr, shift, out, y0, y1); };
+                               }
+                               else
+                               {
+                                   fn = [=, &cfa](std::int64_t y0, std::int64_t y1)
+                                   { BinRows(in, W, factor, cfa, bgr, shift, out, y0, y1); };
+                               }
+                           });
+
+            const std::int64_t min_rows = OW >= kMinParallelElements ? 1 : kMinParallelElements / OW;
+            core::ThreadPool::Default().ParallelFor(0, OH, min_rows, fn);
+
+            return core::Status::Ok();
+        }
+} // namespace ptk::operators
@@ -0,0 +1,171 @@
+#include "operators/dequantize.h"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "operators/kernel_dispatch.h"
+#include "operators/simd.h"
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+#if defined(PTK_SIMD_NEON)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace ptk::operators
+{
+        namespace
+        {
+            // Dequantizes n elements with per-lane scale and zero point over a
+            // repeating period that is a multiple of 4 (see QuantizeRun).
+            template <typename Q, int N>
+            void DequantizeRun(const Q *q, std::int64_t n, const float *scale, const std::int32_t *zero_point,
+                               std::int64_t runtime_channels, float *out)
+            {
+                const std::int64_t period = 4 * ChannelCount<N>(runtime_channels);
+                std::int64_t i = 0;
+                for (; i + period <= n; i += period)
+                {
+                    std::int64_t j = 0;
+#if defined(PTK_SIMD_NEON)
+                    for (; j < period; j += 4)
+                    {
+                        std::uint32_t bits;
+                        std::memcpy(&bits, q + i + j, sizeof(bits));
+                        const uint8x8_t raw = vreinterpret_u8_u32(vdup_n_u32(bits));
+                        const int16x8_t wide = std::is_signed<Q>::value
+                                                   ? vmovl_s8(vreinterpret_s8_u8(raw))
+                                                   : vreinterpretq_s16_u16(vmovl_u8(raw));
+                        const int32x4_t v = vsubq_s32(vmovl_s16(vget_low_s16(wide)), vld1q_s32(zero_point + j));
+                        vst1q_f32(out + i + j, vmulq_f32(vcvtq_f32_s32(v), vld1q_f32(scale + j)));
+                    }
+#elif defined(PTK_SIMD_SSE2)
+                    for (; j < period; j += 4)
+                    {
+                        std::int32_t bits;
+                        std::memcpy(&bits, q + i + j, sizeof(bits));
+                        const __m128i raw = _mm_cvtsi32_si128(bits);
+                        __m128i v;
+                        if (std::is_signed<Q>::value)
+                        {
+                            // Sign extend by placing each byte in the top of a
+                            // wider lane and shifting back arithmetically.
+                            const __m128i w16 = _mm_srai_epi16(_mm_unpacklo_epi8(raw, raw), 8);
+                            v = _mm_srai_epi32(_mm_unpacklo_epi16(w16, w16), 16);
+                        }
+                        else
+                        {
+                            const __m128i zero = _mm_setzero_si128();
+                            v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(raw, zero), zero);
+                        }
+                        v = _mm_sub_epi32(v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(zero_point + j)));
+                        _mm_storeu_ps(out + i + j, _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_loadu_ps(scale + j)));
+                    }
+#endif
+                    for (; j < period; ++j)
+                    {
+                        out[i + j] = static_cast<float>(static_cast<std::int32_t>(q[i + j]) - zero_point[j]) * scale[j];
+                    }
+                }
+                for (std::int64_t j = 0; i < n; ++i, ++j)
+                {
+                    out[i] = static_cast<float>(static_cast<std::int32_t>(q[i]) - zero_point[j]) * scale[j];
+                }
+            }
+
+            template <typename Q>
+            void DequantizeImpl(const Q *in, float *out, std::int64_t outer, std::int64_t channels,
+                                std::int64_t inner, const QuantizationParams &params)
+            {
+                const bool per_tensor = params.scales.size() == 1;
+
+                if (inner == 1)
+                {
+                    const std::int64_t period = 4 * channels;
+                    std::vector<float> scale(static_cast<std::size_t>(period));
+                    std::vector<std::int32_t> zero_point(static_cast<std::size_t>(period));
+                    for (std::int64_t j = 0; j < period; ++j)
+                    {
+                        const std::size_t c = per_tensor ? 0 : static_cast<std::size_t>(j % channels);
+                        scale[j] = params.scales[c];
+                        zero_point[j] = params.zero_points[c];
+                    }
+                    DispatchChannels(channels, [&](auto pattern) {
+                        DequantizeRun<Q, decltype(pattern)::value>(in, outer * channels, scale.data(), zero_point.data(),
+                                                                   channels, out);
+                    });
+                    return;
+                }
+
+                for (std::int64_t o = 0; o < outer; ++o)
+                {
+                    for (std::int64_t c = 0; c < channels; ++c)
+                    {
+                        const float s = params.scales[static_cast<std::size_t>(c)];
+                        const std::int32_t z = params.zero_points[static_cast<std::size_t>(c)];
+                        const float scale[4] = {s, s, s, s};
+                        const std::int32_t zero_point[4] = {z, z, z, z};
+                        const std::int64_t offset = (o * channels + c) * inner;
+                        DequantizeRun<Q, 1>(in + offset, inner, scale, zero_point, 1, out + offset);
+                    }
+                }
+            }
+        } // namespace
+
+        core::Status Dequantize(const data::TensorView &src, const QuantizationParams &params, data::TensorView *dst)
+        {
+            if (dst == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Dequantize: dst is null");
+            }
+            if ((src.dtype() != core::DataType::kInt8 && src.dtype() != core::DataType::kUint8) ||
+                dst->dtype() != core::DataType::kFloat32)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Dequantize: expects int8 or uint8 src and float32 dst");
+            }
+            if (src.shape().dims() != dst->shape().dims())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Dequantize: shape mismatch");
+            }
+            if (!src.is_contiguous() || !dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Dequantize: expects contiguous tensors");
+            }
+
+            std::int64_t outer = 0;
+            std::int64_t channels = 0;
+            std::int64_t inner = 0;
+            core::Status s = ResolveQuantizationAxis(src.shape(), params, &outer, &channels, &inner);
+            if (!s.ok())
+            {
+                return s;
+            }
+
+            const void *in = src.buffer().data();
+            float *out = static_cast<float *>(dst->buffer().data());
+            if (in == nullptr || out == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Dequantize: null buffer data");
+            }
+
+            if (src.dtype() == core::DataType::kInt8)
+            {
+                DequantizeImpl(static_cast<const std::int8_t *>(in), out, outer, channels, inner, params);
+            }
+            else
+            {
+                DequantizeImpl(static_cast<const std::uint8_t *>(in), out, outer, channels, inner, params);
+            }
+            return core::Status::Ok();
+        }
+} // namespace ptk::operators
@@ -0,0 +1,546 @@
+#include "operators/elementwise_chain.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "operators/cast_float32_to_bfloat16.h"
+#include "operators/cast_float32_to_float16.h"
+#include "operators/kernel_dispatch.h"
+#include "runtime/core/status.h"
+#include "runtime/core/thread_pool.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+namespace ptk::operators
+{
+        namespace
+        {
+            // Below this many elements a frame runs on the calling thread.
+            constexpr std::int64_t kMinParallelElements = 1 << 15;
+
+            // Pixels per tile. Four float planes of this width plus the packed
+            // output staging come to about 128 KiB, which stays resident in L2.
+            constexpr std::int64_t kTilePixels = 4096;
+
+            // Converts n floats into dst of the given type.
+            void StoreRun(const float *src, std::int64_t n, core::DataType dtype, void *dst)
+            {
+                switch (dtype)
+                {
+                case core::DataType::kFloat32:
+                    std::memcpy(dst, src, static_cast<std::size_t>(n) * sizeof(float));
+                    break;
+                case core::DataType::kFloat16:
+                case core::DataType::kBFloat16:
+                {
+                    const data::TensorShape shape(std::vector<std::int64_t>{n});
+                    const data::TensorView in(
+                        data::BufferView(const_cast<float *>(src), static_cast<std::size_t>(n) * sizeof(float),
+                                         core::DeviceType::kCpu),
+                        core::DataType::kFloat32, shape);
+                    data::TensorView out(
+                        data::BufferView(dst, static_cast<std::size_t>(n) * sizeof(std::uint16_t),
+                                         core::DeviceType::kCpu),
+                        dtype, shape);
+                    if (dtype == core::DataType::kFloat16)
+                    {
+                        CastFloat32ToFloat16(in, &out);
+                    }
+                    else
+                    {
+                        CastFloat32ToBFloat16(in, &out);
+                    }
+                    break;
+                }
+                default:
+                {
+                    std::uint8_t *out = static_cast<std::uint8_t *>(dst);
+                    for (std::int64_t i = 0; i < n; ++i)
+                    {
+                        out[i] = static_cast<std::uint8_t>(std::nearbyint(std::min(std::max(src[i], 0.0f), 255.0f)));
+                    }
+                    break;
+                }
+                }
+            }
+
+            template <int N>
+            void InterleaveTile(float *const *planes, std::int64_t n, std::int64_t runtime_channels, float *dst)
+            {
+                const std::int64_t C = ChannelCount<N>(runtime_channels);
+                for (std::int64_t i = 0; i < n; ++i)
+                {
+                    for (std::int64_t c = 0; c < C; ++c)
+                    {
+                        dst[i * C + c] = planes[c][i];
+                    }
+                }
+            }
+        } // namespace
+
+        ElementwiseChain::ElementwiseChain()
+            : ops_(),
+              out_dtype_(core::DataType::kFloat32),
+              out_layout_(core::TensorLayout::kHwc),
+              error_(),
+              compiled_(false),
+              exact_channels_(0),
+              min_channels_(1),
+              channel_map_(),
+              stages_(),
+              lut_()
+        {
+        }
+
+        ElementwiseChain &ElementwiseChain::Cast(core::DataType dtype)
+        {
+            if (dtype != core::DataType::kFloat32 && dtype != core::DataType::kFloat16 &&
+                dtype != core::DataType::kBFloat16 && dtype != core::DataType::kUint8)
+            {
+                if (error_.empty())
+                {
+                    error_ = "ElementwiseChain: Cast supports float32, float16, bfloat16 and uint8";
+                }
+                return *this;
+            }
+            out_dtype_ = dtype;
+            compiled_ = false;
+            return *this;
+        }
+
+        ElementwiseChain &ElementwiseChain::SwapRB()
+        {
+            Op op{};
+            op.kind = OpKind::kPermute;
+            op.channels = 0;
+            op.order[0] = 2;
+            op.order[1] = 1;
+            op.order[2] = 0;
+            op.order[3] = 3;
+            ops_.push_back(op);
+            compiled_ = false;
+            return *this;
+        }
+
+        ElementwiseChain &ElementwiseChain::PermuteChannels(const std::vector<int> &order)
+        {
+            const int n = static_cast<int>(order.size());
+            bool ok = n >= 1 && n <= kMaxChannels;
+            for (int c = 0; ok && c < n; ++c)
+            {
+                ok = order[c] >= 0 && order[c] < n;
+            }
+            if (!ok)
+            {
+                if (error_.empty())
+                {
+                    error_ = "ElementwiseChain: PermuteChannels order must index [0, size) with size in [1,4]";
+                }
+                return *this;
+            }
+            Op op{};
+            op.kind = OpKind::kPermute;
+            op.channels = n;
+            for (int c = 0; c < kMaxChannels; ++c)
+            {
+                op.order[c] = c < n ? order[c] : c;
+            }
+            ops_.push_back(op);
+            compiled_ = false;
+            return *this;
+        }
+
+        ElementwiseChain &ElementwiseChain::Normalize(const NormalizationParams &params)
+        {
+            bool ok = params.num_channels >= 1 && params.num_channels <= kMaxChannels;
+            for (int c = 0; ok && c < params.num_channels; ++c)
+            {
+                ok = params.std[c] != 0.0f;
+            }
+            if (!ok)
+            {
+                if (error_.empty())
+                {
+                    error_ = "ElementwiseChain: Normalize needs 1 to 4 channels with non-zero std";
+                }
+                return *this;
+            }
+            Op op{};
+            op.kind = OpKind::kAffine;
+            op.channels = params.num_channels;
+            for (int c = 0; c < kMaxChannels; ++c)
+            {
+                op.scale[c] = c < params.num_channels ? 1.0f / params.std[c] : 1.0f;
+                op.bias[c] = c < params.num_channels ? -params.mean[c] / params.std[c] : 0.0f;
+            }
+            ops_.push_back(op);
+            compiled_ = false;
+            return *this;
+        }
+
+        ElementwiseChain &ElementwiseChain::Affine(float scale, float bias)
+        {
+            Op op{};
+            op.kind = OpKind::kAffine;
+            op.channels = 0;
+            for (int c = 0; c < kMaxChannels; ++c)
+            {
+                op.scale[c] = scale;
+                op.bias[c] = bias;
+            }
+            ops_.push_back(op);
+            compiled_ = false;
+            return *this;
+        }
+
+        ElementwiseChain &ElementwiseChain::Clamp(float lo, float hi)
+        {
+            if (!(lo <= hi))
+            {
+                if (error_.empty())
+                {
+                    error_ = "ElementwiseChain: Clamp needs lo <= hi";
+                }
+                return *this;
+            }
+            Op op{};
+            op.kind = OpKind::kClamp;
+            op.channels = 0;
+            op.lo = lo;
+            op.hi = hi;
+            ops_.push_back(op);
+            compiled_ = false;
+            return *this;
+        }
+
+        ElementwiseChain &ElementwiseChain::ToLayout(core::TensorLayout layout)
+        {
+            if (layout != core::TensorLayout::kHwc && layout != core::TensorLayout::kChw)
+            {
+                if (error_.empty())
+                {
+                    error_ = "ElementwiseChain: ToLayout supports HWC and CHW";
+                }
+                return *this;
+            }
+            out_layout_ = layout;
+            compiled_ = false;
+            return *this;
+        }
+
+        core::Status ElementwiseChain::Compile()
+        {
+            compiled_ = false;
+            if (!error_.empty())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, error_);
+            }
+
+            exact_channels_ = 0;
+            min_channels_ = 1;
+            for (int c = 0; c < kMaxChannels; ++c)
+            {
+                channel_map_[c] = c;
+            }
+            stages_.clear();
+
+            auto identity = []()
+            {
+                Stage stage;
+                for (int c = 0; c < kMaxChannels; ++c)
+                {
+                    stage.scale[c] = 1.0f;
+                    stage.bias[c] = 0.0f;
+                }
+                stage.clamp = false;
+                stage.lo = 0.0f;
+                stage.hi = 0.0f;
+                return stage;
+            };
+
+            for (const Op &op : ops_)
+            {
+                if (op.channels > 0)
+                {
+                    if (exact_channels_ != 0 && exact_channels_ != op.channels)
+                    {
+                        return core::Status(core::StatusCode::kInvalidArgument,
+                                      "ElementwiseChain: ops disagree on the channel count");
+                    }
+                    exact_channels_ = op.channels;
+                }
+
+                switch (op.kind)
+                {
+                case OpKind::kPermute:
+                {
+                    // A move re-indexes everything recorded before it, so it
+                    // costs nothing at run time.
+                    if (op.channels == 0)
+                    {
+                        min_channels_ = std::max(min_channels_, 3);
+                    }
+                    int map[kMaxChannels];
+                    for (int c = 0; c < kMaxChannels; ++c)
+                    {
+                        map[c] = channel_map_[op.order[c]];
+                    }
+                    std::copy(map, map + kMaxChannels, channel_map_);
+                    for (Stage &stage : stages_)
+                    {
+                        Stage moved = stage;
+                        for (int c = 0; c < kMaxChannels; ++c)
+                        {
+                            moved.scale[c] = stage.scale[op.order[c]];
+                            moved.bias[c] = stage.bias[op.order[c]];
+                        }
+                        stage = moved;
+                    }
+                    break;
+                }
+                case OpKind::kAffine:
+                {
+                    if (stages_.empty() || stages_.back().clamp)
+                    {
+                        stages_.push_back(identity());
+                    }
+                    Stage &stage = stages_.back();
+                    for (int c = 0; c < kMaxChannels; ++c)
+                    {
+                        stage.scale[c] *= op.scale[c];
+                        stage.bias[c] = stage.bias[c] * op.scale[c] + op.bias[c];
+                    }
+                    break;
+                }
+                case OpKind::kClamp:
+                {
+                    if (stages_.empty() || stages_.back().clamp)
+                    {
+                        stages_.push_back(identity());
+                    }
+                    Stage &stage = stages_.back();
+                    stage.clamp = true;
+                    stage.lo = op.lo;
+                    stage.hi = op.hi;
+                    break;
+                }
+                }
+            }
+
+            if (exact_channels_ != 0 && exact_channels_ < min_channels_)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ElementwiseChain: SwapRB needs at least 3 channels");
+            }
+
+            for (int c = 0; c < kMaxChannels; ++c)
+            {
+                for (int v = 0; v < 256; ++v)
+                {
+                    float x = static_cast<float>(v);
+                    for (const Stage &stage : stages_)
+                    {
+                        x = x * stage.scale[c] + stage.bias[c];
+                        if (stage.clamp)
+                        {
+                            x = std::min(std::max(x, stage.lo), stage.hi);
+                        }
+                    }
+                    lut_[c][v] = x;
+                }
+            }
+
+            compiled_ = true;
+            return core::Status::Ok();
+        }
+
+        core::Status ElementwiseChain::Run(const data::TensorView &src, data::TensorView *dst) const
+        {
+            if (dst == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ElementwiseChain: dst is null");
+            }
+            if (!compiled_)
+            {
+                return core::Status(core::StatusCode::kFailedPrecondition,
+                              "ElementwiseChain: Compile must be called first");
+            }
+            if (src.dtype() != core::DataType::kUint8 && src.dtype() != core::DataType::kFloat32)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ElementwiseChain: expects uint8 or float32 src");
+            }
+            if (dst->dtype() != out_dtype_)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ElementwiseChain: dst dtype differs from Cast");
+            }
+
+            const data::TensorShape &sshape = src.shape();
+            if (sshape.rank() != 3)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ElementwiseChain: expects rank 3 HWC src");
+            }
+            const std::int64_t H = sshape.dim(0);
+            const std::int64_t W = sshape.dim(1);
+            const std::int64_t C = sshape.dim(2);
+            if (C < min_channels_ || C > kMaxChannels || (exact_channels_ != 0 && C != exact_channels_))
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ElementwiseChain: src channel count does not fit the chain");
+            }
+            if (src.stride(2) != 1 || src.stride(1) != C)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ElementwiseChain: src rows must be packed");
+            }
+
+            const bool chw = out_layout_ == core::TensorLayout::kChw;
+            std::vector<std::int64_t> expected = chw ? std::vector<std::int64_t>{C, H, W}
+                                                     : std::vector<std::int64_t>{H, W, C};
+            std::vector<std::int64_t> dims = dst->shape().dims();
+            if (dims.size() == 4 && dims[0] == 1)
+            {
+                dims.erase(dims.begin());
+            }
+            if (dims != expected)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              chw ? "ElementwiseChain: dst shape must be [C,H,W]"
+                                  : "ElementwiseChain: dst shape must be [H,W,C]");
+            }
+            if (!dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ElementwiseChain: dst must be contiguous");
+            }
+
+            const void *in = src.buffer().data();
+            std::uint8_t *out = static_cast<std::uint8_t *>(dst->buffer().data());
+            if (in == nullptr || out == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ElementwiseChain: null buffer data");
+            }
+            if (H == 0 || W == 0)
+            {
+                return core::Status::Ok();
+            }
+
+            const std::int64_t out_elem = static_cast<std::int64_t>(dst->element_size());
+            const std::int64_t src_row_stride = src.stride(0);
+            // float32 CHW output is produced in place in dst's planes.
+            const bool direct = chw && out_dtype_ == core::DataType::kFloat32;
+
+            DispatchDType<std::uint8_t, float>(src.dtype(), [&](auto type) {
+                using T = typename decltype(type)::type;
+                DispatchChannels(C, [&](auto channels) {
+                    constexpr int N = decltype(channels)::value;
+                    const std::int64_t row_len = W * C;
+                    const std::int64_t min_rows =
+                        row_len >= kMinParallelElements ? 1 : kMinParallelElements / row_len;
+
+                    core::ThreadPool::Default().ParallelFor(0, H, min_rows, [&](std::int64_t h0, std::int64_t h1) {
+                        const std::int64_t tile = std::min(W, kTilePixels);
+                        // Per thread and only grown, so steady-state runs do
+                        // not allocate.
+                        thread_local std::vector<float> scratch;
+                        const std::size_t scratch_size =
+                            static_cast<std::size_t>((direct ? 0 : C) * tile + (chw ? 0 : C * tile));
+                        if (scratch.size() < scratch_size)
+                        {
+                            scratch.resize(scratch_size);
+                        }
+                        float *packed = scratch.data() + (direct ? 0 : C * tile);
+
+                        for (std::int64_t h = h0; h < h1; ++h)
+                        {
+                            const T *src_row = static_cast<const T *>(in) + h * src_row_stride;
+                            for (std::int64_t x0 = 0; x0 < W; x0 += tile)
+                            {
+                                const std::int64_t n = std::min(tile, W - x0);
+                                const T *src_px = src_row + x0 * C;
+
+                                float *planes[kMaxChannels];
+                                for (std::int64_t c = 0; c < C; ++c)
+                                {
+                                    planes[c] = direct ? reinterpret_cast<float *>(out) + (c * H + h) * W + x0
+                                                       : scratch.data() + c * tile;
+                                }
+
+                                // Gather each output channel from its mapped source channel.
+                                for (std::int64_t c = 0; c < ChannelCount<N>(C); ++c)
+                                {
+                                    const T *s = src_px + channel_map_[c];
+                                    float *p = planes[c];
+                                    if constexpr (std::is_same<T, std::uint8_t>::value)
+                                    {
+                                        const float *lut = lut_[c];
+                                        for (std::int64_t i = 0; i < n; ++i)
+                                        {
+                                            p[i] = lut[s[i * ChannelCount<N>(C)]];
+                                        }
+                                    }
+                                    else
+                                    {
+                                        for (std::int64_t i = 0; i < n; ++i)
+                                        {
+                                            p[i] = s[i * ChannelCount<N>(C)];
+                                        }
+                                        for (const Stage &stage : stages_)
+                                        {
+                                            const float k = stage.scale[c];
+                                            const float b = stage.bias[c];
+                                            for (std::int64_t i = 0; i < n; ++i)
+                                            {
+                                                p[i] = p[i] * k + b;
+                                            }
+                                            if (stage.clamp)
+                                            {
+                                                const float lo = stage.lo;
+                                                const float hi = stage.hi;
+                                                for (std::int64_t i = 0; i < n; ++i)
+                                                {
+                                                    p[i] = std::min(std::max(p[i], lo), hi);
+                                                }
+                                            }
+                                        }
+                                    }
+                                }
+
+                                if (direct)
+                                {
+                                    continue;
+                                }
+                                if (chw)
+                                {
+                                    for (std::int64_t c = 0; c < C; ++c)
+                                    {
+                                        StoreRun(planes[c], n, out_dtype_, out + ((c * H + h) * W + x0) * out_elem);
+                                    }
+                                }
+                                else if (out_dtype_ == core::DataType::kFloat32)
+                                {
+                                    InterleaveTile<N>(planes, n, C,
+                                                      reinterpret_cast<float *>(out) + (h * W + x0) * C);
+                                }
+                                else
+                                {
+                                    InterleaveTile<N>(planes, n, C, packed);
+                                    StoreRun(packed, n * C, out_dtype_, out + (h * W + x0) * C * out_elem);
+                                }
+                            }
+                        }
+                    });
+                });
+            });
+
+            return core::Status::Ok();
+        }
+} // namespace ptk::operators
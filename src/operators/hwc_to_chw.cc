@@ -1,11 +1,167 @@
 #include "operators/hwc_to_chw.h"
+#include "operators/interleave.h"
+#include "operators/kernel_dispatch.h"
+#include "operators/simd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 
 #include "runtime/core/status.h"
 #include "runtime/core/types.h"
 #include "runtime/data/tensor.h"
 
+#if defined(PTK_SIMD_NEON)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSE2)
+#include <emmintrin.h>
+#if defined(PTK_SIMD_SSSE3)
+#include <tmmintrin.h>
+#endif
+#endif
+
 namespace ptk::operators
 {
+        namespace
+        {
+            using detail::Deinterleave3;
+            using detail::Deinterleave4;
+
+            // Pixels per tile in the generic path, sized so one tile of the
+            // source row and its C destination runs stay in L1.
+            constexpr std::int64_t kTileWidth = 256;
+
+            void Deinterleave3(const float *src, float *d0, float *d1, float *d2, std::int64_t W)
+            {
+                std::int64_t w = 0;
+#if defined(PTK_SIMD_NEON)
+                for (; w + 4 <= W; w += 4)
+                {
+                    const float32x4x3_t px = vld3q_f32(src + w * 3);
+                    vst1q_f32(d0 + w, px.val[0]);
+                    vst1q_f32(d1 + w, px.val[1]);
+                    vst1q_f32(d2 + w, px.val[2]);
+                }
+#elif defined(PTK_SIMD_SSE2)
+                for (; w + 4 <= W; w += 4)
+                {
+                    // a = r0 g0 b0 r1, b = g1 b1 r2 g2, c = b2 r3 g3 b3
+                    const float *p = src + w * 3;
+                    const __m128 a = _mm_loadu_ps(p);
+                    const __m128 b = _mm_loadu_ps(p + 4);
+                    const __m128 c = _mm_loadu_ps(p + 8);
+                    const __m128 r = _mm_shuffle_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 0, 0)),
+                                                    _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)),
+                                                    _MM_SHUFFLE(2, 0, 2, 0));
+                    const __m128 g = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                                                    _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+                                                    _MM_SHUFFLE(2, 0, 2, 0));
+                    const __m128 bl = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                                                     _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)),
+                                                     _MM_SHUFFLE(2, 0, 2, 0));
+                    _mm_storeu_ps(d0 + w, r);
+                    _mm_storeu_ps(d1 + w, g);
+                    _mm_storeu_ps(d2 + w, bl);
+                }
+#endif
+                for (; w < W; ++w)
+                {
+                    d0[w] = src[w * 3 + 0];
+                    d1[w] = src[w * 3 + 1];
+                    d2[w] = src[w * 3 + 2];
+                }
+            }
+
+            void Deinterleave4(const float *src, float *d0, float *d1, float *d2, float *d3, std::int64_t W)
+            {
+                std::int64_t w = 0;
+#if defined(PTK_SIMD_NEON)
+                for (; w + 4 <= W; w += 4)
+                {
+                    const float32x4x4_t px = vld4q_f32(src + w * 4);
+                    vst1q_f32(d0 + w, px.val[0]);
+                    vst1q_f32(d1 + w, px.val[1]);
+                    vst1q_f32(d2 + w, px.val[2]);
+                    vst1q_f32(d3 + w, px.val[3]);
+                }
+#elif defined(PTK_SIMD_SSE2)
+                for (; w + 4 <= W; w += 4)
+                {
+                    const float *p = src + w * 4;
+                    __m128 a = _mm_loadu_ps(p);
+                    __m128 b = _mm_loadu_ps(p + 4);
+                    __m128 c = _mm_loadu_ps(p + 8);
+                    __m128 d = _mm_loadu_ps(p + 12);
+                    _MM_TRANSPOSE4_PS(a, b, c, d);
+                    _mm_storeu_ps(d0 + w, a);
+                    _mm_storeu_ps(d1 + w, b);
+                    _mm_storeu_ps(d2 + w, c);
+                    _mm_storeu_ps(d3 + w, d);
+                }
+#endif
+                for (; w < W; ++w)
+                {
+                    d0[w] = src[w * 4 + 0];
+                    d1[w] = src[w * 4 + 1];
+                    d2[w] = src[w * 4 + 2];
+                    d3[w] = src[w * 4 + 3];
+                }
+            }
+
+            // Each source row is read once and split into C sequential plane
+            // writes, instead of re-walking the whole image per channel. N is the
+            // channel count when known at compile time (see kernel_dispatch.h).
+            template <typename T, int N>
+            void HwcToChwImpl(const T *src, T *dst, std::int64_t H, std::int64_t W, std::int64_t runtime_channels)
+            {
+                const std::int64_t C = ChannelCount<N>(runtime_channels);
+                const std::int64_t plane = H * W;
+                if constexpr (N == 1)
+                {
+                    std::memcpy(dst, src, static_cast<std::size_t>(plane) * sizeof(T));
+                    return;
+                }
+
+                T *planes[4];
+                for (std::int64_t h = 0; h < H; ++h)
+                {
+                    const T *src_row = src + h * W * C;
+                    if constexpr (N == 3)
+                    {
+                        Deinterleave3(src_row, dst + h * W, dst + plane + h * W, dst + 2 * plane + h * W, W);
+                    }
+                    else if constexpr (N == 4)
+                    {
+                        Deinterleave4(src_row, dst + h * W, dst + plane + h * W, dst + 2 * plane + h * W,
+                                      dst + 3 * plane + h * W, W);
+                    }
+                    else
+                    {
+                        for (std::int64_t c0 = 0; c0 < C; c0 += 4)
+                        {
+                            const std::int64_t n = std::min<std::int64_t>(4, C - c0);
+                            for (std::int64_t c = 0; c < n; ++c)
+                            {
+                                planes[c] = dst + (c0 + c) * plane + h * W;
+                            }
+                            // Walk channels in groups of 4 so the plane pointers stay in registers.
+                            for (std::int64_t w0 = 0; w0 < W; w0 += kTileWidth)
+                            {
+                                const std::int64_t w1 = std::min(W, w0 + kTileWidth);
+                                for (std::int64_t c = 0; c < n; ++c)
+                                {
+                                    for (std::int64_t w = w0; w < w1; ++w)
+                                    {
+                                        planes[c][w] = src_row[w * C + c0 + c];
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        } // namespace
+
         core::Status HwcToChw(const data::TensorView &src, data::TensorView *dst)
         {
             if (dst == nullptr)
@@ -13,11 +169,17 @@ namespace ptk::operators
                 return core::Status(core::StatusCode::kInvalidArgument,
                               "HwcToChw: dst is null");
             }
-            if (src.dtype() != core::DataType::kFloat32 ||
-                dst->dtype() != core::DataType::kFloat32)
+            if (src.dtype() != dst->dtype() ||
+                (src.dtype() != core::DataType::kFloat32 &&
+                 src.dtype() != core::DataType::kUint8))
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "HwcToChw: expects matching uint8 or float32 src and dst");
+            }
+            if (!src.is_contiguous() || !dst->is_contiguous())
             {
                 return core::Status(core::StatusCode::kInvalidArgument,
-                              "HwcToChw: expects float32 src and dst");
+                              "HwcToChw: expects contiguous tensors");
             }
 
             const data::TensorShape &sshape = src.shape();
@@ -41,10 +203,8 @@ namespace ptk::operators
                               "HwcToChw: dst shape must be [C,H,W]");
             }
 
-            const float *src_data =
-                static_cast<const float *>(src.buffer().data());
-            float *dst_data =
-                static_cast<float *>(dst->buffer().data());
+            const void *src_data = src.buffer().data();
+            void *dst_data = dst->buffer().data();
 
             if (src_data == nullptr || dst_data == nullptr)
             {
@@ -52,25 +212,14 @@ namespace ptk::operators
                               "HwcToChw: null buffer data");
             }
 
-            // HWC to CHW
-            // src: (h, w, c) -> (h * W + w) * C + c
-            // dst: (c, h, w) -> (c * H + h) * W + w
-            for (std::int64_t c = 0; c < C; ++c)
-            {
-                for (std::int64_t h = 0; h < H; ++h)
-                {
-                    for (std::int64_t w = 0; w < W; ++w)
-                    {
-                        const std::size_t src_idx =
-                            static_cast<std::size_t>((h * W + w) * C + c);
-                        const std::size_t dst_idx =
-                            static_cast<std::size_t>((c * H + h) * W + w);
-                        dst_data[dst_idx] = src_data[src_idx];
-                    }
-                }
-            }
+            DispatchDType<std::uint8_t, float>(src.dtype(), [&](auto type) {
+                using T = typename decltype(type)::type;
+                DispatchChannels(C, [&](auto channels) {
+                    HwcToChwImpl<T, decltype(channels)::value>(static_cast<const T *>(src_data),
+                                                               static_cast<T *>(dst_data), H, W, C);
+                });
+            });
 
             return core::Status::Ok();
         }
 } // namespace ptk::operators
-
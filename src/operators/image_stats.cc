@@ -0,0 +1,721 @@
+#include "operators/image_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "operators/interleave.h"
+#include "operators/simd.h"
+#include "runtime/core/status.h"
+#include "runtime/core/thread_pool.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+#if defined(PTK_SIMD_NEON64)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace ptk::operators
+{
+        namespace
+        {
+            // Below this many sampled elements an image is reduced on the calling thread.
+            constexpr std::int64_t kMinParallelElements = 1 << 15;
+
+            // Contiguous rows are reduced kTileWidth pixels at a time: uint8
+            // planes of one tile stay in L1, and the 32-bit square sums and
+            // float lane sums cannot overflow or drift within a tile.
+            constexpr std::int64_t kTileWidth = 256;
+
+            constexpr int kMaxChannels = 4;
+
+            // Histogram rows rotate over this many copies of the counts, so a
+            // run of equal pixels does not serialize on one counter.
+            constexpr int kHistogramCopies = 4;
+
+            constexpr int kMaxBins = 1 << 16;
+
+            // The sampled pixels of the ROI: rows x cols pixels of `channels`
+            // elements, sampled row i starting at base + i * row_bytes and
+            // sampled pixel j at element j * pixel_step of that row.
+            struct Region
+            {
+                const std::uint8_t *base;
+                std::int64_t row_bytes;
+                std::int64_t rows;
+                std::int64_t cols;
+                std::int64_t channels;
+                std::int64_t step;
+                std::int64_t pixel_step;
+            };
+
+            core::Status CheckImage(const data::TensorView &src, const StatsOptions &options, const std::string &name,
+                                    Region *region)
+            {
+                if (src.shape().rank() != 3)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects rank 3 HWC tensor");
+                }
+                if (src.dtype() != core::DataType::kUint8 && src.dtype() != core::DataType::kFloat32)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects uint8 or float32 input");
+                }
+                if (src.buffer().data() == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": null buffer data");
+                }
+                const std::int64_t H = src.shape().dim(0);
+                const std::int64_t W = src.shape().dim(1);
+                const std::int64_t C = src.shape().dim(2);
+                if (H <= 0 || W <= 0)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": empty image");
+                }
+                if (C < 1 || C > kMaxChannels)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects 1 to 4 channels");
+                }
+                if (src.stride(2) != 1 || src.stride(1) != C)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": rows must be packed");
+                }
+                if (options.sample_stride < 1)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": sample_stride must be positive");
+                }
+
+                const ImageRoi &roi = options.roi;
+                const bool full = roi.width == 0 || roi.height == 0;
+                const std::int64_t x0 = full ? 0 : roi.x;
+                const std::int64_t y0 = full ? 0 : roi.y;
+                const std::int64_t w = full ? W : roi.width;
+                const std::int64_t h = full ? H : roi.height;
+                if (x0 < 0 || y0 < 0 || w < 0 || h < 0 || x0 + w > W || y0 + h > H)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": roi outside the image");
+                }
+
+                const std::int64_t elem = static_cast<std::int64_t>(src.element_size());
+                const std::int64_t step = options.sample_stride;
+                region->base = static_cast<const std::uint8_t *>(src.buffer().data()) +
+                               (y0 * src.stride(0) + x0 * C) * elem;
+                region->row_bytes = src.stride(0) * step * elem;
+                region->rows = (h + step - 1) / step;
+                region->cols = (w + step - 1) / step;
+                region->channels = C;
+                region->step = step;
+                region->pixel_step = C * step;
+                return core::Status::Ok();
+            }
+
+            std::int64_t MinRows(const Region &r)
+            {
+                const std::int64_t elems = r.cols * r.channels;
+                return elems >= kMinParallelElements ? 1 : kMinParallelElements / elems;
+            }
+
+            template <typename T>
+            const T *RowAt(const Region &r, std::int64_t i)
+            {
+                return reinterpret_cast<const T *>(r.base + i * r.row_bytes);
+            }
+
+            struct U8Acc
+            {
+                std::uint64_t sum = 0;
+                std::uint64_t sum_sq = 0;
+                std::uint8_t min = 255;
+                std::uint8_t max = 0;
+            };
+
+            struct F32Acc
+            {
+                double sum = 0.0;
+                double sum_sq = 0.0;
+                float min = std::numeric_limits<float>::infinity();
+                float max = -std::numeric_limits<float>::infinity();
+            };
+
+            // n <= kTileWidth keeps every 32-bit square lane below 2^23.
+            void ReducePlane(const std::uint8_t *p, std::int64_t n, U8Acc *acc)
+            {
+                std::int64_t i = 0;
+                std::uint64_t sum = 0;
+                std::uint64_t sum_sq = 0;
+                std::uint8_t lo = acc->min;
+                std::uint8_t hi = acc->max;
+#if defined(PTK_SIMD_NEON64)
+                if (n >= 16)
+                {
+                    uint16x8_t vsum = vdupq_n_u16(0);
+                    uint32x4_t vsq = vdupq_n_u32(0);
+                    uint8x16_t vmin = vdupq_n_u8(255);
+                    uint8x16_t vmax = vdupq_n_u8(0);
+                    for (; i + 16 <= n; i += 16)
+                    {
+                        const uint8x16_t v = vld1q_u8(p + i);
+                        vsum = vpadalq_u8(vsum, v);
+                        vsq = vpadalq_u16(vsq, vmull_u8(vget_low_u8(v), vget_low_u8(v)));
+                        vsq = vpadalq_u16(vsq, vmull_u8(vget_high_u8(v), vget_high_u8(v)));
+                        vmin = vminq_u8(vmin, v);
+                        vmax = vmaxq_u8(vmax, v);
+                    }
+                    sum = vaddlvq_u16(vsum);
+                    sum_sq = vaddlvq_u32(vsq);
+                    lo = std::min(lo, vminvq_u8(vmin));
+                    hi = std::max(hi, vmaxvq_u8(vmax));
+                }
+#elif defined(PTK_SIMD_SSE2)
+                if (n >= 16)
+                {
+                    const __m128i zero = _mm_setzero_si128();
+                    __m128i vsum = zero;
+                    __m128i vsq = zero;
+                    __m128i vmin = _mm_set1_epi8(-1);
+                    __m128i vmax = zero;
+                    for (; i + 16 <= n; i += 16)
+                    {
+                        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+                        vsum = _mm_add_epi64(vsum, _mm_sad_epu8(v, zero));
+                        const __m128i v0 = _mm_unpacklo_epi8(v, zero);
+                        const __m128i v1 = _mm_unpackhi_epi8(v, zero);
+                        vsq = _mm_add_epi32(vsq, _mm_add_epi32(_mm_madd_epi16(v0, v0), _mm_madd_epi16(v1, v1)));
+                        vmin = _mm_min_epu8(vmin, v);
+                        vmax = _mm_max_epu8(vmax, v);
+                    }
+                    alignas(16) std::uint64_t s[2];
+                    alignas(16) std::uint32_t q[4];
+                    alignas(16) std::uint8_t mn[16];
+                    alignas(16) std::uint8_t mx[16];
+                    _mm_store_si128(reinterpret_cast<__m128i *>(s), vsum);
+                    _mm_store_si128(reinterpret_cast<__m128i *>(q), vsq);
+                    _mm_store_si128(reinterpret_cast<__m128i *>(mn), vmin);
+                    _mm_store_si128(reinterpret_cast<__m128i *>(mx), vmax);
+                    sum = s[0] + s[1];
+                    sum_sq = static_cast<std::uint64_t>(q[0]) + q[1] + q[2] + q[3];
+                    for (int k = 0; k < 16; ++k)
+                    {
+                        lo = std::min(lo, mn[k]);
+                        hi = std::max(hi, mx[k]);
+                    }
+                }
+#endif
+                for (; i < n; ++i)
+                {
+                    const std::uint32_t v = p[i];
+                    sum += v;
+                    sum_sq += v * v;
+                    lo = std::min(lo, p[i]);
+                    hi = std::max(hi, p[i]);
+                }
+                acc->sum += sum;
+                acc->sum_sq += sum_sq;
+                acc->min = lo;
+                acc->max = hi;
+            }
+
+            void ReduceRow(const std::uint8_t *row, const Region &r, U8Acc *acc)
+            {
+                const std::int64_t C = r.channels;
+                if (r.step != 1)
+                {
+                    for (std::int64_t x = 0; x < r.cols; ++x)
+                    {
+                        const std::uint8_t *px = row + x * r.pixel_step;
+                        for (std::int64_t c = 0; c < C; ++c)
+                        {
+                            const std::uint32_t v = px[c];
+                            acc[c].sum += v;
+                            acc[c].sum_sq += v * v;
+                            acc[c].min = std::min(acc[c].min, px[c]);
+                            acc[c].max = std::max(acc[c].max, px[c]);
+                        }
+                    }
+                    return;
+                }
+
+                // Interleaved channels are split into planes first, so every
+                // SIMD lane of a reduction belongs to one channel.
+                alignas(16) std::uint8_t planes[kMaxChannels][kTileWidth];
+                for (std::int64_t x0 = 0; x0 < r.cols; x0 += kTileWidth)
+                {
+                    const std::int64_t n = std::min(kTileWidth, r.cols - x0);
+                    const std::uint8_t *src = row + x0 * C;
+                    if (C == 1)
+                    {
+                        ReducePlane(src, n, acc);
+                        continue;
+                    }
+                    if (C == 3)
+                    {
+                        detail::Deinterleave3(src, planes[0], planes[1], planes[2], n);
+                    }
+                    else if (C == 4)
+                    {
+                        detail::Deinterleave4(src, planes[0], planes[1], planes[2], planes[3], n);
+                    }
+                    else
+                    {
+                        for (std::int64_t x = 0; x < n; ++x)
+                        {
+                            planes[0][x] = src[x * 2];
+                            planes[1][x] = src[x * 2 + 1];
+                        }
+                    }
+                    for (std::int64_t c = 0; c < C; ++c)
+                    {
+                        ReducePlane(planes[c], n, &acc[c]);
+                    }
+                }
+            }
+
+            void ReduceRow(const float *row, const Region &r, F32Acc *acc)
+            {
+                const std::int64_t C = r.channels;
+                if (r.step != 1)
+                {
+                    for (std::int64_t x = 0; x < r.cols; ++x)
+                    {
+                        const float *px = row + x * r.pixel_step;
+                        for (std::int64_t c = 0; c < C; ++c)
+                        {
+                            const double v = px[c];
+                            acc[c].sum += v;
+                            acc[c].sum_sq += v * v;
+                            acc[c].min = std::min(acc[c].min, px[c]);
+                            acc[c].max = std::max(acc[c].max, px[c]);
+                        }
+                    }
+                    return;
+                }
+
+                // Floats reduce in place: four pixels span C vectors, and lane
+                // l of vector k always holds channel (4 * k + l) % C, so each
+                // accumulator lane stays within one channel.
+                for (std::int64_t x0 = 0; x0 < r.cols; x0 += kTileWidth)
+                {
+                    const std::int64_t n = std::min(kTileWidth, r.cols - x0);
+                    const float *src = row + x0 * C;
+                    std::int64_t x = 0;
+#if defined(PTK_SIMD_NEON64) || defined(PTK_SIMD_SSE2)
+                    if (n >= 4)
+                    {
+                        alignas(16) float sum[kMaxChannels][4];
+                        alignas(16) float sq[kMaxChannels][4];
+                        alignas(16) float mn[kMaxChannels][4];
+                        alignas(16) float mx[kMaxChannels][4];
+#if defined(PTK_SIMD_NEON64)
+                        float32x4_t vsum[kMaxChannels];
+                        float32x4_t vsq[kMaxChannels];
+                        float32x4_t vmin[kMaxChannels];
+                        float32x4_t vmax[kMaxChannels];
+                        for (std::int64_t k = 0; k < C; ++k)
+                        {
+                            vsum[k] = vdupq_n_f32(0.0f);
+                            vsq[k] = vdupq_n_f32(0.0f);
+                            vmin[k] = vdupq_n_f32(std::numeric_limits<float>::infinity());
+                            vmax[k] = vdupq_n_f32(-std::numeric_limits<float>::infinity());
+                        }
+                        for (; x + 4 <= n; x += 4)
+                        {
+                            const float *p = src + x * C;
+                            for (std::int64_t k = 0; k < C; ++k)
+                            {
+                                const float32x4_t v = vld1q_f32(p + 4 * k);
+                                vsum[k] = vaddq_f32(vsum[k], v);
+                                vsq[k] = vmlaq_f32(vsq[k], v, v);
+                                vmin[k] = vminq_f32(vmin[k], v);
+                                vmax[k] = vmaxq_f32(vmax[k], v);
+                            }
+                        }
+                        for (std::int64_t k = 0; k < C; ++k)
+                        {
+                            vst1q_f32(sum[k], vsum[k]);
+                            vst1q_f32(sq[k], vsq[k]);
+                            vst1q_f32(mn[k], vmin[k]);
+                            vst1q_f32(mx[k], vmax[k]);
+                        }
+#else
+                        __m128 vsum[kMaxChannels];
+                        __m128 vsq[kMaxChannels];
+                        __m128 vmin[kMaxChannels];
+                        __m128 vmax[kMaxChannels];
+                        for (std::int64_t k = 0; k < C; ++k)
+                        {
+                            vsum[k] = _mm_setzero_ps();
+                            vsq[k] = _mm_setzero_ps();
+                            vmin[k] = _mm_set1_ps(std::numeric_limits<float>::infinity());
+                            vmax[k] = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+                        }
+                        for (; x + 4 <= n; x += 4)
+                        {
+                            const float *p = src + x * C;
+                            for (std::int64_t k = 0; k < C; ++k)
+                            {
+                                const __m128 v = _mm_loadu_ps(p + 4 * k);
+                                vsum[k] = _mm_add_ps(vsum[k], v);
+                                vsq[k] = _mm_add_ps(vsq[k], _mm_mul_ps(v, v));
+                                vmin[k] = _mm_min_ps(vmin[k], v);
+                                vmax[k] = _mm_max_ps(vmax[k], v);
+                            }
+                        }
+                        for (std::int64_t k = 0; k < C; ++k)
+                        {
+                            _mm_store_ps(sum[k], vsum[k]);
+                            _mm_store_ps(sq[k], vsq[k]);
+                            _mm_store_ps(mn[k], vmin[k]);
+                            _mm_store_ps(mx[k], vmax[k]);
+                        }
+#endif
+                        for (std::int64_t k = 0; k < C; ++k)
+                        {
+                            for (std::int64_t l = 0; l < 4; ++l)
+                            {
+                                F32Acc &a = acc[(4 * k + l) % C];
+                                a.sum += sum[k][l];
+                                a.sum_sq += sq[k][l];
+                                a.min = std::min(a.min, mn[k][l]);
+                                a.max = std::max(a.max, mx[k][l]);
+                            }
+                        }
+                    }
+#endif
+                    for (; x < n; ++x)
+                    {
+                        const float *px = src + x * C;
+                        for (std::int64_t c = 0; c < C; ++c)
+                        {
+                            const double v = px[c];
+                            acc[c].sum += v;
+                            acc[c].sum_sq += v * v;
+                            acc[c].min = std::min(acc[c].min, px[c]);
+                            acc[c].max = std::max(acc[c].max, px[c]);
+                        }
+                    }
+                }
+            }
+
+            ChannelStats ToChannelStats(const U8Acc &acc, std::int64_t count)
+            {
+                ChannelStats s;
+                s.count = count;
+                s.sum = static_cast<double>(acc.sum);
+                s.sum_sq = static_cast<double>(acc.sum_sq);
+                s.min = acc.min;
+                s.max = acc.max;
+                return s;
+            }
+
+            ChannelStats ToChannelStats(const F32Acc &acc, std::int64_t count)
+            {
+                ChannelStats s;
+                s.count = count;
+                s.sum = acc.sum;
+                s.sum_sq = acc.sum_sq;
+                s.min = acc.min;
+                s.max = acc.max;
+                return s;
+            }
+
+            template <typename T, typename Acc>
+            void StatsRows(const Region &r, ImageStats *stats)
+            {
+                std::mutex mu;
+                auto fn = [&](std::int64_t begin, std::int64_t end)
+                {
+                    Acc acc[kMaxChannels];
+                    for (std::int64_t i = begin; i < end; ++i)
+                    {
+                        ReduceRow(RowAt<T>(r, i), r, acc);
+                    }
+                    ImageStats partial;
+                    partial.channels = static_cast<int>(r.channels);
+                    for (std::int64_t c = 0; c < r.channels; ++c)
+                    {
+                        partial.channel[c] = ToChannelStats(acc[c], (end - begin) * r.cols);
+                    }
+                    std::lock_guard<std::mutex> lock(mu);
+                    stats->Merge(partial);
+                };
+                core::ThreadPool::Default().ParallelFor(0, r.rows, MinRows(r), fn);
+            }
+
+            // Maps values to bins: (v - lo) * scale, clamped to [0, bins - 1]
+            // and truncated. NaN lands in bin 0.
+            struct BinMap
+            {
+                float lo;
+                float scale;
+                float top;
+
+                std::int32_t Index(float v) const
+                {
+                    float t = (v - lo) * scale;
+                    t = t > 0.0f ? t : 0.0f;
+                    t = t < top ? t : top;
+                    return static_cast<std::int32_t>(t);
+                }
+            };
+
+            // Adds one sampled row to counts, laid out [copy][channel][bin];
+            // pixel x goes to copy x % kHistogramCopies.
+            void HistogramRow(const std::uint8_t *row, const Region &r, const std::int32_t *lut, std::int64_t bins,
+                              std::uint32_t *counts)
+            {
+                const std::int64_t C = r.channels;
+                const std::int64_t copy_size = C * bins;
+                for (std::int64_t x = 0; x < r.cols; ++x)
+                {
+                    const std::uint8_t *px = row + x * r.pixel_step;
+                    std::uint32_t *h = counts + (x % kHistogramCopies) * copy_size;
+                    for (std::int64_t c = 0; c < C; ++c)
+                    {
+                        ++h[c * bins + lut[px[c]]];
+                    }
+                }
+            }
+
+            // Contiguous rows compute a tile of bin indices with SIMD before
+            // the scalar increments.
+            void BinIndices(const float *src, std::int64_t n, const BinMap &map, std::int32_t *idx)
+            {
+                std::int64_t i = 0;
+#if defined(PTK_SIMD_NEON64)
+                const float32x4_t lo = vdupq_n_f32(map.lo);
+                const float32x4_t scale = vdupq_n_f32(map.scale);
+                const float32x4_t zero = vdupq_n_f32(0.0f);
+                const float32x4_t top = vdupq_n_f32(map.top);
+                for (; i + 4 <= n; i += 4)
+                {
+                    float32x4_t t = vmulq_f32(vsubq_f32(vld1q_f32(src + i), lo), scale);
+                    // vmaxnmq keeps the number when one operand is NaN.
+                    t = vminq_f32(vmaxnmq_f32(t, zero), top);
+                    vst1q_s32(idx + i, vcvtq_s32_f32(t));
+                }
+#elif defined(PTK_SIMD_SSE2)
+                const __m128 lo = _mm_set1_ps(map.lo);
+                const __m128 scale = _mm_set1_ps(map.scale);
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 top = _mm_set1_ps(map.top);
+                for (; i + 4 <= n; i += 4)
+                {
+                    __m128 t = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(src + i), lo), scale);
+                    // maxps returns its second operand when the first is NaN.
+                    t = _mm_min_ps(_mm_max_ps(t, zero), top);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(idx + i), _mm_cvttps_epi32(t));
+                }
+#endif
+                for (; i < n; ++i)
+                {
+                    idx[i] = map.Index(src[i]);
+                }
+            }
+
+            void HistogramRow(const float *row, const Region &r, const BinMap &map, std::int64_t bins,
+                              std::uint32_t *counts)
+            {
+                const std::int64_t C = r.channels;
+                const std::int64_t copy_size = C * bins;
+                if (r.step != 1)
+                {
+                    for (std::int64_t x = 0; x < r.cols; ++x)
+                    {
+                        const float *px = row + x * r.pixel_step;
+                        std::uint32_t *h = counts + (x % kHistogramCopies) * copy_size;
+                        for (std::int64_t c = 0; c < C; ++c)
+                        {
+                            ++h[c * bins + map.Index(px[c])];
+                        }
+                    }
+                    return;
+                }
+
+                alignas(16) std::int32_t idx[kTileWidth * kMaxChannels];
+                for (std::int64_t x0 = 0; x0 < r.cols; x0 += kTileWidth)
+                {
+                    const std::int64_t n = std::min(kTileWidth, r.cols - x0);
+                    BinIndices(row + x0 * C, n * C, map, idx);
+                    for (std::int64_t x = 0; x < n; ++x)
+                    {
+                        std::uint32_t *h = counts + (x % kHistogramCopies) * copy_size;
+                        for (std::int64_t c = 0; c < C; ++c)
+                        {
+                            ++h[c * bins + idx[x * C + c]];
+                        }
+                    }
+                }
+            }
+        } // namespace
+
+        double ChannelStats::mean() const
+        {
+            return count > 0 ? sum / static_cast<double>(count) : 0.0;
+        }
+
+        double ChannelStats::stddev() const
+        {
+            if (count <= 0)
+            {
+                return 0.0;
+            }
+            const double m = mean();
+            return std::sqrt(std::max(0.0, sum_sq / static_cast<double>(count) - m * m));
+        }
+
+        void ChannelStats::Merge(const ChannelStats &other)
+        {
+            if (other.count == 0)
+            {
+                return;
+            }
+            if (count == 0)
+            {
+                *this = other;
+                return;
+            }
+            count += other.count;
+            sum += other.sum;
+            sum_sq += other.sum_sq;
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+        }
+
+        void ImageStats::Merge(const ImageStats &other)
+        {
+            channels = std::max(channels, other.channels);
+            for (int c = 0; c < other.channels; ++c)
+            {
+                channel[c].Merge(other.channel[c]);
+            }
+        }
+
+        void ImageHistogram::Merge(const ImageHistogram &other)
+        {
+            if (counts.empty())
+            {
+                *this = other;
+                return;
+            }
+            const std::size_t n = std::min(counts.size(), other.counts.size());
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                counts[i] += other.counts[i];
+            }
+        }
+
+        core::Status ComputeImageStats(const data::TensorView &src, const StatsOptions &options, ImageStats *stats)
+        {
+            if (stats == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ComputeImageStats: stats is null");
+            }
+            Region r;
+            core::Status s = CheckImage(src, options, "ComputeImageStats", &r);
+            if (!s.ok())
+            {
+                return s;
+            }
+
+            *stats = ImageStats();
+            stats->channels = static_cast<int>(r.channels);
+            if (src.dtype() == core::DataType::kUint8)
+            {
+                StatsRows<std::uint8_t, U8Acc>(r, stats);
+            }
+            else
+            {
+                StatsRows<float, F32Acc>(r, stats);
+            }
+            return core::Status::Ok();
+        }
+
+        core::Status ComputeHistogram(const data::TensorView &src, const HistogramParams &params,
+                                      const StatsOptions &options, ImageHistogram *histogram)
+        {
+            if (histogram == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ComputeHistogram: histogram is null");
+            }
+            if (params.bins < 1 || params.bins > kMaxBins)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ComputeHistogram: bins must be in [1, 65536]");
+            }
+            if (!(params.hi > params.lo))
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ComputeHistogram: hi must be greater than lo");
+            }
+            Region r;
+            core::Status s = CheckImage(src, options, "ComputeHistogram", &r);
+            if (!s.ok())
+            {
+                return s;
+            }
+
+            const std::int64_t bins = params.bins;
+            const std::int64_t size = r.channels * bins;
+            histogram->channels = static_cast<int>(r.channels);
+            histogram->params = params;
+            histogram->counts.assign(static_cast<std::size_t>(size), 0);
+
+            const BinMap map{params.lo, static_cast<float>(params.bins) / (params.hi - params.lo),
+                             static_cast<float>(params.bins - 1)};
+            std::int32_t lut[256];
+            for (int v = 0; v < 256; ++v)
+            {
+                lut[v] = map.Index(static_cast<float>(v));
+            }
+            const bool is_u8 = src.dtype() == core::DataType::kUint8;
+
+            std::mutex mu;
+            auto fn = [&](std::int64_t begin, std::int64_t end)
+            {
+                std::vector<std::uint32_t> local(static_cast<std::size_t>(kHistogramCopies * size), 0);
+                for (std::int64_t i = begin; i < end; ++i)
+                {
+                    if (is_u8)
+                    {
+                        HistogramRow(RowAt<std::uint8_t>(r, i), r, lut, bins, local.data());
+                    }
+                    else
+                    {
+                        HistogramRow(RowAt<float>(r, i), r, map, bins, local.data());
+                    }
+                }
+                for (int k = 1; k < kHistogramCopies; ++k)
+                {
+                    const std::uint32_t *copy = local.data() + k * size;
+                    for (std::int64_t j = 0; j < size; ++j)
+                    {
+                        local[j] += copy[j];
+                    }
+                }
+                std::lock_guard<std::mutex> lock(mu);
+                for (std::int64_t j = 0; j < size; ++j)
+                {
+                    histogram->counts[j] += local[j];
+                }
+            };
+            core::ThreadPool::Default().ParallelFor(0, r.rows, MinRows(r), fn);
+
+            return core::Status::Ok();
+        }
+} // namespace ptk::operators
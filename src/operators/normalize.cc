@@ -1,105 +1,227 @@
 #include "operators/normalize.h"
 
+#include <cstdint>
+
+#include "operators/kernel_dispatch.h"
+#include "operators/simd.h"
 #include "runtime/core/status.h"
+#include "runtime/core/thread_pool.h"
 #include "runtime/core/types.h"
 #include "runtime/data/tensor.h"
 
+#if defined(PTK_SIMD_NEON)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
 namespace ptk::operators
 {
-        core::Status Normalize(data::TensorView *tensor,
-                         const NormalizationParams &params,
-                         core::TensorLayout layout)
+        namespace
         {
-            if (tensor == nullptr)
+            // Below this many elements a frame is normalized on the calling thread.
+            constexpr std::int64_t kMinParallelElements = 1 << 15;
+
+            // The image seen as rows that share one channel pattern: HWC rows hold
+            // W pixels of interleaved channels, CHW rows belong to one channel.
+            struct RowGeometry
             {
-                return core::Status(core::StatusCode::kInvalidArgument,
-                              "Normalize: tensor is null");
-            }
+                bool interleaved;
+                std::int64_t rows;
+                std::int64_t row_len;
+                std::int64_t C;
+                std::int64_t H;
+            };
 
-            if (tensor->dtype() != core::DataType::kFloat32)
+            core::Status ResolveRows(const data::TensorShape &shape, core::TensorLayout layout,
+                                     int num_channels, RowGeometry *geo)
             {
-                return core::Status(core::StatusCode::kInvalidArgument,
-                              "Normalize: expects float32 tensor");
-            }
+                const std::size_t rank = shape.rank();
 
-            const data::TensorShape &shape = tensor->shape();
-            const std::size_t rank = shape.rank();
+                std::int64_t N = 1;
+                std::int64_t C = 0;
+                std::int64_t H = 0;
+                std::int64_t W = 0;
 
-            std::int64_t N = 1;
-            std::int64_t C = 0;
-            std::int64_t H = 0;
-            std::int64_t W = 0;
+                switch (layout)
+                {
+                case core::TensorLayout::kHwc:
+                {
+                    if (rank != 3)
+                    {
+                        return core::Status(core::StatusCode::kInvalidArgument,
+                                      "Normalize: HWC layout expects rank 3 tensor");
+                    }
+                    H = shape.dim(0);
+                    W = shape.dim(1);
+                    C = shape.dim(2);
+                    break;
+                }
+                case core::TensorLayout::kChw:
+                {
+                    if (rank != 3)
+                    {
+                        return core::Status(core::StatusCode::kInvalidArgument,
+                                      "Normalize: CHW layout expects rank 3 tensor");
+                    }
+                    C = shape.dim(0);
+                    H = shape.dim(1);
+                    W = shape.dim(2);
+                    break;
+                }
+                case core::TensorLayout::kNhwc:
+                {
+                    if (rank != 4)
+                    {
+                        return core::Status(core::StatusCode::kInvalidArgument,
+                                      "Normalize: NHWC layout expects rank 4 tensor");
+                    }
+                    N = shape.dim(0);
+                    H = shape.dim(1);
+                    W = shape.dim(2);
+                    C = shape.dim(3);
+                    break;
+                }
+                case core::TensorLayout::kNchw:
+                {
+                    if (rank != 4)
+                    {
+                        return core::Status(core::StatusCode::kInvalidArgument,
+                                      "Normalize: NCHW layout expects rank 4 tensor");
+                    }
+                    N = shape.dim(0);
+                    C = shape.dim(1);
+                    H = shape.dim(2);
+                    W = shape.dim(3);
+                    break;
+                }
+                default:
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "Normalize: unsupported TensorLayout");
+                }
 
-            switch (layout)
-            {
-            case core::TensorLayout::kHwc:
-            {
-                if (rank != 3)
+                if (C <= 0 || H <= 0 || W <= 0 || N <= 0)
                 {
                     return core::Status(core::StatusCode::kInvalidArgument,
-                                  "Normalize: HWC layout expects rank 3 tensor");
+                                  "Normalize: non positive dimension");
                 }
-                H = shape.dim(0);
-                W = shape.dim(1);
-                C = shape.dim(2);
-                N = 1;
-                break;
-            }
-            case core::TensorLayout::kChw:
-            {
-                if (rank != 3)
+
+                if (num_channels != C)
                 {
                     return core::Status(core::StatusCode::kInvalidArgument,
-                                  "Normalize: CHW layout expects rank 3 tensor");
+                                  "Normalize: num_channels must match tensor channels");
                 }
-                C = shape.dim(0);
-                H = shape.dim(1);
-                W = shape.dim(2);
-                N = 1;
-                break;
+
+                geo->interleaved = layout == core::TensorLayout::kHwc || layout == core::TensorLayout::kNhwc;
+                geo->C = C;
+                geo->H = H;
+                if (geo->interleaved)
+                {
+                    geo->rows = N * H;
+                    geo->row_len = W * C;
+                }
+                else
+                {
+                    geo->rows = N * C * H;
+                    geo->row_len = W;
+                }
+                return core::Status::Ok();
             }
-            case core::TensorLayout::kNhwc:
+
+            // x[i] = x[i] * scale + bias for a single channel run.
+            void ScaleBiasConst(float *x, std::int64_t n, float scale, float bias)
             {
-                if (rank != 4)
+                std::int64_t i = 0;
+#if defined(PTK_SIMD_NEON)
+                const float32x4_t s = vdupq_n_f32(scale);
+                const float32x4_t b = vdupq_n_f32(bias);
+                for (; i + 8 <= n; i += 8)
                 {
-                    return core::Status(core::StatusCode::kInvalidArgument,
-                                  "Normalize: NHWC layout expects rank 4 tensor");
+                    vst1q_f32(x + i, vmlaq_f32(b, vld1q_f32(x + i), s));
+                    vst1q_f32(x + i + 4, vmlaq_f32(b, vld1q_f32(x + i + 4), s));
+                }
+#elif defined(PTK_SIMD_SSE2)
+                const __m128 s = _mm_set1_ps(scale);
+                const __m128 b = _mm_set1_ps(bias);
+                for (; i + 8 <= n; i += 8)
+                {
+                    _mm_storeu_ps(x + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x + i), s), b));
+                    _mm_storeu_ps(x + i + 4, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x + i + 4), s), b));
+                }
+#endif
+                for (; i < n; ++i)
+                {
+                    x[i] = x[i] * scale + bias;
                 }
-                N = shape.dim(0);
-                H = shape.dim(1);
-                W = shape.dim(2);
-                C = shape.dim(3);
-                break;
             }
-            case core::TensorLayout::kNchw:
+
+            // Same for interleaved channels. scale and bias hold the per-channel
+            // values repeated over period = 4 * C floats, so every 4-wide vector
+            // lines up with a fixed slice of the pattern. With N > 0 the period is
+            // a constant and the pattern loop unrolls completely.
+            template <int N>
+            void ScaleBiasPattern(float *x, std::int64_t n, const float *scale, const float *bias,
+                                  std::int64_t runtime_channels)
             {
-                if (rank != 4)
+                const std::int64_t period = 4 * ChannelCount<N>(runtime_channels);
+                std::int64_t i = 0;
+                for (; i + period <= n; i += period)
                 {
-                    return core::Status(core::StatusCode::kInvalidArgument,
-                                  "Normalize: NCHW layout expects rank 4 tensor");
+                    float *p = x + i;
+                    std::int64_t j = 0;
+#if defined(PTK_SIMD_NEON)
+                    for (; j < period; j += 4)
+                    {
+                        vst1q_f32(p + j, vmlaq_f32(vld1q_f32(bias + j), vld1q_f32(p + j), vld1q_f32(scale + j)));
+                    }
+#elif defined(PTK_SIMD_SSE2)
+                    for (; j < period; j += 4)
+                    {
+                        _mm_storeu_ps(p + j, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(p + j), _mm_loadu_ps(scale + j)),
+                                                        _mm_loadu_ps(bias + j)));
+                    }
+#endif
+                    for (; j < period; ++j)
+                    {
+                        p[j] = p[j] * scale[j] + bias[j];
+                    }
+                }
+                for (std::int64_t j = 0; i < n; ++i, ++j)
+                {
+                    x[i] = x[i] * scale[j] + bias[j];
                 }
-                N = shape.dim(0);
-                C = shape.dim(1);
-                H = shape.dim(2);
-                W = shape.dim(3);
-                break;
             }
-            default:
-                return core::Status(core::StatusCode::kInvalidArgument,
-                              "Normalize: unsupported TensorLayout");
+
+            template <int N>
+            void LookupRow(const std::uint8_t *in, float *out, std::int64_t W, std::int64_t runtime_channels,
+                           const float (*lut)[256])
+            {
+                const std::int64_t C = ChannelCount<N>(runtime_channels);
+                for (std::int64_t w = 0; w < W; ++w)
+                {
+                    for (std::int64_t c = 0; c < C; ++c)
+                    {
+                        out[w * C + c] = lut[c][in[w * C + c]];
+                    }
+                }
             }
 
-            if (C <= 0 || H <= 0 || W <= 0 || N <= 0)
+            void RunRows(const RowGeometry &geo, const std::function<void(std::int64_t, std::int64_t)> &fn)
             {
-                return core::Status(core::StatusCode::kInvalidArgument,
-                              "Normalize: non positive dimension");
+                const std::int64_t min_rows =
+                    geo.row_len >= kMinParallelElements ? 1 : kMinParallelElements / geo.row_len;
+                core::ThreadPool::Default().ParallelFor(0, geo.rows, min_rows, fn);
             }
+        } // namespace
 
-            if (params.num_channels <= 0 ||
-                params.num_channels != C)
+        Normalizer::Normalizer() : num_channels_(0), scale_(), bias_(), lut_() {}
+
+        core::Status Normalizer::Init(const NormalizationParams &params)
+        {
+            if (params.num_channels <= 0 || params.num_channels > 4)
             {
                 return core::Status(core::StatusCode::kInvalidArgument,
-                              "Normalize: num_channels must match tensor channels");
+                              "Normalize: num_channels must be in [1,4]");
             }
 
             for (int c = 0; c < params.num_channels; ++c)
@@ -111,6 +233,50 @@ namespace ptk::operators
                 }
             }
 
+            for (int c = 0; c < params.num_channels; ++c)
+            {
+                scale_[c] = 1.0f / params.std[c];
+                bias_[c] = -params.mean[c] * scale_[c];
+                // The table is exact: it uses the division, not the reciprocal.
+                for (int v = 0; v < 256; ++v)
+                {
+                    lut_[c][v] = (static_cast<float>(v) - params.mean[c]) / params.std[c];
+                }
+            }
+            num_channels_ = params.num_channels;
+            return core::Status::Ok();
+        }
+
+        core::Status Normalizer::Apply(data::TensorView *tensor, core::TensorLayout layout) const
+        {
+            if (tensor == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Normalize: tensor is null");
+            }
+            if (!initialized())
+            {
+                return core::Status(core::StatusCode::kFailedPrecondition,
+                              "Normalize: Normalizer::Init must be called first");
+            }
+            if (tensor->dtype() != core::DataType::kFloat32)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Normalize: expects float32 tensor");
+            }
+            if (!tensor->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Normalize: expects contiguous tensor");
+            }
+
+            RowGeometry geo;
+            core::Status s = ResolveRows(tensor->shape(), layout, num_channels_, &geo);
+            if (!s.ok())
+            {
+                return s;
+            }
+
             float *data =
                 static_cast<float *>(tensor->buffer().data());
             if (data == nullptr)
@@ -119,102 +285,130 @@ namespace ptk::operators
                               "Normalize: tensor buffer data is null");
             }
 
-            switch (layout)
-            {
-            case core::TensorLayout::kHwc:
+            if (geo.interleaved)
             {
-                // (h, w, c) -> (h * W + w) * C + c
-                for (std::int64_t h = 0; h < H; ++h)
+                const std::int64_t period = 4 * geo.C;
+                float scale[16];
+                float bias[16];
+                for (std::int64_t j = 0; j < period; ++j)
                 {
-                    for (std::int64_t w = 0; w < W; ++w)
-                    {
-                        for (std::int64_t c = 0; c < C; ++c)
-                        {
-                            const std::size_t idx =
-                                static_cast<std::size_t>((h * W + w) * C + c);
-                            const float m = params.mean[c];
-                            const float s = params.std[c];
-                            data[idx] = (data[idx] - m) / s;
-                        }
-                    }
+                    scale[j] = scale_[j % geo.C];
+                    bias[j] = bias_[j % geo.C];
                 }
-                break;
+                DispatchChannels(geo.C, [&](auto channels) {
+                    RunRows(geo, [&](std::int64_t r0, std::int64_t r1) {
+                        ScaleBiasPattern<decltype(channels)::value>(data + r0 * geo.row_len,
+                                                                    (r1 - r0) * geo.row_len, scale, bias, geo.C);
+                    });
+                });
             }
-
-            case core::TensorLayout::kChw:
+            else
             {
-                // (c, h, w) -> (c * H + h) * W + w
-                for (std::int64_t c = 0; c < C; ++c)
-                {
-                    for (std::int64_t h = 0; h < H; ++h)
+                RunRows(geo, [&](std::int64_t r0, std::int64_t r1) {
+                    for (std::int64_t r = r0; r < r1; ++r)
                     {
-                        for (std::int64_t w = 0; w < W; ++w)
-                        {
-                            const std::size_t idx =
-                                static_cast<std::size_t>((c * H + h) * W + w);
-                            const float m = params.mean[c];
-                            const float s = params.std[c];
-                            data[idx] = (data[idx] - m) / s;
-                        }
+                        const std::int64_t c = (r / geo.H) % geo.C;
+                        ScaleBiasConst(data + r * geo.row_len, geo.row_len, scale_[c], bias_[c]);
                     }
-                }
-                break;
+                });
             }
 
-            case core::TensorLayout::kNhwc:
+            return core::Status::Ok();
+        }
+
+        core::Status Normalizer::Apply(const data::TensorView &src, data::TensorView *dst,
+                                       core::TensorLayout layout) const
+        {
+            if (dst == nullptr)
             {
-                // (n, h, w, c) -> (((n * H + h) * W + w) * C + c)
-                for (std::int64_t n = 0; n < N; ++n)
-                {
-                    for (std::int64_t h = 0; h < H; ++h)
-                    {
-                        for (std::int64_t w = 0; w < W; ++w)
-                        {
-                            for (std::int64_t c = 0; c < C; ++c)
-                            {
-                                const std::size_t idx =
-                                    static_cast<std::size_t>(
-                                        (((n * H + h) * W + w) * C + c));
-                                const float m = params.mean[c];
-                                const float s = params.std[c];
-                                data[idx] = (data[idx] - m) / s;
-                            }
-                        }
-                    }
-                }
-                break;
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Normalize: dst is null");
+            }
+            if (!initialized())
+            {
+                return core::Status(core::StatusCode::kFailedPrecondition,
+                              "Normalize: Normalizer::Init must be called first");
+            }
+            if (src.dtype() != core::DataType::kUint8 ||
+                dst->dtype() != core::DataType::kFloat32)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Normalize: expects uint8 src and float32 dst");
+            }
+            if (src.shape().dims() != dst->shape().dims())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Normalize: src and dst shape differ");
+            }
+            if (!src.is_contiguous() || !dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Normalize: expects contiguous tensors");
             }
 
-            case core::TensorLayout::kNchw:
+            RowGeometry geo;
+            core::Status s = ResolveRows(src.shape(), layout, num_channels_, &geo);
+            if (!s.ok())
             {
-                // (n, c, h, w) -> (((n * C + c) * H + h) * W + w)
-                for (std::int64_t n = 0; n < N; ++n)
-                {
-                    for (std::int64_t c = 0; c < C; ++c)
-                    {
-                        for (std::int64_t h = 0; h < H; ++h)
+                return s;
+            }
+
+            const std::uint8_t *in = static_cast<const std::uint8_t *>(src.buffer().data());
+            float *out = static_cast<float *>(dst->buffer().data());
+            if (in == nullptr || out == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Normalize: null buffer data");
+            }
+
+            if (geo.interleaved)
+            {
+                DispatchChannels(geo.C, [&](auto channels) {
+                    RunRows(geo, [&](std::int64_t r0, std::int64_t r1) {
+                        for (std::int64_t r = r0; r < r1; ++r)
                         {
-                            for (std::int64_t w = 0; w < W; ++w)
-                            {
-                                const std::size_t idx =
-                                    static_cast<std::size_t>(
-                                        (((n * C + c) * H + h) * W + w));
-                                const float m = params.mean[c];
-                                const float s = params.std[c];
-                                data[idx] = (data[idx] - m) / s;
-                            }
+                            LookupRow<decltype(channels)::value>(in + r * geo.row_len, out + r * geo.row_len,
+                                                                 geo.row_len / geo.C, geo.C, lut_);
                         }
+                    });
+                });
+            }
+            else
+            {
+                RunRows(geo, [&](std::int64_t r0, std::int64_t r1) {
+                    for (std::int64_t r = r0; r < r1; ++r)
+                    {
+                        LookupRow<1>(in + r * geo.row_len, out + r * geo.row_len, geo.row_len, 1,
+                                     &lut_[(r / geo.H) % geo.C]);
                     }
-                }
-                break;
+                });
             }
 
-            default:
-                return core::Status(core::StatusCode::kInternal,
-                              "Normalize: unreachable layout branch");
+            return core::Status::Ok();
+        }
+
+        core::Status Normalize(data::TensorView *tensor,
+                         const NormalizationParams &params,
+                         core::TensorLayout layout)
+        {
+            Normalizer normalizer;
+            core::Status s = normalizer.Init(params);
+            if (!s.ok())
+            {
+                return s;
             }
+            return normalizer.Apply(tensor, layout);
+        }
 
-            return core::Status::Ok();
+        core::Status NormalizeUint8(const data::TensorView &src, const NormalizationParams &params,
+                                    core::TensorLayout layout, data::TensorView *dst)
+        {
+            Normalizer normalizer;
+            core::Status s = normalizer.Init(params);
+            if (!s.ok())
+            {
+                return s;
+            }
+            return normalizer.Apply(src, dst, layout);
         }
 } // namespace ptk::operators
-
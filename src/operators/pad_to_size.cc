@@ -1,13 +1,192 @@
 #include "operators/pad_to_size.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
 #include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
 
 namespace ptk::operators
 {
-        // TODO: Implement PadToSize
-        core::Status PadToSize(const data::TensorView &src, int target_h, int target_w, data::TensorView *dst)
+        namespace
+        {
+            // Fills count elements starting at dst with the pad value.
+            void Fill(std::uint8_t *dst, std::int64_t count, core::DataType dtype, float pad_value)
+            {
+                if (count <= 0)
+                {
+                    return;
+                }
+                if (dtype == core::DataType::kUint8)
+                {
+                    const float clamped = std::min(std::max(pad_value, 0.0f), 255.0f);
+                    std::memset(dst, static_cast<int>(std::lround(clamped)), static_cast<std::size_t>(count));
+                    return;
+                }
+                std::fill_n(reinterpret_cast<float *>(dst), count, pad_value);
+            }
+
+            // Copies count elements spaced src_stride apart into a packed run at dst.
+            void CopyRun(std::uint8_t *dst, const std::uint8_t *src, std::int64_t count,
+                         std::int64_t src_stride, std::int64_t elem)
+            {
+                if (src_stride == 1)
+                {
+                    std::memcpy(dst, src, static_cast<std::size_t>(count * elem));
+                    return;
+                }
+                for (std::int64_t i = 0; i < count; ++i)
+                {
+                    std::memcpy(dst + i * elem, src + i * src_stride * elem, static_cast<std::size_t>(elem));
+                }
+            }
+        } // namespace
+
+        core::Status PadToSize(const data::TensorView &src, int target_h, int target_w, data::TensorView *dst,
+                               core::TensorLayout layout, float pad_value)
         {
-            return core::Status(core::StatusCode::kInternal, "PadToSize not yet implemented");
+            if (dst == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PadToSize: dst is null");
+            }
+            if (src.dtype() != core::DataType::kUint8 &&
+                src.dtype() != core::DataType::kFloat32)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PadToSize: expects uint8 or float32 tensor");
+            }
+            if (dst->dtype() != src.dtype())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PadToSize: src and dst dtype differ");
+            }
+            if (!dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PadToSize: dst must be contiguous");
+            }
+
+            const data::TensorShape &sshape = src.shape();
+            const data::TensorShape &dshape = dst->shape();
+            if (sshape.rank() != 3 || dshape.rank() != 3)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PadToSize: expects rank 3 tensors");
+            }
+
+            std::int64_t H = 0;
+            std::int64_t W = 0;
+            std::int64_t C = 0;
+            std::int64_t sh = 0; // element strides of h, w, c in src
+            std::int64_t sw = 0;
+            std::int64_t sc = 0;
+            switch (layout)
+            {
+            case core::TensorLayout::kHwc:
+                H = sshape.dim(0);
+                W = sshape.dim(1);
+                C = sshape.dim(2);
+                sh = src.stride(0);
+                sw = src.stride(1);
+                sc = src.stride(2);
+                if (dshape.dim(0) != target_h || dshape.dim(1) != target_w || dshape.dim(2) != C)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "PadToSize: dst shape must be [target_h,target_w,C]");
+                }
+                break;
+            case core::TensorLayout::kChw:
+                C = sshape.dim(0);
+                H = sshape.dim(1);
+                W = sshape.dim(2);
+                sc = src.stride(0);
+                sh = src.stride(1);
+                sw = src.stride(2);
+                if (dshape.dim(0) != C || dshape.dim(1) != target_h || dshape.dim(2) != target_w)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "PadToSize: dst shape must be [C,target_h,target_w]");
+                }
+                break;
+            default:
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PadToSize: layout must be HWC or CHW");
+            }
+
+            if (target_h < H || target_w < W)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PadToSize: target size smaller than source");
+            }
+
+            const std::uint8_t *in = static_cast<const std::uint8_t *>(src.buffer().data());
+            std::uint8_t *out = static_cast<std::uint8_t *>(dst->buffer().data());
+            if (in == nullptr || out == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PadToSize: null buffer data");
+            }
+
+            const core::DataType dtype = src.dtype();
+            const std::int64_t elem = static_cast<std::int64_t>(src.element_size());
+            const std::int64_t TH = target_h;
+            const std::int64_t TW = target_w;
+            const std::int64_t top = (TH - H) / 2;
+            const std::int64_t left = (TW - W) / 2;
+            const std::int64_t bottom = TH - H - top;
+            const std::int64_t right = TW - W - left;
+
+            if (layout == core::TensorLayout::kHwc)
+            {
+                const std::int64_t drow = TW * C;
+                const bool packed = sc == 1 && sw == C;
+
+                Fill(out, top * drow, dtype, pad_value);
+                for (std::int64_t h = 0; h < H; ++h)
+                {
+                    std::uint8_t *dst_row = out + (top + h) * drow * elem;
+                    const std::uint8_t *src_row = in + h * sh * elem;
+
+                    Fill(dst_row, left * C, dtype, pad_value);
+                    std::uint8_t *dst_px = dst_row + left * C * elem;
+                    if (packed)
+                    {
+                        CopyRun(dst_px, src_row, W * C, 1, elem);
+                    }
+                    else
+                    {
+                        for (std::int64_t w = 0; w < W; ++w)
+                        {
+                            CopyRun(dst_px + w * C * elem, src_row + w * sw * elem, C, sc, elem);
+                        }
+                    }
+                    Fill(dst_row + (left + W) * C * elem, right * C, dtype, pad_value);
+                }
+                Fill(out + (top + H) * drow * elem, bottom * drow, dtype, pad_value);
+            }
+            else
+            {
+                for (std::int64_t c = 0; c < C; ++c)
+                {
+                    std::uint8_t *plane = out + c * TH * TW * elem;
+                    const std::uint8_t *src_plane = in + c * sc * elem;
+
+                    Fill(plane, top * TW, dtype, pad_value);
+                    for (std::int64_t h = 0; h < H; ++h)
+                    {
+                        std::uint8_t *dst_row = plane + (top + h) * TW * elem;
+                        Fill(dst_row, left, dtype, pad_value);
+                        CopyRun(dst_row + left * elem, src_plane + h * sh * elem, W, sw, elem);
+                        Fill(dst_row + (left + W) * elem, right, dtype, pad_value);
+                    }
+                    Fill(plane + (top + H) * TW * elem, bottom * TW, dtype, pad_value);
+                }
+            }
+
+            return core::Status::Ok();
         }
 } // namespace ptk::operators
-
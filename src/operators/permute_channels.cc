@@ -0,0 +1,262 @@
+#include "operators/permute_channels.h"
+#include "operators/simd.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "runtime/core/status.h"
+#include "runtime/core/thread_pool.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+#if defined(PTK_SIMD_NEON64)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSSE3)
+#include <tmmintrin.h>
+#endif
+
+namespace ptk::operators
+{
+        namespace
+        {
+            // Below this many pixels a tensor is permuted on the calling thread.
+            constexpr std::int64_t kMinParallelElements = 1 << 15;
+
+            constexpr int kMaxChannels = 4;
+
+            // One 16 byte shuffle moves `pixels` whole pixels: it reads in_step
+            // bytes of src and produces out_step bytes of dst. The 16 byte store
+            // also covers the bytes after out_step; those are either written
+            // back unchanged (same channel count, so in place they are the
+            // pixels not yet permuted) or overwritten by the next block.
+            struct ShufflePlan
+            {
+                std::uint8_t mask[16];
+                std::int64_t pixels;
+                std::int64_t in_step;
+                std::int64_t out_step;
+                std::int64_t lookahead; // pixels a block may touch past its start
+                bool simd;
+            };
+
+            ShufflePlan MakePlan(const int *order, std::int64_t in_channels, std::int64_t out_channels,
+                                 std::int64_t elem_size, bool in_place)
+            {
+                const std::int64_t in_px = in_channels * elem_size;
+                const std::int64_t out_px = out_channels * elem_size;
+
+                ShufflePlan plan;
+                plan.pixels = 16 / std::max(in_px, out_px);
+                plan.in_step = plan.pixels * in_px;
+                plan.out_step = plan.pixels * out_px;
+                plan.lookahead = std::max((16 + in_px - 1) / in_px, (16 + out_px - 1) / out_px);
+                for (std::int64_t j = 0; j < 16; ++j)
+                {
+                    std::int64_t m = 0x80;
+                    if (j < plan.out_step)
+                    {
+                        const std::int64_t p = j / out_px;
+                        const std::int64_t c = (j % out_px) / elem_size;
+                        m = p * in_px + order[c] * elem_size + j % elem_size;
+                    }
+                    else if (in_channels == out_channels)
+                    {
+                        m = j;
+                    }
+                    plan.mask[j] = static_cast<std::uint8_t>(m);
+                }
+                // Compacting in place, the store must not reach src bytes that
+                // are still unread, which holds for every block once in_step
+                // is a full vector.
+                plan.simd = !(in_place && out_channels < in_channels && plan.in_step < 16);
+                return plan;
+            }
+
+            // Permutes n pixels. T is the element bit pattern (uint8 or the
+            // 32-bit word of a float), so values are copied, never converted.
+            template <typename T>
+            void PermuteRun(const T *src, T *dst, std::int64_t n, const int *order, std::int64_t in_channels,
+                            std::int64_t out_channels, const ShufflePlan &plan)
+            {
+                std::int64_t p = 0;
+#if defined(PTK_SIMD_NEON64) || defined(PTK_SIMD_SSSE3)
+                if (plan.simd)
+                {
+                    const std::uint8_t *in = reinterpret_cast<const std::uint8_t *>(src);
+                    std::uint8_t *out = reinterpret_cast<std::uint8_t *>(dst);
+#if defined(PTK_SIMD_NEON64)
+                    const uint8x16_t mask = vld1q_u8(plan.mask);
+#else
+                    const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i *>(plan.mask));
+#endif
+                    for (; p + plan.lookahead <= n; p += plan.pixels)
+                    {
+#if defined(PTK_SIMD_NEON64)
+                        vst1q_u8(out, vqtbl1q_u8(vld1q_u8(in), mask));
+#else
+                        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_shuffle_epi8(v, mask));
+#endif
+                        in += plan.in_step;
+                        out += plan.out_step;
+                    }
+                }
+#else
+                (void)plan;
+#endif
+                for (; p < n; ++p)
+                {
+                    T px[kMaxChannels];
+                    for (std::int64_t c = 0; c < in_channels; ++c)
+                    {
+                        px[c] = src[p * in_channels + c];
+                    }
+                    for (std::int64_t c = 0; c < out_channels; ++c)
+                    {
+                        dst[p * out_channels + c] = px[order[c]];
+                    }
+                }
+            }
+        } // namespace
+
+        core::Status PermuteChannels(const data::TensorView &src, const std::vector<int> &order,
+                                     data::TensorView *dst)
+        {
+            if (dst == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PermuteChannels: dst is null");
+            }
+
+            const core::DataType dtype = src.dtype();
+            if ((dtype != core::DataType::kUint8 && dtype != core::DataType::kFloat32) ||
+                dst->dtype() != dtype)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PermuteChannels: expects uint8 or float32 src and dst of the same type");
+            }
+
+            const data::TensorShape &sshape = src.shape();
+            const data::TensorShape &dshape = dst->shape();
+            const std::size_t rank = sshape.rank();
+            if (rank == 0 || dshape.rank() != rank)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PermuteChannels: expects src and dst of the same rank, channels last");
+            }
+            for (std::size_t i = 0; i + 1 < rank; ++i)
+            {
+                if (sshape.dim(i) != dshape.dim(i))
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "PermuteChannels: src and dst differ outside the channel dimension");
+                }
+            }
+
+            const std::int64_t in_channels = sshape.dim(rank - 1);
+            const std::int64_t out_channels = dshape.dim(rank - 1);
+            if (in_channels < 1 || in_channels > kMaxChannels)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PermuteChannels: src must have 1 to 4 channels");
+            }
+            if (out_channels < 1 || out_channels > kMaxChannels ||
+                static_cast<std::int64_t>(order.size()) != out_channels)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PermuteChannels: dst must have order.size() channels, 1 to 4");
+            }
+            int ord[kMaxChannels];
+            for (std::int64_t c = 0; c < out_channels; ++c)
+            {
+                ord[c] = order[static_cast<std::size_t>(c)];
+                if (ord[c] < 0 || ord[c] >= in_channels)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "PermuteChannels: order entry out of range");
+                }
+            }
+
+            if (!src.is_contiguous() || !dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PermuteChannels: expects contiguous tensors");
+            }
+
+            const std::uint8_t *in = static_cast<const std::uint8_t *>(src.buffer().data());
+            std::uint8_t *out = static_cast<std::uint8_t *>(dst->buffer().data());
+            if (in == nullptr || out == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PermuteChannels: null buffer data");
+            }
+
+            const std::int64_t pixels = sshape.num_elements() / in_channels;
+            const std::int64_t elem_size = dtype == core::DataType::kUint8 ? 1 : 4;
+            const bool in_place = in == out;
+            if (!in_place && in < out + pixels * out_channels * elem_size && out < in + pixels * in_channels * elem_size)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PermuteChannels: src and dst partially overlap");
+            }
+            if (in_place && out_channels > in_channels)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "PermuteChannels: cannot add channels in place");
+            }
+            if (pixels == 0)
+            {
+                return core::Status::Ok();
+            }
+
+            const ShufflePlan plan = MakePlan(ord, in_channels, out_channels, elem_size, in_place);
+
+            // Rows are the second to last dimension; a rank 1 tensor is one pixel
+            // per row.
+            const std::int64_t W = rank >= 2 ? sshape.dim(rank - 2) : 1;
+            const std::int64_t rows = pixels / W;
+            std::function<void(std::int64_t, std::int64_t)> fn;
+            if (elem_size == 1)
+            {
+                fn = [=, &plan](std::int64_t r0, std::int64_t r1)
+                {
+                    PermuteRun(in + r0 * W * in_channels, out + r0 * W * out_channels, (r1 - r0) * W, ord,
+                               in_channels, out_channels, plan);
+                };
+            }
+            else
+            {
+                const std::uint32_t *in32 = reinterpret_cast<const std::uint32_t *>(in);
+                std::uint32_t *out32 = reinterpret_cast<std::uint32_t *>(out);
+                fn = [=, &plan](std::int64_t r0, std::int64_t r1)
+                {
+                    PermuteRun(in32 + r0 * W * in_channels, out32 + r0 * W * out_channels, (r1 - r0) * W, ord,
+                               in_channels, out_channels, plan);
+                };
+            }
+
+            // Compacting in place moves every row towards the start of the
+            // buffer, over rows other threads would still be reading.
+            if (in_place && out_channels < in_channels)
+            {
+                fn(0, rows);
+                return core::Status::Ok();
+            }
+            const std::int64_t min_rows = W >= kMinParallelElements ? 1 : kMinParallelElements / W;
+            core::ThreadPool::Default().ParallelFor(0, rows, min_rows, fn);
+
+            return core::Status::Ok();
+        }
+
+        core::Status RgbaToRgb(const data::TensorView &src, data::TensorView *dst)
+        {
+            return PermuteChannels(src, {0, 1, 2}, dst);
+        }
+
+        core::Status BgraToRgb(const data::TensorView &src, data::TensorView *dst)
+        {
+            return PermuteChannels(src, {2, 1, 0}, dst);
+        }
+} // namespace ptk::operators
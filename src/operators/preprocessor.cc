@@ -3,32 +3,203 @@
 #include "operators/chw_to_hwc.h"
 #include "operators/cast_uint8_to_float32.h"
 #include "operators/cast_float32_to_uint8.h"
+#include "operators/cast_float32_to_float16.h"
+#include "operators/cast_float32_to_bfloat16.h"
 #include "operators/normalize.h"
 #include "operators/rgb_to_gray.h"
 #include "operators/rgb_to_bgr.h"
 #include "operators/bgr_to_rgb.h"
 #include "operators/pad_to_size.h"
+#include "operators/remap.h"
+#include "operators/rotate_flip.h"
 #include "operators/center_crop.h"
+#include "operators/demosaic.h"
 #include "operators/add_batch_dim.h"
+#include "operators/yuv_to_rgb.h"
 #include "runtime/core/runtime_context.h"
 #include "runtime/core/status.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 namespace ptk {
 
+core::Status ConfigureFromModelInput(const data::TensorSpec& spec, PreprocessorConfig* config) {
+  if (config == nullptr) {
+    return core::Status(core::StatusCode::kInvalidArgument, "ConfigureFromModelInput: config is null");
+  }
+  if (!spec.known()) {
+    return core::Status(core::StatusCode::kInvalidArgument,
+                        "ConfigureFromModelInput: no shape or dtype for " + spec.name);
+  }
+  if (spec.dtype != core::DataType::kFloat32 && spec.dtype != core::DataType::kFloat16 &&
+      spec.dtype != core::DataType::kBFloat16 && spec.dtype != core::DataType::kInt8) {
+    return core::Status(core::StatusCode::kInvalidArgument,
+                        "ConfigureFromModelInput: unsupported input type for " + spec.name);
+  }
+  const std::size_t rank = spec.dims.size();
+  if (rank != 3 && rank != 4) {
+    return core::Status(core::StatusCode::kInvalidArgument,
+                        "ConfigureFromModelInput: expected a rank 3 or 4 image input for " + spec.name);
+  }
+
+  const std::size_t first = rank - 3;
+  auto is_channels = [](std::int64_t d) { return d == 1 || d == 3; };
+  const bool chw = is_channels(spec.dims[first]) && !is_channels(spec.dims[rank - 1]);
+  const std::int64_t C = chw ? spec.dims[first] : spec.dims[rank - 1];
+  const std::int64_t H = spec.dims[chw ? first + 1 : first];
+  const std::int64_t W = spec.dims[chw ? first + 2 : first + 1];
+  // The pipeline writes one RGB/BGR or gray frame per tick.
+  if (C != 1 && C != 3) {
+    return core::Status(core::StatusCode::kInvalidArgument,
+                        "ConfigureFromModelInput: expected 1 or 3 channels for " + spec.name);
+  }
+  if (rank == 4 && spec.dims[0] > 1) {
+    return core::Status(core::StatusCode::kInvalidArgument,
+                        "ConfigureFromModelInput: static batch size above 1 for " + spec.name);
+  }
+
+  config->output_type = spec.dtype;
+  config->add_batch_dimension = rank == 4;
+  config->output_layout = rank == 4 ? (chw ? core::TensorLayout::kNchw : core::TensorLayout::kNhwc)
+                                    : (chw ? core::TensorLayout::kChw : core::TensorLayout::kHwc);
+  if (H > 0 && W > 0) {
+    config->target_height = static_cast<int>(H);
+    config->target_width = static_cast<int>(W);
+  }
+  if (C == 1) {
+    config->to_grayscale = true;
+    config->output_format = core::PixelFormat::kGray8;
+  }
+  return core::Status::Ok();
+}
+
 Preprocessor::Preprocessor(const PreprocessorConfig& config)
     : context_(nullptr),
       input_(nullptr),
       output_(nullptr),
       config_(config),
+      normalizer_(),
+      quantizer_(),
+      chain_(),
+      undistorter_(),
       float_buffer_(),
       uint8_temp_(),
+      color_temp_(),
+      gray_temp_(),
+      undistort_temp_(),
+      orient_temp_(),
       output_frame_() {}
 
+void Preprocessor::BindInput(core::InputPort<data::Frame>* in) {
+  input_ = in;
+}
+
+void Preprocessor::BindOutput(core::OutputPort<data::Frame>* out) {
+  output_ = out;
+}
+
 core::Status Preprocessor::Init(core::RuntimeContext* context) {
   if (context == nullptr) {
     return core::Status(core::StatusCode::kInvalidArgument, "Context is null");
   }
   context_ = context;
+  if (config_.normalize) {
+    core::Status s = normalizer_.Init(config_.norm);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  const bool gray = config_.to_grayscale || config_.output_format == core::PixelFormat::kGray8;
+  if (config_.output_type == core::DataType::kInt8) {
+    // Without normalization the table quantizes raw pixel values, one per
+    // channel of the frame that reaches it.
+    operators::NormalizationParams norm = config_.norm;
+    if (!config_.normalize) {
+      for (int c = 0; c < 4; ++c) {
+        norm.mean[c] = 0.0f;
+        norm.std[c] = 1.0f;
+      }
+      norm.num_channels = gray ? 1 : config_.input_format == core::PixelFormat::kRgba8 ? 4 : 3;
+    }
+    core::Status s = quantizer_.Init(norm, config_.quant, core::DataType::kInt8,
+                                     config_.convert_rgb_to_bgr && !gray);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  const bool hwc_input = config_.input_layout == core::TensorLayout::kUnknown ||
+                         config_.input_layout == core::TensorLayout::kHwc ||
+                         config_.input_layout == core::TensorLayout::kNhwc;
+  const bool float_output = config_.output_type == core::DataType::kFloat32 ||
+                            config_.output_type == core::DataType::kFloat16 ||
+                            config_.output_type == core::DataType::kBFloat16;
+  if (hwc_input && float_output) {
+    const bool chw_output = config_.output_layout == core::TensorLayout::kChw ||
+                            config_.output_layout == core::TensorLayout::kNchw;
+    if (config_.convert_rgb_to_bgr && !config_.to_grayscale) {
+      chain_.SwapRB();
+    }
+    if (config_.normalize) {
+      chain_.Normalize(config_.norm);
+    }
+    chain_.ToLayout(chw_output ? core::TensorLayout::kChw : core::TensorLayout::kHwc)
+        .Cast(config_.output_type);
+    core::Status s = chain_.Compile();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  // A known target size bounds the padding and half precision scratch, so
+  // they are reserved here rather than on the first frame.
+  if (config_.target_height > 0 && config_.target_width > 0) {
+    const std::size_t channels = gray ? 1 : 3;
+    const std::size_t elements = static_cast<std::size_t>(config_.target_height) *
+                                 static_cast<std::size_t>(config_.target_width) * channels;
+    uint8_temp_.reserve(elements);
+    if (config_.output_type == core::DataType::kFloat16 ||
+        config_.output_type == core::DataType::kBFloat16) {
+      float_buffer_.reserve(elements);
+    }
+  }
+  // A known frame size bounds the scratch of every stage before the resize.
+  if (config_.input_height > 0 && config_.input_width > 0) {
+    const core::PixelFormat f = config_.input_format;
+    const bool yuv = f == core::PixelFormat::kYuyv || f == core::PixelFormat::kNv12 ||
+                     f == core::PixelFormat::kI420;
+    const bool bayer = f == core::PixelFormat::kBayerRggb || f == core::PixelFormat::kBayerBggr ||
+                       f == core::PixelFormat::kBayerGrbg || f == core::PixelFormat::kBayerGbrg;
+    std::size_t pixels = static_cast<std::size_t>(config_.input_height) *
+                         static_cast<std::size_t>(config_.input_width);
+    std::size_t channels = f == core::PixelFormat::kRgba8 ? 4 : f == core::PixelFormat::kGray8 ? 1 : 3;
+    if (yuv || bayer) {
+      if (bayer && config_.bayer_downscale > 1) {
+        const std::size_t f2 = static_cast<std::size_t>(config_.bayer_downscale);
+        pixels /= f2 * f2;
+      }
+      color_temp_.reserve(pixels * 3);
+    }
+    if (gray && channels == 3) {
+      if (!yuv) {
+        gray_temp_.reserve(pixels);
+      }
+      channels = 1;
+    }
+    // Decoded frames are uint8; others keep the input type.
+    const std::size_t elem =
+        yuv || bayer ? 1
+                     : std::max<std::size_t>(1, data::TensorView(data::BufferView(), config_.input_type,
+                                                                 data::TensorShape())
+                                                    .element_size());
+    if (config_.undistort) {
+      undistort_temp_.reserve(pixels * channels);
+    }
+    if (config_.flip != operators::FlipMode::kNone ||
+        config_.rotation != operators::Rotation::kNone) {
+      orient_temp_.reserve(pixels * channels * elem);
+    }
+  }
   return core::Status::Ok();
 }
 
@@ -84,16 +255,315 @@ void Preprocessor::Tick() {
     return;
   }
 
-  const data::TensorView& src = in->image;
-  data::TensorView& dst = out->image;
+  data::TensorView src = in->image;
+  // src pixels to in->image pixels, composed as stages move or resample them.
+  data::PixelTransform geometry;
 
-  // For now: simple uint8 -> float32 cast.
-  core::Status s = operators::CastUint8ToFloat32(src, &dst);
-  if (!s.ok()) {
-    context_->LogError("Preprocessor: CastUint8ToFloat32 failed");
+  // Camera YUV is decoded once into packed pixels of the configured format.
+  if (in->pixel_format == core::PixelFormat::kYuyv ||
+      in->pixel_format == core::PixelFormat::kNv12 ||
+      in->pixel_format == core::PixelFormat::kI420) {
+    if (src.shape().rank() != 3) {
+      context_->LogError("Preprocessor: YUV frame must be a rank 3 tensor");
+      return;
+    }
+    const core::PixelFormat format =
+        config_.output_format == core::PixelFormat::kBgr8 ||
+                config_.output_format == core::PixelFormat::kGray8
+            ? config_.output_format
+            : core::PixelFormat::kRgb8;
+    const std::int64_t H = in->pixel_format == core::PixelFormat::kYuyv
+                               ? src.shape().dim(0)
+                               : src.shape().dim(0) / 3 * 2;
+    const std::int64_t W = src.shape().dim(1);
+    const std::int64_t C = format == core::PixelFormat::kGray8 ? 1 : 3;
+    color_temp_.resize(static_cast<std::size_t>(H * W * C));
+    data::TensorView decoded(
+        data::BufferView(color_temp_.data(), color_temp_.size(), core::DeviceType::kCpu),
+        core::DataType::kUint8, data::TensorShape({H, W, C}));
+
+    core::Status s = operators::YuvToRgb(src, in->pixel_format, &decoded, format, config_.yuv);
+    if (!s.ok()) {
+      context_->LogError("Preprocessor: YuvToRgb failed: " + s.message());
+      return;
+    }
+    src = decoded;
+    out->pixel_format = format;
+  }
+
+  // Raw Bayer is demosaiced the same way, binned down when configured so the
+  // full-resolution color image is never produced.
+  if (in->pixel_format == core::PixelFormat::kBayerRggb ||
+      in->pixel_format == core::PixelFormat::kBayerBggr ||
+      in->pixel_format == core::PixelFormat::kBayerGrbg ||
+      in->pixel_format == core::PixelFormat::kBayerGbrg) {
+    if (src.shape().rank() != 3) {
+      context_->LogError("Preprocessor: Bayer frame must be a rank 3 tensor");
+      return;
+    }
+    const core::PixelFormat format = config_.output_format == core::PixelFormat::kBgr8
+                                         ? core::PixelFormat::kBgr8
+                                         : core::PixelFormat::kRgb8;
+    const bool binned = config_.bayer_downscale > 1;
+    const std::int64_t f = binned ? config_.bayer_downscale : 1;
+    const std::int64_t H = src.shape().dim(0) / f;
+    const std::int64_t W = src.shape().dim(1) / f;
+    color_temp_.resize(static_cast<std::size_t>(H * W * 3));
+    data::TensorView decoded(
+        data::BufferView(color_temp_.data(), color_temp_.size(), core::DeviceType::kCpu),
+        core::DataType::kUint8, data::TensorShape({H, W, 3}));
+
+    core::Status s =
+        binned ? operators::DemosaicBinned(src, in->pixel_format, &decoded, format, config_.bayer)
+               : operators::Demosaic(src, in->pixel_format, &decoded, format, config_.bayer);
+    if (!s.ok()) {
+      context_->LogError("Preprocessor: Demosaic failed: " + s.message());
+      return;
+    }
+    geometry = data::Compose(geometry, data::PixelTransform::Scale(static_cast<double>(f), static_cast<double>(f)));
+    src = decoded;
+    out->pixel_format = format;
+  }
+
+  // Grayscale models get one luma channel before any resampling, so later
+  // stages touch a third of the data. YUV frames were decoded to gray above.
+  if ((config_.to_grayscale || config_.output_format == core::PixelFormat::kGray8) &&
+      src.shape().rank() == 3 && src.shape().dim(2) == 3) {
+    const std::int64_t H = src.shape().dim(0);
+    const std::int64_t W = src.shape().dim(1);
+    gray_temp_.resize(static_cast<std::size_t>(H * W) * src.element_size());
+    data::TensorView gray(
+        data::BufferView(gray_temp_.data(), gray_temp_.size(), core::DeviceType::kCpu),
+        src.dtype(), data::TensorShape({H, W, 1}));
+    core::Status s = out->pixel_format == core::PixelFormat::kBgr8
+                         ? operators::BgrToGray(src, &gray)
+                         : operators::RgbToGray(src, &gray);
+    if (!s.ok()) {
+      context_->LogError("Preprocessor: gray conversion failed: " + s.message());
+      return;
+    }
+    src = gray;
+    out->pixel_format = core::PixelFormat::kGray8;
+  }
+
+  // Undistortion resamples the whole frame through a fixed-point map that is
+  // computed once per frame size.
+  if (config_.undistort) {
+    if (src.shape().rank() != 3 || src.dtype() != core::DataType::kUint8) {
+      context_->LogError("Preprocessor: undistort expects a uint8 HWC frame");
+      return;
+    }
+    const std::int64_t H = src.shape().dim(0);
+    const std::int64_t W = src.shape().dim(1);
+    const std::int64_t C = src.shape().dim(2);
+    if (!undistorter_.initialized() || undistorter_.src_height() != H ||
+        undistorter_.src_width() != W) {
+      core::Status s = undistorter_.InitUndistort(config_.camera, config_.distortion,
+                                                  static_cast<int>(H), static_cast<int>(W),
+                                                  static_cast<int>(H), static_cast<int>(W));
+      if (!s.ok()) {
+        context_->LogError("Preprocessor: Remapper init failed: " + s.message());
+        return;
+      }
+    }
+    undistort_temp_.resize(static_cast<std::size_t>(H * W * C));
+    data::TensorView undistorted(
+        data::BufferView(undistort_temp_.data(), undistort_temp_.size(), core::DeviceType::kCpu),
+        core::DataType::kUint8, data::TensorShape({H, W, C}));
+    core::Status s = undistorter_.Apply(src, &undistorted);
+    if (!s.ok()) {
+      context_->LogError("Preprocessor: Remapper failed: " + s.message());
+      return;
+    }
+    src = undistorted;
+  }
+
+  // A vertical flip is a view with a negative row stride that every later step
+  // reads directly; other orientations are composed as views and copied once.
+  if (config_.flip != operators::FlipMode::kNone ||
+      config_.rotation != operators::Rotation::kNone) {
+    if (src.shape().rank() != 3) {
+      context_->LogError("Preprocessor: orientation expects an HWC frame");
+      return;
+    }
+    // Oriented pixels to src pixels: undo the rotation, then the flip.
+    const double H = static_cast<double>(src.shape().dim(0));
+    const double W = static_cast<double>(src.shape().dim(1));
+    const bool flip_x = config_.flip == operators::FlipMode::kHorizontal ||
+                        config_.flip == operators::FlipMode::kBoth;
+    const bool flip_y = config_.flip == operators::FlipMode::kVertical ||
+                        config_.flip == operators::FlipMode::kBoth;
+    const data::PixelTransform unflip(flip_x ? -1.0 : 1.0, 0.0, flip_x ? W : 0.0,
+                                      0.0, flip_y ? -1.0 : 1.0, flip_y ? H : 0.0);
+    data::PixelTransform unrotate;
+    switch (config_.rotation) {
+      case operators::Rotation::k90:
+        unrotate = data::PixelTransform(0.0, 1.0, 0.0, -1.0, 0.0, H);
+        break;
+      case operators::Rotation::k180:
+        unrotate = data::PixelTransform(-1.0, 0.0, W, 0.0, -1.0, H);
+        break;
+      case operators::Rotation::k270:
+        unrotate = data::PixelTransform(0.0, -1.0, W, 1.0, 0.0, 0.0);
+        break;
+      default:
+        break;
+    }
+    geometry = data::Compose(geometry, data::Compose(unflip, unrotate));
+
+    data::TensorView view;
+    core::Status s = operators::FlipView(src, config_.flip, &view);
+    if (s.ok()) {
+      s = operators::RotateView(view, config_.rotation, &view);
+    }
+    if (!s.ok()) {
+      context_->LogError("Preprocessor: orientation failed: " + s.message());
+      return;
+    }
+    if (config_.flip == operators::FlipMode::kVertical &&
+        config_.rotation == operators::Rotation::kNone) {
+      src = view;
+    } else {
+      orient_temp_.resize(src.bytes());
+      data::TensorView oriented(
+          data::BufferView(orient_temp_.data(), orient_temp_.size(), core::DeviceType::kCpu),
+          src.dtype(), view.shape());
+      s = operators::Flip(view, operators::FlipMode::kNone, &oriented);
+      if (!s.ok()) {
+        context_->LogError("Preprocessor: orientation failed: " + s.message());
+        return;
+      }
+      src = oriented;
+    }
+  }
+
+  // Resize to target by cropping (as a view, no copy) and padding (into the
+  // reused uint8 buffer), so the cast below reads only output-sized data.
+  if (config_.target_height > 0 && config_.target_width > 0) {
+    const core::TensorLayout layout =
+        config_.input_layout == core::TensorLayout::kChw ? core::TensorLayout::kChw
+                                                         : core::TensorLayout::kHwc;
+    const bool chw = layout == core::TensorLayout::kChw;
+    const std::int64_t H = src.shape().dim(chw ? 1 : 0);
+    const std::int64_t W = src.shape().dim(chw ? 2 : 1);
+    const std::int64_t C = src.shape().dim(chw ? 0 : 2);
+    const int crop_h = static_cast<int>(std::min<std::int64_t>(H, config_.target_height));
+    const int crop_w = static_cast<int>(std::min<std::int64_t>(W, config_.target_width));
+
+    if (crop_h != H || crop_w != W) {
+      core::Status s = operators::CenterCropView(src, crop_h, crop_w, &src, layout);
+      if (!s.ok()) {
+        context_->LogError("Preprocessor: CenterCropView failed: " + s.message());
+        return;
+      }
+      geometry = data::Compose(geometry, data::PixelTransform::Translate(
+                                             static_cast<double>((W - crop_w) / 2),
+                                             static_cast<double>((H - crop_h) / 2)));
+    }
+
+    if (crop_h != config_.target_height || crop_w != config_.target_width) {
+      const std::int64_t TH = config_.target_height;
+      const std::int64_t TW = config_.target_width;
+      uint8_temp_.resize(static_cast<std::size_t>(TH * TW * C));
+      data::TensorShape padded_shape(chw ? std::vector<std::int64_t>{C, TH, TW}
+                                         : std::vector<std::int64_t>{TH, TW, C});
+      data::TensorView padded(
+          data::BufferView(uint8_temp_.data(), uint8_temp_.size(), core::DeviceType::kCpu),
+          core::DataType::kUint8, padded_shape);
+
+      core::Status s = operators::PadToSize(src, config_.target_height, config_.target_width,
+                                            &padded, layout);
+      if (!s.ok()) {
+        context_->LogError("Preprocessor: PadToSize failed: " + s.message());
+        return;
+      }
+      geometry = data::Compose(geometry, data::PixelTransform::Translate(
+                                             -static_cast<double>((TW - crop_w) / 2),
+                                             -static_cast<double>((TH - crop_h) / 2)));
+      src = padded;
+    }
+  }
+
+  out->to_source = data::Compose(in->to_source, geometry);
+
+  const core::TensorLayout norm_layout =
+      config_.input_layout == core::TensorLayout::kUnknown ? core::TensorLayout::kHwc
+                                                           : config_.input_layout;
+
+  // Quantized models take uint8 pixels straight to int8 through one table.
+  if (config_.output_type == core::DataType::kInt8) {
+    const bool chw_output = config_.output_layout == core::TensorLayout::kChw ||
+                            config_.output_layout == core::TensorLayout::kNchw;
+    core::Status s = quantizer_.Apply(src, &out->image, norm_layout,
+                                      chw_output ? core::TensorLayout::kChw : core::TensorLayout::kHwc);
+    if (!s.ok()) {
+      context_->LogError("Preprocessor: ImageQuantizer failed: " + s.message());
+    }
+    return;
+  }
+
+  // HWC frames go from pixels to the model tensor in one tiled pass: channel
+  // swap, normalization, layout change and narrowing are fused.
+  if (chain_.compiled()) {
+    core::Status s = chain_.Run(src, &out->image);
+    if (!s.ok()) {
+      context_->LogError("Preprocessor: ElementwiseChain failed: " + s.message());
+    }
     return;
   }
 
+  // 16-bit float outputs are produced in float32 scratch and narrowed last.
+  const bool half_output = config_.output_type == core::DataType::kFloat16 ||
+                           config_.output_type == core::DataType::kBFloat16;
+  data::TensorView dst = out->image;
+  if (half_output) {
+    float_buffer_.resize(out->image.num_elements());
+    dst = data::TensorView(
+        data::BufferView(float_buffer_.data(), float_buffer_.size() * sizeof(float),
+                         core::DeviceType::kCpu),
+        core::DataType::kFloat32, out->image.shape());
+  }
+
+  if (src.num_elements() != dst.num_elements()) {
+    context_->LogError("Preprocessor: output tensor size does not match the preprocessed frame");
+    return;
+  }
+  // Normalization sees dst in the frame's own shape, without the batch dim.
+  data::TensorView frame_dst(dst.buffer(), core::DataType::kFloat32, src.shape());
+
+  // Normalizing a packed uint8 frame is a single table lookup per element,
+  // which also covers the cast.
+  if (config_.normalize && src.dtype() == core::DataType::kUint8 && src.is_contiguous()) {
+    core::Status s = normalizer_.Apply(src, &frame_dst, norm_layout);
+    if (!s.ok()) {
+      context_->LogError("Preprocessor: Normalize failed: " + s.message());
+      return;
+    }
+  } else {
+    core::Status s = operators::CastUint8ToFloat32(src, &dst);
+    if (!s.ok()) {
+      context_->LogError("Preprocessor: CastUint8ToFloat32 failed: " + s.message());
+      return;
+    }
+
+    if (config_.normalize) {
+      s = normalizer_.Apply(&frame_dst, norm_layout);
+      if (!s.ok()) {
+        context_->LogError("Preprocessor: Normalize failed: " + s.message());
+        return;
+      }
+    }
+  }
+
+  if (half_output) {
+    core::Status s = config_.output_type == core::DataType::kFloat16
+                         ? operators::CastFloat32ToFloat16(dst, &out->image)
+                         : operators::CastFloat32ToBFloat16(dst, &out->image);
+    if (!s.ok()) {
+      context_->LogError("Preprocessor: half precision cast failed: " + s.message());
+      return;
+    }
+  }
 }
 
 }  // namespace ptk
@@ -0,0 +1,481 @@
+#include "operators/quantize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "operators/kernel_dispatch.h"
+#include "operators/simd.h"
+#include "runtime/core/status.h"
+#include "runtime/core/thread_pool.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+#if defined(PTK_SIMD_NEON64)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace ptk::operators
+{
+        namespace
+        {
+            constexpr std::int64_t kMinParallelElements = 1 << 16;
+
+            template <typename Q>
+            struct QuantRange;
+
+            template <>
+            struct QuantRange<std::int8_t>
+            {
+                static constexpr float kMin = -128.0f;
+                static constexpr float kMax = 127.0f;
+            };
+
+            template <>
+            struct QuantRange<std::uint8_t>
+            {
+                static constexpr float kMin = 0.0f;
+                static constexpr float kMax = 255.0f;
+            };
+
+            template <typename Q>
+            Q QuantizeScalar(float x, float scale, float zero_point)
+            {
+                float v = std::nearbyint(x / scale) + zero_point;
+                if (!(v >= QuantRange<Q>::kMin))
+                {
+                    v = QuantRange<Q>::kMin;
+                }
+                if (v > QuantRange<Q>::kMax)
+                {
+                    v = QuantRange<Q>::kMax;
+                }
+                return static_cast<Q>(v);
+            }
+
+            // Quantizes n elements. scale and zero_point give the value for each
+            // lane over a repeating period that is a multiple of 4, so vectors
+            // always line up with the same slice of the pattern.
+            template <typename Q, int N>
+            void QuantizeRun(const float *x, std::int64_t n, const float *scale, const std::int32_t *zero_point,
+                             std::int64_t runtime_channels, Q *out)
+            {
+                const std::int64_t period = 4 * ChannelCount<N>(runtime_channels);
+                std::int64_t i = 0;
+                for (; i + period <= n; i += period)
+                {
+                    std::int64_t j = 0;
+#if defined(PTK_SIMD_NEON64)
+                    for (; j < period; j += 4)
+                    {
+                        float32x4_t v = vdivq_f32(vld1q_f32(x + i + j), vld1q_f32(scale + j));
+                        // Keep the integer conversion in range; saturation does the rest.
+                        v = vmaxq_f32(vminq_f32(v, vdupq_n_f32(32767.0f)), vdupq_n_f32(-32768.0f));
+                        const int32x4_t q = vaddq_s32(vcvtnq_s32_f32(v), vld1q_s32(zero_point + j));
+                        const int16x4_t q16 = vqmovn_s32(q);
+                        std::uint32_t bits;
+                        if (std::is_signed<Q>::value)
+                        {
+                            bits = vget_lane_u32(vreinterpret_u32_s8(vqmovn_s16(vcombine_s16(q16, q16))), 0);
+                        }
+                        else
+                        {
+                            bits = vget_lane_u32(vreinterpret_u32_u8(vqmovun_s16(vcombine_s16(q16, q16))), 0);
+                        }
+                        std::memcpy(out + i + j, &bits, sizeof(bits));
+                    }
+#elif defined(PTK_SIMD_SSE2)
+                    const __m128 lo = _mm_set1_ps(-32768.0f);
+                    const __m128 hi = _mm_set1_ps(32767.0f);
+                    for (; j < period; j += 4)
+                    {
+                        __m128 v = _mm_div_ps(_mm_loadu_ps(x + i + j), _mm_loadu_ps(scale + j));
+                        // Keep cvtps in range (it returns INT_MIN on overflow);
+                        // the saturating packs clamp to the 8-bit range.
+                        v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+                        const __m128i q = _mm_add_epi32(
+                            _mm_cvtps_epi32(v),
+                            _mm_loadu_si128(reinterpret_cast<const __m128i *>(zero_point + j)));
+                        const __m128i q16 = _mm_packs_epi32(q, q);
+                        const __m128i q8 = std::is_signed<Q>::value ? _mm_packs_epi16(q16, q16)
+                                                                    : _mm_packus_epi16(q16, q16);
+                        const std::int32_t bits = _mm_cvtsi128_si32(q8);
+                        std::memcpy(out + i + j, &bits, sizeof(bits));
+                    }
+#endif
+                    for (; j < period; ++j)
+                    {
+                        out[i + j] = QuantizeScalar<Q>(x[i + j], scale[j], static_cast<float>(zero_point[j]));
+                    }
+                }
+                for (std::int64_t j = 0; i < n; ++i, ++j)
+                {
+                    out[i] = QuantizeScalar<Q>(x[i], scale[j], static_cast<float>(zero_point[j]));
+                }
+            }
+
+            template <typename Q>
+            void QuantizeImpl(const float *in, Q *out, std::int64_t outer, std::int64_t channels,
+                              std::int64_t inner, const QuantizationParams &params)
+            {
+                const bool per_tensor = params.scales.size() == 1;
+
+                if (inner == 1)
+                {
+                    // Channels are innermost (or per-tensor): repeat them to 4 * C lanes.
+                    const std::int64_t period = 4 * channels;
+                    std::vector<float> scale(static_cast<std::size_t>(period));
+                    std::vector<std::int32_t> zero_point(static_cast<std::size_t>(period));
+                    for (std::int64_t j = 0; j < period; ++j)
+                    {
+                        const std::size_t c = per_tensor ? 0 : static_cast<std::size_t>(j % channels);
+                        scale[j] = params.scales[c];
+                        zero_point[j] = params.zero_points[c];
+                    }
+                    // Split on whole periods so every chunk starts on channel 0.
+                    const std::int64_t total = outer * channels;
+                    DispatchChannels(channels, [&](auto pattern) {
+                        core::ThreadPool::Default().ParallelFor(
+                            0, (total + period - 1) / period, std::max<std::int64_t>(1, kMinParallelElements / period),
+                            [&](std::int64_t b, std::int64_t e) {
+                                const std::int64_t begin = b * period;
+                                const std::int64_t end = std::min(total, e * period);
+                                QuantizeRun<Q, decltype(pattern)::value>(in + begin, end - begin, scale.data(),
+                                                                         zero_point.data(), channels, out + begin);
+                            });
+                    });
+                    return;
+                }
+
+                // Each channel covers a contiguous run of inner elements.
+                for (std::int64_t o = 0; o < outer; ++o)
+                {
+                    for (std::int64_t c = 0; c < channels; ++c)
+                    {
+                        const float s = params.scales[static_cast<std::size_t>(c)];
+                        const std::int32_t z = params.zero_points[static_cast<std::size_t>(c)];
+                        const float scale[4] = {s, s, s, s};
+                        const std::int32_t zero_point[4] = {z, z, z, z};
+                        const std::int64_t offset = (o * channels + c) * inner;
+                        QuantizeRun<Q, 1>(in + offset, inner, scale, zero_point, 1, out + offset);
+                    }
+                }
+            }
+
+            // Image rows h0..h1 through the table of each output channel. Source
+            // and destination are HWC or CHW; N is the channel count when known at
+            // compile time. CHW sources are addressed by plane and row stride so
+            // crop views are read in place.
+            template <core::TensorLayout SrcL, core::TensorLayout DstL, int N>
+            void LookupImageRows(const std::uint8_t *in, std::int64_t plane_stride, std::int64_t row_stride,
+                                 std::uint8_t *out, std::int64_t h0, std::int64_t h1, std::int64_t W,
+                                 std::int64_t H, std::int64_t runtime_channels, const int *channel_map,
+                                 const std::uint8_t (*lut)[256])
+            {
+                const std::int64_t C = ChannelCount<N>(runtime_channels);
+                constexpr bool src_hwc = SrcL == core::TensorLayout::kHwc;
+                constexpr bool dst_hwc = DstL == core::TensorLayout::kHwc;
+                for (std::int64_t h = h0; h < h1; ++h)
+                {
+                    if constexpr (src_hwc && dst_hwc)
+                    {
+                        const std::uint8_t *row_in = in + h * row_stride;
+                        std::uint8_t *row_out = out + h * W * C;
+                        for (std::int64_t w = 0; w < W; ++w)
+                        {
+                            for (std::int64_t c = 0; c < C; ++c)
+                            {
+                                row_out[w * C + c] = lut[c][row_in[w * C + channel_map[c]]];
+                            }
+                        }
+                    }
+                    else
+                    {
+                        for (std::int64_t c = 0; c < C; ++c)
+                        {
+                            const std::uint8_t *channel_lut = lut[c];
+                            const std::int64_t sc = channel_map[c];
+                            const std::uint8_t *row_in =
+                                src_hwc ? in + h * row_stride + sc : in + sc * plane_stride + h * row_stride;
+                            std::uint8_t *row_out = dst_hwc ? out + h * W * C + c : out + (c * H + h) * W;
+                            const std::int64_t in_step = src_hwc ? C : 1;
+                            const std::int64_t out_step = dst_hwc ? C : 1;
+                            for (std::int64_t w = 0; w < W; ++w)
+                            {
+                                row_out[w * out_step] = channel_lut[row_in[w * in_step]];
+                            }
+                        }
+                    }
+                }
+            }
+        } // namespace
+
+        core::Status ResolveQuantizationAxis(const data::TensorShape &shape, const QuantizationParams &params,
+                                             std::int64_t *outer, std::int64_t *channels, std::int64_t *inner)
+        {
+            if (params.scales.empty() || params.scales.size() != params.zero_points.size())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Quantization: need one zero point per scale");
+            }
+            for (float s : params.scales)
+            {
+                if (!(s > 0.0f))
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "Quantization: scales must be positive");
+                }
+            }
+
+            if (params.scales.size() == 1)
+            {
+                *outer = shape.num_elements();
+                *channels = 1;
+                *inner = 1;
+                return core::Status::Ok();
+            }
+
+            if (params.axis < 0 || static_cast<std::size_t>(params.axis) >= shape.rank())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Quantization: axis out of range");
+            }
+            const std::size_t axis = static_cast<std::size_t>(params.axis);
+            if (shape.dim(axis) != static_cast<std::int64_t>(params.scales.size()))
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Quantization: scale count must match the axis dim");
+            }
+
+            *outer = 1;
+            for (std::size_t i = 0; i < axis; ++i)
+            {
+                *outer *= shape.dim(i);
+            }
+            *channels = shape.dim(axis);
+            *inner = 1;
+            for (std::size_t i = axis + 1; i < shape.rank(); ++i)
+            {
+                *inner *= shape.dim(i);
+            }
+            return core::Status::Ok();
+        }
+
+        core::Status Quantize(const data::TensorView &src, const QuantizationParams &params, data::TensorView *dst)
+        {
+            if (dst == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Quantize: dst is null");
+            }
+            if (src.dtype() != core::DataType::kFloat32 ||
+                (dst->dtype() != core::DataType::kInt8 && dst->dtype() != core::DataType::kUint8))
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Quantize: expects float32 src and int8 or uint8 dst");
+            }
+            if (src.shape().dims() != dst->shape().dims())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Quantize: shape mismatch");
+            }
+            if (!src.is_contiguous() || !dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Quantize: expects contiguous tensors");
+            }
+
+            std::int64_t outer = 0;
+            std::int64_t channels = 0;
+            std::int64_t inner = 0;
+            core::Status s = ResolveQuantizationAxis(src.shape(), params, &outer, &channels, &inner);
+            if (!s.ok())
+            {
+                return s;
+            }
+
+            const float *in = static_cast<const float *>(src.buffer().data());
+            void *out = dst->buffer().data();
+            if (in == nullptr || out == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Quantize: null buffer data");
+            }
+
+            if (dst->dtype() == core::DataType::kInt8)
+            {
+                QuantizeImpl(in, static_cast<std::int8_t *>(out), outer, channels, inner, params);
+            }
+            else
+            {
+                QuantizeImpl(in, static_cast<std::uint8_t *>(out), outer, channels, inner, params);
+            }
+            return core::Status::Ok();
+        }
+
+        ImageQuantizer::ImageQuantizer()
+            : num_channels_(0), dtype_(core::DataType::kUnknown), channel_map_{0, 1, 2, 3}, lut_()
+        {
+        }
+
+        core::Status ImageQuantizer::Init(const NormalizationParams &norm, const QuantizationParams &params,
+                                          core::DataType dtype, bool swap_rb)
+        {
+            if (dtype != core::DataType::kInt8 && dtype != core::DataType::kUint8)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ImageQuantizer: dtype must be int8 or uint8");
+            }
+            if (norm.num_channels <= 0 || norm.num_channels > 4)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ImageQuantizer: num_channels must be in [1,4]");
+            }
+            if (swap_rb && norm.num_channels < 3)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ImageQuantizer: swap_rb needs at least 3 channels");
+            }
+            if (params.scales.empty() || params.scales.size() != params.zero_points.size() ||
+                (params.scales.size() != 1 &&
+                 params.scales.size() != static_cast<std::size_t>(norm.num_channels)))
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ImageQuantizer: need one scale, or one per channel");
+            }
+
+            for (int c = 0; c < norm.num_channels; ++c)
+            {
+                const std::size_t qc = params.scales.size() == 1 ? 0 : static_cast<std::size_t>(c);
+                const float scale = params.scales[qc];
+                const float zero_point = static_cast<float>(params.zero_points[qc]);
+                if (norm.std[c] == 0.0f || !(scale > 0.0f))
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  "ImageQuantizer: std and scale must be non zero");
+                }
+                for (int v = 0; v < 256; ++v)
+                {
+                    // Same arithmetic as Normalize followed by Quantize.
+                    const float x = (static_cast<float>(v) - norm.mean[c]) / norm.std[c];
+                    if (dtype == core::DataType::kInt8)
+                    {
+                        const std::int8_t q = QuantizeScalar<std::int8_t>(x, scale, zero_point);
+                        std::memcpy(&lut_[c][v], &q, 1);
+                    }
+                    else
+                    {
+                        lut_[c][v] = QuantizeScalar<std::uint8_t>(x, scale, zero_point);
+                    }
+                }
+                channel_map_[c] = c;
+            }
+            if (swap_rb)
+            {
+                channel_map_[0] = 2;
+                channel_map_[2] = 0;
+            }
+
+            num_channels_ = norm.num_channels;
+            dtype_ = dtype;
+            return core::Status::Ok();
+        }
+
+        core::Status ImageQuantizer::Apply(const data::TensorView &src, data::TensorView *dst,
+                                           core::TensorLayout layout, core::TensorLayout dst_layout) const
+        {
+            if (dst == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ImageQuantizer: dst is null");
+            }
+            if (!initialized())
+            {
+                return core::Status(core::StatusCode::kFailedPrecondition,
+                              "ImageQuantizer: Init must be called first");
+            }
+            if (src.dtype() != core::DataType::kUint8 || dst->dtype() != dtype_)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ImageQuantizer: expects uint8 src and dst of the Init dtype");
+            }
+            if ((layout != core::TensorLayout::kHwc && layout != core::TensorLayout::kChw) ||
+                (dst_layout != core::TensorLayout::kHwc && dst_layout != core::TensorLayout::kChw))
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ImageQuantizer: layouts must be HWC or CHW");
+            }
+            if (src.shape().rank() != 3)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ImageQuantizer: expects a rank 3 src");
+            }
+
+            const bool src_hwc = layout == core::TensorLayout::kHwc;
+            const std::int64_t H = src.shape().dim(src_hwc ? 0 : 1);
+            const std::int64_t W = src.shape().dim(src_hwc ? 1 : 2);
+            const std::int64_t C = src.shape().dim(src_hwc ? 2 : 0);
+            if (C != num_channels_)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ImageQuantizer: channel count differs from Init");
+            }
+
+            const bool dst_hwc = dst_layout == core::TensorLayout::kHwc;
+            const std::vector<std::int64_t> expected = dst_hwc ? std::vector<std::int64_t>{H, W, C}
+                                                               : std::vector<std::int64_t>{C, H, W};
+            std::vector<std::int64_t> dims = dst->shape().dims();
+            if (dims.size() == 4 && dims[0] == 1)
+            {
+                dims.erase(dims.begin());
+            }
+            if (dims != expected)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              dst_hwc ? "ImageQuantizer: dst shape must be [H,W,C]"
+                                      : "ImageQuantizer: dst shape must be [C,H,W]");
+            }
+            if (!dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ImageQuantizer: dst must be contiguous");
+            }
+
+            // Packed-row views (crops) are read in place.
+            if (src.stride(2) != 1 || (src_hwc && src.stride(1) != C))
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ImageQuantizer: src rows must be packed");
+            }
+            const std::int64_t plane_stride = src_hwc ? 0 : src.stride(0);
+            const std::int64_t row_stride = src_hwc ? src.stride(0) : src.stride(1);
+
+            const std::uint8_t *in = static_cast<const std::uint8_t *>(src.buffer().data());
+            std::uint8_t *out = static_cast<std::uint8_t *>(dst->buffer().data());
+            if (in == nullptr || out == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "ImageQuantizer: null buffer data");
+            }
+
+            const std::int64_t min_rows = std::max<std::int64_t>(1, kMinParallelElements / (W * C));
+            DispatchLayout<core::TensorLayout::kHwc, core::TensorLayout::kChw>(layout, [&](auto src_layout) {
+                DispatchLayout<core::TensorLayout::kHwc, core::TensorLayout::kChw>(dst_layout, [&](auto out_layout) {
+                    DispatchChannels(C, [&](auto channels) {
+                        core::ThreadPool::Default().ParallelFor(0, H, min_rows, [&](std::int64_t h0, std::int64_t h1) {
+                            LookupImageRows<decltype(src_layout)::value, decltype(out_layout)::value,
+                                            decltype(channels)::value>(in, plane_stride, row_stride, out, h0, h1,
+                                                                       W, H, C, channel_map_, lut_);
+                        });
+                    });
+                });
+            });
+
+            return core::Status::Ok();
+        }
+} // namespace ptk::operators
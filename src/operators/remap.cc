@@ -0,0 +1,322 @@
+#include "operators/remap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "operators/kernel_dispatch.h"
+#include "operators/simd.h"
+#include "runtime/core/status.h"
+#include "runtime/core/thread_pool.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+#if defined(PTK_SIMD_NEON)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace ptk::operators
+{
+        namespace
+        {
+            // Below this many output pixels a frame is remapped on the calling thread.
+            constexpr std::int64_t kMinParallelElements = 1 << 15;
+
+            // Sub-pixel positions per source pixel; fractions run 0..kFracSteps
+            // inclusive so the last row and column are reachable exactly.
+            constexpr int kFracSteps = 32;
+
+            std::uint32_t Load32(const std::uint8_t *p)
+            {
+                std::uint32_t v;
+                std::memcpy(&v, p, sizeof(v));
+                return v;
+            }
+
+            // Remaps n output pixels. Each one reads the 2x2 source block at
+            // offsets[i]; the vector path loads 4 bytes per source pixel, so it
+            // is used while the bottom-right load stays below `limit`.
+            template <int N>
+            void RemapRun(const std::uint8_t *src, std::int64_t row_bytes, std::int64_t runtime_channels,
+                          std::int64_t limit, const std::int32_t *offsets, const std::uint16_t *weights,
+                          const std::uint32_t (*table)[2], std::int64_t n, std::uint8_t *out)
+            {
+                const std::int64_t C = ChannelCount<N>(runtime_channels);
+                for (std::int64_t i = 0; i < n; ++i, out += C)
+                {
+                    if (offsets[i] < 0)
+                    {
+                        std::memset(out, 0, static_cast<std::size_t>(C));
+                        continue;
+                    }
+                    const std::uint8_t *p0 = src + offsets[i] * C;
+                    const std::uint8_t *p1 = p0 + row_bytes;
+                    const std::uint32_t *w = table[weights[i]];
+#if defined(PTK_SIMD_NEON) || defined(PTK_SIMD_SSE2)
+                    if (N > 0 && p1 + C - src <= limit)
+                    {
+#if defined(PTK_SIMD_NEON)
+                        auto widen = [](const std::uint8_t *p)
+                        { return vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(Load32(p))))); };
+                        uint32x4_t acc = vmull_n_u16(widen(p0), static_cast<std::uint16_t>(w[0]));
+                        acc = vmlal_n_u16(acc, widen(p0 + C), static_cast<std::uint16_t>(w[0] >> 16));
+                        acc = vmlal_n_u16(acc, widen(p1), static_cast<std::uint16_t>(w[1]));
+                        acc = vmlal_n_u16(acc, widen(p1 + C), static_cast<std::uint16_t>(w[1] >> 16));
+                        const uint16x4_t v = vrshrn_n_u32(acc, 14);
+                        const std::uint32_t px = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(v, v))), 0);
+#else
+                        // Pixels of a row become (left, right) 16-bit pairs per
+                        // channel, so one madd applies both horizontal weights.
+                        const __m128i zero = _mm_setzero_si128();
+                        auto pairs = [&](const std::uint8_t *p)
+                        {
+                            const __m128i v = _mm_unpacklo_epi8(
+                                _mm_unpacklo_epi32(_mm_cvtsi32_si128(static_cast<int>(Load32(p))),
+                                                   _mm_cvtsi32_si128(static_cast<int>(Load32(p + C)))),
+                                zero);
+                            return _mm_unpacklo_epi16(v, _mm_srli_si128(v, 8));
+                        };
+                        __m128i acc = _mm_add_epi32(
+                            _mm_madd_epi16(pairs(p0), _mm_set1_epi32(static_cast<int>(w[0]))),
+                            _mm_madd_epi16(pairs(p1), _mm_set1_epi32(static_cast<int>(w[1]))));
+                        acc = _mm_srli_epi32(_mm_add_epi32(acc, _mm_set1_epi32(1 << 13)), 14);
+                        acc = _mm_packs_epi32(acc, acc);
+                        const std::uint32_t px = static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(acc, acc)));
+#endif
+                        std::memcpy(out, &px, static_cast<std::size_t>(C));
+                        continue;
+                    }
+#endif
+                    const std::uint32_t w00 = w[0] & 0xFFFF;
+                    const std::uint32_t w01 = w[0] >> 16;
+                    const std::uint32_t w10 = w[1] & 0xFFFF;
+                    const std::uint32_t w11 = w[1] >> 16;
+                    for (std::int64_t c = 0; c < C; ++c)
+                    {
+                        out[c] = static_cast<std::uint8_t>(
+                            (p0[c] * w00 + p0[C + c] * w01 + p1[c] * w10 + p1[C + c] * w11 + (1 << 13)) >> 14);
+                    }
+                }
+            }
+        } // namespace
+
+        Remapper::Remapper()
+            : src_height_(0),
+              src_width_(0),
+              out_height_(0),
+              out_width_(0),
+              offsets_(),
+              weights_(),
+              table_()
+        {
+        }
+
+        core::Status Remapper::InitUndistort(const CameraIntrinsics &camera, const DistortionCoefficients &distortion,
+                                             int src_height, int src_width, int out_height, int out_width,
+                                             const CameraIntrinsics *new_camera)
+        {
+            if (camera.fx <= 0.0f || camera.fy <= 0.0f || src_height <= 0 || src_width <= 0 || out_height <= 0 ||
+                out_width <= 0)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: invalid camera or image size");
+            }
+
+            // Default output camera: the input one rescaled to the output size,
+            // with pixel centres kept aligned.
+            CameraIntrinsics out = camera;
+            if (new_camera != nullptr)
+            {
+                out = *new_camera;
+            }
+            else
+            {
+                const float sx = static_cast<float>(out_width) / static_cast<float>(src_width);
+                const float sy = static_cast<float>(out_height) / static_cast<float>(src_height);
+                out.fx = camera.fx * sx;
+                out.fy = camera.fy * sy;
+                out.cx = (camera.cx + 0.5f) * sx - 0.5f;
+                out.cy = (camera.cy + 0.5f) * sy - 0.5f;
+            }
+            if (out.fx <= 0.0f || out.fy <= 0.0f)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: invalid output camera");
+            }
+
+            const std::size_t count = static_cast<std::size_t>(out_height) * static_cast<std::size_t>(out_width);
+            std::vector<float> map_x(count);
+            std::vector<float> map_y(count);
+            const double k1 = distortion.k1;
+            const double k2 = distortion.k2;
+            const double k3 = distortion.k3;
+            const double p1 = distortion.p1;
+            const double p2 = distortion.p2;
+            for (int v = 0; v < out_height; ++v)
+            {
+                const double y = (v - out.cy) / out.fy;
+                for (int u = 0; u < out_width; ++u)
+                {
+                    const double x = (u - out.cx) / out.fx;
+                    const double r2 = x * x + y * y;
+                    const double radial = 1.0 + r2 * (k1 + r2 * (k2 + r2 * k3));
+                    const double xd = x * radial + 2.0 * p1 * x * y + p2 * (r2 + 2.0 * x * x);
+                    const double yd = y * radial + p1 * (r2 + 2.0 * y * y) + 2.0 * p2 * x * y;
+                    const std::size_t i = static_cast<std::size_t>(v) * static_cast<std::size_t>(out_width) +
+                                          static_cast<std::size_t>(u);
+                    map_x[i] = static_cast<float>(camera.fx * xd + camera.cx);
+                    map_y[i] = static_cast<float>(camera.fy * yd + camera.cy);
+                }
+            }
+            return Init(map_x, map_y, src_height, src_width, out_height, out_width);
+        }
+
+        core::Status Remapper::Init(const std::vector<float> &map_x, const std::vector<float> &map_y,
+                                    int src_height, int src_width, int out_height, int out_width)
+        {
+            if (src_height < 2 || src_width < 2 || out_height <= 0 || out_width <= 0)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: source must be at least 2x2 and output non-empty");
+            }
+            const std::size_t count = static_cast<std::size_t>(out_height) * static_cast<std::size_t>(out_width);
+            if (map_x.size() != count || map_y.size() != count)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: map size does not match the output size");
+            }
+
+            for (int fy = 0; fy <= kFracSteps; ++fy)
+            {
+                for (int fx = 0; fx <= kFracSteps; ++fx)
+                {
+                    // Q14: the four weights sum to 32 * 32 * 16 = 16384.
+                    const std::uint32_t w00 = static_cast<std::uint32_t>((kFracSteps - fx) * (kFracSteps - fy) * 16);
+                    const std::uint32_t w01 = static_cast<std::uint32_t>(fx * (kFracSteps - fy) * 16);
+                    const std::uint32_t w10 = static_cast<std::uint32_t>((kFracSteps - fx) * fy * 16);
+                    const std::uint32_t w11 = static_cast<std::uint32_t>(fx * fy * 16);
+                    table_[fy * (kFracSteps + 1) + fx][0] = w00 | w01 << 16;
+                    table_[fy * (kFracSteps + 1) + fx][1] = w10 | w11 << 16;
+                }
+            }
+
+            offsets_.resize(count);
+            weights_.resize(count);
+            const float max_x = static_cast<float>(src_width - 1);
+            const float max_y = static_cast<float>(src_height - 1);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                float x = map_x[i];
+                float y = map_y[i];
+                // Within half a pixel of the image the edge is replicated;
+                // further out (or NaN) the pixel is left black.
+                if (!(x >= -0.5f && x <= max_x + 0.5f && y >= -0.5f && y <= max_y + 0.5f))
+                {
+                    offsets_[i] = -1;
+                    weights_[i] = 0;
+                    continue;
+                }
+                x = std::min(std::max(x, 0.0f), max_x);
+                y = std::min(std::max(y, 0.0f), max_y);
+                // The block's top-left corner stays one pixel inside the right
+                // and bottom edges; those edges are reached with a full fraction.
+                const int x0 = std::min(static_cast<int>(x), src_width - 2);
+                const int y0 = std::min(static_cast<int>(y), src_height - 2);
+                const int fx = static_cast<int>(std::lround((x - static_cast<float>(x0)) * kFracSteps));
+                const int fy = static_cast<int>(std::lround((y - static_cast<float>(y0)) * kFracSteps));
+                offsets_[i] = y0 * src_width + x0;
+                weights_[i] = static_cast<std::uint16_t>(fy * (kFracSteps + 1) + fx);
+            }
+
+            src_height_ = src_height;
+            src_width_ = src_width;
+            out_height_ = out_height;
+            out_width_ = out_width;
+            return core::Status::Ok();
+        }
+
+        core::Status Remapper::Apply(const data::TensorView &src, data::TensorView *dst) const
+        {
+            if (!initialized())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: not initialized");
+            }
+            if (dst == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: dst is null");
+            }
+            if (src.dtype() != core::DataType::kUint8 || dst->dtype() != core::DataType::kUint8)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: expects uint8 tensors");
+            }
+
+            const data::TensorShape &sshape = src.shape();
+            const data::TensorShape &dshape = dst->shape();
+            if (sshape.rank() != 3 || dshape.rank() != 3)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: expects rank 3 HWC tensors");
+            }
+            const std::int64_t C = sshape.dim(2);
+            if (C < 1 || C > 4)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: expects 1 to 4 channels");
+            }
+            if (sshape.dim(0) != src_height_ || sshape.dim(1) != src_width_)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: src size does not match the map");
+            }
+            if (dshape.dim(0) != out_height_ || dshape.dim(1) != out_width_ || dshape.dim(2) != C)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: dst must be [out_height, out_width, C]");
+            }
+            if (!src.is_contiguous() || !dst->is_contiguous())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: expects contiguous tensors");
+            }
+
+            const std::uint8_t *in = static_cast<const std::uint8_t *>(src.buffer().data());
+            std::uint8_t *out = static_cast<std::uint8_t *>(dst->buffer().data());
+            if (in == nullptr || out == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "Remapper: null buffer data");
+            }
+
+            const std::int64_t W = out_width_;
+            const std::int64_t row_bytes = static_cast<std::int64_t>(src_width_) * C;
+            // Last byte offset at which a 4-byte load stays inside src.
+            const std::int64_t limit = static_cast<std::int64_t>(src_height_) * row_bytes - 4;
+            const std::int32_t *offsets = offsets_.data();
+            const std::uint16_t *weights = weights_.data();
+            const std::uint32_t(*table)[2] = table_;
+
+            std::function<void(std::int64_t, std::int64_t)> fn;
+            DispatchChannels(C, [&](auto channels)
+                             {
+                                 fn = [=](std::int64_t y0, std::int64_t y1)
+                                 {
+                                     RemapRun<decltype(channels)::value>(in, row_bytes, C, limit, offsets + y0 * W,
+                                                                         weights + y0 * W, table, (y1 - y0) * W,
+                                                                         out + y0 * W * C);
+                                 };
+                             });
+
+            const std::int64_t min_rows = W >= kMinParallelElements ? 1 : kMinParallelElements / W;
+            core::ThreadPool::Default().ParallelFor(0, out_height_, min_rows, fn);
+
+            return core::Status::Ok();
+        }
+} // namespace ptk::operators
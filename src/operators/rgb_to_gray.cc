@@ -1,86 +1,240 @@
 #include "operators/rgb_to_gray.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "operators/interleave.h"
+#include "operators/simd.h"
 #include "runtime/core/status.h"
+#include "runtime/core/thread_pool.h"
 #include "runtime/core/types.h"
 #include "runtime/data/tensor.h"
 
+#if defined(PTK_SIMD_NEON)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
 namespace ptk::operators
 {
-        core::Status RgbToGray(const data::TensorView &src, data::TensorView *dst)
+        namespace
         {
-            if (dst == nullptr)
+            // Below this many pixels a frame is converted on the calling thread.
+            constexpr std::int64_t kMinParallelElements = 1 << 15;
+
+            // Pixels split into planar scratch at a time, so the three scratch
+            // runs stay in L1.
+            constexpr std::int64_t kTileWidth = 256;
+
+            // Per-channel weights in source channel order, as floats and as Q16
+            // integers that sum to 65536 so white maps to 255 exactly.
+            struct Weights
             {
-                return core::Status(core::StatusCode::kInvalidArgument,
-                              "RgbToGray: dst is null");
-            }
+                float f[3];
+                std::uint32_t q[3];
+            };
 
-            if (src.dtype() != core::DataType::kFloat32 ||
-                dst->dtype() != core::DataType::kFloat32)
+            Weights MakeWeights(LumaWeights luma, bool bgr)
             {
-                return core::Status(core::StatusCode::kInvalidArgument,
-                              "RgbToGray: expects float32 src and dst");
+                Weights w;
+                if (luma == LumaWeights::kBt709)
+                {
+                    w = {{0.2126f, 0.7152f, 0.0722f}, {13933, 46871, 4732}};
+                }
+                else
+                {
+                    w = {{0.299f, 0.587f, 0.114f}, {19595, 38470, 7471}};
+                }
+                if (bgr)
+                {
+                    std::swap(w.f[0], w.f[2]);
+                    std::swap(w.q[0], w.q[2]);
+                }
+                return w;
             }
 
-            const data::TensorShape &sshape = src.shape();
-            const data::TensorShape &dshape = dst->shape();
-
-            if (sshape.rank() != 3 || dshape.rank() != 3)
+            // gray = sum((c * q) >> 8) rounded by a final >> 8. Each term is the
+            // 16-bit multiply-high of (c << 8) and q, which the SIMD paths use.
+            void WeightedSum(const std::uint8_t *c0, const std::uint8_t *c1, const std::uint8_t *c2,
+                             std::int64_t W, const std::uint32_t *q, std::uint8_t *out)
             {
-                return core::Status(core::StatusCode::kInvalidArgument,
-                              "RgbToGray: expects rank 3 HWC tensors");
+                std::int64_t w = 0;
+#if defined(PTK_SIMD_NEON)
+                const uint16x4_t q0 = vdup_n_u16(static_cast<std::uint16_t>(q[0]));
+                const uint16x4_t q1 = vdup_n_u16(static_cast<std::uint16_t>(q[1]));
+                const uint16x4_t q2 = vdup_n_u16(static_cast<std::uint16_t>(q[2]));
+                auto term = [](uint16x8_t x, uint16x4_t k)
+                {
+                    return vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(x), k), 8),
+                                        vshrn_n_u32(vmull_u16(vget_high_u16(x), k), 8));
+                };
+                for (; w + 8 <= W; w += 8)
+                {
+                    const uint16x8_t sum = vaddq_u16(vaddq_u16(term(vmovl_u8(vld1_u8(c0 + w)), q0),
+                                                               term(vmovl_u8(vld1_u8(c1 + w)), q1)),
+                                                     term(vmovl_u8(vld1_u8(c2 + w)), q2));
+                    vst1_u8(out + w, vmovn_u16(vrshrq_n_u16(sum, 8)));
+                }
+#elif defined(PTK_SIMD_SSE2)
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i half = _mm_set1_epi16(128);
+                const __m128i q0 = _mm_set1_epi16(static_cast<short>(q[0]));
+                const __m128i q1 = _mm_set1_epi16(static_cast<short>(q[1]));
+                const __m128i q2 = _mm_set1_epi16(static_cast<short>(q[2]));
+                for (; w + 16 <= W; w += 16)
+                {
+                    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c0 + w));
+                    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c1 + w));
+                    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c2 + w));
+                    __m128i lo = _mm_add_epi16(_mm_mulhi_epu16(_mm_unpacklo_epi8(zero, a), q0),
+                                               _mm_mulhi_epu16(_mm_unpacklo_epi8(zero, b), q1));
+                    __m128i hi = _mm_add_epi16(_mm_mulhi_epu16(_mm_unpackhi_epi8(zero, a), q0),
+                                               _mm_mulhi_epu16(_mm_unpackhi_epi8(zero, b), q1));
+                    lo = _mm_add_epi16(_mm_add_epi16(lo, _mm_mulhi_epu16(_mm_unpacklo_epi8(zero, c), q2)), half);
+                    hi = _mm_add_epi16(_mm_add_epi16(hi, _mm_mulhi_epu16(_mm_unpackhi_epi8(zero, c), q2)), half);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + w),
+                                     _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+                }
+#endif
+                for (; w < W; ++w)
+                {
+                    const std::uint32_t sum = ((c0[w] * q[0]) >> 8) + ((c1[w] * q[1]) >> 8) + ((c2[w] * q[2]) >> 8);
+                    out[w] = static_cast<std::uint8_t>((sum + 128) >> 8);
+                }
             }
 
-            const std::int64_t H = sshape.dim(0);
-            const std::int64_t W = sshape.dim(1);
-            const std::int64_t C = sshape.dim(2);
-
-            if (C != 3)
+            void GrayRowUint8(const std::uint8_t *src, std::int64_t W, const Weights &weights, std::uint8_t *out)
             {
-                return core::Status(core::StatusCode::kInvalidArgument,
-                              "RgbToGray: src must have 3 channels");
+                std::uint8_t c0[kTileWidth];
+                std::uint8_t c1[kTileWidth];
+                std::uint8_t c2[kTileWidth];
+                for (std::int64_t x0 = 0; x0 < W; x0 += kTileWidth)
+                {
+                    const std::int64_t n = std::min(kTileWidth, W - x0);
+                    detail::Deinterleave3(src + 3 * x0, c0, c1, c2, n);
+                    WeightedSum(c0, c1, c2, n, weights.q, out + x0);
+                }
             }
 
-            if (dshape.dim(0) != H ||
-                dshape.dim(1) != W ||
-                dshape.dim(2) != 1)
+            void GrayRowFloat(const float *src, std::int64_t W, const Weights &weights, float *out)
             {
-                return core::Status(core::StatusCode::kInvalidArgument,
-                              "RgbToGray: dst shape must be [H,W,1]");
+                const float k0 = weights.f[0];
+                const float k1 = weights.f[1];
+                const float k2 = weights.f[2];
+                for (std::int64_t w = 0; w < W; ++w)
+                {
+                    out[w] = k0 * src[3 * w + 0] + k1 * src[3 * w + 1] + k2 * src[3 * w + 2];
+                }
             }
 
-            const float *src_data =
-                static_cast<const float *>(src.buffer().data());
-            float *dst_data =
-                static_cast<float *>(dst->buffer().data());
-
-            if (src_data == nullptr || dst_data == nullptr)
+            core::Status ToGray(const data::TensorView &src, data::TensorView *dst, const Weights &weights,
+                                const char *op)
             {
-                return core::Status(core::StatusCode::kInvalidArgument,
-                              "RgbToGray: null buffer data");
-            }
+                const std::string name(op);
+                if (dst == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": dst is null");
+                }
 
-            const float kR = 0.299f;
-            const float kG = 0.587f;
-            const float kB = 0.114f;
+                const core::DataType dtype = src.dtype();
+                if ((dtype != core::DataType::kFloat32 && dtype != core::DataType::kUint8) ||
+                    dst->dtype() != dtype)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects uint8 or float32 src and dst of the same type");
+                }
 
-            for (std::int64_t h = 0; h < H; ++h)
-            {
-                for (std::int64_t w = 0; w < W; ++w)
+                const data::TensorShape &sshape = src.shape();
+                const data::TensorShape &dshape = dst->shape();
+
+                if (sshape.rank() != 3 || dshape.rank() != 3)
                 {
-                    const std::size_t src_base =
-                        static_cast<std::size_t>((h * W + w) * 3);
-                    const std::size_t dst_idx =
-                        static_cast<std::size_t>((h * W + w));
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects rank 3 HWC tensors");
+                }
+                if (!src.is_contiguous() || !dst->is_contiguous())
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects contiguous tensors");
+                }
 
-                    const float r = src_data[src_base + 0];
-                    const float g = src_data[src_base + 1];
-                    const float b = src_data[src_base + 2];
+                const std::int64_t H = sshape.dim(0);
+                const std::int64_t W = sshape.dim(1);
+                const std::int64_t C = sshape.dim(2);
 
-                    dst_data[dst_idx] = kR * r + kG * g + kB * b;
+                if (C != 3)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": src must have 3 channels");
+                }
+
+                if (dshape.dim(0) != H ||
+                    dshape.dim(1) != W ||
+                    dshape.dim(2) != 1)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": dst shape must be [H,W,1]");
+                }
+
+                const void *src_data = src.buffer().data();
+                void *dst_data = dst->buffer().data();
+
+                if (src_data == nullptr || dst_data == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": null buffer data");
                 }
+                if (H == 0 || W == 0)
+                {
+                    return core::Status::Ok();
+                }
+
+                std::function<void(std::int64_t, std::int64_t)> fn;
+                if (dtype == core::DataType::kUint8)
+                {
+                    const std::uint8_t *in = static_cast<const std::uint8_t *>(src_data);
+                    std::uint8_t *out = static_cast<std::uint8_t *>(dst_data);
+                    fn = [=, &weights](std::int64_t h0, std::int64_t h1)
+                    {
+                        for (std::int64_t h = h0; h < h1; ++h)
+                        {
+                            GrayRowUint8(in + h * W * 3, W, weights, out + h * W);
+                        }
+                    };
+                }
+                else
+                {
+                    const float *in = static_cast<const float *>(src_data);
+                    float *out = static_cast<float *>(dst_data);
+                    fn = [=, &weights](std::int64_t h0, std::int64_t h1)
+                    {
+                        for (std::int64_t h = h0; h < h1; ++h)
+                        {
+                            GrayRowFloat(in + h * W * 3, W, weights, out + h * W);
+                        }
+                    };
+                }
+
+                const std::int64_t min_rows = W >= kMinParallelElements ? 1 : kMinParallelElements / W;
+                core::ThreadPool::Default().ParallelFor(0, H, min_rows, fn);
+
+                return core::Status::Ok();
             }
+        } // namespace
 
-            return core::Status::Ok();
+        core::Status RgbToGray(const data::TensorView &src, data::TensorView *dst, LumaWeights weights)
+        {
+            const Weights w = MakeWeights(weights, false);
+            return ToGray(src, dst, w, "RgbToGray");
         }
-} // namespace ptk::operators
 
+        core::Status BgrToGray(const data::TensorView &src, data::TensorView *dst, LumaWeights weights)
+        {
+            const Weights w = MakeWeights(weights, true);
+            return ToGray(src, dst, w, "BgrToGray");
+        }
+} // namespace ptk::operators
@@ -0,0 +1,475 @@
+#include "operators/rotate_flip.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "operators/kernel_dispatch.h"
+#include "operators/simd.h"
+#include "runtime/core/status.h"
+#include "runtime/core/thread_pool.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+#if defined(PTK_SIMD_NEON64)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSSE3)
+#include <tmmintrin.h>
+#endif
+
+namespace ptk::operators
+{
+        namespace
+        {
+            // Below this many elements a tensor is copied on the calling thread.
+            constexpr std::int64_t kMinParallelElements = 1 << 15;
+
+            // Transposes move kBlock x kBlock pixel tiles, so the kBlock source
+            // rows a tile reads stay in L1 while its output rows are written.
+            constexpr std::int64_t kBlock = 32;
+
+            // Builds the view whose element (i, j, k) is src element at
+            // offset + i * strides[0] + j * strides[1] + k * strides[2].
+            core::Status MakeView(const data::TensorView &src, std::int64_t offset, const std::int64_t strides[3],
+                                  std::int64_t rows, std::int64_t cols, data::TensorView *view)
+            {
+                const std::int64_t elem = static_cast<std::int64_t>(src.element_size());
+                const std::int64_t bytes = offset * elem;
+                std::uint8_t *base = static_cast<std::uint8_t *>(const_cast<void *>(src.buffer().data()));
+                // Negative strides reach back from the new origin, so the size
+                // only covers src's buffer from that element on.
+                data::BufferView bv(base + bytes, src.buffer().size_bytes() - static_cast<std::size_t>(bytes),
+                                    src.device_type());
+                *view = data::TensorView(bv, src.dtype(), data::TensorShape({rows, cols, src.shape().dim(2)}),
+                                         {strides[0], strides[1], strides[2]});
+                return core::Status::Ok();
+            }
+
+            core::Status CheckSource(const data::TensorView &src, const data::TensorView *out, const std::string &name)
+            {
+                if (out == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": output is null");
+                }
+                if (src.shape().rank() != 3)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects rank 3 HWC tensor");
+                }
+                if (src.buffer().data() == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": null buffer data");
+                }
+                return core::Status::Ok();
+            }
+
+            core::Status FlipViewImpl(const data::TensorView &src, FlipMode mode, data::TensorView *view,
+                                      const std::string &name)
+            {
+                core::Status s = CheckSource(src, view, name);
+                if (!s.ok())
+                {
+                    return s;
+                }
+                const std::int64_t H = src.shape().dim(0);
+                const std::int64_t W = src.shape().dim(1);
+                std::int64_t strides[3] = {src.stride(0), src.stride(1), src.stride(2)};
+                std::int64_t offset = 0;
+                if (mode == FlipMode::kVertical || mode == FlipMode::kBoth)
+                {
+                    offset += (H - 1) * strides[0];
+                    strides[0] = -strides[0];
+                }
+                if (mode == FlipMode::kHorizontal || mode == FlipMode::kBoth)
+                {
+                    offset += (W - 1) * strides[1];
+                    strides[1] = -strides[1];
+                }
+                return MakeView(src, offset, strides, H, W, view);
+            }
+
+            core::Status RotateViewImpl(const data::TensorView &src, Rotation rotation, data::TensorView *view,
+                                        const std::string &name)
+            {
+                if (rotation == Rotation::k180)
+                {
+                    return FlipViewImpl(src, FlipMode::kBoth, view, name);
+                }
+                core::Status s = CheckSource(src, view, name);
+                if (!s.ok())
+                {
+                    return s;
+                }
+                const std::int64_t H = src.shape().dim(0);
+                const std::int64_t W = src.shape().dim(1);
+                const std::int64_t sh = src.stride(0);
+                const std::int64_t sw = src.stride(1);
+                const std::int64_t sc = src.stride(2);
+                if (rotation == Rotation::k90)
+                {
+                    // Output (r, c) is src (H - 1 - c, r).
+                    const std::int64_t strides[3] = {sw, -sh, sc};
+                    return MakeView(src, (H - 1) * sh, strides, W, H, view);
+                }
+                if (rotation == Rotation::k270)
+                {
+                    // Output (r, c) is src (c, W - 1 - r).
+                    const std::int64_t strides[3] = {-sw, sh, sc};
+                    return MakeView(src, (W - 1) * sw, strides, W, H, view);
+                }
+                const std::int64_t strides[3] = {sh, sw, sc};
+                return MakeView(src, 0, strides, H, W, view);
+            }
+
+            // Copies n pixels whose source runs backwards, ending at src (the
+            // first output pixel). The vector path loads the 16 bytes ending
+            // after a block's first pixel and reverses whole pixels with one
+            // byte shuffle.
+            template <typename T, int N>
+            void ReverseRun(const T *src, std::int64_t n, T *dst)
+            {
+                constexpr std::int64_t P = N * static_cast<std::int64_t>(sizeof(T));
+                std::int64_t x = 0;
+#if defined(PTK_SIMD_NEON64) || defined(PTK_SIMD_SSSE3)
+                if constexpr (P <= 16)
+                {
+                    constexpr std::int64_t g = 16 / P;
+                    alignas(16) std::uint8_t mask_bytes[16];
+                    for (std::int64_t j = 0; j < 16; ++j)
+                    {
+                        mask_bytes[j] = static_cast<std::uint8_t>(j < g * P ? 16 - P - (j / P) * P + j % P : 0x80);
+                    }
+#if defined(PTK_SIMD_NEON64)
+                    const uint8x16_t mask = vld1q_u8(mask_bytes);
+#else
+                    const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i *>(mask_bytes));
+#endif
+                    // Both the load and the 16 byte store stay inside the row.
+                    for (; (n - x) * P >= 16; x += g)
+                    {
+                        const std::uint8_t *end = reinterpret_cast<const std::uint8_t *>(src - x * N) + P;
+                        std::uint8_t *out = reinterpret_cast<std::uint8_t *>(dst + x * N);
+#if defined(PTK_SIMD_NEON64)
+                        vst1q_u8(out, vqtbl1q_u8(vld1q_u8(end - 16), mask));
+#else
+                        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(end - 16));
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_shuffle_epi8(v, mask));
+#endif
+                    }
+                }
+#endif
+                for (; x < n; ++x)
+                {
+                    std::memcpy(dst + x * N, src - x * N, static_cast<std::size_t>(P));
+                }
+            }
+
+#if defined(PTK_SIMD_NEON64) || defined(PTK_SIMD_SSSE3)
+            // Byte shuffles for TransposeBlock4: `spread` moves each of the four
+            // P-byte pixels of a source run into its own 32-bit lane (reversing
+            // them if the run goes backwards), `pack` squeezes a row of four
+            // lanes back into 4 * P bytes.
+            struct TransposeMasks
+            {
+                alignas(16) std::uint8_t spread[16];
+                alignas(16) std::uint8_t pack[16];
+            };
+
+            TransposeMasks MakeTransposeMasks(int P, bool reversed)
+            {
+                TransposeMasks m;
+                for (int j = 0; j < 16; ++j)
+                {
+                    const int lane = j / 4;
+                    const int src_px = reversed ? 3 - lane : lane;
+                    m.spread[j] = static_cast<std::uint8_t>(j % 4 < P ? src_px * P + j % 4 : 0x80);
+                    m.pack[j] = static_cast<std::uint8_t>(j < 4 * P ? (j / P) * 4 + j % P : 0x80);
+                }
+                return m;
+            }
+
+            // Transposes a 4x4 block of P-byte pixels (P is 3 or 4) whose view
+            // rows are adjacent source pixels (sr_bytes is +P or -P): each
+            // source run is loaded once, spread to one pixel per lane,
+            // transposed in registers and packed into four output rows.
+            template <int P>
+            void TransposeBlock4(const std::uint8_t *in, std::int64_t sr_bytes, std::int64_t sc_bytes,
+                                 std::uint8_t *out, std::int64_t out_row_bytes, const TransposeMasks &masks)
+            {
+                const std::uint8_t *first = sr_bytes < 0 ? in + 3 * sr_bytes : in;
+#if defined(PTK_SIMD_NEON64)
+                const uint8x16_t spread = vld1q_u8(masks.spread);
+                const uint8x16_t pack = vld1q_u8(masks.pack);
+                uint32x4_t v[4];
+                for (int i = 0; i < 4; ++i)
+                {
+                    const std::uint8_t *p = first + i * sc_bytes;
+                    uint8x16_t raw;
+                    if (P == 4)
+                    {
+                        raw = vld1q_u8(p);
+                    }
+                    else
+                    {
+                        std::uint32_t tail;
+                        std::memcpy(&tail, p + 8, sizeof(tail));
+                        raw = vreinterpretq_u8_u64(vcombine_u64(vld1_u64(reinterpret_cast<const std::uint64_t *>(p)),
+                                                                vcreate_u64(tail)));
+                    }
+                    v[i] = vreinterpretq_u32_u8(vqtbl1q_u8(raw, spread));
+                }
+                const uint32x4x2_t t0 = vtrnq_u32(v[0], v[1]);
+                const uint32x4x2_t t1 = vtrnq_u32(v[2], v[3]);
+                const uint32x4_t rows[4] = {
+                    vcombine_u32(vget_low_u32(t0.val[0]), vget_low_u32(t1.val[0])),
+                    vcombine_u32(vget_low_u32(t0.val[1]), vget_low_u32(t1.val[1])),
+                    vcombine_u32(vget_high_u32(t0.val[0]), vget_high_u32(t1.val[0])),
+                    vcombine_u32(vget_high_u32(t0.val[1]), vget_high_u32(t1.val[1])),
+                };
+                for (int j = 0; j < 4; ++j)
+                {
+                    std::uint8_t *o = out + j * out_row_bytes;
+                    const uint8x16_t packed = vqtbl1q_u8(vreinterpretq_u8_u32(rows[j]), pack);
+                    if (P == 4)
+                    {
+                        vst1q_u8(o, packed);
+                    }
+                    else
+                    {
+                        vst1_u8(o, vget_low_u8(packed));
+                        const std::uint32_t tail = vgetq_lane_u32(vreinterpretq_u32_u8(packed), 2);
+                        std::memcpy(o + 8, &tail, sizeof(tail));
+                    }
+                }
+#else
+                const __m128i spread = _mm_load_si128(reinterpret_cast<const __m128i *>(masks.spread));
+                const __m128i pack = _mm_load_si128(reinterpret_cast<const __m128i *>(masks.pack));
+                __m128i v[4];
+                for (int i = 0; i < 4; ++i)
+                {
+                    const std::uint8_t *p = first + i * sc_bytes;
+                    __m128i raw;
+                    if (P == 4)
+                    {
+                        raw = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                    }
+                    else
+                    {
+                        // Exactly 12 bytes, so the last pixel of a buffer is safe.
+                        std::int32_t tail;
+                        std::memcpy(&tail, p + 8, sizeof(tail));
+                        raw = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)),
+                                                 _mm_cvtsi32_si128(tail));
+                    }
+                    v[i] = _mm_shuffle_epi8(raw, spread);
+                }
+                const __m128i t0 = _mm_unpacklo_epi32(v[0], v[1]);
+                const __m128i t1 = _mm_unpackhi_epi32(v[0], v[1]);
+                const __m128i t2 = _mm_unpacklo_epi32(v[2], v[3]);
+                const __m128i t3 = _mm_unpackhi_epi32(v[2], v[3]);
+                const __m128i rows[4] = {
+                    _mm_unpacklo_epi64(t0, t2),
+                    _mm_unpackhi_epi64(t0, t2),
+                    _mm_unpacklo_epi64(t1, t3),
+                    _mm_unpackhi_epi64(t1, t3),
+                };
+                for (int j = 0; j < 4; ++j)
+                {
+                    std::uint8_t *o = out + j * out_row_bytes;
+                    const __m128i packed = _mm_shuffle_epi8(rows[j], pack);
+                    if (P == 4)
+                    {
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(o), packed);
+                    }
+                    else
+                    {
+                        _mm_storel_epi64(reinterpret_cast<__m128i *>(o), packed);
+                        const std::int32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(packed, 8));
+                        std::memcpy(o + 8, &tail, sizeof(tail));
+                    }
+                }
+#endif
+            }
+#endif
+
+            // Fills rows [r0, r1) of the packed [rows, cols, C] dst from the
+            // view base[r * sr + c * sc + k] (channel stride 1).
+            template <typename T, int N>
+            void CopyRows(const T *base, std::int64_t sr, std::int64_t sc, std::int64_t cols,
+                          std::int64_t runtime_channels, T *dst, std::int64_t r0, std::int64_t r1)
+            {
+                const std::int64_t C = ChannelCount<N>(runtime_channels);
+                if (sc == C)
+                {
+                    for (std::int64_t r = r0; r < r1; ++r)
+                    {
+                        std::memcpy(dst + r * cols * C, base + r * sr, static_cast<std::size_t>(cols * C) * sizeof(T));
+                    }
+                    return;
+                }
+                if constexpr (N > 0)
+                {
+                    if (sc == -C)
+                    {
+                        for (std::int64_t r = r0; r < r1; ++r)
+                        {
+                            ReverseRun<T, N>(base + r * sr, cols, dst + r * cols * C);
+                        }
+                        return;
+                    }
+                }
+                // Columns of the view walk across source rows: copy in square
+                // tiles so each source row is touched once per tile.
+#if defined(PTK_SIMD_NEON64) || defined(PTK_SIMD_SSSE3)
+                constexpr std::int64_t P = N * static_cast<std::int64_t>(sizeof(T));
+                const TransposeMasks masks = MakeTransposeMasks(static_cast<int>(P), sr < 0);
+#endif
+                for (std::int64_t rb = r0; rb < r1; rb += kBlock)
+                {
+                    const std::int64_t re = std::min(rb + kBlock, r1);
+                    for (std::int64_t cb = 0; cb < cols; cb += kBlock)
+                    {
+                        const std::int64_t ce = std::min(cb + kBlock, cols);
+                        std::int64_t r = rb;
+#if defined(PTK_SIMD_NEON64) || defined(PTK_SIMD_SSSE3)
+                        if constexpr (P == 3 || P == 4)
+                        {
+                            if (sr == C || sr == -C)
+                            {
+                                for (; r + 4 <= re; r += 4)
+                                {
+                                    const T *in = base + r * sr;
+                                    T *out = dst + r * cols * C;
+                                    std::int64_t c = cb;
+                                    for (; c + 4 <= ce; c += 4)
+                                    {
+                                        TransposeBlock4<P>(reinterpret_cast<const std::uint8_t *>(in + c * sc),
+                                                           sr * static_cast<std::int64_t>(sizeof(T)),
+                                                           sc * static_cast<std::int64_t>(sizeof(T)),
+                                                           reinterpret_cast<std::uint8_t *>(out + c * C), cols * P, masks);
+                                    }
+                                    for (std::int64_t k = 0; k < 4; ++k)
+                                    {
+                                        for (std::int64_t cc = c; cc < ce; ++cc)
+                                        {
+                                            std::memcpy(out + k * cols * C + cc * C, in + k * sr + cc * sc,
+                                                        static_cast<std::size_t>(P));
+                                        }
+                                    }
+                                }
+                            }
+                        }
+#endif
+                        for (; r < re; ++r)
+                        {
+                            const T *in = base + r * sr;
+                            T *out = dst + r * cols * C;
+                            for (std::int64_t c = cb; c < ce; ++c)
+                            {
+                                std::memcpy(out + c * C, in + c * sc, static_cast<std::size_t>(C) * sizeof(T));
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Copies an oriented view into the packed dst.
+            core::Status CopyView(const data::TensorView &view, data::TensorView *dst, const std::string &name)
+            {
+                if (dst == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": dst is null");
+                }
+                const core::DataType dtype = view.dtype();
+                if ((dtype != core::DataType::kUint8 && dtype != core::DataType::kFloat32) || dst->dtype() != dtype)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects uint8 or float32 src and dst of the same type");
+                }
+                const std::int64_t rows = view.shape().dim(0);
+                const std::int64_t cols = view.shape().dim(1);
+                const std::int64_t C = view.shape().dim(2);
+                if (C < 1 || C > 4 || view.stride(2) != 1)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects 1 to 4 packed channels");
+                }
+                if (dst->shape().dims() != view.shape().dims())
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": dst shape must match the oriented src");
+                }
+                if (!dst->is_contiguous() || dst->buffer().data() == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": dst must be contiguous with data");
+                }
+                if (rows == 0 || cols == 0)
+                {
+                    return core::Status::Ok();
+                }
+
+                const std::int64_t sr = view.stride(0);
+                const std::int64_t sc = view.stride(1);
+                std::function<void(std::int64_t, std::int64_t)> fn;
+                DispatchDType<std::uint8_t, float>(dtype, [&](auto type)
+                                                   {
+                    using T = typename decltype(type)::type;
+                    const T *base = static_cast<const T *>(view.buffer().data());
+                    T *out = static_cast<T *>(dst->buffer().data());
+                    DispatchChannels(C, [&](auto channels)
+                                     {
+                        fn = [=](std::int64_t r0, std::int64_t r1)
+                        { CopyRows<T, decltype(channels)::value>(base, sr, sc, cols, C, out, r0, r1); };
+                    }); });
+
+                const std::int64_t row_len = cols * C;
+                std::int64_t min_rows = row_len >= kMinParallelElements ? 1 : kMinParallelElements / row_len;
+                // Transposed copies split on tile boundaries.
+                if (sc != C && sc != -C)
+                {
+                    min_rows = (min_rows + kBlock - 1) / kBlock * kBlock;
+                }
+                core::ThreadPool::Default().ParallelFor(0, rows, min_rows, fn);
+                return core::Status::Ok();
+            }
+        } // namespace
+
+        core::Status FlipView(const data::TensorView &src, FlipMode mode, data::TensorView *view)
+        {
+            return FlipViewImpl(src, mode, view, "FlipView");
+        }
+
+        core::Status RotateView(const data::TensorView &src, Rotation rotation, data::TensorView *view)
+        {
+            return RotateViewImpl(src, rotation, view, "RotateView");
+        }
+
+        core::Status Flip(const data::TensorView &src, FlipMode mode, data::TensorView *dst)
+        {
+            data::TensorView view;
+            core::Status s = FlipViewImpl(src, mode, &view, "Flip");
+            if (!s.ok())
+            {
+                return s;
+            }
+            return CopyView(view, dst, "Flip");
+        }
+
+        core::Status Rotate(const data::TensorView &src, Rotation rotation, data::TensorView *dst)
+        {
+            data::TensorView view;
+            core::Status s = RotateViewImpl(src, rotation, &view, "Rotate");
+            if (!s.ok())
+            {
+                return s;
+            }
+            return CopyView(view, dst, "Rotate");
+        }
+} // namespace ptk::operators
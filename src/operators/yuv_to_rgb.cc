@@ -0,0 +1,640 @@
+#include "operators/yuv_to_rgb.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "operators/interleave.h"
+#include "operators/simd.h"
+#include "runtime/core/status.h"
+#include "runtime/core/thread_pool.h"
+#include "runtime/core/types.h"
+#include "runtime/data/tensor.h"
+
+#if defined(PTK_SIMD_NEON)
+#include <arm_neon.h>
+#elif defined(PTK_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace ptk::operators
+{
+        namespace
+        {
+            // Below this many output pixels a frame is converted on the calling thread.
+            constexpr std::int64_t kMinParallelElements = 1 << 15;
+
+            // Pixels converted into planar scratch before being interleaved, so
+            // the three scratch rows stay in L1.
+            constexpr std::int64_t kTileWidth = 256;
+
+            // Conversion matrix in Q13. Every term is evaluated as
+            // ((x << 7) * k) >> 16, the 16-bit multiply-high the SIMD paths use,
+            // which leaves results in Q4 for a final rounding shift.
+            struct Coefficients
+            {
+                int y_offset;
+                int y;
+                int vr;
+                int ug;
+                int vg;
+                int ub;
+            };
+
+            Coefficients MakeCoefficients(const YuvConversionParams &params)
+            {
+                const bool bt709 = params.matrix == YuvMatrix::kBt709;
+                const double kr = bt709 ? 0.2126 : 0.299;
+                const double kb = bt709 ? 0.0722 : 0.114;
+                const double kg = 1.0 - kr - kb;
+                const double y_scale = params.full_range ? 1.0 : 255.0 / 219.0;
+                const double c_scale = params.full_range ? 1.0 : 255.0 / 224.0;
+
+                auto q13 = [](double v)
+                { return static_cast<int>(std::lround(v * 8192.0)); };
+
+                Coefficients k;
+                k.y_offset = params.full_range ? 0 : 16;
+                k.y = q13(y_scale);
+                k.vr = q13(2.0 * (1.0 - kr) * c_scale);
+                k.ug = q13(2.0 * kb * (1.0 - kb) / kg * c_scale);
+                k.vg = q13(2.0 * kr * (1.0 - kr) / kg * c_scale);
+                k.ub = q13(2.0 * (1.0 - kb) * c_scale);
+                return k;
+            }
+
+            inline int Term(int x, int k)
+            {
+                return (x * 128 * k) >> 16;
+            }
+
+            inline std::uint8_t ClampQ4(int v)
+            {
+                v = (v + 8) >> 4;
+                return static_cast<std::uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+            }
+
+            inline std::uint8_t ConvertLuma(int y, const Coefficients &k)
+            {
+                return ClampQ4(Term(y - k.y_offset, k.y));
+            }
+
+            inline void ConvertPixel(int y, int u, int v, const Coefficients &k,
+                                     std::uint8_t *r, std::uint8_t *g, std::uint8_t *b)
+            {
+                const int yt = Term(y - k.y_offset, k.y);
+                const int du = u - 128;
+                const int dv = v - 128;
+                *r = ClampQ4(yt + Term(dv, k.vr));
+                *g = ClampQ4(yt - Term(du, k.ug) - Term(dv, k.vg));
+                *b = ClampQ4(yt + Term(du, k.ub));
+            }
+
+#if defined(PTK_SIMD_NEON)
+            // vqdmulh doubles the product, so inputs are shifted by 6 instead of 7.
+            inline int16x8_t MulTerm(int16x8_t x, int16x8_t offset, int k)
+            {
+                return vqdmulhq_s16(vshlq_n_s16(vsubq_s16(x, offset), 6), vdupq_n_s16(static_cast<std::int16_t>(k)));
+            }
+
+            inline uint8x16_t PackQ4(int16x8_t lo, int16x8_t hi)
+            {
+                return vcombine_u8(vqrshrun_n_s16(lo, 4), vqrshrun_n_s16(hi, 4));
+            }
+
+            // Converts 16 pixels given as widened luma halves and 8 chroma pairs.
+            inline void ConvertBlock16(int16x8_t y_lo, int16x8_t y_hi, int16x8_t u, int16x8_t v,
+                                       const Coefficients &k, std::uint8_t *r, std::uint8_t *g, std::uint8_t *b)
+            {
+                const int16x8_t c128 = vdupq_n_s16(128);
+                const int16x8_t yoff = vdupq_n_s16(static_cast<std::int16_t>(k.y_offset));
+                const int16x8_t yl = MulTerm(y_lo, yoff, k.y);
+                const int16x8_t yh = MulTerm(y_hi, yoff, k.y);
+                const int16x8_t rc = MulTerm(v, c128, k.vr);
+                const int16x8_t gc = vaddq_s16(MulTerm(u, c128, k.ug), MulTerm(v, c128, k.vg));
+                const int16x8_t bc = MulTerm(u, c128, k.ub);
+
+                const int16x8x2_t rd = vzipq_s16(rc, rc);
+                const int16x8x2_t gd = vzipq_s16(gc, gc);
+                const int16x8x2_t bd = vzipq_s16(bc, bc);
+                vst1q_u8(r, PackQ4(vaddq_s16(yl, rd.val[0]), vaddq_s16(yh, rd.val[1])));
+                vst1q_u8(g, PackQ4(vsubq_s16(yl, gd.val[0]), vsubq_s16(yh, gd.val[1])));
+                vst1q_u8(b, PackQ4(vaddq_s16(yl, bd.val[0]), vaddq_s16(yh, bd.val[1])));
+            }
+
+            inline int16x8_t Widen(uint8x8_t v)
+            {
+                return vreinterpretq_s16_u16(vmovl_u8(v));
+            }
+#elif defined(PTK_SIMD_SSE2)
+            inline __m128i MulTerm(__m128i x, __m128i offset, int k)
+            {
+                return _mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(x, offset), 7),
+                                       _mm_set1_epi16(static_cast<short>(k)));
+            }
+
+            inline __m128i PackQ4(__m128i lo, __m128i hi)
+            {
+                const __m128i half = _mm_set1_epi16(8);
+                return _mm_packus_epi16(_mm_srai_epi16(_mm_add_epi16(lo, half), 4),
+                                        _mm_srai_epi16(_mm_add_epi16(hi, half), 4));
+            }
+
+            // Converts 16 pixels given as widened luma halves and 8 chroma pairs.
+            inline void ConvertBlock16(__m128i y_lo, __m128i y_hi, __m128i u, __m128i v,
+                                       const Coefficients &k, std::uint8_t *r, std::uint8_t *g, std::uint8_t *b)
+            {
+                const __m128i c128 = _mm_set1_epi16(128);
+                const __m128i yoff = _mm_set1_epi16(static_cast<short>(k.y_offset));
+                const __m128i yl = MulTerm(y_lo, yoff, k.y);
+                const __m128i yh = MulTerm(y_hi, yoff, k.y);
+                const __m128i rc = MulTerm(v, c128, k.vr);
+                const __m128i gc = _mm_add_epi16(MulTerm(u, c128, k.ug), MulTerm(v, c128, k.vg));
+                const __m128i bc = MulTerm(u, c128, k.ub);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(r),
+                                 PackQ4(_mm_add_epi16(yl, _mm_unpacklo_epi16(rc, rc)),
+                                        _mm_add_epi16(yh, _mm_unpackhi_epi16(rc, rc))));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(g),
+                                 PackQ4(_mm_sub_epi16(yl, _mm_unpacklo_epi16(gc, gc)),
+                                        _mm_sub_epi16(yh, _mm_unpackhi_epi16(gc, gc))));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(b),
+                                 PackQ4(_mm_add_epi16(yl, _mm_unpacklo_epi16(bc, bc)),
+                                        _mm_add_epi16(yh, _mm_unpackhi_epi16(bc, bc))));
+            }
+#endif
+
+            // One row of planar 4:2:x input into planar r, g, b. Chroma samples
+            // are c_step bytes apart: 1 for I420, 2 for NV12 (where v == u + 1).
+            void ConvertRowPlanar(const std::uint8_t *y, const std::uint8_t *u, const std::uint8_t *v,
+                                  std::int64_t c_step, std::int64_t W, const Coefficients &k,
+                                  std::uint8_t *r, std::uint8_t *g, std::uint8_t *b)
+            {
+                std::int64_t w = 0;
+#if defined(PTK_SIMD_NEON)
+                for (; w + 16 <= W; w += 16)
+                {
+                    const uint8x16_t yv = vld1q_u8(y + w);
+                    int16x8_t uu;
+                    int16x8_t vv;
+                    if (c_step == 2)
+                    {
+                        const uint8x8x2_t uv = vld2_u8(u + w);
+                        uu = Widen(uv.val[0]);
+                        vv = Widen(uv.val[1]);
+                    }
+                    else
+                    {
+                        uu = Widen(vld1_u8(u + w / 2));
+                        vv = Widen(vld1_u8(v + w / 2));
+                    }
+                    ConvertBlock16(Widen(vget_low_u8(yv)), Widen(vget_high_u8(yv)), uu, vv, k, r + w, g + w, b + w);
+                }
+#elif defined(PTK_SIMD_SSE2)
+                const __m128i zero = _mm_setzero_si128();
+                for (; w + 16 <= W; w += 16)
+                {
+                    const __m128i yv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + w));
+                    __m128i uu;
+                    __m128i vv;
+                    if (c_step == 2)
+                    {
+                        const __m128i uv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(u + w));
+                        uu = _mm_and_si128(uv, _mm_set1_epi16(0x00ff));
+                        vv = _mm_srli_epi16(uv, 8);
+                    }
+                    else
+                    {
+                        uu = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + w / 2)), zero);
+                        vv = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + w / 2)), zero);
+                    }
+                    ConvertBlock16(_mm_unpacklo_epi8(yv, zero), _mm_unpackhi_epi8(yv, zero), uu, vv, k,
+                                   r + w, g + w, b + w);
+                }
+#endif
+                for (; w < W; ++w)
+                {
+                    const std::int64_t c = (w / 2) * c_step;
+                    ConvertPixel(y[w], u[c], v[c], k, r + w, g + w, b + w);
+                }
+            }
+
+            // One row of packed Y0 U Y1 V input into planar r, g, b.
+            void ConvertRowYuyv(const std::uint8_t *src, std::int64_t W, const Coefficients &k,
+                                std::uint8_t *r, std::uint8_t *g, std::uint8_t *b)
+            {
+                std::int64_t w = 0;
+#if defined(PTK_SIMD_NEON)
+                for (; w + 16 <= W; w += 16)
+                {
+                    const uint8x16x2_t px = vld2q_u8(src + 2 * w);
+                    const uint8x8x2_t uv = vuzp_u8(vget_low_u8(px.val[1]), vget_high_u8(px.val[1]));
+                    ConvertBlock16(Widen(vget_low_u8(px.val[0])), Widen(vget_high_u8(px.val[0])),
+                                   Widen(uv.val[0]), Widen(uv.val[1]), k, r + w, g + w, b + w);
+                }
+#elif defined(PTK_SIMD_SSE2)
+                const __m128i low_byte = _mm_set1_epi16(0x00ff);
+                const __m128i low_half = _mm_set1_epi32(0x0000ffff);
+                for (; w + 16 <= W; w += 16)
+                {
+                    const __m128i x0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * w));
+                    const __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * w + 16));
+                    // Odd bytes hold U0 V0 U1 V1 ...; split them into U and V lanes.
+                    const __m128i uv0 = _mm_srli_epi16(x0, 8);
+                    const __m128i uv1 = _mm_srli_epi16(x1, 8);
+                    const __m128i uu = _mm_packs_epi32(_mm_and_si128(uv0, low_half), _mm_and_si128(uv1, low_half));
+                    const __m128i vv = _mm_packs_epi32(_mm_srli_epi32(uv0, 16), _mm_srli_epi32(uv1, 16));
+                    ConvertBlock16(_mm_and_si128(x0, low_byte), _mm_and_si128(x1, low_byte), uu, vv, k,
+                                   r + w, g + w, b + w);
+                }
+#endif
+                for (; w < W; w += 2)
+                {
+                    const std::uint8_t *p = src + 2 * w;
+                    ConvertPixel(p[0], p[1], p[3], k, r + w, g + w, b + w);
+                    ConvertPixel(p[2], p[1], p[3], k, r + w + 1, g + w + 1, b + w + 1);
+                }
+            }
+
+            // Luma samples y_step bytes apart (1 planar, 2 YUYV) into a gray row.
+            void ConvertRowLuma(const std::uint8_t *y, std::int64_t y_step, std::int64_t W,
+                                const Coefficients &k, std::uint8_t *out)
+            {
+                if (k.y_offset == 0 && k.y == 8192 && y_step == 1)
+                {
+                    std::memcpy(out, y, static_cast<std::size_t>(W));
+                    return;
+                }
+
+                std::int64_t w = 0;
+#if defined(PTK_SIMD_NEON)
+                const int16x8_t yoff = vdupq_n_s16(static_cast<std::int16_t>(k.y_offset));
+                for (; w + 16 <= W; w += 16)
+                {
+                    const uint8x16_t yv = y_step == 2 ? vld2q_u8(y + 2 * w).val[0] : vld1q_u8(y + w);
+                    vst1q_u8(out + w, PackQ4(MulTerm(Widen(vget_low_u8(yv)), yoff, k.y),
+                                             MulTerm(Widen(vget_high_u8(yv)), yoff, k.y)));
+                }
+#elif defined(PTK_SIMD_SSE2)
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i low_byte = _mm_set1_epi16(0x00ff);
+                const __m128i yoff = _mm_set1_epi16(static_cast<short>(k.y_offset));
+                for (; w + 16 <= W; w += 16)
+                {
+                    __m128i lo;
+                    __m128i hi;
+                    if (y_step == 2)
+                    {
+                        lo = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + 2 * w)), low_byte);
+                        hi = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + 2 * w + 16)), low_byte);
+                    }
+                    else
+                    {
+                        const __m128i yv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + w));
+                        lo = _mm_unpacklo_epi8(yv, zero);
+                        hi = _mm_unpackhi_epi8(yv, zero);
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + w),
+                                     PackQ4(MulTerm(lo, yoff, k.y), MulTerm(hi, yoff, k.y)));
+                }
+#endif
+                for (; w < W; ++w)
+                {
+                    out[w] = ConvertLuma(y[w * y_step], k);
+                }
+            }
+
+            // Byte addressing of the luma and chroma samples of a YUV image.
+            struct YuvPlanes
+            {
+                const std::uint8_t *y;
+                const std::uint8_t *u;
+                const std::uint8_t *v;
+                std::int64_t y_row;  // bytes between luma rows
+                std::int64_t y_step; // bytes between luma samples in a row
+                std::int64_t c_row;
+                std::int64_t c_step;
+                std::int64_t c_rows; // H for 4:2:2, H / 2 for 4:2:0
+                std::int64_t height;
+                std::int64_t width;
+                bool packed; // YUYV
+            };
+
+            core::Status ResolvePlanes(const data::TensorView &src, core::PixelFormat format,
+                                       const char *op, YuvPlanes *planes)
+            {
+                const std::string name(op);
+                if (src.dtype() != core::DataType::kUint8 || !src.is_contiguous())
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects contiguous uint8 src");
+                }
+                const data::TensorShape &shape = src.shape();
+                if (shape.rank() != 3)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": expects rank 3 src");
+                }
+                const std::uint8_t *base = static_cast<const std::uint8_t *>(src.buffer().data());
+                if (base == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": null buffer data");
+                }
+
+                std::int64_t H = 0;
+                const std::int64_t W = shape.dim(1);
+                switch (format)
+                {
+                case core::PixelFormat::kYuyv:
+                    if (shape.dim(2) != 2)
+                    {
+                        return core::Status(core::StatusCode::kInvalidArgument,
+                                      name + ": YUYV src must be [H,W,2]");
+                    }
+                    H = shape.dim(0);
+                    planes->y = base;
+                    planes->u = base + 1;
+                    planes->v = base + 3;
+                    planes->y_row = 2 * W;
+                    planes->y_step = 2;
+                    planes->c_row = 2 * W;
+                    planes->c_step = 4;
+                    planes->c_rows = H;
+                    planes->packed = true;
+                    break;
+                case core::PixelFormat::kNv12:
+                case core::PixelFormat::kI420:
+                    if (shape.dim(2) != 1 || shape.dim(0) % 3 != 0)
+                    {
+                        return core::Status(core::StatusCode::kInvalidArgument,
+                                      name + ": 4:2:0 src must be [H*3/2,W,1]");
+                    }
+                    H = shape.dim(0) / 3 * 2;
+                    planes->y = base;
+                    planes->y_row = W;
+                    planes->y_step = 1;
+                    planes->c_rows = H / 2;
+                    planes->packed = false;
+                    if (format == core::PixelFormat::kNv12)
+                    {
+                        planes->u = base + H * W;
+                        planes->v = planes->u + 1;
+                        planes->c_row = W;
+                        planes->c_step = 2;
+                    }
+                    else
+                    {
+                        planes->u = base + H * W;
+                        planes->v = planes->u + (H / 2) * (W / 2);
+                        planes->c_row = W / 2;
+                        planes->c_step = 1;
+                    }
+                    break;
+                default:
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": src format must be YUYV, NV12 or I420");
+                }
+
+                if (H <= 0 || W <= 0 || H % 2 != 0 || W % 2 != 0)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": height and width must be even and non-zero");
+                }
+                planes->height = H;
+                planes->width = W;
+                return core::Status::Ok();
+            }
+
+            core::Status CheckDst(const data::TensorView *dst, core::PixelFormat format, const char *op,
+                                  std::int64_t *channels)
+            {
+                const std::string name(op);
+                if (dst == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": dst is null");
+                }
+                switch (format)
+                {
+                case core::PixelFormat::kRgb8:
+                case core::PixelFormat::kBgr8:
+                    *channels = 3;
+                    break;
+                case core::PixelFormat::kGray8:
+                    *channels = 1;
+                    break;
+                default:
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": dst format must be RGB, BGR or Gray");
+                }
+                if (dst->dtype() != core::DataType::kUint8 || !dst->is_contiguous() ||
+                    dst->shape().rank() != 3 || dst->shape().dim(2) != *channels)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": dst must be a contiguous uint8 [H,W,C] tensor");
+                }
+                if (dst->buffer().data() == nullptr)
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                  name + ": null buffer data");
+                }
+                return core::Status::Ok();
+            }
+
+            void RunRows(std::int64_t rows, std::int64_t row_len,
+                         const std::function<void(std::int64_t, std::int64_t)> &fn)
+            {
+                const std::int64_t min_rows =
+                    row_len >= kMinParallelElements ? 1 : kMinParallelElements / row_len;
+                core::ThreadPool::Default().ParallelFor(0, rows, min_rows, fn);
+            }
+
+            // Source index pair and Q8 weight of the second sample for one output
+            // coordinate, using pixel-center alignment.
+            struct AxisSample
+            {
+                std::int32_t i0;
+                std::int32_t i1;
+                std::int32_t w;
+            };
+
+            std::vector<AxisSample> MakeAxis(std::int64_t src_len, std::int64_t dst_len)
+            {
+                std::vector<AxisSample> axis(static_cast<std::size_t>(dst_len));
+                const double scale = static_cast<double>(src_len) / static_cast<double>(dst_len);
+                for (std::int64_t i = 0; i < dst_len; ++i)
+                {
+                    double s = (static_cast<double>(i) + 0.5) * scale - 0.5;
+                    s = std::min(std::max(s, 0.0), static_cast<double>(src_len - 1));
+                    const std::int64_t i0 = static_cast<std::int64_t>(s);
+                    AxisSample &a = axis[static_cast<std::size_t>(i)];
+                    a.i0 = static_cast<std::int32_t>(i0);
+                    a.i1 = static_cast<std::int32_t>(std::min(i0 + 1, src_len - 1));
+                    a.w = static_cast<std::int32_t>(std::lround((s - static_cast<double>(i0)) * 256.0));
+                }
+                return axis;
+            }
+
+            inline int Bilinear(const std::uint8_t *plane, std::int64_t row_bytes, std::int64_t step,
+                                const AxisSample &ys, const AxisSample &xs)
+            {
+                const std::uint8_t *r0 = plane + ys.i0 * row_bytes;
+                const std::uint8_t *r1 = plane + ys.i1 * row_bytes;
+                const int top = r0[xs.i0 * step] * (256 - xs.w) + r0[xs.i1 * step] * xs.w;
+                const int bottom = r1[xs.i0 * step] * (256 - xs.w) + r1[xs.i1 * step] * xs.w;
+                return (top * (256 - ys.w) + bottom * ys.w + (1 << 15)) >> 16;
+            }
+        } // namespace
+
+        core::Status YuvToRgb(const data::TensorView &src, core::PixelFormat src_format,
+                              data::TensorView *dst, core::PixelFormat dst_format,
+                              const YuvConversionParams &params)
+        {
+            std::int64_t C = 0;
+            core::Status s = CheckDst(dst, dst_format, "YuvToRgb", &C);
+            if (!s.ok())
+            {
+                return s;
+            }
+            YuvPlanes planes;
+            s = ResolvePlanes(src, src_format, "YuvToRgb", &planes);
+            if (!s.ok())
+            {
+                return s;
+            }
+
+            const std::int64_t H = planes.height;
+            const std::int64_t W = planes.width;
+            if (dst->shape().dim(0) != H || dst->shape().dim(1) != W)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "YuvToRgb: dst shape must be [H,W,C]");
+            }
+
+            const Coefficients k = MakeCoefficients(params);
+            std::uint8_t *out = static_cast<std::uint8_t *>(dst->buffer().data());
+            const bool bgr = dst_format == core::PixelFormat::kBgr8;
+
+            auto fn = [&](std::int64_t h0, std::int64_t h1)
+            {
+                std::uint8_t r[kTileWidth];
+                std::uint8_t g[kTileWidth];
+                std::uint8_t b[kTileWidth];
+                for (std::int64_t h = h0; h < h1; ++h)
+                {
+                    const std::uint8_t *y_row = planes.y + h * planes.y_row;
+                    std::uint8_t *dst_row = out + h * W * C;
+                    if (C == 1)
+                    {
+                        ConvertRowLuma(y_row, planes.y_step, W, k, dst_row);
+                        continue;
+                    }
+
+                    const std::int64_t ch = planes.c_rows == H ? h : h / 2;
+                    for (std::int64_t x0 = 0; x0 < W; x0 += kTileWidth)
+                    {
+                        const std::int64_t n = std::min(kTileWidth, W - x0);
+                        if (planes.packed)
+                        {
+                            ConvertRowYuyv(y_row + 2 * x0, n, k, r, g, b);
+                        }
+                        else
+                        {
+                            const std::int64_t c_off = ch * planes.c_row + (x0 / 2) * planes.c_step;
+                            ConvertRowPlanar(y_row + x0, planes.u + c_off, planes.v + c_off, planes.c_step,
+                                             n, k, r, g, b);
+                        }
+                        if (bgr)
+                        {
+                            detail::Interleave3(b, g, r, dst_row + 3 * x0, n);
+                        }
+                        else
+                        {
+                            detail::Interleave3(r, g, b, dst_row + 3 * x0, n);
+                        }
+                    }
+                }
+            };
+            RunRows(H, W, fn);
+
+            return core::Status::Ok();
+        }
+
+        core::Status YuvToRgbResized(const data::TensorView &src, core::PixelFormat src_format,
+                                     data::TensorView *dst, core::PixelFormat dst_format,
+                                     const YuvConversionParams &params)
+        {
+            std::int64_t C = 0;
+            core::Status s = CheckDst(dst, dst_format, "YuvToRgbResized", &C);
+            if (!s.ok())
+            {
+                return s;
+            }
+            YuvPlanes planes;
+            s = ResolvePlanes(src, src_format, "YuvToRgbResized", &planes);
+            if (!s.ok())
+            {
+                return s;
+            }
+
+            const std::int64_t OH = dst->shape().dim(0);
+            const std::int64_t OW = dst->shape().dim(1);
+            if (OH <= 0 || OW <= 0)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                              "YuvToRgbResized: dst height and width must be non-zero");
+            }
+            if (OH == planes.height && OW == planes.width)
+            {
+                return YuvToRgb(src, src_format, dst, dst_format, params);
+            }
+
+            const Coefficients k = MakeCoefficients(params);
+            const std::vector<AxisSample> luma_x = MakeAxis(planes.width, OW);
+            const std::vector<AxisSample> luma_y = MakeAxis(planes.height, OH);
+            const std::vector<AxisSample> chroma_x = MakeAxis(planes.width / 2, OW);
+            const std::vector<AxisSample> chroma_y = MakeAxis(planes.c_rows, OH);
+
+            std::uint8_t *out = static_cast<std::uint8_t *>(dst->buffer().data());
+            const bool bgr = dst_format == core::PixelFormat::kBgr8;
+
+            auto fn = [&](std::int64_t h0, std::int64_t h1)
+            {
+                for (std::int64_t h = h0; h < h1; ++h)
+                {
+                    const AxisSample &ly = luma_y[static_cast<std::size_t>(h)];
+                    const AxisSample &cy = chroma_y[static_cast<std::size_t>(h)];
+                    std::uint8_t *dst_row = out + h * OW * C;
+                    for (std::int64_t w = 0; w < OW; ++w)
+                    {
+                        const std::size_t i = static_cast<std::size_t>(w);
+                        const int y = Bilinear(planes.y, planes.y_row, planes.y_step, ly, luma_x[i]);
+                        if (C == 1)
+                        {
+                            dst_row[w] = ConvertLuma(y, k);
+                            continue;
+                        }
+                        const int u = Bilinear(planes.u, planes.c_row, planes.c_step, cy, chroma_x[i]);
+                        const int v = Bilinear(planes.v, planes.c_row, planes.c_step, cy, chroma_x[i]);
+                        std::uint8_t *px = dst_row + 3 * w;
+                        if (bgr)
+                        {
+                            ConvertPixel(y, u, v, k, px + 2, px + 1, px);
+                        }
+                        else
+                        {
+                            ConvertPixel(y, u, v, k, px, px + 1, px + 2);
+                        }
+                    }
+                }
+            };
+            RunRows(OH, OW, fn);
+
+            return core::Status::Ok();
+        }
+} // namespace ptk::operators
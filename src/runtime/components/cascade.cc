@@ -0,0 +1,399 @@
+#include "runtime/components/cascade.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "operators/crop_resize.h"
+#include "operators/preprocessor.h"
+#include "runtime/core/runtime_context.h"
+#include "runtime/core/thread_pool.h"
+
+namespace ptk::components
+{
+
+        core::Status DecodeBoxRows(const std::vector<data::TensorView> &outputs, std::vector<data::Detection> *out)
+        {
+            if (outputs.empty() || outputs[0].dtype() != core::DataType::kFloat32)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "DecodeBoxRows: expects a float32 output");
+            }
+            const data::TensorShape &shape = outputs[0].shape();
+            const bool batched = shape.rank() == 3 && shape.dim(0) == 1;
+            if (shape.rank() != 2 && !batched)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "DecodeBoxRows: expects [N,K] or [1,N,K]");
+            }
+            const std::int64_t rows = shape.dim(batched ? 1 : 0);
+            const std::int64_t cols = shape.dim(batched ? 2 : 1);
+            if (cols < 6)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "DecodeBoxRows: rows need at least 6 values");
+            }
+
+            const float *p = static_cast<const float *>(outputs[0].buffer().data());
+            out->resize(static_cast<std::size_t>(rows));
+            for (std::int64_t r = 0; r < rows; ++r, p += cols)
+            {
+                data::Detection &d = (*out)[static_cast<std::size_t>(r)];
+                d.x0 = p[0];
+                d.y0 = p[1];
+                d.x1 = p[2];
+                d.y1 = p[3];
+                d.score = p[4];
+                d.class_id = static_cast<int>(p[5]);
+            }
+            return core::Status::Ok();
+        }
+
+        CascadeComponent::CascadeComponent(perception::Engine *detector, perception::Engine *classifier,
+                                           const CascadeConfig &config)
+            : detector_(detector), classifier_(classifier), config_(config), context_(nullptr), source_(nullptr),
+              detector_input_(nullptr), output_(nullptr)
+        {
+        }
+
+        void CascadeComponent::BindSource(core::InputPort<data::Frame> *in)
+        {
+            source_ = in;
+        }
+
+        void CascadeComponent::BindDetectorInput(core::InputPort<data::Frame> *in)
+        {
+            detector_input_ = in;
+        }
+
+        void CascadeComponent::BindOutput(core::OutputPort<data::DetectionList> *out)
+        {
+            output_ = out;
+        }
+
+        core::Status CascadeComponent::Init(core::RuntimeContext *context)
+        {
+            if (context == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "Context is null");
+            }
+            if (detector_ == nullptr || classifier_ == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "CascadeComponent: engine is null");
+            }
+            if (detector_->InputNames().size() != 1 || classifier_->InputNames().size() != 1)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                                    "CascadeComponent: engines must have exactly one input");
+            }
+            if (config_.max_rois < 1 || !config_.decode)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                                    "CascadeComponent: max_rois must be positive and decode set");
+            }
+            if (config_.classifier_output < 0 ||
+                static_cast<std::size_t>(config_.classifier_output) >= classifier_->OutputNames().size())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                                    "CascadeComponent: classifier_output out of range");
+            }
+            context_ = context;
+
+            const data::TensorSpec detector_spec = detector_->InputSpecs().front();
+            detector_rank_ = detector_spec.known() ? detector_spec.dims.size() : 0;
+
+            // The classifier's input spec fixes the crop size, layout and type.
+            const data::TensorSpec spec = classifier_->InputSpecs().front();
+            PreprocessorConfig crop{};
+            core::Status s = ConfigureFromModelInput(spec, &crop);
+            if (!s.ok())
+            {
+                return s;
+            }
+            if (spec.dims.size() != 4 || crop.target_height <= 0 || crop.target_width <= 0)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                                    "CascadeComponent: classifier input must be [N,C,H,W] or [N,H,W,C] with "
+                                    "static H, W and C");
+            }
+            const bool chw = crop.output_layout == core::TensorLayout::kNchw;
+            crop_height_ = crop.target_height;
+            crop_width_ = crop.target_width;
+            crop_channels_ = static_cast<int>(spec.dims[chw ? 1 : 3]);
+
+            // A fixed batch dim caps the ROIs and is always filled.
+            pad_batch_ = spec.dims[0] > 0;
+            if (pad_batch_)
+            {
+                config_.max_rois = std::min<int>(config_.max_rois, static_cast<int>(spec.dims[0]));
+            }
+
+            operators::BatchAssemblerConfig batch_config;
+            batch_config.max_batch_size = pad_batch_ ? static_cast<int>(spec.dims[0]) : config_.max_rois;
+            batch_config.layout = crop.output_layout;
+            batch_config.data_type = spec.dtype;
+            batch_config.channels = crop_channels_;
+            batch_config.height = crop_height_;
+            batch_config.width = crop_width_;
+            s = batch_.Init(batch_config);
+            if (!s.ok())
+            {
+                return s;
+            }
+
+            chain_ = operators::ElementwiseChain();
+            if (config_.swap_rb)
+            {
+                chain_.SwapRB();
+            }
+            if (config_.normalize)
+            {
+                chain_.Normalize(config_.norm);
+            }
+            chain_.ToLayout(chw ? core::TensorLayout::kChw : core::TensorLayout::kHwc).Cast(spec.dtype);
+            s = chain_.Compile();
+            if (!s.ok())
+            {
+                return s;
+            }
+
+            const std::size_t rois = static_cast<std::size_t>(config_.max_rois);
+            crop_storage_.assign(rois * static_cast<std::size_t>(crop_height_) * crop_width_ * crop_channels_, 0);
+            slots_.reserve(rois);
+            crop_status_.reserve(rois);
+            stats_ = CascadeStats();
+            return core::Status::Ok();
+        }
+
+        core::Status CascadeComponent::Start()
+        {
+            if (context_ == nullptr)
+            {
+                return core::Status(core::StatusCode::kFailedPrecondition, "CascadeComponent: not initialized");
+            }
+            if (source_ == nullptr || !source_->is_bound() || detector_input_ == nullptr ||
+                !detector_input_->is_bound() || output_ == nullptr || !output_->is_bound())
+            {
+                return core::Status(core::StatusCode::kFailedPrecondition, "CascadeComponent ports not bound");
+            }
+            context_->LogInfo("CascadeComponent started.");
+            return core::Status::Ok();
+        }
+
+        core::Status CascadeComponent::Stop()
+        {
+            if (context_ != nullptr)
+            {
+                context_->LogInfo("CascadeComponent stopped: " + std::to_string(stats_.frames) + " frames, " +
+                                  std::to_string(stats_.rois) + " ROIs classified, " +
+                                  std::to_string(stats_.capped) + " over the cap, " +
+                                  std::to_string(stats_.failures) + " failed.");
+            }
+            return core::Status::Ok();
+        }
+
+        core::Status CascadeComponent::RunDetector(const data::Frame &source, const data::Frame &detector_input)
+        {
+            data::TensorView input = detector_input.image;
+            if (input.shape().rank() + 1 == detector_rank_)
+            {
+                std::vector<std::int64_t> dims = input.shape().dims();
+                dims.insert(dims.begin(), 1);
+                input = data::TensorView(input.buffer(), input.dtype(), data::TensorShape(dims));
+            }
+            detector_inputs_.assign(1, input);
+            detector_outputs_.clear();
+            if (!detector_->Infer(detector_inputs_, detector_outputs_))
+            {
+                return core::Status(core::StatusCode::kInternal, "CascadeComponent: detector Infer failed");
+            }
+
+            detections_.clear();
+            core::Status s = config_.decode(detector_outputs_, &detections_);
+            if (!s.ok())
+            {
+                return s;
+            }
+            // Boxes with no area (or NaN corners) have nothing to crop.
+            detections_.erase(std::remove_if(detections_.begin(), detections_.end(),
+                                             [this](const data::Detection &d)
+                                             {
+                                                 return d.score < config_.min_score || !(d.x1 > d.x0) ||
+                                                        !(d.y1 > d.y0);
+                                             }),
+                              detections_.end());
+            std::stable_sort(detections_.begin(), detections_.end(),
+                             [](const data::Detection &a, const data::Detection &b)
+                             { return a.score > b.score; });
+
+            // Detector input pixels to camera pixels, through whatever crop,
+            // pad, orientation or binning produced the detector input, then
+            // back into the source image.
+            data::PixelTransform from_camera;
+            if (!source.to_source.Invert(&from_camera))
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                                    "CascadeComponent: source frame transform is singular");
+            }
+            const data::PixelTransform to_source = data::Compose(from_camera, detector_input.to_source);
+            for (data::Detection &d : detections_)
+            {
+                // Quarter turns and flips swap or reverse edges, so the mapped
+                // corners are re-sorted.
+                double ax = 0.0;
+                double ay = 0.0;
+                double bx = 0.0;
+                double by = 0.0;
+                to_source.Apply(d.x0, d.y0, &ax, &ay);
+                to_source.Apply(d.x1, d.y1, &bx, &by);
+                d.x0 = static_cast<float>(std::min(ax, bx));
+                d.x1 = static_cast<float>(std::max(ax, bx));
+                d.y0 = static_cast<float>(std::min(ay, by));
+                d.y1 = static_cast<float>(std::max(ay, by));
+                d.label = -1;
+                d.label_score = 0.0f;
+                d.attributes.clear();
+            }
+            return core::Status::Ok();
+        }
+
+        core::Status CascadeComponent::RunClassifier(const data::Frame &source)
+        {
+            const std::size_t n = std::min<std::size_t>(detections_.size(), static_cast<std::size_t>(config_.max_rois));
+            batch_.Reset();
+            slots_.clear();
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                data::TensorView slot;
+                core::Status s = batch_.AcquireSlot(source, &slot);
+                if (!s.ok())
+                {
+                    return s;
+                }
+                slots_.push_back(slot);
+            }
+
+            // Boxes are independent: each is resampled into its own crop and
+            // converted into its batch slot on one pool thread.
+            const std::size_t crop_bytes = static_cast<std::size_t>(crop_height_) * crop_width_ * crop_channels_;
+            crop_status_.assign(n, core::Status::Ok());
+            core::ThreadPool::Default().ParallelFor(
+                0, static_cast<std::int64_t>(n), 1, [&](std::int64_t b, std::int64_t e)
+                {
+                    for (std::int64_t i = b; i < e; ++i)
+                    {
+                        const std::size_t k = static_cast<std::size_t>(i);
+                        const data::Detection &d = detections_[k];
+                        const float pw = (d.x1 - d.x0) * config_.roi_padding;
+                        const float ph = (d.y1 - d.y0) * config_.roi_padding;
+                        operators::CropBox box;
+                        box.x0 = d.x0 - pw;
+                        box.y0 = d.y0 - ph;
+                        box.x1 = d.x1 + pw;
+                        box.y1 = d.y1 + ph;
+
+                        data::TensorView crop(
+                            data::BufferView(crop_storage_.data() + k * crop_bytes, crop_bytes, core::DeviceType::kCpu),
+                            core::DataType::kUint8,
+                            data::TensorShape({crop_height_, crop_width_, crop_channels_}));
+                        core::Status s = operators::CropResize(source.image, box, &crop);
+                        if (s.ok())
+                        {
+                            s = chain_.Run(crop, &slots_[k]);
+                        }
+                        crop_status_[k] = s;
+                    }
+                });
+            for (const core::Status &s : crop_status_)
+            {
+                if (!s.ok())
+                {
+                    return s;
+                }
+            }
+
+            data::TensorView batch;
+            core::Status s = batch_.Finalize(pad_batch_, &batch);
+            if (!s.ok())
+            {
+                return s;
+            }
+            classifier_inputs_.assign(1, batch);
+            classifier_outputs_.clear();
+            if (!classifier_->Infer(classifier_inputs_, classifier_outputs_))
+            {
+                return core::Status(core::StatusCode::kInternal, "CascadeComponent: classifier Infer failed");
+            }
+
+            const data::TensorView &out = classifier_outputs_[static_cast<std::size_t>(config_.classifier_output)];
+            if (out.dtype() != core::DataType::kFloat32 || out.shape().rank() == 0 ||
+                out.shape().dim(0) != batch.shape().dim(0))
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                                    "CascadeComponent: classifier output must be float32 with the batch dim first");
+            }
+            const std::size_t row = out.num_elements() / static_cast<std::size_t>(out.shape().dim(0));
+            const float *p = static_cast<const float *>(out.buffer().data());
+            for (std::size_t i = 0; i < n; ++i, p += row)
+            {
+                data::Detection &d = detections_[i];
+                d.attributes.assign(p, p + row);
+                const float *best = std::max_element(p, p + row);
+                d.label = row > 0 ? static_cast<int>(best - p) : -1;
+                d.label_score = row > 0 ? *best : 0.0f;
+            }
+            stats_.rois += n;
+            stats_.capped += detections_.size() - n;
+            return core::Status::Ok();
+        }
+
+        void CascadeComponent::Tick()
+        {
+            if (context_ == nullptr)
+            {
+                return;
+            }
+            if (source_ == nullptr || !source_->is_bound() || detector_input_ == nullptr ||
+                !detector_input_->is_bound() || output_ == nullptr || !output_->is_bound())
+            {
+                context_->LogError("CascadeComponent: ports not bound");
+                return;
+            }
+            const data::Frame *source = source_->get();
+            const data::Frame *detector_input = detector_input_->get();
+            data::DetectionList *out = output_->get();
+            if (source == nullptr || detector_input == nullptr || out == nullptr || source->image.empty() ||
+                detector_input->image.empty())
+            {
+                context_->LogError("CascadeComponent: empty input frame");
+                return;
+            }
+            if (source->image.dtype() != core::DataType::kUint8 || source->image.shape().rank() != 3 ||
+                source->image.shape().dim(2) != crop_channels_)
+            {
+                context_->LogError("CascadeComponent: source must be a uint8 [H,W,C] frame matching the classifier");
+                return;
+            }
+
+            const std::int64_t start = context_->NowNanoseconds();
+            core::Status s = RunDetector(*source, *detector_input);
+            if (s.ok() && !detections_.empty())
+            {
+                s = RunClassifier(*source);
+            }
+            stats_.last_latency_ns = context_->NowNanoseconds() - start;
+            if (!s.ok())
+            {
+                ++stats_.failures;
+                context_->LogError("CascadeComponent: " + s.message());
+                return;
+            }
+            ++stats_.frames;
+
+            // Swapped so both vectors keep their capacity across frames.
+            out->detections.swap(detections_);
+            out->classified = static_cast<int>(
+                std::min<std::size_t>(out->detections.size(), static_cast<std::size_t>(config_.max_rois)));
+            out->timestamp_ns = source->timestamp_ns;
+            out->frame_index = source->frame_index;
+            out->camera_id = source->camera_id;
+        }
+
+} // namespace ptk::components
@@ -0,0 +1,400 @@
+#include "runtime/components/dynamic_batcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "engines/thread_output_storage.h"
+#include "runtime/core/runtime_context.h"
+
+namespace ptk::components
+{
+
+        namespace
+        {
+            constexpr int kDelayBuckets = 32;
+
+            int DelayBucket(std::chrono::steady_clock::duration delay)
+            {
+                std::int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(delay).count();
+                int bucket = 0;
+                while (us > 1 && bucket < kDelayBuckets - 1)
+                {
+                    us >>= 1;
+                    ++bucket;
+                }
+                return bucket;
+            }
+
+            bool SameShapes(const std::vector<data::TensorView> &a, const std::vector<data::TensorView> &b)
+            {
+                if (a.size() != b.size())
+                {
+                    return false;
+                }
+                for (std::size_t i = 0; i < a.size(); ++i)
+                {
+                    if (a[i].dtype() != b[i].dtype() || a[i].shape().dims() != b[i].shape().dims())
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        } // namespace
+
+        DynamicBatcher::DynamicBatcher(perception::Engine *engine, const DynamicBatcherConfig &config)
+            : engine_(engine), config_(config), context_(nullptr), num_inputs_(0), num_outputs_(0), running_(false)
+        {
+        }
+
+        DynamicBatcher::~DynamicBatcher()
+        {
+            Shutdown();
+        }
+
+        core::Status DynamicBatcher::Init(core::RuntimeContext *context)
+        {
+            if (context == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "Context is null");
+            }
+            if (engine_ == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "DynamicBatcher: engine is null");
+            }
+            if (config_.max_batch_size < 1 || config_.max_wait_us < 0 || config_.max_queue < 1)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                                    "DynamicBatcher: max_batch_size and max_queue must be positive");
+            }
+            context_ = context;
+            // The engine is loaded before the pipeline is built, so its I/O
+            // counts are fixed from here on.
+            num_inputs_ = engine_->InputNames().size();
+            num_outputs_ = engine_->OutputNames().size();
+
+            stats_ = DynamicBatcherStats();
+            stats_.batch_size.assign(static_cast<std::size_t>(config_.max_batch_size) + 1, 0);
+            stats_.queue_delay_us.assign(kDelayBuckets, 0);
+            batch_.reserve(static_cast<std::size_t>(config_.max_batch_size));
+
+            // Inputs whose per-sample shape the model fixes get their full
+            // batch buffers now rather than on the first batch.
+            const std::vector<data::TensorSpec> specs = engine_->InputSpecs();
+            batch_storage_.resize(num_inputs_);
+            for (std::size_t i = 0; i < specs.size() && i < num_inputs_; ++i)
+            {
+                const data::TensorSpec &spec = specs[i];
+                if (!spec.known())
+                {
+                    continue;
+                }
+                std::vector<std::int64_t> sample(spec.dims.begin() + 1, spec.dims.end());
+                const bool fixed = std::all_of(sample.begin(), sample.end(), [](std::int64_t d)
+                                               { return d >= 0; });
+                if (fixed)
+                {
+                    batch_storage_[i].reserve(spec.bytes(data::TensorShape(sample)) *
+                                              static_cast<std::size_t>(config_.max_batch_size));
+                }
+            }
+            return core::Status::Ok();
+        }
+
+        core::Status DynamicBatcher::Start()
+        {
+            if (context_ == nullptr)
+            {
+                return core::Status(core::StatusCode::kFailedPrecondition, "DynamicBatcher: not initialized");
+            }
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                running_ = true;
+            }
+            if (config_.own_thread)
+            {
+                worker_ = std::thread(&DynamicBatcher::WorkerLoop, this);
+            }
+            context_->LogInfo("DynamicBatcher started.");
+            return core::Status::Ok();
+        }
+
+        core::Status DynamicBatcher::Stop()
+        {
+            Shutdown();
+            if (context_ != nullptr)
+            {
+                const DynamicBatcherStats s = stats();
+                const double mean = s.batches > 0 ? static_cast<double>(s.requests) / s.batches : 0.0;
+                context_->LogInfo("DynamicBatcher stopped: " + std::to_string(s.requests) + " requests in " +
+                                  std::to_string(s.batches) + " batches (mean " + std::to_string(mean) + "), " +
+                                  std::to_string(s.rejected) + " rejected.");
+            }
+            return core::Status::Ok();
+        }
+
+        void DynamicBatcher::Shutdown()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                running_ = false;
+            }
+            queue_cv_.notify_all();
+            if (worker_.joinable())
+            {
+                worker_.join();
+            }
+
+            // Requests still queued will never run.
+            std::lock_guard<std::mutex> lock(mu_);
+            for (Request *r : queue_)
+            {
+                r->status = core::Status(core::StatusCode::kFailedPrecondition, "DynamicBatcher: stopped");
+                r->done = true;
+            }
+            queue_.clear();
+            done_cv_.notify_all();
+        }
+
+        void DynamicBatcher::Tick()
+        {
+            if (config_.own_thread)
+            {
+                return;
+            }
+            std::unique_lock<std::mutex> lock(mu_);
+            while (running_ && !queue_.empty())
+            {
+                const bool full = static_cast<int>(queue_.size()) >= config_.max_batch_size;
+                const bool expired =
+                    Clock::now() >= queue_.front()->enqueued + std::chrono::microseconds(config_.max_wait_us);
+                if (!full && !expired)
+                {
+                    break;
+                }
+                TakeBatch(&batch_);
+                RunTaken(lock);
+            }
+        }
+
+        void DynamicBatcher::WorkerLoop()
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            while (true)
+            {
+                queue_cv_.wait(lock, [this]
+                               { return !running_ || !queue_.empty(); });
+                if (!running_)
+                {
+                    break;
+                }
+                const Clock::time_point deadline =
+                    queue_.front()->enqueued + std::chrono::microseconds(config_.max_wait_us);
+                queue_cv_.wait_until(lock, deadline, [this]
+                                     { return !running_ || static_cast<int>(queue_.size()) >= config_.max_batch_size; });
+                if (!running_)
+                {
+                    break;
+                }
+                TakeBatch(&batch_);
+                RunTaken(lock);
+            }
+        }
+
+        void DynamicBatcher::TakeBatch(std::vector<Request *> *batch)
+        {
+            batch->clear();
+            const Clock::time_point now = Clock::now();
+            const std::vector<data::TensorView> &first = *queue_.front()->inputs;
+            for (auto it = queue_.begin(); it != queue_.end() && static_cast<int>(batch->size()) < config_.max_batch_size;)
+            {
+                // A request of another shape waits, in order, for a batch of its own.
+                if (!SameShapes(*(*it)->inputs, first))
+                {
+                    ++it;
+                    continue;
+                }
+                ++stats_.queue_delay_us[DelayBucket(now - (*it)->enqueued)];
+                batch->push_back(*it);
+                it = queue_.erase(it);
+            }
+            ++stats_.batches;
+            stats_.requests += batch->size();
+            ++stats_.batch_size[batch->size()];
+        }
+
+        void DynamicBatcher::RunTaken(std::unique_lock<std::mutex> &lock)
+        {
+            lock.unlock();
+            RunBatch(batch_);
+            lock.lock();
+            for (Request *r : batch_)
+            {
+                r->done = true;
+            }
+            done_cv_.notify_all();
+        }
+
+        void DynamicBatcher::RunBatch(const std::vector<Request *> &batch)
+        {
+            core::Status s = GatherInputs(batch);
+            if (s.ok() && !engine_->Infer(batch_inputs_, batch_outputs_))
+            {
+                s = core::Status(core::StatusCode::kInternal, "DynamicBatcher: engine Infer failed");
+            }
+            if (!s.ok())
+            {
+                for (Request *r : batch)
+                {
+                    r->status = s;
+                }
+                return;
+            }
+            ScatterOutputs(batch);
+        }
+
+        core::Status DynamicBatcher::GatherInputs(const std::vector<Request *> &batch)
+        {
+            const std::vector<data::TensorView> &first = *batch.front()->inputs;
+            const std::int64_t rows = config_.pad_to_max_batch ? config_.max_batch_size
+                                                               : static_cast<std::int64_t>(batch.size());
+            batch_storage_.resize(first.size());
+            batch_inputs_.clear();
+            for (std::size_t i = 0; i < first.size(); ++i)
+            {
+                const std::size_t sample_bytes = first[i].bytes();
+                // Sized for a full batch so the buffer, and the engine's binding
+                // of it, stays put as the batch size varies.
+                std::vector<std::uint8_t> &buf = batch_storage_[i];
+                buf.resize(sample_bytes * static_cast<std::size_t>(config_.max_batch_size));
+                for (std::size_t k = 0; k < batch.size(); ++k)
+                {
+                    std::memcpy(buf.data() + k * sample_bytes, (*batch[k]->inputs)[i].buffer().data(), sample_bytes);
+                }
+                const std::size_t used = sample_bytes * static_cast<std::size_t>(rows);
+                if (used > batch.size() * sample_bytes)
+                {
+                    std::memset(buf.data() + batch.size() * sample_bytes, 0, used - batch.size() * sample_bytes);
+                }
+
+                std::vector<std::int64_t> dims;
+                dims.reserve(first[i].shape().rank() + 1);
+                dims.push_back(rows);
+                dims.insert(dims.end(), first[i].shape().dims().begin(), first[i].shape().dims().end());
+                batch_inputs_.emplace_back(data::BufferView(buf.data(), used, core::DeviceType::kCpu),
+                                           first[i].dtype(), data::TensorShape(dims));
+            }
+            return core::Status::Ok();
+        }
+
+        void DynamicBatcher::ScatterOutputs(const std::vector<Request *> &batch)
+        {
+            const std::int64_t rows = config_.pad_to_max_batch ? config_.max_batch_size
+                                                               : static_cast<std::int64_t>(batch.size());
+            for (const auto &out : batch_outputs_)
+            {
+                if (out.shape().rank() == 0 || out.shape().dim(0) != rows)
+                {
+                    for (Request *r : batch)
+                    {
+                        r->status = core::Status(core::StatusCode::kInternal,
+                                                 "DynamicBatcher: output has no matching batch dimension");
+                    }
+                    return;
+                }
+            }
+
+            for (std::size_t k = 0; k < batch.size(); ++k)
+            {
+                Request *r = batch[k];
+                r->status = core::Status::Ok();
+                if (r->storage != nullptr)
+                {
+                    r->storage->resize(batch_outputs_.size());
+                    r->outputs->clear();
+                }
+                for (std::size_t i = 0; i < batch_outputs_.size(); ++i)
+                {
+                    const data::TensorView &out = batch_outputs_[i];
+                    const std::size_t slice_bytes = out.bytes() / static_cast<std::size_t>(rows);
+                    const std::uint8_t *src = static_cast<const std::uint8_t *>(out.buffer().data()) + k * slice_bytes;
+                    if (r->storage == nullptr)
+                    {
+                        data::TensorView &dst = (*r->outputs)[i];
+                        if (dst.buffer().size_bytes() < slice_bytes)
+                        {
+                            r->status = core::Status(core::StatusCode::kInvalidArgument,
+                                                     "DynamicBatcher: output buffer too small");
+                            break;
+                        }
+                        std::memcpy(dst.buffer().data(), src, slice_bytes);
+                        continue;
+                    }
+                    std::vector<std::uint8_t> &buf = (*r->storage)[i];
+                    buf.resize(slice_bytes);
+                    std::memcpy(buf.data(), src, slice_bytes);
+                    const std::vector<std::int64_t> &dims = out.shape().dims();
+                    r->outputs->emplace_back(data::BufferView(buf.data(), slice_bytes, core::DeviceType::kCpu),
+                                             out.dtype(),
+                                             data::TensorShape(std::vector<std::int64_t>(dims.begin() + 1, dims.end())));
+                }
+            }
+        }
+
+        core::Status DynamicBatcher::Infer(const std::vector<data::TensorView> &inputs,
+                                           std::vector<data::TensorView> &outputs)
+        {
+            if (inputs.size() != num_inputs_)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                                    "DynamicBatcher: expected " + std::to_string(num_inputs_) + " inputs");
+            }
+            for (const auto &tv : inputs)
+            {
+                if (tv.empty() || !tv.is_contiguous())
+                {
+                    return core::Status(core::StatusCode::kInvalidArgument,
+                                        "DynamicBatcher: inputs must be non-empty and contiguous");
+                }
+            }
+
+            Request req;
+            req.inputs = &inputs;
+            req.outputs = &outputs;
+            bool caller_buffers = outputs.size() == num_outputs_;
+            for (std::size_t i = 0; caller_buffers && i < outputs.size(); ++i)
+            {
+                caller_buffers = !outputs[i].empty() && !perception::PointsIntoThreadStorage(outputs[i]);
+            }
+            if (!caller_buffers)
+            {
+                // This producer's storage; the batching thread fills it.
+                req.storage = &perception::ThreadOutputStorage();
+            }
+
+            std::unique_lock<std::mutex> lock(mu_);
+            if (!running_)
+            {
+                return core::Status(core::StatusCode::kFailedPrecondition, "DynamicBatcher: not running");
+            }
+            if (static_cast<int>(queue_.size()) >= config_.max_queue)
+            {
+                ++stats_.rejected;
+                return core::Status(core::StatusCode::kFailedPrecondition, "DynamicBatcher: queue full");
+            }
+            req.enqueued = Clock::now();
+            queue_.push_back(&req);
+            queue_cv_.notify_one();
+            done_cv_.wait(lock, [&req]
+                          { return req.done; });
+            return req.status;
+        }
+
+        DynamicBatcherStats DynamicBatcher::stats() const
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            return stats_;
+        }
+
+} // namespace ptk::components
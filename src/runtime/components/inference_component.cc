@@ -0,0 +1,274 @@
+#include "runtime/components/inference_component.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "runtime/core/runtime_context.h"
+
+namespace ptk::components
+{
+
+        InferenceComponent::InferenceComponent(perception::Engine *engine, const InferenceComponentConfig &config)
+            : engine_(engine), config_(config), context_(nullptr), input_(nullptr)
+        {
+        }
+
+        void InferenceComponent::BindInput(core::InputPort<data::Frame> *in)
+        {
+            input_ = in;
+        }
+
+        void InferenceComponent::BindOutput(std::size_t index, core::OutputPort<data::TensorPacket> *out)
+        {
+            if (index >= outputs_.size())
+            {
+                outputs_.resize(index + 1, nullptr);
+            }
+            outputs_[index] = out;
+        }
+
+        bool InferenceComponent::BindOutput(const std::string &name, core::OutputPort<data::TensorPacket> *out)
+        {
+            if (engine_ == nullptr)
+            {
+                return false;
+            }
+            const std::vector<std::string> names = engine_->OutputNames();
+            auto it = std::find(names.begin(), names.end(), name);
+            if (it == names.end())
+            {
+                return false;
+            }
+            BindOutput(static_cast<std::size_t>(it - names.begin()), out);
+            return true;
+        }
+
+        core::Status InferenceComponent::Init(core::RuntimeContext *context)
+        {
+            if (context == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "Context is null");
+            }
+            if (engine_ == nullptr)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument, "InferenceComponent: engine is null");
+            }
+            if (engine_->InputNames().size() != 1)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                                    "InferenceComponent: model must have exactly one input");
+            }
+            if (config_.output_buffers < 1)
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                                    "InferenceComponent: output_buffers must be positive");
+            }
+            context_ = context;
+
+            input_spec_ = engine_->InputSpecs().front();
+            output_specs_ = engine_->OutputSpecs();
+            output_names_ = engine_->OutputNames();
+            if (outputs_.size() > output_names_.size())
+            {
+                return core::Status(core::StatusCode::kInvalidArgument,
+                                    "InferenceComponent: output port bound past the model's outputs");
+            }
+            outputs_.resize(output_names_.size(), nullptr);
+
+            buffers_.assign(static_cast<std::size_t>(config_.output_buffers),
+                            std::vector<std::vector<std::uint8_t>>(output_names_.size()));
+            slot_ = 0;
+            stats_ = InferenceStats();
+            resolved_ = false;
+
+            // A fully static model gets every buffer now, so the first frame
+            // does not allocate.
+            if (input_spec_.is_static() && ResolveOutputShapes(data::TensorShape(input_spec_.dims)))
+            {
+                for (auto &slot : buffers_)
+                {
+                    for (std::size_t i = 0; i < slot.size(); ++i)
+                    {
+                        slot[i].resize(output_specs_[i].bytes(resolved_shapes_[i]));
+                    }
+                }
+            }
+            return core::Status::Ok();
+        }
+
+        core::Status InferenceComponent::Start()
+        {
+            if (context_ == nullptr)
+            {
+                return core::Status(core::StatusCode::kFailedPrecondition, "InferenceComponent: not initialized");
+            }
+            if (input_ == nullptr || !input_->is_bound())
+            {
+                return core::Status(core::StatusCode::kFailedPrecondition, "InferenceComponent input not bound");
+            }
+            context_->LogInfo("InferenceComponent started.");
+            return core::Status::Ok();
+        }
+
+        core::Status InferenceComponent::Stop()
+        {
+            if (context_ != nullptr)
+            {
+                const double mean_ms =
+                    stats_.frames > 0 ? static_cast<double>(stats_.total_latency_ns) / stats_.frames / 1e6 : 0.0;
+                context_->LogInfo("InferenceComponent stopped: " + std::to_string(stats_.frames) + " frames (mean " +
+                                  std::to_string(mean_ms) + " ms), " + std::to_string(stats_.failures) +
+                                  " failed.");
+            }
+            return core::Status::Ok();
+        }
+
+        bool InferenceComponent::ResolveOutputShapes(const data::TensorShape &input_shape)
+        {
+            resolved_ = true;
+            resolved_input_ = input_shape.dims();
+            resolved_shapes_.clear();
+            if (!input_spec_.known() || input_spec_.dims.size() != input_shape.rank())
+            {
+                return false;
+            }
+
+            std::vector<std::pair<std::string, std::int64_t>> bound;
+            for (std::size_t d = 0; d < input_spec_.dims.size(); ++d)
+            {
+                if (input_spec_.dims[d] < 0 && d < input_spec_.dim_names.size() && !input_spec_.dim_names[d].empty())
+                {
+                    bound.emplace_back(input_spec_.dim_names[d], input_shape.dim(d));
+                }
+            }
+
+            std::vector<data::TensorShape> shapes;
+            for (const data::TensorSpec &spec : output_specs_)
+            {
+                if (!spec.known())
+                {
+                    return false;
+                }
+                std::vector<std::int64_t> dims = spec.dims;
+                for (std::size_t d = 0; d < dims.size(); ++d)
+                {
+                    if (dims[d] >= 0)
+                    {
+                        continue;
+                    }
+                    auto it = std::find_if(bound.begin(), bound.end(), [&](const auto &b)
+                                           { return d < spec.dim_names.size() && !spec.dim_names[d].empty() &&
+                                                    b.first == spec.dim_names[d]; });
+                    if (it == bound.end())
+                    {
+                        return false;
+                    }
+                    dims[d] = it->second;
+                }
+                shapes.emplace_back(dims);
+            }
+            resolved_shapes_ = std::move(shapes);
+            return true;
+        }
+
+        void InferenceComponent::Tick()
+        {
+            if (context_ == nullptr)
+            {
+                return;
+            }
+            if (input_ == nullptr || !input_->is_bound())
+            {
+                context_->LogError("InferenceComponent: input port not bound");
+                return;
+            }
+            const data::Frame *frame = input_->get();
+            if (frame == nullptr || frame->image.empty())
+            {
+                context_->LogError("InferenceComponent: input frame has empty image tensor");
+                return;
+            }
+            if (!frame->image.is_contiguous())
+            {
+                context_->LogError("InferenceComponent: input image must be contiguous");
+                return;
+            }
+
+            data::TensorView input = frame->image;
+            if (input_spec_.known() && input.shape().rank() + 1 == input_spec_.dims.size())
+            {
+                std::vector<std::int64_t> dims = input.shape().dims();
+                dims.insert(dims.begin(), 1);
+                input = data::TensorView(input.buffer(), input.dtype(), data::TensorShape(dims));
+            }
+            inputs_.assign(1, input);
+
+            if (!resolved_ || resolved_input_ != input.shape().dims())
+            {
+                ResolveOutputShapes(input.shape());
+            }
+
+            slot_ = (slot_ + 1) % buffers_.size();
+            std::vector<std::vector<std::uint8_t>> &buffers = buffers_[slot_];
+
+            const std::int64_t start = context_->NowNanoseconds();
+            results_.clear();
+            bool ok = false;
+            if (!resolved_shapes_.empty())
+            {
+                // Shapes are known up front: the engine writes in place.
+                for (std::size_t i = 0; i < buffers.size(); ++i)
+                {
+                    const std::size_t bytes = output_specs_[i].bytes(resolved_shapes_[i]);
+                    buffers[i].resize(bytes);
+                    data::BufferView bv(buffers[i].data(), bytes, core::DeviceType::kCpu);
+                    results_.emplace_back(bv, output_specs_[i].dtype, resolved_shapes_[i]);
+                }
+                ok = engine_->Infer(inputs_, results_);
+            }
+            else
+            {
+                ok = engine_->Infer(inputs_, results_) && results_.size() == buffers.size();
+                for (std::size_t i = 0; ok && i < results_.size(); ++i)
+                {
+                    const data::TensorView &src = results_[i];
+                    const std::size_t bytes = src.buffer().size_bytes();
+                    buffers[i].resize(bytes);
+                    std::memcpy(buffers[i].data(), src.buffer().data(), bytes);
+                    data::BufferView bv(buffers[i].data(), bytes, core::DeviceType::kCpu);
+                    results_[i] = data::TensorView(bv, src.dtype(), src.shape());
+                }
+            }
+            stats_.last_latency_ns = context_->NowNanoseconds() - start;
+
+            if (!ok)
+            {
+                ++stats_.failures;
+                context_->LogError("InferenceComponent: Infer failed for frame " +
+                                   std::to_string(frame->frame_index));
+                return;
+            }
+            ++stats_.frames;
+            stats_.total_latency_ns += stats_.last_latency_ns;
+            Publish(*frame);
+        }
+
+        void InferenceComponent::Publish(const data::Frame &frame)
+        {
+            for (std::size_t i = 0; i < outputs_.size(); ++i)
+            {
+                if (outputs_[i] == nullptr || !outputs_[i]->is_bound())
+                {
+                    continue;
+                }
+                data::TensorPacket *packet = outputs_[i]->get();
+                packet->tensor = results_[i];
+                packet->timestamp_ns = frame.timestamp_ns;
+                packet->frame_index = frame.frame_index;
+                packet->camera_id = frame.camera_id;
+            }
+        }
+
+} // namespace ptk::components
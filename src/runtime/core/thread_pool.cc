@@ -0,0 +1,133 @@
+#include "runtime/core/thread_pool.h"
+
+#include <algorithm>
+
+namespace ptk::core
+{
+
+        namespace
+        {
+            thread_local bool tls_in_pool_task = false;
+        }
+
+        ThreadPool::ThreadPool(int num_threads)
+            : fn_(nullptr),
+              begin_(0),
+              end_(0),
+              chunk_size_(0),
+              num_chunks_(0),
+              next_chunk_(0),
+              active_workers_(0),
+              generation_(0),
+              stop_(false)
+        {
+            const int workers = std::max(num_threads, 1) - 1;
+            workers_.reserve(static_cast<std::size_t>(workers));
+            for (int i = 0; i < workers; ++i)
+            {
+                workers_.emplace_back([this]() { WorkerLoop(); });
+            }
+        }
+
+        ThreadPool::~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                stop_ = true;
+            }
+            work_cv_.notify_all();
+            for (auto &t : workers_)
+            {
+                t.join();
+            }
+        }
+
+        ThreadPool &ThreadPool::Default()
+        {
+            static ThreadPool pool(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+            return pool;
+        }
+
+        void ThreadPool::RunChunks()
+        {
+            for (;;)
+            {
+                const std::int64_t i = next_chunk_.fetch_add(1, std::memory_order_relaxed);
+                if (i >= num_chunks_)
+                {
+                    return;
+                }
+                const std::int64_t b = begin_ + i * chunk_size_;
+                const std::int64_t e = std::min(end_, b + chunk_size_);
+                (*fn_)(b, e);
+            }
+        }
+
+        void ThreadPool::WorkerLoop()
+        {
+            tls_in_pool_task = true;
+            std::uint64_t seen = 0;
+            for (;;)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mu_);
+                    work_cv_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+                    if (stop_)
+                    {
+                        return;
+                    }
+                    seen = generation_;
+                }
+
+                RunChunks();
+
+                std::lock_guard<std::mutex> lock(mu_);
+                if (--active_workers_ == 0)
+                {
+                    done_cv_.notify_one();
+                }
+            }
+        }
+
+        void ThreadPool::ParallelFor(std::int64_t begin, std::int64_t end, std::int64_t min_chunk,
+                                     const std::function<void(std::int64_t, std::int64_t)> &fn)
+        {
+            const std::int64_t n = end - begin;
+            if (n <= 0)
+            {
+                return;
+            }
+
+            min_chunk = std::max<std::int64_t>(min_chunk, 1);
+            const std::int64_t max_chunks = (n + min_chunk - 1) / min_chunk;
+            const std::int64_t chunks = std::min<std::int64_t>(max_chunks, num_threads());
+            if (chunks <= 1 || tls_in_pool_task)
+            {
+                fn(begin, end);
+                return;
+            }
+
+            std::lock_guard<std::mutex> run_lock(run_mu_);
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                fn_ = &fn;
+                begin_ = begin;
+                end_ = end;
+                chunk_size_ = (n + chunks - 1) / chunks;
+                num_chunks_ = (n + chunk_size_ - 1) / chunk_size_;
+                next_chunk_.store(0, std::memory_order_relaxed);
+                active_workers_ = static_cast<int>(workers_.size());
+                ++generation_;
+            }
+            work_cv_.notify_all();
+
+            tls_in_pool_task = true;
+            RunChunks();
+            tls_in_pool_task = false;
+
+            std::unique_lock<std::mutex> lock(mu_);
+            done_cv_.wait(lock, [&]() { return active_workers_ == 0; });
+            fn_ = nullptr;
+        }
+
+} // namespace ptk::core
@@ -0,0 +1,256 @@
+// Runs CascadeComponent on a Preprocessor-produced detector input and checks
+// that boxes and the crops taken for the classifier land on the source pixels
+// the detector saw.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "engines/engine.h"
+#include "operators/preprocessor.h"
+#include "runtime/components/cascade.h"
+#include "runtime/core/runtime_context.h"
+
+namespace
+{
+    using namespace ptk;
+
+    constexpr int kSourceHeight = 720;
+    constexpr int kSourceWidth = 1280;
+    constexpr int kDetectorSize = 640;
+    constexpr int kCropSize = 4;
+
+    // Source pixel (x, y) holds R = x / 5, G = y / 3, B = 0.
+    std::uint8_t SourceR(double x) { return static_cast<std::uint8_t>(static_cast<int>(x) / 5); }
+    std::uint8_t SourceG(double y) { return static_cast<std::uint8_t>(static_cast<int>(y) / 3); }
+
+    // Reports one fixed box in detector input pixels, plus any added ones.
+    class FakeDetector : public perception::Engine
+    {
+    public:
+        bool Load(const std::string &) override { return true; }
+
+        bool Infer(const std::vector<data::TensorView> &, std::vector<data::TensorView> &outputs) override
+        {
+            const std::int64_t n = static_cast<std::int64_t>(rows_.size() / 6);
+            outputs.assign(1, data::TensorView(data::BufferView(rows_.data(), rows_.size() * sizeof(float),
+                                                                core::DeviceType::kCpu),
+                                               core::DataType::kFloat32, data::TensorShape({n, 6})));
+            return true;
+        }
+
+        void AddBox(float x0, float y0, float x1, float y1, float score)
+        {
+            rows_.insert(rows_.end(), {x0, y0, x1, y1, score, 1.0f});
+        }
+
+        std::vector<std::string> InputNames() const override { return {"image"}; }
+        std::vector<std::string> OutputNames() const override { return {"boxes"}; }
+
+        std::vector<data::TensorSpec> InputSpecs() const override
+        {
+            data::TensorSpec spec;
+            spec.name = "image";
+            spec.dtype = core::DataType::kFloat32;
+            spec.dims = {1, 3, kDetectorSize, kDetectorSize};
+            spec.dim_names.resize(4);
+            return {spec};
+        }
+
+    private:
+        std::vector<float> rows_ = {100.0f, 100.0f, 200.0f, 200.0f, 0.9f, 1.0f};
+    };
+
+    // Keeps the crop it was given and outputs two scores per box.
+    class FakeClassifier : public perception::Engine
+    {
+    public:
+        bool Load(const std::string &) override { return true; }
+
+        bool Infer(const std::vector<data::TensorView> &inputs, std::vector<data::TensorView> &outputs) override
+        {
+            const data::TensorView &batch = inputs[0];
+            const float *p = static_cast<const float *>(batch.buffer().data());
+            crop.assign(p, p + 3 * kCropSize * kCropSize);
+            const std::int64_t n = batch.shape().dim(0);
+            scores_.assign(static_cast<std::size_t>(n) * 2, 0.0f);
+            for (std::int64_t i = 0; i < n; ++i)
+            {
+                scores_[static_cast<std::size_t>(i) * 2 + 1] = 1.0f;
+            }
+            outputs.assign(1, data::TensorView(
+                                  data::BufferView(scores_.data(), scores_.size() * sizeof(float), core::DeviceType::kCpu),
+                                  core::DataType::kFloat32, data::TensorShape({n, 2})));
+            return true;
+        }
+
+        std::vector<std::string> InputNames() const override { return {"crops"}; }
+        std::vector<std::string> OutputNames() const override { return {"scores"}; }
+
+        std::vector<data::TensorSpec> InputSpecs() const override
+        {
+            data::TensorSpec spec;
+            spec.name = "crops";
+            spec.dtype = core::DataType::kFloat32;
+            spec.dims = {-1, 3, kCropSize, kCropSize};
+            spec.dim_names = {"N", "", "", ""};
+            return {spec};
+        }
+
+        std::vector<float> crop; // [3, kCropSize, kCropSize] of the first box
+
+    private:
+        std::vector<float> scores_;
+    };
+
+    bool Near(double a, double b, double tolerance) { return std::fabs(a - b) <= tolerance; }
+
+    // Preprocesses the source for the detector with flip, runs the cascade and
+    // compares the published box and the classifier's crop with expected.
+    // With degenerate set the detector also reports higher-scoring boxes with
+    // no area, which must be dropped rather than fail the frame.
+    bool RunCase(const char *name, operators::FlipMode flip, double x0, double y0, double x1, double y1,
+                 bool degenerate = false)
+    {
+        core::RuntimeContext context;
+        context.Init(core::RuntimeContextOptions());
+
+        std::vector<std::uint8_t> pixels(static_cast<std::size_t>(kSourceHeight) * kSourceWidth * 3);
+        for (int y = 0; y < kSourceHeight; ++y)
+        {
+            for (int x = 0; x < kSourceWidth; ++x)
+            {
+                std::uint8_t *px = &pixels[(static_cast<std::size_t>(y) * kSourceWidth + x) * 3];
+                px[0] = SourceR(x);
+                px[1] = SourceG(y);
+                px[2] = 0;
+            }
+        }
+        data::Frame source;
+        source.pixel_format = core::PixelFormat::kRgb8;
+        source.layout = core::TensorLayout::kHwc;
+        source.image = data::TensorView(data::BufferView(pixels.data(), pixels.size(), core::DeviceType::kCpu),
+                                        core::DataType::kUint8,
+                                        data::TensorShape({kSourceHeight, kSourceWidth, 3}));
+
+        std::vector<float> detector_pixels(3 * kDetectorSize * kDetectorSize);
+        data::Frame detector_input;
+        detector_input.layout = core::TensorLayout::kNchw;
+        detector_input.image = data::TensorView(
+            data::BufferView(detector_pixels.data(), detector_pixels.size() * sizeof(float), core::DeviceType::kCpu),
+            core::DataType::kFloat32, data::TensorShape({1, 3, kDetectorSize, kDetectorSize}));
+
+        FakeDetector detector;
+        FakeClassifier classifier;
+        if (degenerate)
+        {
+            detector.AddBox(300.0f, 100.0f, 300.0f, 200.0f, 0.99f); // zero width
+            detector.AddBox(300.0f, 200.0f, 400.0f, 150.0f, 0.98f); // inverted
+            detector.AddBox(300.0f, 100.0f, 400.0f, 100.0f, 0.97f); // zero height
+        }
+
+        PreprocessorConfig pre{};
+        pre.input_layout = core::TensorLayout::kHwc;
+        pre.input_format = core::PixelFormat::kRgb8;
+        pre.input_type = core::DataType::kUint8;
+        pre.output_format = core::PixelFormat::kRgb8;
+        pre.flip = flip;
+        core::Status s = ConfigureFromModelInput(detector.InputSpecs().front(), &pre);
+        Preprocessor preprocessor(pre);
+        core::InputPort<data::Frame> pre_in;
+        core::OutputPort<data::Frame> pre_out;
+        pre_in.Bind(&source);
+        pre_out.Bind(&detector_input);
+        preprocessor.BindInput(&pre_in);
+        preprocessor.BindOutput(&pre_out);
+
+        components::CascadeComponent cascade(&detector, &classifier, components::CascadeConfig());
+        core::InputPort<data::Frame> source_in;
+        core::InputPort<data::Frame> detector_in;
+        core::OutputPort<data::DetectionList> out;
+        data::DetectionList detections;
+        source_in.Bind(&source);
+        detector_in.Bind(&detector_input);
+        out.Bind(&detections);
+        cascade.BindSource(&source_in);
+        cascade.BindDetectorInput(&detector_in);
+        cascade.BindOutput(&out);
+
+        if (s.ok())
+        {
+            s = preprocessor.Init(&context);
+        }
+        if (s.ok())
+        {
+            s = cascade.Init(&context);
+        }
+        if (s.ok())
+        {
+            s = preprocessor.Start();
+        }
+        if (s.ok())
+        {
+            s = cascade.Start();
+        }
+        if (!s.ok())
+        {
+            std::printf("%s: setup failed: %s\n", name, s.message().c_str());
+            return false;
+        }
+        preprocessor.Tick();
+        cascade.Tick();
+
+        if (detections.detections.size() != 1 || detections.classified != 1)
+        {
+            std::printf("%s: expected one classified box, got %zu (%d classified)\n", name,
+                        detections.detections.size(), detections.classified);
+            return false;
+        }
+        const data::Detection &d = detections.detections[0];
+        if (!Near(d.x0, x0, 1e-3) || !Near(d.y0, y0, 1e-3) || !Near(d.x1, x1, 1e-3) || !Near(d.y1, y1, 1e-3))
+        {
+            std::printf("%s: box (%g, %g, %g, %g), expected (%g, %g, %g, %g)\n", name, d.x0, d.y0, d.x1, d.y1, x0,
+                        y0, x1, y1);
+            return false;
+        }
+        if (d.label != 1)
+        {
+            std::printf("%s: label %d, expected 1\n", name, d.label);
+            return false;
+        }
+
+        // Each crop pixel samples the source at its center within the box;
+        // bilinear sampling of the stepped gradient stays within one level.
+        bool ok = true;
+        for (int i = 0; i < kCropSize; ++i)
+        {
+            const double sx = x0 + (x1 - x0) * (i + 0.5) / kCropSize;
+            const double sy = y0 + (y1 - y0) * (i + 0.5) / kCropSize;
+            const float r = classifier.crop[static_cast<std::size_t>(0 * kCropSize * kCropSize + i)];
+            const float g = classifier.crop[static_cast<std::size_t>(1 * kCropSize * kCropSize + i * kCropSize)];
+            if (!Near(r, SourceR(sx), 1.0) || !Near(g, SourceG(sy), 1.0))
+            {
+                std::printf("%s: crop sample %d is (%g, %g), expected about (%d, %d)\n", name, i, r, g,
+                            SourceR(sx), SourceG(sy));
+                ok = false;
+            }
+        }
+        return ok;
+    }
+} // namespace
+
+int main()
+{
+    bool ok = true;
+    // 1280x720 center-cropped to 640x640: detector pixels are offset by
+    // (320, 40) in the source.
+    ok &= RunCase("center crop", ptk::operators::FlipMode::kNone, 420.0, 140.0, 520.0, 240.0);
+    // Mirrored before the crop: x runs from the right edge.
+    ok &= RunCase("mirrored crop", ptk::operators::FlipMode::kHorizontal, 760.0, 140.0, 860.0, 240.0);
+    // Boxes with no area are dropped before cropping.
+    ok &= RunCase("degenerate boxes", ptk::operators::FlipMode::kNone, 420.0, 140.0, 520.0, 240.0, true);
+    std::printf(ok ? "cascade_test passed\n" : "cascade_test FAILED\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// CenterCrop, CenterCropView and PadToSize against index arithmetic, for
+// uint8 and float32 in HWC and CHW, including casts that read crop views.
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "operators/cast_float32_to_uint8.h"
+#include "operators/cast_uint8_to_float32.h"
+#include "operators/center_crop.h"
+#include "operators/pad_to_size.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    constexpr std::int64_t kH = 7;
+    constexpr std::int64_t kW = 9;
+    constexpr std::int64_t kC = 3;
+    constexpr int kCropH = 4;
+    constexpr int kCropW = 5;
+    constexpr std::int64_t kTop = (kH - kCropH) / 2;
+    constexpr std::int64_t kLeft = (kW - kCropW) / 2;
+
+    // Element (h, w, c) of a kH x kW x kC image stored in layout.
+    std::int64_t Index(bool chw, std::int64_t h, std::int64_t w, std::int64_t c, std::int64_t H, std::int64_t W,
+                       std::int64_t C)
+    {
+        return chw ? (c * H + h) * W + w : (h * W + w) * C + c;
+    }
+
+    template <typename T>
+    void TestCrop(bool chw)
+    {
+        const core::TensorLayout layout = chw ? core::TensorLayout::kChw : core::TensorLayout::kHwc;
+        std::vector<T> image(kH * kW * kC);
+        for (std::size_t i = 0; i < image.size(); ++i)
+        {
+            image[i] = static_cast<T>(i % 251);
+        }
+        data::TensorView src =
+            test::View(image, chw ? std::vector<std::int64_t>{kC, kH, kW} : std::vector<std::int64_t>{kH, kW, kC});
+        const std::vector<std::int64_t> crop_dims =
+            chw ? std::vector<std::int64_t>{kC, kCropH, kCropW} : std::vector<std::int64_t>{kCropH, kCropW, kC};
+
+        std::vector<T> expected(kCropH * kCropW * kC);
+        for (std::int64_t h = 0; h < kCropH; ++h)
+        {
+            for (std::int64_t w = 0; w < kCropW; ++w)
+            {
+                for (std::int64_t c = 0; c < kC; ++c)
+                {
+                    expected[Index(chw, h, w, c, kCropH, kCropW, kC)] =
+                        image[Index(chw, h + kTop, w + kLeft, c, kH, kW, kC)];
+                }
+            }
+        }
+
+        std::vector<T> copy(expected.size());
+        data::TensorView dst = test::View(copy, crop_dims);
+        PTK_CHECK_OK(operators::CenterCrop(src, kCropH, kCropW, &dst, layout));
+        PTK_CHECK(copy == expected);
+
+        data::TensorView view;
+        PTK_CHECK_OK(operators::CenterCropView(src, kCropH, kCropW, &view, layout));
+        PTK_CHECK(!view.is_contiguous());
+        PTK_CHECK(view.shape().dims() == crop_dims);
+
+        // The casts walk the view directly, whatever its row stride.
+        if constexpr (std::is_same_v<T, std::uint8_t>)
+        {
+            std::vector<float> cast(expected.size());
+            data::TensorView cast_dst = test::View(cast, crop_dims);
+            PTK_CHECK_OK(operators::CastUint8ToFloat32(view, &cast_dst));
+            PTK_CHECK(std::vector<float>(expected.begin(), expected.end()) == cast);
+        }
+        else
+        {
+            std::vector<std::uint8_t> cast(expected.size());
+            data::TensorView cast_dst = test::View(cast, crop_dims);
+            PTK_CHECK_OK(operators::CastFloat32ToUint8(view, &cast_dst));
+            PTK_CHECK(std::vector<std::uint8_t>(expected.begin(), expected.end()) == cast);
+        }
+
+        // Padding the view back out restores the window with pad margins.
+        const int TH = 8;
+        const int TW = 11;
+        const std::int64_t top = (TH - kCropH) / 2;
+        const std::int64_t left = (TW - kCropW) / 2;
+        std::vector<T> padded(static_cast<std::size_t>(TH * TW * kC));
+        data::TensorView pad_dst =
+            test::View(padded, chw ? std::vector<std::int64_t>{kC, TH, TW} : std::vector<std::int64_t>{TH, TW, kC});
+        PTK_CHECK_OK(operators::PadToSize(view, TH, TW, &pad_dst, layout, 7.0f));
+        int bad = 0;
+        for (std::int64_t h = 0; h < TH; ++h)
+        {
+            for (std::int64_t w = 0; w < TW; ++w)
+            {
+                for (std::int64_t c = 0; c < kC; ++c)
+                {
+                    const std::int64_t y = h - top;
+                    const std::int64_t x = w - left;
+                    const T want = y >= 0 && y < kCropH && x >= 0 && x < kCropW
+                                       ? expected[Index(chw, y, x, c, kCropH, kCropW, kC)]
+                                       : static_cast<T>(7);
+                    bad += padded[Index(chw, h, w, c, TH, TW, kC)] != want;
+                }
+            }
+        }
+        PTK_CHECK(bad == 0);
+    }
+
+    void TestInvalid()
+    {
+        std::vector<std::uint8_t> image(kH * kW * kC);
+        data::TensorView src = test::View(image, {kH, kW, kC});
+        data::TensorView view;
+        PTK_CHECK(!operators::CenterCropView(src, kH + 1, kW, &view).ok());
+        PTK_CHECK(!operators::CenterCropView(src, 0, kW, &view).ok());
+
+        std::vector<std::uint8_t> small(2 * 2 * kC);
+        data::TensorView small_dst = test::View(small, {2, 2, kC});
+        PTK_CHECK(!operators::PadToSize(src, 2, 2, &small_dst).ok());
+    }
+} // namespace
+
+int main()
+{
+    TestCrop<std::uint8_t>(false);
+    TestCrop<std::uint8_t>(true);
+    TestCrop<float>(false);
+    TestCrop<float>(true);
+    TestInvalid();
+    return ptk::test::Finish("crop_pad_test");
+}
@@ -0,0 +1,252 @@
+// Demosaic and DemosaicBinned against a per-pixel evaluation of their
+// documented interpolation (rounding averages, mirrored borders) for every
+// Bayer layout, both methods and every input/output type, on widths that
+// exercise the vector bodies, the border tiles and the row split; plus flat
+// color fields, which every method must reproduce exactly.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "operators/demosaic.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+    using operators::DemosaicMethod;
+    using operators::DemosaicParams;
+
+    struct Layout
+    {
+        core::PixelFormat format;
+        bool red_row[2]; // row parity holds red (else blue) besides green
+        int site[2];     // column parity of that color
+    };
+
+    const Layout kLayouts[] = {
+        {core::PixelFormat::kBayerRggb, {true, false}, {0, 1}},
+        {core::PixelFormat::kBayerBggr, {false, true}, {0, 1}},
+        {core::PixelFormat::kBayerGrbg, {true, false}, {1, 0}},
+        {core::PixelFormat::kBayerGbrg, {false, true}, {1, 0}},
+    };
+
+    std::uint32_t Avg(std::uint32_t a, std::uint32_t b) { return (a + b + 1) >> 1; }
+    std::uint32_t Diff(std::uint32_t a, std::uint32_t b) { return a > b ? a - b : b - a; }
+
+    std::int64_t Reflect(std::int64_t i, std::int64_t n) { return i < 0 ? -i : (i >= n ? 2 * n - 2 - i : i); }
+
+    // R, G, B of pixel (y, x) at the sensor's bit depth.
+    void Pixel(const std::vector<std::uint16_t> &m, std::int64_t H, std::int64_t W, const Layout &layout,
+               bool edge_aware, std::int64_t y, std::int64_t x, std::uint32_t rgb[3])
+    {
+        auto at = [&](std::int64_t dy, std::int64_t dx) -> std::uint32_t {
+            return m[Reflect(y + dy, H) * W + Reflect(x + dx, W)];
+        };
+        const bool red = layout.red_row[y & 1];
+        const std::uint32_t hor = Avg(at(0, -1), at(0, 1));
+        const std::uint32_t ver = Avg(at(-1, 0), at(1, 0));
+        std::uint32_t own_color;
+        std::uint32_t green;
+        std::uint32_t other_color;
+        if ((x & 1) == layout.site[y & 1])
+        {
+            own_color = at(0, 0);
+            green = Avg(hor, ver);
+            if (edge_aware)
+            {
+                const std::uint32_t dh = Diff(at(0, -1), at(0, 1));
+                const std::uint32_t dv = Diff(at(-1, 0), at(1, 0));
+                green = dh < dv ? hor : (dv < dh ? ver : green);
+            }
+            other_color = Avg(Avg(at(-1, -1), at(-1, 1)), Avg(at(1, -1), at(1, 1)));
+        }
+        else
+        {
+            own_color = hor;
+            green = at(0, 0);
+            other_color = ver;
+        }
+        rgb[0] = red ? own_color : other_color;
+        rgb[1] = green;
+        rgb[2] = red ? other_color : own_color;
+    }
+
+    // Rounded mean of each color over the f x f block at output (y, x).
+    void Bin(const std::vector<std::uint16_t> &m, std::int64_t W, const Layout &layout, std::int64_t f,
+             std::int64_t y, std::int64_t x, std::uint32_t rgb[3])
+    {
+        std::uint32_t sum[3] = {0, 0, 0};
+        for (std::int64_t dy = 0; dy < f; ++dy)
+        {
+            const std::int64_t sy = y * f + dy;
+            for (std::int64_t dx = 0; dx < f; ++dx)
+            {
+                const std::int64_t sx = x * f + dx;
+                const int color = (sx & 1) == layout.site[sy & 1] ? (layout.red_row[sy & 1] ? 0 : 2) : 1;
+                sum[color] += m[sy * W + sx];
+            }
+        }
+        const std::uint32_t n = static_cast<std::uint32_t>(f * f / 4);
+        rgb[0] = (sum[0] + n / 2) / n;
+        rgb[1] = (sum[1] + n) / (2 * n);
+        rgb[2] = (sum[2] + n / 2) / n;
+    }
+
+    // A mosaic of the given bit depth, or a flat field of one color per site.
+    std::vector<std::uint16_t> Mosaic(std::int64_t H, std::int64_t W, int bits, const Layout &layout, bool flat)
+    {
+        const std::vector<std::uint8_t> bytes = test::Pattern(static_cast<std::size_t>(H * W * 2),
+                                                              static_cast<std::uint32_t>(H * W + bits));
+        const std::uint32_t flat_rgb[3] = {(200u << (bits - 8)) + 3, (90u << (bits - 8)) + 1, (17u << (bits - 8))};
+        std::vector<std::uint16_t> m(static_cast<std::size_t>(H * W));
+        for (std::int64_t y = 0; y < H; ++y)
+        {
+            for (std::int64_t x = 0; x < W; ++x)
+            {
+                const std::size_t i = static_cast<std::size_t>(y * W + x);
+                if (flat)
+                {
+                    const int color = (x & 1) == layout.site[y & 1] ? (layout.red_row[y & 1] ? 0 : 2) : 1;
+                    m[i] = static_cast<std::uint16_t>(flat_rgb[color] & ((1u << bits) - 1));
+                    continue;
+                }
+                m[i] = static_cast<std::uint16_t>((bytes[2 * i] | (bytes[2 * i + 1] << 8)) & ((1u << bits) - 1));
+            }
+        }
+        return m;
+    }
+
+    // One call on a mosaic of `bits` depth stored as src_type into dst_type;
+    // factor 1 runs Demosaic, larger factors DemosaicBinned.
+    void TestCase(const Layout &layout, core::DataType src_type, core::DataType dst_type, int bits, bool bgr,
+                  bool edge_aware, std::int64_t H, std::int64_t W, std::int64_t factor, bool flat)
+    {
+        const std::vector<std::uint16_t> mosaic = Mosaic(H, W, bits, layout, flat);
+        std::vector<std::uint8_t> src8(mosaic.begin(), mosaic.end());
+        std::vector<std::uint16_t> src16 = mosaic;
+        const data::TensorView src = src_type == core::DataType::kUint8 ? test::View(src8, {H, W, 1})
+                                                                       : test::View(src16, {H, W, 1});
+        const std::int64_t OH = H / factor;
+        const std::int64_t OW = W / factor;
+        std::vector<std::uint8_t> out8(static_cast<std::size_t>(OH * OW * 3));
+        std::vector<std::uint16_t> out16(out8.size());
+        data::TensorView dst = dst_type == core::DataType::kUint8 ? test::View(out8, {OH, OW, 3})
+                                                                  : test::View(out16, {OH, OW, 3});
+        DemosaicParams params;
+        params.method = edge_aware ? DemosaicMethod::kEdgeAware : DemosaicMethod::kBilinear;
+        params.bit_depth = src_type == core::DataType::kUint8 ? 0 : bits;
+        const core::PixelFormat dst_format = bgr ? core::PixelFormat::kBgr8 : core::PixelFormat::kRgb8;
+        if (!PTK_CHECK_OK(factor == 1 ? operators::Demosaic(src, layout.format, &dst, dst_format, params)
+                                      : operators::DemosaicBinned(src, layout.format, &dst, dst_format, params)))
+        {
+            return;
+        }
+
+        const int shift = dst_type == src_type ? 0 : bits - 8;
+        const std::uint32_t max = dst_type == core::DataType::kUint8 ? 255 : 65535;
+        int bad = 0;
+        for (std::int64_t y = 0; y < OH; ++y)
+        {
+            for (std::int64_t x = 0; x < OW; ++x)
+            {
+                std::uint32_t rgb[3];
+                if (factor == 1)
+                {
+                    Pixel(mosaic, H, W, layout, edge_aware, y, x, rgb);
+                }
+                else
+                {
+                    Bin(mosaic, W, layout, factor, y, x, rgb);
+                }
+                for (int c = 0; c < 3; ++c)
+                {
+                    const std::size_t i = static_cast<std::size_t>((y * OW + x) * 3 + (bgr ? 2 - c : c));
+                    const std::uint32_t got = dst_type == core::DataType::kUint8 ? out8[i] : out16[i];
+                    bad += got != std::min(rgb[c] >> shift, max);
+                }
+            }
+        }
+        if (flat)
+        {
+            // Every output pixel is the field's color.
+            std::uint32_t field[3];
+            Pixel(mosaic, H, W, layout, false, 0, 0, field);
+            for (std::size_t i = 0; i < out8.size(); ++i)
+            {
+                const int c = static_cast<int>(i % 3);
+                const std::uint32_t got = dst_type == core::DataType::kUint8 ? out8[i] : out16[i];
+                bad += got != (field[bgr ? 2 - c : c] >> shift);
+            }
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  format=%d %d-bit into %s %s %s H=%lld W=%lld factor=%lld%s\n",
+                        static_cast<int>(layout.format), bits, dst_type == core::DataType::kUint8 ? "uint8" : "uint16",
+                        bgr ? "BGR" : "RGB", edge_aware ? "edge-aware" : "bilinear", static_cast<long long>(H),
+                        static_cast<long long>(W), static_cast<long long>(factor), flat ? " flat" : "");
+        }
+    }
+
+    void TestInvalid()
+    {
+        std::vector<std::uint8_t> src(6 * 6);
+        std::vector<std::uint8_t> out(6 * 6 * 3);
+        data::TensorView rgb = test::View(out, {6, 6, 3});
+        PTK_CHECK(!operators::Demosaic(test::View(src, {6, 6, 1}), core::PixelFormat::kRgb8, &rgb,
+                                       core::PixelFormat::kRgb8)
+                       .ok());
+        PTK_CHECK(!operators::Demosaic(test::View(src, {6, 6, 1}), core::PixelFormat::kBayerRggb, &rgb,
+                                       core::PixelFormat::kGray8)
+                       .ok());
+        data::TensorView odd = test::View(out, {5, 6, 3});
+        PTK_CHECK(!operators::Demosaic(test::View(src, {5, 6, 1}), core::PixelFormat::kBayerRggb, &odd,
+                                       core::PixelFormat::kRgb8)
+                       .ok());
+        data::TensorView third = test::View(out, {2, 2, 3});
+        PTK_CHECK(!operators::DemosaicBinned(test::View(src, {6, 6, 1}), core::PixelFormat::kBayerRggb, &third,
+                                             core::PixelFormat::kRgb8)
+                       .ok());
+        DemosaicParams params;
+        params.bit_depth = 12;
+        PTK_CHECK(!operators::Demosaic(test::View(src, {6, 6, 1}), core::PixelFormat::kBayerRggb, &rgb,
+                                       core::PixelFormat::kRgb8, params)
+                       .ok());
+        std::vector<std::uint16_t> wide(6 * 6 * 3);
+        data::TensorView wide_dst = test::View(wide, {6, 6, 3});
+        PTK_CHECK(!operators::Demosaic(test::View(src, {6, 6, 1}), core::PixelFormat::kBayerRggb, &wide_dst,
+                                       core::PixelFormat::kRgb8)
+                       .ok());
+    }
+} // namespace
+
+int main()
+{
+    using ptk::core::DataType;
+    // Border-only rows, vector bodies with tails, several tiles per row and
+    // frames split over threads.
+    const std::int64_t sizes[][2] = {{2, 2}, {4, 6}, {6, 34}, {4, 520}, {96, 366}};
+    for (const Layout &layout : kLayouts)
+    {
+        for (const auto &size : sizes)
+        {
+            for (bool edge_aware : {false, true})
+            {
+                TestCase(layout, DataType::kUint8, DataType::kUint8, 8, false, edge_aware, size[0], size[1], 1, false);
+                TestCase(layout, DataType::kUint16, DataType::kUint16, 12, true, edge_aware, size[0], size[1], 1,
+                         false);
+            }
+            TestCase(layout, DataType::kUint16, DataType::kUint8, 10, false, false, size[0], size[1], 1, false);
+            TestCase(layout, DataType::kUint16, DataType::kUint8, 16, true, true, size[0], size[1], 1, false);
+            TestCase(layout, DataType::kUint8, DataType::kUint8, 8, true, true, size[0], size[1], 1, true);
+            TestCase(layout, DataType::kUint8, DataType::kUint8, 8, false, false, size[0], size[1], 2, false);
+            TestCase(layout, DataType::kUint16, DataType::kUint8, 12, true, false, size[0], size[1], 2, false);
+            TestCase(layout, DataType::kUint16, DataType::kUint16, 16, false, false, size[0], size[1], 2, true);
+        }
+        TestCase(layout, DataType::kUint8, DataType::kUint8, 8, false, false, 8, 24, 4, false);
+        TestCase(layout, DataType::kUint16, DataType::kUint8, 10, true, false, 12, 36, 6, false);
+        TestCase(layout, DataType::kUint16, DataType::kUint16, 12, false, false, 96, 2400, 4, false);
+    }
+    TestInvalid();
+    return ptk::test::Finish("demosaic_test");
+}
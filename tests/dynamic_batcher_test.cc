@@ -0,0 +1,433 @@
+// DynamicBatcher over a fake engine: concurrent producers get their own
+// rows back from shared batches, with the batch sizes and counts the stats
+// report; results in caller buffers or in the calling thread's shared
+// output storage; requests of other shapes batched apart; padding to a
+// fixed batch; batches run from Tick; and the failures Infer reports.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engines/engine.h"
+#include "engines/thread_output_storage.h"
+#include "runtime/components/dynamic_batcher.h"
+#include "runtime/core/runtime_context.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    // x [N, W] -> y = 2 * x [N, W] and s = row sums [N, 1], in buffers it
+    // owns. Records the batch sizes it ran.
+    class FakeEngine : public perception::Engine
+    {
+    public:
+        bool fail = false;
+        bool drop_batch_dim = false;
+        std::int64_t fixed_batch = -1; // declared batch dim
+
+        bool Load(const std::string &) override { return true; }
+
+        bool Infer(const std::vector<data::TensorView> &inputs, std::vector<data::TensorView> &outputs) override
+        {
+            if (fail || inputs.size() != 1 || inputs[0].shape().rank() != 2)
+            {
+                return false;
+            }
+            const std::int64_t rows = inputs[0].shape().dim(0);
+            const std::int64_t width = inputs[0].shape().dim(1);
+            {
+                std::lock_guard<std::mutex> lock(mu_);
+                batches_.push_back(rows);
+            }
+            const float *x = static_cast<const float *>(inputs[0].buffer().data());
+            y_.resize(static_cast<std::size_t>(rows * width));
+            s_.resize(static_cast<std::size_t>(rows));
+            for (std::int64_t r = 0; r < rows; ++r)
+            {
+                s_[r] = 0.0f;
+                for (std::int64_t c = 0; c < width; ++c)
+                {
+                    y_[r * width + c] = 2.0f * x[r * width + c];
+                    s_[r] += x[r * width + c];
+                }
+            }
+            const std::vector<std::int64_t> sum_dims =
+                drop_batch_dim ? std::vector<std::int64_t>{} : std::vector<std::int64_t>{rows, 1};
+            outputs = {data::TensorView(data::BufferView(y_.data(), y_.size() * sizeof(float), core::DeviceType::kCpu),
+                                        core::DataType::kFloat32, data::TensorShape({rows, width})),
+                       data::TensorView(data::BufferView(s_.data(), s_.size() * sizeof(float), core::DeviceType::kCpu),
+                                        core::DataType::kFloat32, data::TensorShape(sum_dims))};
+            return true;
+        }
+
+        std::vector<std::string> InputNames() const override { return {"x"}; }
+        std::vector<std::string> OutputNames() const override { return {"y", "s"}; }
+
+        std::vector<data::TensorSpec> InputSpecs() const override
+        {
+            data::TensorSpec spec;
+            spec.name = "x";
+            spec.dtype = core::DataType::kFloat32;
+            spec.dims = {fixed_batch, -1};
+            spec.dim_names = {fixed_batch < 0 ? "N" : "", "W"};
+            return {spec};
+        }
+
+        std::vector<std::int64_t> batches() const
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            return batches_;
+        }
+
+    private:
+        mutable std::mutex mu_;
+        std::vector<std::int64_t> batches_;
+        std::vector<float> y_;
+        std::vector<float> s_;
+    };
+
+    std::vector<float> Sample(std::int64_t width, float start)
+    {
+        std::vector<float> x(static_cast<std::size_t>(width));
+        for (std::int64_t c = 0; c < width; ++c)
+        {
+            x[c] = start + static_cast<float>(c);
+        }
+        return x;
+    }
+
+    bool Matches(const std::vector<data::TensorView> &outputs, const std::vector<float> &x)
+    {
+        const std::int64_t width = static_cast<std::int64_t>(x.size());
+        if (outputs.size() != 2 || outputs[0].shape().dims() != std::vector<std::int64_t>({width}) ||
+            outputs[1].shape().dims() != std::vector<std::int64_t>({1}))
+        {
+            return false;
+        }
+        const float *y = static_cast<const float *>(outputs[0].buffer().data());
+        float sum = 0.0f;
+        for (std::int64_t c = 0; c < width; ++c)
+        {
+            if (y[c] != 2.0f * x[c])
+            {
+                return false;
+            }
+            sum += x[c];
+        }
+        return *static_cast<const float *>(outputs[1].buffer().data()) == sum;
+    }
+
+    struct Fixture
+    {
+        core::RuntimeContext context;
+        FakeEngine engine;
+
+        Fixture() { context.Init(core::RuntimeContextOptions()); }
+    };
+
+    // Producers block in Infer, so with 8 of them and a long wait the
+    // batches fill; every producer must still get back its own rows.
+    void TestBatching()
+    {
+        Fixture f;
+        components::DynamicBatcherConfig config;
+        config.max_batch_size = 4;
+        config.max_wait_us = 20000;
+        components::DynamicBatcher batcher(&f.engine, config);
+        if (!PTK_CHECK_OK(batcher.Init(&f.context)) || !PTK_CHECK_OK(batcher.Start()))
+        {
+            return;
+        }
+        constexpr int kProducers = 8;
+        constexpr int kRequests = 25;
+        std::atomic<int> bad{0};
+        std::vector<std::thread> producers;
+        for (int p = 0; p < kProducers; ++p)
+        {
+            producers.emplace_back([&batcher, &bad, p]
+                                   {
+                                       std::vector<data::TensorView> outputs;
+                                       for (int i = 0; i < kRequests; ++i)
+                                       {
+                                           std::vector<float> x = Sample(6, static_cast<float>(p * 100 + i));
+                                           if (!batcher.Infer({test::View(x, {6})}, outputs).ok() ||
+                                               !Matches(outputs, x))
+                                           {
+                                               ++bad;
+                                           }
+                                       } });
+        }
+        for (auto &producer : producers)
+        {
+            producer.join();
+        }
+        PTK_CHECK_OK(batcher.Stop());
+        PTK_CHECK(bad == 0);
+
+        const std::vector<std::int64_t> batches = f.engine.batches();
+        const components::DynamicBatcherStats stats = batcher.stats();
+        PTK_CHECK(stats.requests == kProducers * kRequests);
+        PTK_CHECK(stats.batches == batches.size());
+        PTK_CHECK(stats.rejected == 0);
+        PTK_CHECK(*std::max_element(batches.begin(), batches.end()) <= 4);
+        PTK_CHECK(*std::max_element(batches.begin(), batches.end()) > 1);
+        std::uint64_t requests = 0;
+        std::uint64_t delays = 0;
+        for (std::size_t n = 0; n < stats.batch_size.size(); ++n)
+        {
+            requests += n * stats.batch_size[n];
+        }
+        for (std::uint64_t count : stats.queue_delay_us)
+        {
+            delays += count;
+        }
+        PTK_CHECK(requests == stats.requests);
+        PTK_CHECK(delays == stats.requests);
+    }
+
+    // Caller buffers receive the slices in place; otherwise results land in
+    // the thread's shared output storage, which later calls refill.
+    void TestOutputs()
+    {
+        Fixture f;
+        components::DynamicBatcherConfig config;
+        config.max_wait_us = 0;
+        components::DynamicBatcher batcher(&f.engine, config);
+        if (!PTK_CHECK_OK(batcher.Init(&f.context)) || !PTK_CHECK_OK(batcher.Start()))
+        {
+            return;
+        }
+        std::vector<float> x = Sample(5, 3.0f);
+        std::vector<float> y(5);
+        std::vector<float> s(1);
+        std::vector<data::TensorView> outputs = {test::View(y, {5}), test::View(s, {1})};
+        if (PTK_CHECK_OK(batcher.Infer({test::View(x, {5})}, outputs)))
+        {
+            PTK_CHECK(outputs[0].buffer().data() == y.data() && Matches(outputs, x));
+        }
+
+        outputs.clear();
+        PTK_CHECK_OK(batcher.Infer({test::View(x, {5})}, outputs));
+        PTK_CHECK(Matches(outputs, x));
+        PTK_CHECK(perception::PointsIntoThreadStorage(outputs[0]) &&
+                  perception::PointsIntoThreadStorage(outputs[1]));
+        const void *storage = outputs[0].buffer().data();
+        std::vector<float> x2 = Sample(5, -8.0f);
+        PTK_CHECK_OK(batcher.Infer({test::View(x2, {5})}, outputs));
+        PTK_CHECK(Matches(outputs, x2) && outputs[0].buffer().data() == storage);
+
+        std::vector<float> small(2);
+        outputs = {test::View(small, {2}), test::View(s, {1})};
+        const core::Status too_small = batcher.Infer({test::View(x, {5})}, outputs);
+        PTK_CHECK(too_small.code() == core::StatusCode::kInvalidArgument);
+        PTK_CHECK_OK(batcher.Stop());
+    }
+
+    // Requests of two widths arrive in one window; they batch by width.
+    void TestShapes()
+    {
+        Fixture f;
+        components::DynamicBatcherConfig config;
+        config.max_batch_size = 8;
+        config.max_wait_us = 20000;
+        components::DynamicBatcher batcher(&f.engine, config);
+        if (!PTK_CHECK_OK(batcher.Init(&f.context)) || !PTK_CHECK_OK(batcher.Start()))
+        {
+            return;
+        }
+        std::atomic<int> bad{0};
+        std::vector<std::thread> producers;
+        for (int p = 0; p < 6; ++p)
+        {
+            producers.emplace_back([&batcher, &bad, p]
+                                   {
+                                       const std::int64_t width = p % 2 ? 3 : 7;
+                                       std::vector<float> x = Sample(width, static_cast<float>(p));
+                                       std::vector<data::TensorView> outputs;
+                                       if (!batcher.Infer({test::View(x, {width})}, outputs).ok() ||
+                                           !Matches(outputs, x))
+                                       {
+                                           ++bad;
+                                       }
+                                   });
+        }
+        for (auto &producer : producers)
+        {
+            producer.join();
+        }
+        PTK_CHECK_OK(batcher.Stop());
+        PTK_CHECK(bad == 0);
+        PTK_CHECK(batcher.stats().requests == 6);
+        PTK_CHECK(batcher.stats().batches >= 2);
+    }
+
+    // Partial batches are zero-filled up to max_batch_size for a model with
+    // a fixed batch dimension.
+    void TestPadding()
+    {
+        Fixture f;
+        f.engine.fixed_batch = 4;
+        components::DynamicBatcherConfig config;
+        config.max_batch_size = 4;
+        config.max_wait_us = 0;
+        config.pad_to_max_batch = true;
+        components::DynamicBatcher batcher(&f.engine, config);
+        if (!PTK_CHECK_OK(batcher.Init(&f.context)) || !PTK_CHECK_OK(batcher.Start()))
+        {
+            return;
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            std::vector<float> x = Sample(4, static_cast<float>(i * 10));
+            std::vector<data::TensorView> outputs;
+            PTK_CHECK(batcher.Infer({test::View(x, {4})}, outputs).ok() && Matches(outputs, x));
+        }
+        PTK_CHECK_OK(batcher.Stop());
+        for (std::int64_t rows : f.engine.batches())
+        {
+            PTK_CHECK(rows == 4);
+        }
+        PTK_CHECK(batcher.stats().batch_size[1] == 3);
+    }
+
+    // Without its own thread the batcher runs due batches from Tick.
+    void TestTick()
+    {
+        Fixture f;
+        components::DynamicBatcherConfig config;
+        config.max_batch_size = 3;
+        config.max_wait_us = 1000;
+        config.own_thread = false;
+        components::DynamicBatcher batcher(&f.engine, config);
+        if (!PTK_CHECK_OK(batcher.Init(&f.context)) || !PTK_CHECK_OK(batcher.Start()))
+        {
+            return;
+        }
+        std::atomic<int> finished{0};
+        std::atomic<int> bad{0};
+        std::vector<std::thread> producers;
+        for (int p = 0; p < 5; ++p)
+        {
+            producers.emplace_back([&batcher, &finished, &bad, p]
+                                   {
+                                       std::vector<float> x = Sample(2, static_cast<float>(p));
+                                       std::vector<data::TensorView> outputs;
+                                       if (!batcher.Infer({test::View(x, {2})}, outputs).ok() ||
+                                           !Matches(outputs, x))
+                                       {
+                                           ++bad;
+                                       }
+                                       ++finished;
+                                   });
+        }
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (finished < 5 && std::chrono::steady_clock::now() < deadline)
+        {
+            batcher.Tick();
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        PTK_CHECK(finished == 5);
+        PTK_CHECK_OK(batcher.Stop());
+        for (auto &producer : producers)
+        {
+            producer.join();
+        }
+        PTK_CHECK(bad == 0);
+        PTK_CHECK(batcher.stats().requests == 5);
+    }
+
+    void TestErrors()
+    {
+        Fixture f;
+        components::DynamicBatcherConfig config;
+        config.max_wait_us = 0;
+        components::DynamicBatcher unbound(nullptr, config);
+        PTK_CHECK(!unbound.Init(&f.context).ok());
+        components::DynamicBatcher batcher(&f.engine, config);
+        PTK_CHECK(!batcher.Init(nullptr).ok());
+        PTK_CHECK(!batcher.Start().ok());
+        components::DynamicBatcherConfig empty = config;
+        empty.max_batch_size = 0;
+        components::DynamicBatcher zero(&f.engine, empty);
+        PTK_CHECK(!zero.Init(&f.context).ok());
+
+        if (!PTK_CHECK_OK(batcher.Init(&f.context)))
+        {
+            return;
+        }
+        std::vector<float> x = Sample(4, 1.0f);
+        std::vector<data::TensorView> outputs;
+        PTK_CHECK(batcher.Infer({test::View(x, {4})}, outputs).code() == core::StatusCode::kFailedPrecondition);
+        if (!PTK_CHECK_OK(batcher.Start()))
+        {
+            return;
+        }
+        PTK_CHECK(batcher.Infer({}, outputs).code() == core::StatusCode::kInvalidArgument);
+        std::vector<float> wide(8);
+        const data::TensorView strided(data::BufferView(wide.data(), wide.size() * sizeof(float),
+                                                        core::DeviceType::kCpu),
+                                       core::DataType::kFloat32, data::TensorShape({4}), {2});
+        PTK_CHECK(batcher.Infer({strided}, outputs).code() == core::StatusCode::kInvalidArgument);
+
+        f.engine.fail = true;
+        PTK_CHECK(batcher.Infer({test::View(x, {4})}, outputs).code() == core::StatusCode::kInternal);
+        f.engine.fail = false;
+        f.engine.drop_batch_dim = true;
+        PTK_CHECK(batcher.Infer({test::View(x, {4})}, outputs).code() == core::StatusCode::kInternal);
+        f.engine.drop_batch_dim = false;
+        PTK_CHECK(batcher.Infer({test::View(x, {4})}, outputs).ok() && Matches(outputs, x));
+        PTK_CHECK_OK(batcher.Stop());
+
+        // Nothing runs the queue: one of two producers finds it full, and
+        // stopping fails the other.
+        components::DynamicBatcherConfig manual = config;
+        manual.own_thread = false;
+        manual.max_queue = 1;
+        components::DynamicBatcher queued(&f.engine, manual);
+        if (!PTK_CHECK_OK(queued.Init(&f.context)) || !PTK_CHECK_OK(queued.Start()))
+        {
+            return;
+        }
+        core::Status results[2];
+        std::vector<std::thread> producers;
+        for (core::Status &result : results)
+        {
+            producers.emplace_back([&queued, &x, &result]
+                                   {
+                                       std::vector<data::TensorView> waited;
+                                       result = queued.Infer({test::View(x, {4})}, waited); });
+        }
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (queued.stats().rejected == 0 && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        PTK_CHECK(queued.stats().rejected == 1);
+        PTK_CHECK_OK(queued.Stop());
+        for (auto &producer : producers)
+        {
+            producer.join();
+        }
+        PTK_CHECK(results[0].code() == core::StatusCode::kFailedPrecondition &&
+                  results[1].code() == core::StatusCode::kFailedPrecondition);
+    }
+} // namespace
+
+int main()
+{
+    TestBatching();
+    TestOutputs();
+    TestShapes();
+    TestPadding();
+    TestTick();
+    TestErrors();
+    return ptk::test::Finish("dynamic_batcher_test");
+}
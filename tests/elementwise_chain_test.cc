@@ -0,0 +1,310 @@
+// ElementwiseChain against its recorded ops applied one at a time per pixel,
+// for uint8 and float32 sources, every channel count, both layouts and every
+// output type, across tile and thread boundaries; plus the recording errors
+// Compile reports.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "operators/center_crop.h"
+#include "operators/elementwise_chain.h"
+#include "runtime/data/half.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    // One recorded op as the test applies it to each pixel.
+    struct Step
+    {
+        enum Kind
+        {
+            kMove,
+            kAffine,
+            kClamp,
+        } kind;
+        int order[4];
+        float scale[4];
+        float bias[4];
+        float lo;
+        float hi;
+    };
+
+    Step Permute(std::vector<int> order, int channels)
+    {
+        Step s{};
+        s.kind = Step::kMove;
+        for (int c = 0; c < 4; ++c)
+        {
+            s.order[c] = c < channels ? order[c] : c;
+        }
+        return s;
+    }
+
+    Step Affine(const float *scale, const float *bias)
+    {
+        Step s{};
+        s.kind = Step::kAffine;
+        for (int c = 0; c < 4; ++c)
+        {
+            s.scale[c] = scale[c];
+            s.bias[c] = bias[c];
+        }
+        return s;
+    }
+
+    Step ClampStep(float lo, float hi)
+    {
+        Step s{};
+        s.kind = Step::kClamp;
+        s.lo = lo;
+        s.hi = hi;
+        return s;
+    }
+
+    // Records swap (when C >= 3) or a rotation of the channels, a
+    // normalization, a clamp and a trailing affine on chain, and the same
+    // steps on steps.
+    void Record(std::int64_t C, operators::ElementwiseChain *chain, std::vector<Step> *steps)
+    {
+        const int n = static_cast<int>(C);
+        if (n >= 3)
+        {
+            chain->SwapRB();
+            steps->push_back(Permute({2, 1, 0, 3}, 4));
+        }
+        else
+        {
+            std::vector<int> order;
+            for (int c = 0; c < n; ++c)
+            {
+                order.push_back((c + 1) % n);
+            }
+            chain->PermuteChannels(order);
+            steps->push_back(Permute(order, n));
+        }
+
+        operators::NormalizationParams norm{};
+        const float mean[4] = {123.675f, 116.28f, 103.53f, 127.5f};
+        const float std[4] = {58.395f, 57.12f, 57.375f, 64.0f};
+        float scale[4];
+        float bias[4];
+        for (int c = 0; c < 4; ++c)
+        {
+            norm.mean[c] = mean[c];
+            norm.std[c] = std[c];
+            scale[c] = c < n ? 1.0f / std[c] : 1.0f;
+            bias[c] = c < n ? -mean[c] / std[c] : 0.0f;
+        }
+        norm.num_channels = n;
+        chain->Normalize(norm);
+        steps->push_back(Affine(scale, bias));
+
+        chain->Clamp(-1.5f, 1.75f);
+        steps->push_back(ClampStep(-1.5f, 1.75f));
+
+        const float k[4] = {100.0f, 100.0f, 100.0f, 100.0f};
+        const float b[4] = {128.0f, 128.0f, 128.0f, 128.0f};
+        chain->Affine(100.0f, 128.0f);
+        steps->push_back(Affine(k, b));
+    }
+
+    void Apply(const std::vector<Step> &steps, std::int64_t C, float *px)
+    {
+        for (const Step &s : steps)
+        {
+            float moved[4];
+            for (std::int64_t c = 0; c < C; ++c)
+            {
+                switch (s.kind)
+                {
+                case Step::kMove:
+                    moved[c] = px[s.order[c]];
+                    break;
+                case Step::kAffine:
+                    moved[c] = px[c] * s.scale[c] + s.bias[c];
+                    break;
+                default:
+                    moved[c] = std::fmin(std::fmax(px[c], s.lo), s.hi);
+                    break;
+                }
+            }
+            std::copy(moved, moved + C, px);
+        }
+    }
+
+    // Output element i of dst as a float.
+    float Load(const std::vector<std::uint8_t> &dst, core::DataType dtype, std::int64_t i)
+    {
+        switch (dtype)
+        {
+        case core::DataType::kFloat32:
+        {
+            float f;
+            std::memcpy(&f, &dst[i * 4], sizeof(f));
+            return f;
+        }
+        case core::DataType::kFloat16:
+        case core::DataType::kBFloat16:
+        {
+            std::uint16_t h;
+            std::memcpy(&h, &dst[i * 2], sizeof(h));
+            return dtype == core::DataType::kFloat16 ? data::HalfToFloat(h) : data::BFloat16ToFloat(h);
+        }
+        default:
+            return dst[i];
+        }
+    }
+
+    // Largest difference from the unfused value that one output rounding
+    // and the folded affine arithmetic allow.
+    float Tolerance(core::DataType dtype, float want)
+    {
+        switch (dtype)
+        {
+        case core::DataType::kFloat32:
+            return 1e-4f * (1.0f + std::fabs(want));
+        case core::DataType::kFloat16:
+            return std::fabs(want) / 1024.0f + 1e-3f;
+        case core::DataType::kBFloat16:
+            return std::fabs(want) / 128.0f + 1e-3f;
+        default:
+            return 0.5f + 1e-3f;
+        }
+    }
+
+    template <typename T>
+    void TestChain(std::int64_t C, std::int64_t H, std::int64_t W, core::TensorLayout layout, core::DataType dtype,
+                   bool crop, bool batch)
+    {
+        operators::ElementwiseChain chain;
+        std::vector<Step> steps;
+        Record(C, &chain, &steps);
+        chain.ToLayout(layout).Cast(dtype);
+        if (!PTK_CHECK_OK(chain.Compile()))
+        {
+            return;
+        }
+
+        // A crop drops a two pixel border, leaving rows that are packed but
+        // not contiguous with each other.
+        const std::int64_t border = crop ? 2 : 0;
+        const std::int64_t SH = H + 2 * border;
+        const std::int64_t SW = W + 2 * border;
+        const std::vector<std::uint8_t> bytes = test::Pattern(static_cast<std::size_t>(SH * SW * C),
+                                                              static_cast<std::uint32_t>(C * 10 + W));
+        std::vector<T> pixels(bytes.begin(), bytes.end());
+        data::TensorView src = test::View(pixels, {SH, SW, C});
+        if (crop && !PTK_CHECK_OK(operators::CenterCropView(src, static_cast<int>(H), static_cast<int>(W), &src)))
+        {
+            return;
+        }
+
+        const bool chw = layout == core::TensorLayout::kChw;
+        std::vector<std::int64_t> dims = chw ? std::vector<std::int64_t>{C, H, W} : std::vector<std::int64_t>{H, W, C};
+        if (batch)
+        {
+            dims.insert(dims.begin(), 1);
+        }
+        const data::TensorView probe(data::BufferView(), dtype, data::TensorShape({1}));
+        std::vector<std::uint8_t> out(static_cast<std::size_t>(C * H * W) * probe.element_size());
+        data::TensorView dst = test::View(out, dtype, dims);
+        if (!PTK_CHECK_OK(chain.Run(src, &dst)))
+        {
+            return;
+        }
+
+        int bad = 0;
+        for (std::int64_t h = 0; h < H; ++h)
+        {
+            for (std::int64_t w = 0; w < W; ++w)
+            {
+                float px[4];
+                for (std::int64_t c = 0; c < C; ++c)
+                {
+                    px[c] = static_cast<float>(pixels[((h + border) * SW + w + border) * C + c]);
+                }
+                Apply(steps, C, px);
+                for (std::int64_t c = 0; c < C; ++c)
+                {
+                    float want = px[c];
+                    if (dtype == core::DataType::kUint8)
+                    {
+                        want = std::fmin(std::fmax(want, 0.0f), 255.0f);
+                    }
+                    const float got = Load(out, dtype, chw ? (c * H + h) * W + w : (h * W + w) * C + c);
+                    bad += !(std::fabs(got - want) <= Tolerance(dtype, want));
+                }
+            }
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  %s src C=%lld H=%lld W=%lld %s dtype=%d crop=%d batch=%d\n",
+                        sizeof(T) == 1 ? "uint8" : "float32", static_cast<long long>(C), static_cast<long long>(H),
+                        static_cast<long long>(W), chw ? "CHW" : "HWC", static_cast<int>(dtype), crop, batch);
+        }
+    }
+
+    template <typename T>
+    void TestSource()
+    {
+        const core::DataType dtypes[] = {core::DataType::kFloat32, core::DataType::kFloat16,
+                                         core::DataType::kBFloat16, core::DataType::kUint8};
+        for (core::TensorLayout layout : {core::TensorLayout::kHwc, core::TensorLayout::kChw})
+        {
+            for (core::DataType dtype : dtypes)
+            {
+                for (std::int64_t C = 1; C <= 4; ++C)
+                {
+                    TestChain<T>(C, 3, 5, layout, dtype, false, false);
+                    TestChain<T>(C, 4, 9, layout, dtype, true, true);
+                }
+                // Two tiles per row, and rows spread over threads.
+                TestChain<T>(3, 2, 4100, layout, dtype, false, false);
+                TestChain<T>(3, 64, 300, layout, dtype, true, true);
+            }
+        }
+    }
+
+    void TestErrors()
+    {
+        operators::ElementwiseChain chain;
+        std::vector<std::uint8_t> pixels(2 * 2 * 3);
+        std::vector<float> out(2 * 2 * 3);
+        data::TensorView dst = test::View(out, {2, 2, 3});
+        PTK_CHECK(!chain.Run(test::View(pixels, {2, 2, 3}), &dst).ok());
+
+        PTK_CHECK(!operators::ElementwiseChain().PermuteChannels({0, 3, 1}).Compile().ok());
+        PTK_CHECK(!operators::ElementwiseChain().Cast(core::DataType::kInt8).Compile().ok());
+        PTK_CHECK(!operators::ElementwiseChain().ToLayout(core::TensorLayout::kNchw).Compile().ok());
+        PTK_CHECK(!operators::ElementwiseChain().Clamp(1.0f, 0.0f).Compile().ok());
+        operators::NormalizationParams norm{};
+        norm.num_channels = 3;
+        PTK_CHECK(!operators::ElementwiseChain().Normalize(norm).Compile().ok());
+        norm.std[0] = norm.std[1] = norm.std[2] = 1.0f;
+        PTK_CHECK(!operators::ElementwiseChain().Normalize(norm).PermuteChannels({1, 0}).Compile().ok());
+        PTK_CHECK(!operators::ElementwiseChain().SwapRB().PermuteChannels({1, 0}).Compile().ok());
+
+        // A compiled chain still checks the tensors it is given.
+        PTK_CHECK_OK(chain.Normalize(norm).ToLayout(core::TensorLayout::kChw).Compile());
+        PTK_CHECK(!chain.Run(test::View(pixels, {2, 2, 3}), &dst).ok());
+        data::TensorView chw = test::View(out, {3, 2, 2});
+        PTK_CHECK_OK(chain.Run(test::View(pixels, {2, 2, 3}), &chw));
+        PTK_CHECK(!chain.Run(test::View(pixels, {2, 3, 2}), &chw).ok());
+        std::vector<std::uint16_t> half(out.size());
+        data::TensorView half_dst = test::View(half, core::DataType::kFloat16, {3, 2, 2});
+        PTK_CHECK(!chain.Run(test::View(pixels, {2, 2, 3}), &half_dst).ok());
+    }
+} // namespace
+
+int main()
+{
+    TestSource<std::uint8_t>();
+    TestSource<float>();
+    TestErrors();
+    return ptk::test::Finish("elementwise_chain_test");
+}
@@ -0,0 +1,314 @@
+// EnginePool over fake engines: member creation and auto-tune handoff,
+// results for concurrent callers copied into per-thread storage that stays
+// put and is shared between pools, caller buffers written in place, at most
+// one caller per engine, queue limits and timeouts, and failed loads. The
+// test supplies CreateEngine, so the pool is linked without any backend.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engines/engine_builder.h"
+#include "engines/engine_pool.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    std::mutex g_mu;
+    std::vector<perception::EngineConfig> g_created; // configs CreateEngine saw
+    bool g_fail_load = false;
+    std::atomic<int> g_active{0};
+    std::atomic<int> g_max_active{0};
+
+    // y = 2 * x + 1 into its own buffer, holding the engine for a moment so
+    // concurrent callers overlap. Auto-tuning settles on 3 intra-op threads.
+    class FakeEngine : public perception::Engine
+    {
+    public:
+        explicit FakeEngine(const perception::EngineConfig &config) { config_ = config; }
+
+        bool Load(const std::string &) override
+        {
+            if (g_fail_load)
+            {
+                return false;
+            }
+            if (config_.threading.auto_tune)
+            {
+                config_.threading.intra_op_threads = 3;
+            }
+            return true;
+        }
+
+        bool Infer(const std::vector<data::TensorView> &inputs, std::vector<data::TensorView> &outputs) override
+        {
+            if (inputs.size() != 1)
+            {
+                return false;
+            }
+            const int active = ++g_active;
+            int seen = g_max_active.load();
+            while (active > seen && !g_max_active.compare_exchange_weak(seen, active))
+            {
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+            const float *x = static_cast<const float *>(inputs[0].buffer().data());
+            const std::size_t n = static_cast<std::size_t>(inputs[0].shape().num_elements());
+            float *y;
+            if (outputs.size() == 1 && !outputs[0].empty())
+            {
+                y = static_cast<float *>(const_cast<void *>(outputs[0].buffer().data()));
+            }
+            else
+            {
+                out_.resize(n);
+                y = out_.data();
+                outputs.assign(1, data::TensorView(data::BufferView(y, n * sizeof(float), core::DeviceType::kCpu),
+                                                   core::DataType::kFloat32, inputs[0].shape()));
+            }
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                y[i] = 2.0f * x[i] + 1.0f;
+            }
+            --g_active;
+            return true;
+        }
+
+        std::vector<std::string> InputNames() const override { return {"x"}; }
+        std::vector<std::string> OutputNames() const override { return {"y"}; }
+
+    private:
+        std::vector<float> out_;
+    };
+
+    bool Matches(const std::vector<data::TensorView> &outputs, const std::vector<float> &x)
+    {
+        if (outputs.size() != 1 || outputs[0].shape().num_elements() != static_cast<std::int64_t>(x.size()))
+        {
+            return false;
+        }
+        const float *y = static_cast<const float *>(outputs[0].buffer().data());
+        for (std::size_t i = 0; i < x.size(); ++i)
+        {
+            if (y[i] != 2.0f * x[i] + 1.0f)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<float> Input(std::size_t n, float start)
+    {
+        std::vector<float> x(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            x[i] = start + static_cast<float>(i);
+        }
+        return x;
+    }
+
+    perception::EngineConfig PoolConfig(int sessions)
+    {
+        perception::EngineConfig config;
+        config.pool.sessions = sessions;
+        return config;
+    }
+
+    // Members are created with sessions = 1; only the first tunes, within
+    // its share of the cores, and the rest load with its result.
+    void TestLoad()
+    {
+        g_created.clear();
+        perception::EngineConfig config = PoolConfig(3);
+        config.threading.auto_tune = true;
+        config.threading.tune_cores = 6;
+        perception::EnginePool pool(config);
+        if (!PTK_CHECK(pool.Load("model")))
+        {
+            return;
+        }
+        PTK_CHECK(pool.size() == 3);
+        PTK_CHECK(pool.InputNames() == std::vector<std::string>({"x"}));
+        PTK_CHECK(pool.OutputNames() == std::vector<std::string>({"y"}));
+        PTK_CHECK(pool.threading().intra_op_threads == 3);
+        if (!PTK_CHECK(g_created.size() == 3))
+        {
+            return;
+        }
+        for (std::size_t i = 0; i < g_created.size(); ++i)
+        {
+            PTK_CHECK(g_created[i].pool.sessions == 1);
+            PTK_CHECK(g_created[i].threading.auto_tune == (i == 0));
+            PTK_CHECK(g_created[i].threading.intra_op_threads == (i == 0 ? 1 : 3));
+        }
+
+        // Without tune_cores the first member gets its share of the host.
+        g_created.clear();
+        config.threading.tune_cores = 0;
+        perception::EnginePool shared(config);
+        const int cores = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        if (PTK_CHECK(shared.Load("model")) && PTK_CHECK(!g_created.empty()))
+        {
+            PTK_CHECK(g_created[0].threading.tune_cores == std::max(1, cores / 3));
+        }
+    }
+
+    // Callers on many threads get correct results in their own thread's
+    // storage, which stays at one address across calls, while no engine
+    // ever serves two callers at once.
+    void TestConcurrentInfer()
+    {
+        perception::EnginePool pool(PoolConfig(2));
+        if (!PTK_CHECK(pool.Load("model")))
+        {
+            return;
+        }
+        g_max_active = 0;
+        std::atomic<int> bad{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 6; ++t)
+        {
+            threads.emplace_back([&pool, &bad, t]
+                                 {
+                                     std::vector<data::TensorView> outputs;
+                                     const void *storage = nullptr;
+                                     for (int i = 0; i < 20; ++i)
+                                     {
+                                         std::vector<float> x = Input(64, static_cast<float>(t * 1000 + i));
+                                         if (!pool.Infer({test::View(x, {64})}, outputs) || !Matches(outputs, x) ||
+                                             (storage != nullptr && outputs[0].buffer().data() != storage))
+                                         {
+                                             ++bad;
+                                         }
+                                         storage = outputs.empty() ? nullptr : outputs[0].buffer().data();
+                                     } });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        PTK_CHECK(bad == 0);
+        PTK_CHECK(g_max_active <= 2);
+    }
+
+    // Caller buffers are written in place, while views from an earlier call
+    // are refilled by copy; the thread's storage is shared by every pool.
+    void TestOutputs()
+    {
+        perception::EnginePool a(PoolConfig(2));
+        perception::EnginePool b(PoolConfig(2));
+        if (!PTK_CHECK(a.Load("model")) || !PTK_CHECK(b.Load("model")))
+        {
+            return;
+        }
+        std::vector<float> x = Input(16, 5.0f);
+        std::vector<float> y(16, 0.0f);
+        std::vector<data::TensorView> outputs = {test::View(y, {16})};
+        if (PTK_CHECK(a.Infer({test::View(x, {16})}, outputs)))
+        {
+            PTK_CHECK(outputs[0].buffer().data() == y.data());
+            PTK_CHECK(Matches(outputs, x));
+        }
+
+        outputs.clear();
+        PTK_CHECK(a.Infer({test::View(x, {16})}, outputs) && Matches(outputs, x));
+        const void *storage = outputs.empty() ? nullptr : outputs[0].buffer().data();
+        std::vector<float> x2 = Input(16, -3.0f);
+        PTK_CHECK(b.Infer({test::View(x2, {16})}, outputs) && Matches(outputs, x2));
+        PTK_CHECK(outputs[0].buffer().data() == storage);
+
+        // A different shape through the same storage.
+        std::vector<float> x3 = Input(40, 1.0f);
+        PTK_CHECK(a.Infer({test::View(x3, {40})}, outputs) && Matches(outputs, x3));
+    }
+
+    // A held lease leaves no engine free: with no queue Infer fails at once,
+    // with a timeout it fails after waiting, and a release lets it through.
+    void TestQueue()
+    {
+        perception::EngineConfig config = PoolConfig(1);
+        config.pool.max_queue = 0;
+        perception::EnginePool no_queue(config);
+        std::vector<float> x = Input(8, 0.0f);
+        std::vector<data::TensorView> outputs;
+        PTK_CHECK(!no_queue.Infer({test::View(x, {8})}, outputs));
+        PTK_CHECK(!no_queue.Acquire());
+        if (!PTK_CHECK(no_queue.Load("model")))
+        {
+            return;
+        }
+        {
+            perception::EnginePool::Lease lease = no_queue.Acquire();
+            PTK_CHECK(static_cast<bool>(lease));
+            PTK_CHECK(!no_queue.Infer({test::View(x, {8})}, outputs));
+            std::vector<data::TensorView> direct;
+            PTK_CHECK(lease->Infer({test::View(x, {8})}, direct) && Matches(direct, x));
+        }
+        PTK_CHECK(no_queue.Infer({test::View(x, {8})}, outputs) && Matches(outputs, x));
+
+        config.pool.max_queue = 4;
+        config.pool.queue_timeout_ms = 100;
+        perception::EnginePool timed(config);
+        if (!PTK_CHECK(timed.Load("model")))
+        {
+            return;
+        }
+        perception::EnginePool::Lease lease = timed.Acquire();
+        const auto t0 = std::chrono::steady_clock::now();
+        PTK_CHECK(!timed.Infer({test::View(x, {8})}, outputs));
+        PTK_CHECK(std::chrono::steady_clock::now() - t0 >= std::chrono::milliseconds(90));
+
+        bool ok = false;
+        std::thread waiter([&]
+                           {
+                               std::vector<data::TensorView> waited;
+                               ok = timed.Infer({test::View(x, {8})}, waited) && Matches(waited, x); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        lease = perception::EnginePool::Lease();
+        waiter.join();
+        PTK_CHECK(ok);
+    }
+
+    void TestLoadFailure()
+    {
+        g_fail_load = true;
+        perception::EnginePool pool(PoolConfig(2));
+        PTK_CHECK(!pool.Load("model"));
+        g_fail_load = false;
+        std::vector<float> x = Input(8, 0.0f);
+        std::vector<data::TensorView> outputs;
+        PTK_CHECK(!pool.Infer({test::View(x, {8})}, outputs));
+        PTK_CHECK(pool.size() == 0);
+    }
+} // namespace
+
+namespace ptk::perception
+{
+    std::unique_ptr<Engine> CreateEngine(const EngineConfig &config)
+    {
+        std::lock_guard<std::mutex> lock(g_mu);
+        g_created.push_back(config);
+        return std::make_unique<FakeEngine>(config);
+    }
+} // namespace ptk::perception
+
+int main()
+{
+    TestLoad();
+    TestConcurrentInfer();
+    TestOutputs();
+    TestQueue();
+    TestLoadFailure();
+    return ptk::test::Finish("engine_pool_test");
+}
@@ -0,0 +1,143 @@
+// The Engine interface's defaults on a fake engine: InferAsync in callback
+// and future form running Infer on the calling thread, with engine-owned or
+// preallocated outputs and failed runs, and specs built from names alone.
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "engines/engine.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    // y = x + 10 into its own buffer or a preallocated one; fails on request.
+    class FakeEngine : public perception::Engine
+    {
+    public:
+        bool fail = false;
+        int calls = 0;
+
+        bool Load(const std::string &) override { return true; }
+
+        bool Infer(const std::vector<data::TensorView> &inputs, std::vector<data::TensorView> &outputs) override
+        {
+            ++calls;
+            if (fail || inputs.size() != 1)
+            {
+                return false;
+            }
+            const float *x = static_cast<const float *>(inputs[0].buffer().data());
+            const std::size_t n = static_cast<std::size_t>(inputs[0].shape().num_elements());
+            float *y;
+            if (outputs.size() == 1 && !outputs[0].empty())
+            {
+                y = static_cast<float *>(const_cast<void *>(outputs[0].buffer().data()));
+            }
+            else
+            {
+                out_.resize(n);
+                y = out_.data();
+                outputs.assign(1, data::TensorView(data::BufferView(y, n * sizeof(float), core::DeviceType::kCpu),
+                                                   core::DataType::kFloat32, inputs[0].shape()));
+            }
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                y[i] = x[i] + 10.0f;
+            }
+            return true;
+        }
+
+        std::vector<std::string> InputNames() const override { return {"x"}; }
+        std::vector<std::string> OutputNames() const override { return {"y"}; }
+
+    private:
+        std::vector<float> out_;
+    };
+
+    // The callback runs once, before InferAsync returns, on the calling
+    // thread, with the results or with ok = false.
+    void TestCallback()
+    {
+        FakeEngine engine;
+        std::vector<float> x = {1.0f, 2.0f, 3.0f};
+        int called = 0;
+        bool same_thread = false;
+        std::vector<float> seen;
+        const std::thread::id caller = std::this_thread::get_id();
+        const bool started = engine.InferAsync(
+            {test::View(x, {3})}, {}, [&](bool ok, const std::vector<data::TensorView> &outputs)
+            {
+                ++called;
+                same_thread = std::this_thread::get_id() == caller;
+                if (ok && outputs.size() == 1)
+                {
+                    const float *y = static_cast<const float *>(outputs[0].buffer().data());
+                    seen.assign(y, y + outputs[0].shape().num_elements());
+                } });
+        PTK_CHECK(started && called == 1 && same_thread);
+        PTK_CHECK(seen == std::vector<float>({11.0f, 12.0f, 13.0f}));
+
+        // Preallocated outputs are handed back as given.
+        std::vector<float> y(3);
+        const void *handed = nullptr;
+        engine.InferAsync({test::View(x, {3})}, {test::View(y, {3})},
+                          [&](bool ok, const std::vector<data::TensorView> &outputs)
+                          { handed = ok && outputs.size() == 1 ? outputs[0].buffer().data() : nullptr; });
+        PTK_CHECK(handed == y.data());
+        PTK_CHECK(y == std::vector<float>({11.0f, 12.0f, 13.0f}));
+
+        engine.fail = true;
+        bool failed_ok = true;
+        called = 0;
+        PTK_CHECK(engine.InferAsync({test::View(x, {3})}, {}, [&](bool ok, const std::vector<data::TensorView> &)
+                                    {
+                                        ++called;
+                                        failed_ok = ok; }));
+        PTK_CHECK(called == 1 && !failed_ok);
+    }
+
+    // The future form: ready on return, true with results in the
+    // preallocated outputs, false when the run failed.
+    void TestFuture()
+    {
+        FakeEngine engine;
+        std::vector<float> a = {0.5f, -1.0f};
+        std::vector<float> b = {4.0f, 8.0f};
+        std::vector<float> ya(2);
+        std::vector<float> yb(2);
+        std::future<bool> first = engine.InferAsync({test::View(a, {2})}, {test::View(ya, {2})});
+        std::future<bool> second = engine.InferAsync({test::View(b, {2})}, {test::View(yb, {2})});
+        PTK_CHECK(first.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        PTK_CHECK(first.get() && second.get());
+        PTK_CHECK(ya == std::vector<float>({10.5f, 9.0f}) && yb == std::vector<float>({14.0f, 18.0f}));
+        PTK_CHECK(engine.calls == 2);
+
+        engine.fail = true;
+        PTK_CHECK(!engine.InferAsync({test::View(a, {2})}, {test::View(ya, {2})}).get());
+    }
+
+    // Engines that cannot introspect their model report names only.
+    void TestSpecs()
+    {
+        FakeEngine engine;
+        const std::vector<data::TensorSpec> inputs = engine.InputSpecs();
+        const std::vector<data::TensorSpec> outputs = engine.OutputSpecs();
+        PTK_CHECK(inputs.size() == 1 && inputs[0].name == "x" && !inputs[0].known());
+        PTK_CHECK(outputs.size() == 1 && outputs[0].name == "y" && !outputs[0].known());
+        PTK_CHECK(engine.threading().intra_op_threads == perception::ThreadingConfig().intra_op_threads);
+    }
+} // namespace
+
+int main()
+{
+    TestCallback();
+    TestFuture();
+    TestSpecs();
+    return ptk::test::Finish("engine_test");
+}
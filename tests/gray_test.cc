@@ -0,0 +1,139 @@
+// RgbToGray and BgrToGray: the uint8 path against its Q16 fixed-point
+// formula bit for bit and within one level of the rounded float weights, the
+// float32 path against the weights directly, over widths that exercise the
+// vector bodies, their tails and the tile boundary.
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "operators/rgb_to_gray.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+    using operators::LumaWeights;
+
+    void Weights(LumaWeights luma, double f[3], std::uint32_t q[3])
+    {
+        const bool bt709 = luma == LumaWeights::kBt709;
+        const double fw[3] = {bt709 ? 0.2126 : 0.299, bt709 ? 0.7152 : 0.587, bt709 ? 0.0722 : 0.114};
+        for (int c = 0; c < 3; ++c)
+        {
+            f[c] = fw[c];
+        }
+        // Q16, rounded and then adjusted so the three sum to 65536.
+        const std::uint32_t bt601_q[3] = {19595, 38470, 7471};
+        const std::uint32_t bt709_q[3] = {13933, 46871, 4732};
+        for (int c = 0; c < 3; ++c)
+        {
+            q[c] = bt709 ? bt709_q[c] : bt601_q[c];
+        }
+    }
+
+    void TestUint8(LumaWeights luma, bool bgr, std::int64_t H, std::int64_t W)
+    {
+        std::vector<std::uint8_t> rgb = test::Pattern(static_cast<std::size_t>(H * W * 3),
+                                                      static_cast<std::uint32_t>(W * 3 + H));
+        // White must stay white.
+        rgb[0] = rgb[1] = rgb[2] = 255;
+        std::vector<std::uint8_t> gray(static_cast<std::size_t>(H * W));
+        data::TensorView dst = test::View(gray, {H, W, 1});
+        const data::TensorView src = test::View(rgb, {H, W, 3});
+        if (!PTK_CHECK_OK(bgr ? operators::BgrToGray(src, &dst, luma) : operators::RgbToGray(src, &dst, luma)))
+        {
+            return;
+        }
+
+        double f[3];
+        std::uint32_t q[3];
+        Weights(luma, f, q);
+        PTK_CHECK(q[0] + q[1] + q[2] == 65536u);
+        int bad = 0;
+        int far = 0;
+        for (std::int64_t i = 0; i < H * W; ++i)
+        {
+            const std::uint8_t *px = &rgb[i * 3];
+            const std::uint32_t r = bgr ? px[2] : px[0];
+            const std::uint32_t g = px[1];
+            const std::uint32_t b = bgr ? px[0] : px[2];
+            const std::uint32_t sum = ((r * q[0]) >> 8) + ((g * q[1]) >> 8) + ((b * q[2]) >> 8);
+            bad += gray[i] != static_cast<std::uint8_t>((sum + 128) >> 8);
+            far += std::fabs(gray[i] - (f[0] * r + f[1] * g + f[2] * b)) > 1.0;
+        }
+        PTK_CHECK(gray[0] == 255);
+        if (!PTK_CHECK(bad == 0) || !PTK_CHECK(far == 0))
+        {
+            std::printf("  uint8 %s %s H=%lld W=%lld\n", bgr ? "BGR" : "RGB", luma == LumaWeights::kBt709 ? "BT.709" : "BT.601",
+                        static_cast<long long>(H), static_cast<long long>(W));
+        }
+    }
+
+    void TestFloat(LumaWeights luma, bool bgr, std::int64_t H, std::int64_t W)
+    {
+        const std::vector<std::uint8_t> bytes = test::Pattern(static_cast<std::size_t>(H * W * 3),
+                                                              static_cast<std::uint32_t>(W + H));
+        std::vector<float> rgb(bytes.size());
+        for (std::size_t i = 0; i < bytes.size(); ++i)
+        {
+            rgb[i] = static_cast<float>(bytes[i]) / 255.0f - 0.25f;
+        }
+        std::vector<float> gray(static_cast<std::size_t>(H * W));
+        data::TensorView dst = test::View(gray, {H, W, 1});
+        const data::TensorView src = test::View(rgb, {H, W, 3});
+        if (!PTK_CHECK_OK(bgr ? operators::BgrToGray(src, &dst, luma) : operators::RgbToGray(src, &dst, luma)))
+        {
+            return;
+        }
+
+        double f[3];
+        std::uint32_t q[3];
+        Weights(luma, f, q);
+        int bad = 0;
+        for (std::int64_t i = 0; i < H * W; ++i)
+        {
+            const float *px = &rgb[i * 3];
+            const double want = f[0] * (bgr ? px[2] : px[0]) + f[1] * px[1] + f[2] * (bgr ? px[0] : px[2]);
+            bad += std::fabs(gray[i] - want) > 1e-6;
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  float32 %s H=%lld W=%lld\n", bgr ? "BGR" : "RGB", static_cast<long long>(H),
+                        static_cast<long long>(W));
+        }
+    }
+
+    void TestInvalid()
+    {
+        std::vector<std::uint8_t> rgb(4 * 4 * 3);
+        std::vector<std::uint8_t> gray(4 * 4 * 3);
+        data::TensorView wrong_channels = test::View(gray, {4, 4, 3});
+        PTK_CHECK(!operators::RgbToGray(test::View(rgb, {4, 4, 3}), &wrong_channels).ok());
+        data::TensorView four = test::View(gray, {4, 3, 1});
+        PTK_CHECK(!operators::RgbToGray(test::View(rgb, {4, 3, 4}), &four).ok());
+        std::vector<float> gray_f(16);
+        data::TensorView mixed = test::View(gray_f, {4, 4, 1});
+        PTK_CHECK(!operators::RgbToGray(test::View(rgb, {4, 4, 3}), &mixed).ok());
+        PTK_CHECK(!operators::BgrToGray(test::View(rgb, {4, 4, 3}), nullptr).ok());
+    }
+} // namespace
+
+int main()
+{
+    const std::int64_t widths[] = {1, 7, 8, 16, 17, 255, 256, 257, 600};
+    for (LumaWeights luma : {LumaWeights::kBt601, LumaWeights::kBt709})
+    {
+        for (bool bgr : {false, true})
+        {
+            for (std::int64_t W : widths)
+            {
+                TestUint8(luma, bgr, 3, W);
+                TestFloat(luma, bgr, 3, W);
+            }
+            TestUint8(luma, bgr, 200, 301);
+        }
+    }
+    TestInvalid();
+    return ptk::test::Finish("gray_test");
+}
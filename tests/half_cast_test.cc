@@ -0,0 +1,230 @@
+// fp16 and bf16 conversions: the scalar helpers in data/half.h against the
+// definition of round to nearest even, and every cast kernel against those
+// helpers, over all 16-bit inputs and a spread of float32 inputs.
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "operators/cast_bfloat16_to_float32.h"
+#include "operators/cast_float16_to_float32.h"
+#include "operators/cast_float32_to_bfloat16.h"
+#include "operators/cast_float32_to_float16.h"
+#include "runtime/data/half.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    std::uint32_t Bits(float f)
+    {
+        std::uint32_t b;
+        std::memcpy(&b, &f, sizeof(b));
+        return b;
+    }
+
+    float FromBits(std::uint32_t b)
+    {
+        float f;
+        std::memcpy(&f, &b, sizeof(f));
+        return f;
+    }
+
+    // Special values, the fp16 range edges and random bit patterns of every
+    // exponent; an odd count leaves a scalar tail after each vector loop.
+    std::vector<float> FloatInputs()
+    {
+        std::vector<float> v = {0.0f,
+                                -0.0f,
+                                1.0f,
+                                -2.5f,
+                                65504.0f,
+                                65519.0f,
+                                65520.0f,
+                                -65520.0f,
+                                6.103515625e-05f,
+                                5.9604644775390625e-08f,
+                                2.98023223876953125e-08f,
+                                2.98023259404089e-08f,
+                                1e-30f,
+                                std::numeric_limits<float>::infinity(),
+                                -std::numeric_limits<float>::infinity(),
+                                std::numeric_limits<float>::quiet_NaN(),
+                                FromBits(0x7f800001u),
+                                FromBits(0xffc01234u)};
+        const std::vector<std::uint8_t> bytes = test::Pattern(4 * 4099, 30);
+        for (std::size_t i = 0; i + 4 <= bytes.size(); i += 4)
+        {
+            std::uint32_t b;
+            std::memcpy(&b, &bytes[i], sizeof(b));
+            // Keep most exponents near the fp16 range so rounding is exercised.
+            if (i % 8 == 0)
+            {
+                b = (b & 0x807fffffu) | ((100u + (b >> 23) % 50u) << 23);
+            }
+            v.push_back(FromBits(b));
+        }
+        return v;
+    }
+
+    bool IsNan(float f) { return f != f; }
+
+    // h is the nearest fp16 to x, ties to an even mantissa.
+    bool IsNearestHalf(float x, std::uint16_t h)
+    {
+        if (IsNan(x))
+        {
+            return IsNan(data::HalfToFloat(h));
+        }
+        const double v = x;
+        const double got = data::HalfToFloat(h);
+        if (std::fabs(v) >= 65520.0)
+        {
+            return std::isinf(got) && (got > 0) == (v > 0);
+        }
+        if ((Bits(x) >> 31) != static_cast<std::uint32_t>(h >> 15))
+        {
+            return false;
+        }
+        const std::uint16_t mag = h & 0x7fffu;
+        const double up = data::HalfToFloat(static_cast<std::uint16_t>((h & 0x8000u) | (mag + 1)));
+        const double err = std::fabs(got - v);
+        if (err > std::fabs(up - v))
+        {
+            return false;
+        }
+        if (mag > 0)
+        {
+            const double down = data::HalfToFloat(static_cast<std::uint16_t>((h & 0x8000u) | (mag - 1)));
+            if (err > std::fabs(down - v) || (err == std::fabs(down - v) && (mag & 1u)))
+            {
+                return false;
+            }
+        }
+        return err != std::fabs(up - v) || (mag & 1u) == 0;
+    }
+
+    void TestScalarHalf()
+    {
+        int bad = 0;
+        for (std::uint32_t h = 0; h < 0x10000u; ++h)
+        {
+            const float f = data::HalfToFloat(static_cast<std::uint16_t>(h));
+            const bool nan = (h & 0x7c00u) == 0x7c00u && (h & 0x3ffu) != 0;
+            // Every half converts exactly, so the round trip is the identity;
+            // NaNs come back quiet.
+            const std::uint16_t back = data::FloatToHalf(f);
+            bad += nan ? !IsNan(f) || back != (h | 0x0200u) : back != h;
+        }
+        PTK_CHECK(bad == 0);
+
+        bad = 0;
+        for (float x : FloatInputs())
+        {
+            bad += !IsNearestHalf(x, data::FloatToHalf(x));
+        }
+        PTK_CHECK(bad == 0);
+    }
+
+    void TestScalarBFloat16()
+    {
+        int bad = 0;
+        for (float x : FloatInputs())
+        {
+            const std::uint16_t b = data::FloatToBFloat16(x);
+            if (IsNan(x))
+            {
+                bad += !IsNan(data::BFloat16ToFloat(b));
+                continue;
+            }
+            // Nearest of the two bf16 values around x, ties to even.
+            const std::uint32_t down = Bits(x) & 0xffff0000u;
+            const std::uint32_t rest = Bits(x) & 0xffffu;
+            const std::uint32_t want =
+                (rest > 0x8000u || (rest == 0x8000u && ((down >> 16) & 1u))) ? (down >> 16) + 1 : down >> 16;
+            bad += b != want;
+        }
+        PTK_CHECK(bad == 0);
+    }
+
+    // Kernel results equal the scalar helpers bit for bit; NaNs only need to
+    // stay NaN. flush_denormals allows the AVX-512 BF16 instruction's zero.
+    template <typename From, typename To, typename Kernel, typename Scalar>
+    void TestKernel(std::vector<From> in, core::DataType from, core::DataType to, Kernel kernel, Scalar scalar,
+                    bool flush_denormals)
+    {
+        std::vector<To> out(in.size());
+        data::TensorView dst = test::View(out, to, {static_cast<std::int64_t>(out.size())});
+        if (!PTK_CHECK_OK(kernel(test::View(in, from, {static_cast<std::int64_t>(in.size())}), &dst)))
+        {
+            return;
+        }
+        int bad = 0;
+        for (std::size_t i = 0; i < in.size(); ++i)
+        {
+            const To want = scalar(in[i]);
+            To got_bits = out[i];
+            if (std::memcmp(&got_bits, &want, sizeof(To)) == 0)
+            {
+                continue;
+            }
+            if constexpr (std::is_same_v<To, float>)
+            {
+                bad += !(IsNan(want) && IsNan(out[i]));
+            }
+            else
+            {
+                const float x = static_cast<float>(in[i]);
+                const bool denormal = (Bits(x) & 0x7f800000u) == 0;
+                const bool nan = IsNan(x);
+                bad += !(nan && (out[i] & 0x7fffu) > 0x7f80u) &&
+                       !(flush_denormals && denormal && (out[i] & 0x7fffu) == 0);
+            }
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  %d of %zu elements differ\n", bad, in.size());
+        }
+    }
+
+    void TestKernels()
+    {
+        std::vector<std::uint16_t> all(0x10000u + 7);
+        for (std::size_t i = 0; i < all.size(); ++i)
+        {
+            all[i] = static_cast<std::uint16_t>(i);
+        }
+        const std::vector<float> floats = FloatInputs();
+
+        TestKernel<std::uint16_t, float>(all, core::DataType::kFloat16, core::DataType::kFloat32,
+                                         operators::CastFloat16ToFloat32, data::HalfToFloat, false);
+        TestKernel<std::uint16_t, float>(all, core::DataType::kBFloat16, core::DataType::kFloat32,
+                                         operators::CastBFloat16ToFloat32, data::BFloat16ToFloat, false);
+        TestKernel<float, std::uint16_t>(floats, core::DataType::kFloat32, core::DataType::kFloat16,
+                                         operators::CastFloat32ToFloat16, data::FloatToHalf, false);
+        TestKernel<float, std::uint16_t>(floats, core::DataType::kFloat32, core::DataType::kBFloat16,
+                                         operators::CastFloat32ToBFloat16, data::FloatToBFloat16, true);
+    }
+
+    void TestInvalid()
+    {
+        std::vector<float> f(8);
+        std::vector<std::uint16_t> h(7);
+        data::TensorView short_dst = test::View(h, core::DataType::kFloat16, {7});
+        PTK_CHECK(!operators::CastFloat32ToFloat16(test::View(f, {8}), &short_dst).ok());
+        data::TensorView wrong_type = test::View(h, core::DataType::kBFloat16, {7});
+        PTK_CHECK(!operators::CastFloat16ToFloat32(test::View(f, {7}), &wrong_type).ok());
+    }
+} // namespace
+
+int main()
+{
+    TestScalarHalf();
+    TestScalarBFloat16();
+    TestKernels();
+    TestInvalid();
+    return ptk::test::Finish("half_cast_test");
+}
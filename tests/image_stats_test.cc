@@ -0,0 +1,273 @@
+// ComputeImageStats and ComputeHistogram against per-pixel references for
+// uint8 and float32, 1 to 4 channels, full frames, ROIs, sampling strides,
+// crop and vertical-flip views, on widths around the 16-byte vectors and the
+// 256 pixel tiles; plus Merge and the argument checks.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "operators/image_stats.h"
+#include "operators/rotate_flip.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    // An H x W x C pattern inside a frame with `border` extra pixels on each
+    // side, so a bordered view has rows that are packed but not contiguous.
+    // Float images spread the bytes over negative values too.
+    template <typename T>
+    struct Image
+    {
+        std::vector<T> pixels;
+        std::int64_t C;
+        std::int64_t border;
+        std::int64_t stride;
+        data::TensorView view;
+
+        Image(std::int64_t H, std::int64_t W, std::int64_t channels, std::int64_t b)
+            : C(channels), border(b), stride((W + 2 * b) * channels)
+        {
+            const std::vector<std::uint8_t> bytes = test::Pattern(static_cast<std::size_t>((H + 2 * b) * stride),
+                                                                  static_cast<std::uint32_t>(W * C + H));
+            for (std::uint8_t v : bytes)
+            {
+                pixels.push_back(sizeof(T) == 1 ? static_cast<T>(v) : static_cast<T>((v - 100.0f) * 0.37f));
+            }
+            const std::int64_t offset = b * stride + b * C;
+            view = data::TensorView(data::BufferView(pixels.data() + offset, (pixels.size() - offset) * sizeof(T),
+                                                     core::DeviceType::kCpu),
+                                    operators::DataTypeOf<T>::value, data::TensorShape({H, W, C}), {stride, C, 1});
+        }
+
+        const T &at(std::int64_t y, std::int64_t x, std::int64_t c) const
+        {
+            return pixels[(y + border) * stride + (x + border) * C + c];
+        }
+
+        T &at(std::int64_t y, std::int64_t x, std::int64_t c)
+        {
+            return pixels[(y + border) * stride + (x + border) * C + c];
+        }
+    };
+
+    // The sampled pixels of the ROI, in the order ComputeImageStats documents.
+    struct Sampled
+    {
+        std::int64_t y0, x0, h, w, step;
+    };
+
+    Sampled Sampling(const data::TensorView &view, const operators::StatsOptions &options)
+    {
+        const operators::ImageRoi &roi = options.roi;
+        const bool full = roi.width == 0 || roi.height == 0;
+        return {full ? 0 : roi.y, full ? 0 : roi.x, full ? view.shape().dim(0) : roi.height,
+                full ? view.shape().dim(1) : roi.width, options.sample_stride};
+    }
+
+    template <typename T>
+    void TestStats(std::int64_t H, std::int64_t W, std::int64_t C, const operators::StatsOptions &options, bool crop,
+                   bool flip)
+    {
+        const Image<T> image(H, W, C, crop ? 2 : 0);
+        data::TensorView view = image.view;
+        if (flip && !PTK_CHECK_OK(operators::FlipView(image.view, operators::FlipMode::kVertical, &view)))
+        {
+            return;
+        }
+        operators::ImageStats stats;
+        if (!PTK_CHECK_OK(operators::ComputeImageStats(view, options, &stats)))
+        {
+            return;
+        }
+
+        const Sampled s = Sampling(view, options);
+        int bad = stats.channels != C;
+        for (std::int64_t c = 0; c < C; ++c)
+        {
+            operators::ChannelStats want;
+            for (std::int64_t y = s.y0; y < s.y0 + s.h; y += s.step)
+            {
+                for (std::int64_t x = s.x0; x < s.x0 + s.w; x += s.step)
+                {
+                    const double v = image.at(flip ? H - 1 - y : y, x, c);
+                    want.min = want.count == 0 ? v : std::min(want.min, v);
+                    want.max = want.count == 0 ? v : std::max(want.max, v);
+                    want.sum += v;
+                    want.sum_sq += v * v;
+                    ++want.count;
+                }
+            }
+            const operators::ChannelStats &got = stats.channel[c];
+            // uint8 sums are exact; float ones are rounded per tile.
+            const double tolerance = sizeof(T) == 1 ? 0.0 : 1e-5;
+            bad += got.count != want.count || got.min != want.min || got.max != want.max;
+            bad += std::fabs(got.sum - want.sum) > tolerance * (1.0 + std::fabs(want.sum));
+            bad += std::fabs(got.sum_sq - want.sum_sq) > tolerance * (1.0 + want.sum_sq);
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  stats %s H=%lld W=%lld C=%lld roi=%d,%d,%d,%d stride=%d crop=%d flip=%d\n",
+                        sizeof(T) == 1 ? "uint8" : "float32", static_cast<long long>(H), static_cast<long long>(W),
+                        static_cast<long long>(C), options.roi.x, options.roi.y, options.roi.width,
+                        options.roi.height, options.sample_stride, crop, flip);
+        }
+    }
+
+    template <typename T>
+    void TestHistogram(std::int64_t H, std::int64_t W, std::int64_t C, const operators::HistogramParams &params,
+                       const operators::StatsOptions &options, bool crop)
+    {
+        Image<T> image(H, W, C, crop ? 2 : 0);
+        if constexpr (sizeof(T) == 4)
+        {
+            // NaN and a value far above the bins, next to ones below them.
+            image.at(0, 0, 0) = std::numeric_limits<T>::quiet_NaN();
+            image.at(H - 1, W - 1, C - 1) = 1e6f;
+        }
+        operators::ImageHistogram histogram;
+        if (!PTK_CHECK_OK(operators::ComputeHistogram(image.view, params, options, &histogram)))
+        {
+            return;
+        }
+
+        const Sampled s = Sampling(image.view, options);
+        const float scale = static_cast<float>(params.bins) / (params.hi - params.lo);
+        const float top = static_cast<float>(params.bins - 1);
+        std::vector<std::uint32_t> want(static_cast<std::size_t>(C * params.bins), 0);
+        for (std::int64_t y = s.y0; y < s.y0 + s.h; y += s.step)
+        {
+            for (std::int64_t x = s.x0; x < s.x0 + s.w; x += s.step)
+            {
+                for (std::int64_t c = 0; c < C; ++c)
+                {
+                    float t = (static_cast<float>(image.at(y, x, c)) - params.lo) * scale;
+                    t = t > 0.0f ? std::min(t, top) : 0.0f;
+                    ++want[static_cast<std::size_t>(c * params.bins + static_cast<std::int64_t>(t))];
+                }
+            }
+        }
+        if (!PTK_CHECK(histogram.channels == C && histogram.counts == want))
+        {
+            std::printf("  histogram %s H=%lld W=%lld C=%lld bins=%d stride=%d crop=%d\n",
+                        sizeof(T) == 1 ? "uint8" : "float32", static_cast<long long>(H), static_cast<long long>(W),
+                        static_cast<long long>(C), params.bins, options.sample_stride, crop);
+        }
+    }
+
+    // Stats and histograms of two halves merge into those of the whole.
+    void TestMerge()
+    {
+        const Image<std::uint8_t> image(40, 300, 3, 0);
+        operators::StatsOptions top;
+        top.roi = {0, 0, 300, 17};
+        operators::StatsOptions bottom;
+        bottom.roi = {0, 17, 300, 23};
+        operators::ImageStats whole;
+        operators::ImageStats merged;
+        operators::ImageStats part;
+        operators::ImageHistogram whole_h;
+        operators::ImageHistogram merged_h;
+        operators::ImageHistogram part_h;
+        const operators::HistogramParams params;
+        PTK_CHECK_OK(operators::ComputeImageStats(image.view, operators::StatsOptions(), &whole));
+        PTK_CHECK_OK(operators::ComputeHistogram(image.view, params, operators::StatsOptions(), &whole_h));
+        for (const operators::StatsOptions &half : {top, bottom})
+        {
+            PTK_CHECK_OK(operators::ComputeImageStats(image.view, half, &part));
+            PTK_CHECK_OK(operators::ComputeHistogram(image.view, params, half, &part_h));
+            merged.Merge(part);
+            merged_h.Merge(part_h);
+        }
+        PTK_CHECK(merged.channels == 3);
+        for (int c = 0; c < 3; ++c)
+        {
+            const operators::ChannelStats &a = whole.channel[c];
+            const operators::ChannelStats &b = merged.channel[c];
+            PTK_CHECK(a.count == b.count && a.sum == b.sum && a.sum_sq == b.sum_sq && a.min == b.min &&
+                      a.max == b.max);
+            PTK_CHECK_NEAR(b.mean(), b.sum / static_cast<double>(b.count), 1e-12);
+            PTK_CHECK_NEAR(b.stddev() * b.stddev(), b.sum_sq / b.count - b.mean() * b.mean(), 1e-6);
+        }
+        PTK_CHECK(merged_h.counts == whole_h.counts);
+        PTK_CHECK(whole_h.count(2, 255) == whole_h.counts[2 * 256 + 255]);
+    }
+
+    void TestInvalid()
+    {
+        std::vector<std::uint8_t> pixels(4 * 4 * 5);
+        operators::ImageStats stats;
+        operators::ImageHistogram histogram;
+        const operators::StatsOptions full;
+        const operators::HistogramParams params;
+        PTK_CHECK(!operators::ComputeImageStats(test::View(pixels, {4, 4, 5}), full, &stats).ok());
+        PTK_CHECK(!operators::ComputeImageStats(test::View(pixels, {4, 20}), full, &stats).ok());
+        PTK_CHECK(!operators::ComputeImageStats(test::View(pixels, {4, 4, 3}), full, nullptr).ok());
+        std::vector<std::int8_t> signed_pixels(16);
+        PTK_CHECK(!operators::ComputeImageStats(test::View(signed_pixels, {4, 4, 1}), full, &stats).ok());
+
+        operators::StatsOptions outside;
+        outside.roi = {2, 1, 3, 2};
+        PTK_CHECK(!operators::ComputeImageStats(test::View(pixels, {4, 4, 3}), outside, &stats).ok());
+        operators::StatsOptions zero_stride;
+        zero_stride.sample_stride = 0;
+        PTK_CHECK(!operators::ComputeImageStats(test::View(pixels, {4, 4, 3}), zero_stride, &stats).ok());
+
+        // Horizontal flips leave the pixels of a row unpacked.
+        data::TensorView mirrored;
+        PTK_CHECK_OK(operators::FlipView(test::View(pixels, {4, 4, 3}), operators::FlipMode::kHorizontal, &mirrored));
+        PTK_CHECK(!operators::ComputeImageStats(mirrored, full, &stats).ok());
+
+        operators::HistogramParams no_bins;
+        no_bins.bins = 0;
+        PTK_CHECK(!operators::ComputeHistogram(test::View(pixels, {4, 4, 3}), no_bins, full, &histogram).ok());
+        operators::HistogramParams empty_range;
+        empty_range.hi = empty_range.lo;
+        PTK_CHECK(!operators::ComputeHistogram(test::View(pixels, {4, 4, 3}), empty_range, full, &histogram).ok());
+        PTK_CHECK(!operators::ComputeHistogram(test::View(pixels, {4, 4, 3}), params, full, nullptr).ok());
+    }
+} // namespace
+
+int main()
+{
+    // Widths around the vectors and tiles, and a frame split over threads.
+    const std::int64_t sizes[][2] = {{1, 1}, {3, 7}, {2, 16}, {3, 17}, {2, 255}, {2, 257}, {3, 600}, {150, 410}};
+    operators::StatsOptions full;
+    // A zero-width ROI means the full frame.
+    operators::StatsOptions zero_width;
+    zero_width.roi = {1, 1, 0, 5};
+    operators::HistogramParams bytes;
+    operators::HistogramParams coarse;
+    coarse.bins = 10;
+    coarse.lo = -20.0f;
+    coarse.hi = 60.0f;
+    for (const auto &size : sizes)
+    {
+        const std::int64_t H = size[0];
+        const std::int64_t W = size[1];
+        operators::StatsOptions strided;
+        strided.roi = {static_cast<int>(W / 3), static_cast<int>(H / 3), static_cast<int>(W - W / 3),
+                       static_cast<int>(H - H / 3)};
+        strided.sample_stride = 3;
+        for (std::int64_t C = 1; C <= 4; ++C)
+        {
+            for (const operators::StatsOptions &options : {full, zero_width, strided})
+            {
+                TestStats<std::uint8_t>(H, W, C, options, false, false);
+                TestStats<std::uint8_t>(H, W, C, options, true, true);
+                TestStats<float>(H, W, C, options, true, false);
+                TestStats<float>(H, W, C, options, false, true);
+                TestHistogram<std::uint8_t>(H, W, C, bytes, options, false);
+                TestHistogram<std::uint8_t>(H, W, C, coarse, options, true);
+                TestHistogram<float>(H, W, C, coarse, options, true);
+            }
+        }
+    }
+    TestMerge();
+    TestInvalid();
+    return ptk::test::Finish("image_stats_test");
+}
@@ -0,0 +1,364 @@
+// InferenceComponent over a fake engine: outputs written in place when the
+// specs fix their shapes (statically or through named symbolic dims of the
+// input), copied from the engine's views when they do not, rotated across
+// output buffers, published with the frame's metadata by index or name, and
+// setup and run failures.
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "engines/engine.h"
+#include "runtime/components/inference_component.h"
+#include "runtime/core/port.h"
+#include "runtime/core/runtime_context.h"
+#include "runtime/data/tensor_spec.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    data::TensorSpec Spec(const std::string &name, std::vector<std::int64_t> dims, std::vector<std::string> dim_names)
+    {
+        data::TensorSpec spec;
+        spec.name = name;
+        spec.dtype = core::DataType::kFloat32;
+        spec.dims = std::move(dims);
+        spec.dim_names = std::move(dim_names);
+        return spec;
+    }
+
+    // x[N, W] -> y = 2 * x and s = row sums, into preallocated outputs or
+    // its own buffers. Without specs set it reports names only.
+    class FakeEngine : public perception::Engine
+    {
+    public:
+        std::vector<data::TensorSpec> input_specs;
+        std::vector<data::TensorSpec> output_specs;
+        bool fail = false;
+        bool preallocated = false;       // whether the last run got output buffers
+        std::vector<std::int64_t> input; // dims of the last input
+
+        bool Load(const std::string &) override { return true; }
+
+        bool Infer(const std::vector<data::TensorView> &inputs, std::vector<data::TensorView> &outputs) override
+        {
+            if (fail || inputs.size() != 1 || inputs[0].shape().rank() != 2)
+            {
+                return false;
+            }
+            input = inputs[0].shape().dims();
+            const std::int64_t rows = input[0];
+            const std::int64_t cols = input[1];
+            const float *x = static_cast<const float *>(inputs[0].buffer().data());
+
+            preallocated = outputs.size() == 2 && !outputs[0].empty();
+            float *y;
+            float *s;
+            if (preallocated)
+            {
+                if (outputs[0].shape().dims() != input || outputs[1].shape().num_elements() != rows)
+                {
+                    return false;
+                }
+                y = static_cast<float *>(const_cast<void *>(outputs[0].buffer().data()));
+                s = static_cast<float *>(const_cast<void *>(outputs[1].buffer().data()));
+            }
+            else
+            {
+                y_.resize(static_cast<std::size_t>(rows * cols));
+                s_.resize(static_cast<std::size_t>(rows));
+                y = y_.data();
+                s = s_.data();
+                outputs = {test::View(y_, input), test::View(s_, {rows})};
+            }
+            for (std::int64_t r = 0; r < rows; ++r)
+            {
+                s[r] = 0.0f;
+                for (std::int64_t c = 0; c < cols; ++c)
+                {
+                    y[r * cols + c] = 2.0f * x[r * cols + c];
+                    s[r] += x[r * cols + c];
+                }
+            }
+            return true;
+        }
+
+        std::vector<std::string> InputNames() const override { return {"x"}; }
+        std::vector<std::string> OutputNames() const override { return {"y", "s"}; }
+
+        std::vector<data::TensorSpec> InputSpecs() const override
+        {
+            return input_specs.empty() ? Engine::InputSpecs() : input_specs;
+        }
+        std::vector<data::TensorSpec> OutputSpecs() const override
+        {
+            return output_specs.empty() ? Engine::OutputSpecs() : output_specs;
+        }
+
+        const void *own_y() const { return y_.data(); }
+
+    private:
+        std::vector<float> y_;
+        std::vector<float> s_;
+    };
+
+    // The component with its ports; errors go to a scratch stream so the
+    // test can tell whether a tick logged one.
+    struct Harness
+    {
+        core::RuntimeContext context;
+        std::FILE *log = std::tmpfile();
+        components::InferenceComponent component;
+        core::InputPort<data::Frame> in;
+        core::OutputPort<data::TensorPacket> y_out;
+        core::OutputPort<data::TensorPacket> s_out;
+        data::Frame frame;
+        data::TensorPacket y;
+        data::TensorPacket s;
+
+        Harness(FakeEngine *engine, int output_buffers)
+            : component(engine, Config(output_buffers))
+        {
+            core::RuntimeContextOptions options;
+            options.info_stream = log;
+            options.error_stream = log;
+            context.Init(options);
+            in.Bind(&frame);
+            y_out.Bind(&y);
+            s_out.Bind(&s);
+            component.BindInput(&in);
+        }
+        ~Harness() { std::fclose(log); }
+
+        static components::InferenceComponentConfig Config(int output_buffers)
+        {
+            components::InferenceComponentConfig config;
+            config.output_buffers = output_buffers;
+            return config;
+        }
+
+        bool Setup()
+        {
+            return PTK_CHECK_OK(component.Init(&context)) && PTK_CHECK_OK(component.Start());
+        }
+
+        // One tick on x with the given dims; false if it failed.
+        bool Tick(std::vector<float> &x, const std::vector<std::int64_t> &dims)
+        {
+            frame.image = test::View(x, dims);
+            const std::uint64_t failures = component.stats().failures;
+            component.Tick();
+            return component.stats().failures == failures;
+        }
+    };
+
+    bool Matches(const data::TensorPacket &y, const data::TensorPacket &s, const std::vector<float> &x,
+                 std::int64_t rows)
+    {
+        const std::int64_t cols = static_cast<std::int64_t>(x.size()) / rows;
+        if (y.tensor.shape().num_elements() != rows * cols || s.tensor.shape().num_elements() != rows)
+        {
+            return false;
+        }
+        const float *py = static_cast<const float *>(y.tensor.buffer().data());
+        const float *ps = static_cast<const float *>(s.tensor.buffer().data());
+        for (std::int64_t r = 0; r < rows; ++r)
+        {
+            float sum = 0.0f;
+            for (std::int64_t c = 0; c < cols; ++c)
+            {
+                sum += x[r * cols + c];
+                if (py[r * cols + c] != 2.0f * x[r * cols + c])
+                {
+                    return false;
+                }
+            }
+            if (ps[r] != sum)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<float> Input(std::size_t n, float start)
+    {
+        std::vector<float> x(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            x[i] = start + static_cast<float>(i);
+        }
+        return x;
+    }
+
+    // A static model: a frame one rank short gets the batch dim, outputs
+    // land in place in buffers that rotate, and a packet stays valid while
+    // later ticks use the other buffers.
+    void TestStaticModel()
+    {
+        FakeEngine engine;
+        engine.input_specs = {Spec("x", {1, 4}, {"", ""})};
+        engine.output_specs = {Spec("y", {1, 4}, {"", ""}), Spec("s", {1}, {""})};
+        Harness h(&engine, 2);
+        h.component.BindOutput(0, &h.y_out);
+        h.component.BindOutput(1, &h.s_out);
+        if (!h.Setup())
+        {
+            return;
+        }
+
+        std::vector<float> a = Input(4, 1.0f);
+        h.frame.timestamp_ns = 1234;
+        h.frame.frame_index = 7;
+        h.frame.camera_id = 2;
+        if (!PTK_CHECK(h.Tick(a, {4})))
+        {
+            return;
+        }
+        PTK_CHECK(engine.preallocated);
+        PTK_CHECK(engine.input == std::vector<std::int64_t>({1, 4}));
+        PTK_CHECK(Matches(h.y, h.s, a, 1));
+        PTK_CHECK(h.y.timestamp_ns == 1234 && h.y.frame_index == 7 && h.y.camera_id == 2);
+        PTK_CHECK(h.s.frame_index == 7);
+        const data::TensorPacket first_y = h.y;
+        const data::TensorPacket first_s = h.s;
+
+        std::vector<float> b = Input(4, -10.0f);
+        PTK_CHECK(h.Tick(b, {1, 4}) && Matches(h.y, h.s, b, 1));
+        PTK_CHECK(h.y.tensor.buffer().data() != first_y.tensor.buffer().data());
+        PTK_CHECK(Matches(first_y, first_s, a, 1));
+
+        std::vector<float> c = Input(4, 100.0f);
+        PTK_CHECK(h.Tick(c, {4}) && Matches(h.y, h.s, c, 1));
+        PTK_CHECK(h.y.tensor.buffer().data() == first_y.tensor.buffer().data());
+        PTK_CHECK(h.component.stats().frames == 3 && h.component.stats().failures == 0);
+    }
+
+    // Output dims named after input dims follow each frame's shape, still
+    // written in place, and change when the frame does.
+    void TestSymbolicDims()
+    {
+        FakeEngine engine;
+        engine.input_specs = {Spec("x", {-1, -1}, {"N", "W"})};
+        engine.output_specs = {Spec("y", {-1, -1}, {"N", "W"}), Spec("s", {-1}, {"N"})};
+        Harness h(&engine, 2);
+        PTK_CHECK(h.component.BindOutput("y", &h.y_out));
+        PTK_CHECK(h.component.BindOutput("s", &h.s_out));
+        PTK_CHECK(!h.component.BindOutput("z", &h.s_out));
+        if (!h.Setup())
+        {
+            return;
+        }
+
+        std::vector<float> a = Input(10, 0.5f);
+        PTK_CHECK(h.Tick(a, {2, 5}) && engine.preallocated && Matches(h.y, h.s, a, 2));
+        PTK_CHECK(h.y.tensor.shape().dims() == std::vector<std::int64_t>({2, 5}));
+        std::vector<float> b = Input(18, 3.0f);
+        PTK_CHECK(h.Tick(b, {3, 6}) && engine.preallocated && Matches(h.y, h.s, b, 3));
+        PTK_CHECK(h.s.tensor.shape().dims() == std::vector<std::int64_t>({3}));
+    }
+
+    // Specs that leave an output shape open, or no specs at all: the engine
+    // allocates and the results are copied into the component's buffers.
+    // Spec dims without names count as open too.
+    void TestUnresolvedOutputs()
+    {
+        FakeEngine named_only;
+        FakeEngine unnamed;
+        unnamed.input_specs = {Spec("x", {-1, 3}, {})};
+        unnamed.output_specs = {Spec("y", {-1, 3}, {}), Spec("s", {-1}, {})};
+        for (FakeEngine *engine : {&named_only, &unnamed})
+        {
+            Harness h(engine, 1);
+            h.component.BindOutput(0, &h.y_out);
+            h.component.BindOutput(1, &h.s_out);
+            if (!h.Setup())
+            {
+                return;
+            }
+            std::vector<float> x = Input(6, 2.0f);
+            PTK_CHECK(h.Tick(x, {2, 3}) && !engine->preallocated && Matches(h.y, h.s, x, 2));
+            PTK_CHECK(h.y.tensor.buffer().data() != engine->own_y());
+            std::vector<float> x2 = Input(9, -4.0f);
+            PTK_CHECK(h.Tick(x2, {3, 3}) && Matches(h.y, h.s, x2, 3));
+        }
+    }
+
+    // Unbound outputs are computed but leave their packets alone.
+    void TestUnboundOutput()
+    {
+        FakeEngine engine;
+        Harness h(&engine, 2);
+        h.component.BindOutput(1, &h.s_out);
+        if (!h.Setup())
+        {
+            return;
+        }
+        std::vector<float> x = Input(4, 1.0f);
+        PTK_CHECK(h.Tick(x, {1, 4}));
+        PTK_CHECK(h.y.tensor.empty());
+        PTK_CHECK(h.s.tensor.shape().num_elements() == 1);
+        PTK_CHECK(*static_cast<const float *>(h.s.tensor.buffer().data()) == 10.0f);
+    }
+
+    void TestErrors()
+    {
+        FakeEngine engine;
+        components::InferenceComponent null_engine(nullptr, components::InferenceComponentConfig());
+        PTK_CHECK(!null_engine.BindOutput("y", nullptr));
+        core::RuntimeContext context;
+        context.Init(core::RuntimeContextOptions());
+        PTK_CHECK(null_engine.Init(&context).code() == core::StatusCode::kInvalidArgument);
+        {
+            Harness h(&engine, 2);
+            PTK_CHECK(h.component.Init(nullptr).code() == core::StatusCode::kInvalidArgument);
+            PTK_CHECK(h.component.Start().code() == core::StatusCode::kFailedPrecondition);
+        }
+        {
+            Harness h(&engine, 0);
+            PTK_CHECK(h.component.Init(&h.context).code() == core::StatusCode::kInvalidArgument);
+        }
+        {
+            Harness h(&engine, 2);
+            h.component.BindOutput(2, &h.y_out);
+            PTK_CHECK(h.component.Init(&h.context).code() == core::StatusCode::kInvalidArgument);
+        }
+        {
+            components::InferenceComponent unbound(&engine, components::InferenceComponentConfig());
+            PTK_CHECK_OK(unbound.Init(&context));
+            PTK_CHECK(unbound.Start().code() == core::StatusCode::kFailedPrecondition);
+        }
+
+        // A failed run is counted and logged and publishes nothing.
+        Harness h(&engine, 2);
+        h.component.BindOutput(0, &h.y_out);
+        if (!h.Setup())
+        {
+            return;
+        }
+        const long started = std::ftell(h.log);
+        engine.fail = true;
+        std::vector<float> x = Input(4, 0.0f);
+        PTK_CHECK(!h.Tick(x, {1, 4}));
+        PTK_CHECK(h.component.stats().failures == 1 && h.component.stats().frames == 0);
+        PTK_CHECK(h.y.tensor.empty());
+        PTK_CHECK(std::ftell(h.log) > started);
+
+        engine.fail = false;
+        PTK_CHECK(h.Tick(x, {1, 4}) && h.component.stats().frames == 1);
+    }
+} // namespace
+
+int main()
+{
+    TestStaticModel();
+    TestSymbolicDims();
+    TestUnresolvedOutputs();
+    TestUnboundOutput();
+    TestErrors();
+    return ptk::test::Finish("inference_component_test");
+}
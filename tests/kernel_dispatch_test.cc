@@ -0,0 +1,113 @@
+// The Dispatch* helpers pick the instantiation matching the runtime tensor
+// description, and kernels give the same results through their specialized
+// and generic (Channels<0>) instantiations.
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "operators/dequantize.h"
+#include "operators/kernel_dispatch.h"
+#include "operators/quantize.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    void TestChannels()
+    {
+        for (std::int64_t c = 0; c <= 8; ++c)
+        {
+            const int picked = operators::DispatchChannels(c, [](auto channels) { return decltype(channels)::value; });
+            PTK_CHECK(picked == (c >= 1 && c <= 4 ? c : 0));
+            const std::int64_t count =
+                operators::DispatchChannels(c, [&](auto channels) { return operators::ChannelCount<decltype(channels)::value>(c); });
+            PTK_CHECK(count == c);
+        }
+    }
+
+    void TestDType()
+    {
+        core::DataType seen = core::DataType::kUnknown;
+        auto record = [&](auto tag) { seen = operators::DataTypeOf<typename decltype(tag)::type>::value; };
+        PTK_CHECK((operators::DispatchDType<std::uint8_t, float>(core::DataType::kFloat32, record)));
+        PTK_CHECK(seen == core::DataType::kFloat32);
+        PTK_CHECK((operators::DispatchDType<std::uint8_t, float>(core::DataType::kUint8, record)));
+        PTK_CHECK(seen == core::DataType::kUint8);
+        seen = core::DataType::kUnknown;
+        PTK_CHECK(!(operators::DispatchDType<std::uint8_t, float>(core::DataType::kInt8, record)));
+        PTK_CHECK(seen == core::DataType::kUnknown);
+    }
+
+    void TestLayout()
+    {
+        int calls = 0;
+        core::TensorLayout seen = core::TensorLayout::kUnknown;
+        auto record = [&](auto layout) {
+            ++calls;
+            seen = decltype(layout)::value;
+        };
+        PTK_CHECK((operators::DispatchLayout<core::TensorLayout::kHwc, core::TensorLayout::kChw>(core::TensorLayout::kChw,
+                                                                                                 record)));
+        PTK_CHECK(seen == core::TensorLayout::kChw);
+        PTK_CHECK(!(operators::DispatchLayout<core::TensorLayout::kHwc, core::TensorLayout::kChw>(
+            core::TensorLayout::kNhwc, record)));
+        PTK_CHECK(calls == 1);
+    }
+
+    // Innermost per-channel quantization repeats the channel pattern to 4 * C
+    // lanes; C in [1,4] runs a constant period and larger C the generic one.
+    void TestQuantizePeriods()
+    {
+        for (std::int64_t C = 1; C <= 7; ++C)
+        {
+            const std::int64_t n = 37 * C;
+            operators::QuantizationParams params;
+            for (std::int64_t c = 0; c < C; ++c)
+            {
+                params.scales.push_back(0.01f * static_cast<float>(c + 1));
+                params.zero_points.push_back(static_cast<std::int32_t>(c) - 3);
+            }
+            params.axis = 1;
+            const std::vector<std::uint8_t> bytes = test::Pattern(static_cast<std::size_t>(n), static_cast<std::uint32_t>(C));
+            std::vector<float> x(bytes.size());
+            for (std::size_t i = 0; i < x.size(); ++i)
+            {
+                x[i] = (static_cast<float>(bytes[i]) - 128.0f) * 0.02f;
+            }
+
+            std::vector<std::int8_t> q(x.size());
+            data::TensorView q_view = test::View(q, {37, C});
+            std::vector<float> back(x.size());
+            data::TensorView back_view = test::View(back, {37, C});
+            if (!PTK_CHECK_OK(operators::Quantize(test::View(x, {37, C}), params, &q_view)) ||
+                !PTK_CHECK_OK(operators::Dequantize(test::View(q, {37, C}), params, &back_view)))
+            {
+                continue;
+            }
+            int bad = 0;
+            for (std::int64_t i = 0; i < n; ++i)
+            {
+                const std::size_t c = static_cast<std::size_t>(i % C);
+                float v = std::nearbyint(x[i] / params.scales[c]) + static_cast<float>(params.zero_points[c]);
+                v = v < -128.0f ? -128.0f : v > 127.0f ? 127.0f : v;
+                bad += q[i] != static_cast<std::int8_t>(v);
+                bad += back[i] != static_cast<float>(q[i] - params.zero_points[c]) * params.scales[c];
+            }
+            if (!PTK_CHECK(bad == 0))
+            {
+                std::printf("  C=%lld\n", static_cast<long long>(C));
+            }
+        }
+    }
+} // namespace
+
+int main()
+{
+    TestChannels();
+    TestDType();
+    TestLayout();
+    TestQuantizePeriods();
+    return ptk::test::Finish("kernel_dispatch_test");
+}
@@ -0,0 +1,86 @@
+// HwcToChw and ChwToHwc against a scalar index transpose, for every channel
+// specialization and for widths that exercise the vector bodies, their tails
+// and the tiled generic path.
+
+#include <cstdint>
+#include <vector>
+
+#include "operators/chw_to_hwc.h"
+#include "operators/hwc_to_chw.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    template <typename T>
+    void TestTranspose(std::int64_t H, std::int64_t W, std::int64_t C)
+    {
+        const std::vector<std::uint8_t> bytes = test::Pattern(static_cast<std::size_t>(H * W * C),
+                                                              static_cast<std::uint32_t>(H * 131 + W * 7 + C));
+        std::vector<T> hwc(bytes.begin(), bytes.end());
+        std::vector<T> expected(hwc.size());
+        for (std::int64_t h = 0; h < H; ++h)
+        {
+            for (std::int64_t w = 0; w < W; ++w)
+            {
+                for (std::int64_t c = 0; c < C; ++c)
+                {
+                    expected[(c * H + h) * W + w] = hwc[(h * W + w) * C + c];
+                }
+            }
+        }
+
+        std::vector<T> chw(hwc.size());
+        data::TensorView chw_view = test::View(chw, {C, H, W});
+        PTK_CHECK_OK(operators::HwcToChw(test::View(hwc, {H, W, C}), &chw_view));
+        if (!PTK_CHECK(chw == expected))
+        {
+            std::printf("  HwcToChw H=%lld W=%lld C=%lld\n", static_cast<long long>(H), static_cast<long long>(W),
+                        static_cast<long long>(C));
+        }
+
+        std::vector<T> back(hwc.size());
+        data::TensorView back_view = test::View(back, {H, W, C});
+        PTK_CHECK_OK(operators::ChwToHwc(test::View(expected, {C, H, W}), &back_view));
+        if (!PTK_CHECK(back == hwc))
+        {
+            std::printf("  ChwToHwc H=%lld W=%lld C=%lld\n", static_cast<long long>(H), static_cast<long long>(W),
+                        static_cast<long long>(C));
+        }
+    }
+
+    template <typename T>
+    void TestShapes()
+    {
+        const std::int64_t sizes[][2] = {{1, 1}, {3, 15}, {2, 16}, {3, 37}, {2, 300}};
+        for (const auto &size : sizes)
+        {
+            for (std::int64_t C = 1; C <= 6; ++C)
+            {
+                TestTranspose<T>(size[0], size[1], C);
+            }
+        }
+    }
+
+    void TestInvalid()
+    {
+        std::vector<float> src(2 * 3 * 3);
+        std::vector<float> dst(src.size());
+        data::TensorView wrong = test::View(dst, {3, 3, 2});
+        PTK_CHECK(!operators::HwcToChw(test::View(src, {2, 3, 3}), &wrong).ok());
+        std::vector<std::uint8_t> bytes(src.size());
+        data::TensorView bytes_view = test::View(bytes, {3, 2, 3});
+        PTK_CHECK(!operators::HwcToChw(test::View(src, {2, 3, 3}), &bytes_view).ok());
+        data::TensorView float_view = test::View(dst, {3, 3, 2});
+        PTK_CHECK(!operators::ChwToHwc(test::View(src, {3, 2, 3}), &float_view).ok());
+    }
+} // namespace
+
+int main()
+{
+    TestShapes<std::uint8_t>();
+    TestShapes<float>();
+    TestInvalid();
+    return ptk::test::Finish("layout_test");
+}
@@ -0,0 +1,134 @@
+// Normalizer against (x - mean) / std per element, in place on float32 and
+// through the uint8 table, for every layout and channel count, on frames
+// small enough for the calling thread and large enough to run in parallel.
+
+#include <cstdint>
+#include <vector>
+
+#include "operators/normalize.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    operators::NormalizationParams Params(int channels)
+    {
+        operators::NormalizationParams params{};
+        const float mean[4] = {123.675f, 116.28f, 103.53f, 127.5f};
+        const float std[4] = {58.395f, 57.12f, 57.375f, 0.5f};
+        for (int c = 0; c < 4; ++c)
+        {
+            params.mean[c] = mean[c];
+            params.std[c] = std[c];
+        }
+        params.num_channels = channels;
+        return params;
+    }
+
+    // Channel of element i in a tensor of layout with C channels and H x W planes.
+    std::int64_t ChannelOf(std::int64_t i, core::TensorLayout layout, std::int64_t C, std::int64_t H, std::int64_t W)
+    {
+        const bool interleaved = layout == core::TensorLayout::kHwc || layout == core::TensorLayout::kNhwc;
+        return interleaved ? i % C : (i / (H * W)) % C;
+    }
+
+    std::vector<std::int64_t> Dims(core::TensorLayout layout, std::int64_t N, std::int64_t C, std::int64_t H,
+                                   std::int64_t W)
+    {
+        switch (layout)
+        {
+        case core::TensorLayout::kHwc:
+            return {H, W, C};
+        case core::TensorLayout::kChw:
+            return {C, H, W};
+        case core::TensorLayout::kNhwc:
+            return {N, H, W, C};
+        default:
+            return {N, C, H, W};
+        }
+    }
+
+    void TestLayout(core::TensorLayout layout, std::int64_t C, std::int64_t H, std::int64_t W)
+    {
+        const bool batched = layout == core::TensorLayout::kNhwc || layout == core::TensorLayout::kNchw;
+        const std::int64_t N = batched ? 2 : 1;
+        const std::vector<std::int64_t> dims = Dims(layout, N, C, H, W);
+        const operators::NormalizationParams params = Params(static_cast<int>(C));
+
+        std::vector<std::uint8_t> pixels = test::Pattern(static_cast<std::size_t>(N * C * H * W),
+                                                         static_cast<std::uint32_t>(C * 1000 + H));
+        std::vector<float> expected(pixels.size());
+        for (std::size_t i = 0; i < pixels.size(); ++i)
+        {
+            const std::int64_t c = ChannelOf(static_cast<std::int64_t>(i), layout, C, H, W);
+            expected[i] = (static_cast<float>(pixels[i]) - params.mean[c]) / params.std[c];
+        }
+
+        operators::Normalizer normalizer;
+        if (!PTK_CHECK_OK(normalizer.Init(params)))
+        {
+            return;
+        }
+
+        // In place: the reciprocal scale is within a few ulps of the division.
+        std::vector<float> tensor(pixels.begin(), pixels.end());
+        data::TensorView view = test::View(tensor, dims);
+        PTK_CHECK_OK(normalizer.Apply(&view, layout));
+        int bad = 0;
+        for (std::size_t i = 0; i < tensor.size(); ++i)
+        {
+            bad += std::fabs(tensor[i] - expected[i]) > 1e-5f * (1.0f + std::fabs(expected[i]));
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  in place, layout %d C=%lld H=%lld W=%lld\n", static_cast<int>(layout),
+                        static_cast<long long>(C), static_cast<long long>(H), static_cast<long long>(W));
+        }
+
+        // The uint8 table is built with the division, so it is exact.
+        std::vector<float> looked_up(pixels.size());
+        data::TensorView dst = test::View(looked_up, dims);
+        PTK_CHECK_OK(normalizer.Apply(test::View(pixels, dims), &dst, layout));
+        if (!PTK_CHECK(looked_up == expected))
+        {
+            std::printf("  table, layout %d C=%lld H=%lld W=%lld\n", static_cast<int>(layout),
+                        static_cast<long long>(C), static_cast<long long>(H), static_cast<long long>(W));
+        }
+    }
+
+    void TestInvalid()
+    {
+        operators::NormalizationParams params = Params(3);
+        operators::Normalizer normalizer;
+        std::vector<float> tensor(4 * 4 * 3);
+        data::TensorView view = test::View(tensor, {4, 4, 3});
+        PTK_CHECK(!normalizer.Apply(&view, core::TensorLayout::kHwc).ok());
+
+        params.std[1] = 0.0f;
+        PTK_CHECK(!normalizer.Init(params).ok());
+        params = Params(5);
+        PTK_CHECK(!normalizer.Init(params).ok());
+
+        PTK_CHECK_OK(normalizer.Init(Params(3)));
+        PTK_CHECK(!normalizer.Apply(&view, core::TensorLayout::kChw).ok());
+        PTK_CHECK(!normalizer.Apply(&view, core::TensorLayout::kNhwc).ok());
+    }
+} // namespace
+
+int main()
+{
+    using ptk::core::TensorLayout;
+    const TensorLayout layouts[] = {TensorLayout::kHwc, TensorLayout::kChw, TensorLayout::kNhwc,
+                                    TensorLayout::kNchw};
+    for (TensorLayout layout : layouts)
+    {
+        for (std::int64_t C = 1; C <= 4; ++C)
+        {
+            TestLayout(layout, C, 3, 13);
+            TestLayout(layout, C, 120, 97);
+        }
+    }
+    TestInvalid();
+    return ptk::test::Finish("normalize_test");
+}
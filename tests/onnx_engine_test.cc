@@ -0,0 +1,558 @@
+// OnnxEngine on small generated models (tests/onnx_model.h): results through
+// engine-owned and caller-preallocated outputs, output pointers that stay put
+// across steady-state runs, outputs with symbolic dims relearned when the
+// input shapes change, inputs rebound only when their buffer or shape
+// changed, the same results under every thread setting and auto-tuning,
+// InferAsync with several runs in flight, the optimized-model cache and
+// warmup, and calls Infer rejects. Built only when ONNX Runtime is found.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "engines/onnx_engine.h"
+#include "onnx_model.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    // A generated model file, removed again at exit.
+    struct ModelFile
+    {
+        std::string path;
+
+        ModelFile(const std::string &name, const test::OnnxModel &model)
+            : path((std::filesystem::temp_directory_path() / ("ptk_onnx_engine_test_" + name + ".onnx")).string())
+        {
+            PTK_CHECK(test::WriteModel(model, path));
+        }
+
+        ~ModelFile()
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+    };
+
+    // Inputs x and b of AddNegModel for n rows, filled from seed.
+    struct Inputs
+    {
+        std::vector<float> x;
+        std::vector<float> b;
+        std::int64_t n;
+
+        Inputs(std::int64_t rows, std::uint32_t seed) : n(rows) { Fill(seed); }
+
+        void Fill(std::uint32_t seed)
+        {
+            const std::vector<std::uint8_t> bytes = test::Pattern(static_cast<std::size_t>(n * 8), seed);
+            x.assign(bytes.begin(), bytes.begin() + n * 4);
+            b.assign(bytes.begin() + n * 4, bytes.end());
+            for (float &v : b)
+            {
+                v -= 128.0f;
+            }
+        }
+
+        std::vector<data::TensorView> Views() { return {test::View(x, {n, 4}), test::View(b, {n, 4})}; }
+    };
+
+    // outputs against sum = x + b and neg = -x.
+    bool Matches(const std::vector<data::TensorView> &outputs, const Inputs &in)
+    {
+        if (!PTK_CHECK(outputs.size() == 2))
+        {
+            return false;
+        }
+        for (const data::TensorView &out : outputs)
+        {
+            if (!PTK_CHECK(out.dtype() == core::DataType::kFloat32) ||
+                !PTK_CHECK(out.shape().dims() == std::vector<std::int64_t>({in.n, 4})))
+            {
+                return false;
+            }
+        }
+        const float *sum = static_cast<const float *>(outputs[0].buffer().data());
+        const float *neg = static_cast<const float *>(outputs[1].buffer().data());
+        int bad = 0;
+        for (std::size_t i = 0; i < in.x.size(); ++i)
+        {
+            bad += sum[i] != in.x[i] + in.b[i];
+            bad += neg[i] != -in.x[i];
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  n=%lld: %d values differ\n", static_cast<long long>(in.n), bad);
+            return false;
+        }
+        return true;
+    }
+
+    // Static shapes: outputs are preallocated at Load, written in place and
+    // handed back at the same addresses on every run.
+    void TestEngineOutputs()
+    {
+        const ModelFile model("static", test::AddNegModel({2, 4}));
+        perception::OnnxEngine engine{perception::EngineConfig()};
+        if (!PTK_CHECK(engine.Load(model.path)))
+        {
+            return;
+        }
+        const std::vector<data::TensorSpec> inputs = engine.InputSpecs();
+        const std::vector<data::TensorSpec> outputs = engine.OutputSpecs();
+        PTK_CHECK(engine.InputNames() == std::vector<std::string>({"x", "b"}));
+        PTK_CHECK(engine.OutputNames() == std::vector<std::string>({"sum", "neg"}));
+        PTK_CHECK(inputs.size() == 2 && inputs[0].dtype == core::DataType::kFloat32 && inputs[0].is_static() &&
+                  inputs[0].dims == std::vector<std::int64_t>({2, 4}));
+        PTK_CHECK(outputs.size() == 2 && outputs[1].name == "neg" &&
+                  outputs[1].dims == std::vector<std::int64_t>({2, 4}));
+
+        Inputs in(2, 1);
+        std::vector<data::TensorView> results;
+        if (!PTK_CHECK(engine.Infer(in.Views(), results)) || !Matches(results, in))
+        {
+            return;
+        }
+        const void *sum = results[0].buffer().data();
+        const void *neg = results[1].buffer().data();
+        for (std::uint32_t seed = 2; seed < 5; ++seed)
+        {
+            in.Fill(seed);
+            if (!PTK_CHECK(engine.Infer(in.Views(), results)) || !Matches(results, in))
+            {
+                return;
+            }
+            PTK_CHECK(results[0].buffer().data() == sum && results[1].buffer().data() == neg);
+        }
+    }
+
+    // Caller buffers are bound as given; the engine's own ones come back
+    // once the caller stops passing them.
+    void TestPreallocatedOutputs()
+    {
+        const ModelFile model("preallocated", test::AddNegModel({2, 4}));
+        perception::OnnxEngine engine{perception::EngineConfig()};
+        if (!PTK_CHECK(engine.Load(model.path)))
+        {
+            return;
+        }
+        Inputs in(2, 7);
+        std::vector<float> sum(8, -1.0f);
+        std::vector<float> neg(8, -1.0f);
+        for (std::uint32_t seed = 7; seed < 10; ++seed)
+        {
+            in.Fill(seed);
+            std::vector<data::TensorView> results = {test::View(sum, {2, 4}), test::View(neg, {2, 4})};
+            if (!PTK_CHECK(engine.Infer(in.Views(), results)) || !Matches(results, in))
+            {
+                return;
+            }
+            PTK_CHECK(results[0].buffer().data() == sum.data() && results[1].buffer().data() == neg.data());
+        }
+
+        std::vector<data::TensorView> results;
+        if (PTK_CHECK(engine.Infer(in.Views(), results)) && Matches(results, in))
+        {
+            PTK_CHECK(results[0].buffer().data() != sum.data());
+        }
+    }
+
+    // Symbolic batch: each new input shape relearns the output shape, and
+    // repeated runs at one shape settle on stable preallocated outputs.
+    void TestDynamicShapes()
+    {
+        const ModelFile model("dynamic", test::AddNegModel({-1, 4}));
+        perception::OnnxEngine engine{perception::EngineConfig()};
+        if (!PTK_CHECK(engine.Load(model.path)))
+        {
+            return;
+        }
+        const std::vector<data::TensorSpec> inputs = engine.InputSpecs();
+        PTK_CHECK(inputs.size() == 2 && !inputs[0].is_static() && inputs[0].dims[0] < 0 &&
+                  inputs[0].dim_names[0] == "N");
+
+        for (std::int64_t n : {2, 3, 1, 3})
+        {
+            Inputs in(n, static_cast<std::uint32_t>(n));
+            std::vector<data::TensorView> results;
+            const void *settled = nullptr;
+            for (int run = 0; run < 4; ++run)
+            {
+                in.Fill(static_cast<std::uint32_t>(n * 10 + run));
+                if (!PTK_CHECK(engine.Infer(in.Views(), results)) || !Matches(results, in))
+                {
+                    return;
+                }
+                if (run == 2)
+                {
+                    settled = results[0].buffer().data();
+                }
+                else if (run == 3)
+                {
+                    PTK_CHECK(results[0].buffer().data() == settled);
+                }
+            }
+        }
+    }
+
+    // Inputs stay bound between runs: new contents in the same buffers must
+    // be seen without rebinding, and a new buffer or shape for either input
+    // must rebind it.
+    void TestInputRebinding()
+    {
+        const ModelFile model("rebinding", test::AddNegModel({-1, 4}));
+        perception::OnnxEngine engine{perception::EngineConfig()};
+        if (!PTK_CHECK(engine.Load(model.path)))
+        {
+            return;
+        }
+        Inputs first(3, 21);
+        Inputs second(3, 22);
+        std::vector<data::TensorView> results;
+        const int order[][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}, {0, 0}, {0, 0}};
+        for (std::uint32_t step = 0; step < 6; ++step)
+        {
+            // New contents at the same addresses every step; x and b from
+            // either set, so one input moves while the other stays.
+            first.Fill(100 + step);
+            second.Fill(200 + step);
+            Inputs &xs = order[step][0] ? second : first;
+            Inputs &bs = order[step][1] ? second : first;
+            Inputs expected(3, 0);
+            expected.x = xs.x;
+            expected.b = bs.b;
+            if (!PTK_CHECK(engine.Infer({test::View(xs.x, {3, 4}), test::View(bs.b, {3, 4})}, results)) ||
+                !Matches(results, expected))
+            {
+                std::printf("  step %u\n", step);
+                return;
+            }
+        }
+
+        // The same buffers viewed with fewer rows: same pointers, new shapes.
+        for (std::int64_t n : {2, 3, 1})
+        {
+            Inputs expected(n, 0);
+            expected.x.assign(first.x.begin(), first.x.begin() + n * 4);
+            expected.b.assign(first.b.begin(), first.b.begin() + n * 4);
+            if (!PTK_CHECK(engine.Infer({test::View(first.x, {n, 4}), test::View(first.b, {n, 4})}, results)) ||
+                !Matches(results, expected))
+            {
+                return;
+            }
+        }
+    }
+
+    // Results must not depend on how the session is threaded, and the engine
+    // reports the settings it runs with.
+    void TestThreading()
+    {
+        const ModelFile model("threading", test::AddNegModel({-1, 4}));
+        std::vector<perception::ThreadingConfig> settings(4);
+        settings[0].intra_op_threads = 2;
+        settings[1].intra_op_threads = 2;
+        settings[1].inter_op_threads = 2;
+        settings[1].execution_mode = perception::GraphExecutionMode::Parallel;
+        settings[2].intra_op_threads = 0;
+        settings[3].intra_op_threads = 3;
+        settings[3].allow_spinning = false;
+        for (const perception::ThreadingConfig &threading : settings)
+        {
+            perception::EngineConfig config;
+            config.threading = threading;
+            perception::OnnxEngine engine(config);
+            if (!PTK_CHECK(engine.Load(model.path)))
+            {
+                continue;
+            }
+            PTK_CHECK(engine.threading().intra_op_threads == threading.intra_op_threads &&
+                      engine.threading().inter_op_threads == threading.inter_op_threads &&
+                      engine.threading().execution_mode == threading.execution_mode);
+            for (std::int64_t n : {5, 2})
+            {
+                Inputs in(n, static_cast<std::uint32_t>(threading.intra_op_threads * 10 + n));
+                std::vector<data::TensorView> results;
+                if (!PTK_CHECK(engine.Infer(in.Views(), results)) || !Matches(results, in))
+                {
+                    std::printf("  intra=%d inter=%d\n", threading.intra_op_threads, threading.inter_op_threads);
+                }
+            }
+        }
+    }
+
+    // Auto-tuning keeps one of its candidates (the configured settings, 1, 2
+    // or 4 sequential threads, or 2 x 2 parallel) for either objective, and
+    // the winning session serves inputs of any batch.
+    void TestAutoTune()
+    {
+        const ModelFile model("autotune", test::AddNegModel({-1, 4}));
+        for (perception::TuneObjective objective :
+             {perception::TuneObjective::Latency, perception::TuneObjective::Throughput})
+        {
+            perception::EngineConfig config;
+            config.threading.auto_tune = true;
+            config.threading.tune_objective = objective;
+            config.threading.tune_iterations = 3;
+            config.threading.tune_cores = 4;
+            config.warmup_input_shapes = {{8, 4}, {8, 4}};
+            perception::OnnxEngine engine(config);
+            if (!PTK_CHECK(engine.Load(model.path)))
+            {
+                continue;
+            }
+            const perception::ThreadingConfig &tuned = engine.threading();
+            const bool sequential = tuned.execution_mode == perception::GraphExecutionMode::Sequential &&
+                                    tuned.inter_op_threads == 1 &&
+                                    (tuned.intra_op_threads == 1 || tuned.intra_op_threads == 2 ||
+                                     tuned.intra_op_threads == 4);
+            const bool parallel = tuned.execution_mode == perception::GraphExecutionMode::Parallel &&
+                                  tuned.intra_op_threads == 2 && tuned.inter_op_threads == 2;
+            if (!PTK_CHECK(sequential || parallel))
+            {
+                std::printf("  tuned intra=%d inter=%d\n", tuned.intra_op_threads, tuned.inter_op_threads);
+            }
+            for (std::int64_t n : {8, 3})
+            {
+                Inputs in(n, static_cast<std::uint32_t>(n + 40));
+                std::vector<data::TensorView> results;
+                PTK_CHECK(engine.Infer(in.Views(), results) && Matches(results, in));
+            }
+        }
+
+        // A tuning shape list that does not match the inputs fails Load.
+        perception::EngineConfig config;
+        config.threading.auto_tune = true;
+        config.warmup_input_shapes = {{8, 4}};
+        perception::OnnxEngine engine(config);
+        PTK_CHECK(!engine.Load(model.path));
+    }
+
+    // RunAsync with intra-op workers: several runs in flight from one
+    // thread, callbacks with ORT-allocated or preallocated outputs, and a
+    // destructor that waits for the runs still going.
+    void TestInferAsync()
+    {
+        const ModelFile model("async", test::AddNegModel({-1, 4}));
+        perception::EngineConfig config;
+        config.threading.intra_op_threads = 2;
+        auto engine = std::make_unique<perception::OnnxEngine>(config);
+        if (!PTK_CHECK(engine->Load(model.path)))
+        {
+            return;
+        }
+
+        constexpr int kRuns = 8;
+        std::vector<std::unique_ptr<Inputs>> inputs;
+        std::mutex mu;
+        int done = 0;
+        int bad = 0;
+        for (int i = 0; i < kRuns; ++i)
+        {
+            inputs.push_back(std::make_unique<Inputs>(1 + i % 3, static_cast<std::uint32_t>(60 + i)));
+            const Inputs *in = inputs.back().get();
+            PTK_CHECK(engine->InferAsync(inputs.back()->Views(), {},
+                                         [&, in](bool ok, const std::vector<data::TensorView> &outputs)
+                                         {
+                                             // Outputs are only valid inside the callback.
+                                             const bool good = ok && Matches(outputs, *in);
+                                             std::lock_guard<std::mutex> lock(mu);
+                                             bad += !good;
+                                             ++done;
+                                         }));
+        }
+
+        // Futures with preallocated outputs, waited on after all started.
+        std::vector<std::unique_ptr<Inputs>> batch;
+        std::vector<std::vector<float>> sums(4, std::vector<float>(8));
+        std::vector<std::vector<float>> negs(4, std::vector<float>(8));
+        std::vector<std::future<bool>> futures;
+        for (int i = 0; i < 4; ++i)
+        {
+            batch.push_back(std::make_unique<Inputs>(2, static_cast<std::uint32_t>(80 + i)));
+            futures.push_back(engine->InferAsync(batch.back()->Views(),
+                                                 {test::View(sums[i], {2, 4}), test::View(negs[i], {2, 4})}));
+        }
+        for (int i = 0; i < 4; ++i)
+        {
+            PTK_CHECK(futures[i].get());
+            PTK_CHECK(Matches({test::View(sums[i], {2, 4}), test::View(negs[i], {2, 4})}, *batch[i]));
+        }
+
+        // Destroying the engine waits for the callbacks still to come.
+        engine.reset();
+        PTK_CHECK(done == kRuns);
+        PTK_CHECK(bad == 0);
+    }
+
+    // With a single intra-op thread InferAsync runs Infer before returning.
+    void TestInferAsyncSynchronous()
+    {
+        const ModelFile model("async_sync", test::AddNegModel({2, 4}));
+        perception::OnnxEngine engine{perception::EngineConfig()};
+        if (!PTK_CHECK(engine.Load(model.path)))
+        {
+            return;
+        }
+        Inputs in(2, 90);
+        bool called = false;
+        PTK_CHECK(engine.InferAsync(in.Views(), {}, [&](bool ok, const std::vector<data::TensorView> &outputs)
+                                    { called = ok && Matches(outputs, in); }));
+        PTK_CHECK(called);
+
+        perception::OnnxEngine unloaded{perception::EngineConfig()};
+        PTK_CHECK(!unloaded.InferAsync(in.Views(), {}, [](bool, const std::vector<data::TensorView> &) {}));
+    }
+
+    // Files in the cache directory with the given extension.
+    int CountFiles(const std::string &dir, const std::string &extension)
+    {
+        int n = 0;
+        std::error_code ec;
+        for (const auto &entry : std::filesystem::directory_iterator(dir, ec))
+        {
+            n += entry.path().extension() == extension;
+        }
+        return n;
+    }
+
+    bool LoadAndRun(const perception::EngineConfig &config, const std::string &path, std::int64_t n)
+    {
+        perception::OnnxEngine engine(config);
+        if (!PTK_CHECK(engine.Load(path)))
+        {
+            return false;
+        }
+        Inputs in(n, static_cast<std::uint32_t>(n + 70));
+        std::vector<data::TensorView> results;
+        return PTK_CHECK(engine.Infer(in.Views(), results)) && Matches(results, in);
+    }
+
+    // The first Load writes one optimized entry and the model's content
+    // hash; loads of the unchanged model reuse both. A changed model gets a
+    // new entry, a touched but identical one keeps its entry, and a corrupt
+    // entry is discarded and rebuilt.
+    void TestModelCache()
+    {
+        namespace fs = std::filesystem;
+        const std::string dir = (fs::temp_directory_path() / "ptk_onnx_engine_test_cache").string();
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+        perception::EngineConfig config;
+        config.onnx_optimized_model_cache_dir = dir;
+
+        ModelFile model("cached", test::AddNegModel({-1, 4}));
+        if (!LoadAndRun(config, model.path, 3))
+        {
+            return;
+        }
+        PTK_CHECK(CountFiles(dir, ".onnx") == 1 && CountFiles(dir, ".hash") == 1);
+        LoadAndRun(config, model.path, 2);
+        PTK_CHECK(CountFiles(dir, ".onnx") == 1 && CountFiles(dir, ".hash") == 1);
+
+        // Same content, newer time: rehashed to the same entry.
+        fs::last_write_time(model.path, fs::last_write_time(model.path) + std::chrono::seconds(5), ec);
+        LoadAndRun(config, model.path, 2);
+        PTK_CHECK(CountFiles(dir, ".onnx") == 1);
+
+        // New content at the same path.
+        PTK_CHECK(test::WriteModel(test::AddNegModel({4, 4}), model.path));
+        fs::last_write_time(model.path, fs::last_write_time(model.path) + std::chrono::seconds(10), ec);
+        perception::OnnxEngine changed(config);
+        if (PTK_CHECK(changed.Load(model.path)))
+        {
+            PTK_CHECK(changed.InputSpecs()[0].dims == std::vector<std::int64_t>({4, 4}));
+        }
+        PTK_CHECK(CountFiles(dir, ".onnx") == 2 && CountFiles(dir, ".hash") == 1);
+
+        for (const auto &entry : fs::directory_iterator(dir, ec))
+        {
+            if (entry.path().extension() == ".onnx")
+            {
+                std::ofstream(entry.path(), std::ios::binary | std::ios::trunc) << "not a model";
+            }
+        }
+        LoadAndRun(config, model.path, 4);
+        PTK_CHECK(CountFiles(dir, ".onnx") >= 1);
+        LoadAndRun(config, model.path, 4);
+        fs::remove_all(dir, ec);
+    }
+
+    // Warmup runs at the configured shapes, so the first real Infer at them
+    // already gets the preallocated outputs.
+    void TestWarmup()
+    {
+        const ModelFile model("warmup", test::AddNegModel({-1, 4}));
+        perception::EngineConfig config;
+        config.warmup_runs = 2;
+        config.warmup_input_shapes = {{3, 4}, {3, 4}};
+        perception::OnnxEngine engine(config);
+        if (!PTK_CHECK(engine.Load(model.path)))
+        {
+            return;
+        }
+        Inputs in(3, 95);
+        std::vector<data::TensorView> first;
+        std::vector<data::TensorView> second;
+        if (PTK_CHECK(engine.Infer(in.Views(), first)) && Matches(first, in))
+        {
+            in.Fill(96);
+            PTK_CHECK(engine.Infer(in.Views(), second) && Matches(second, in));
+            PTK_CHECK(first[0].buffer().data() == second[0].buffer().data());
+        }
+
+        config.warmup_input_shapes = {{3, 4}};
+        perception::OnnxEngine mismatched(config);
+        PTK_CHECK(!mismatched.Load(model.path));
+    }
+
+    void TestInvalid()
+    {
+        perception::OnnxEngine unloaded{perception::EngineConfig()};
+        Inputs in(2, 3);
+        std::vector<data::TensorView> results;
+        PTK_CHECK(!unloaded.Infer(in.Views(), results));
+        PTK_CHECK(!unloaded.Load((std::filesystem::temp_directory_path() / "ptk_no_such_model.onnx").string()));
+
+        const ModelFile model("invalid", test::AddNegModel({2, 4}));
+        perception::OnnxEngine engine{perception::EngineConfig()};
+        if (!PTK_CHECK(engine.Load(model.path)))
+        {
+            return;
+        }
+        PTK_CHECK(!engine.Infer({test::View(in.x, {2, 4})}, results));
+
+        // Every other column of a 2 x 8 buffer.
+        std::vector<float> wide(16);
+        const data::TensorView strided(data::BufferView(wide.data(), wide.size() * sizeof(float), core::DeviceType::kCpu),
+                                       core::DataType::kFloat32, data::TensorShape({2, 4}), {8, 2});
+        PTK_CHECK(!engine.Infer({strided, test::View(in.b, {2, 4})}, results));
+
+        // A failed call leaves the engine usable.
+        PTK_CHECK(engine.Infer(in.Views(), results) && Matches(results, in));
+    }
+} // namespace
+
+int main()
+{
+    TestEngineOutputs();
+    TestPreallocatedOutputs();
+    TestDynamicShapes();
+    TestInputRebinding();
+    TestThreading();
+    TestAutoTune();
+    TestInferAsync();
+    TestInferAsyncSynchronous();
+    TestModelCache();
+    TestWarmup();
+    TestInvalid();
+    return ptk::test::Finish("onnx_engine_test");
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Small float32 ONNX models for the engine tests, encoded straight to the
+// ModelProto wire format so the tests need neither model files nor the onnx
+// package. Only the fields ONNX Runtime requires are written (IR version 8,
+// default opset 13).
+namespace ptk::test
+{
+    struct OnnxValue
+    {
+        std::string name;
+        // Fixed dims; -1 is the symbolic dim "N".
+        std::vector<std::int64_t> dims;
+    };
+
+    struct OnnxNode
+    {
+        std::string op_type;
+        std::vector<std::string> inputs;
+        std::vector<std::string> outputs;
+    };
+
+    struct OnnxModel
+    {
+        std::vector<OnnxValue> inputs;
+        std::vector<OnnxValue> outputs;
+        std::vector<OnnxNode> nodes;
+    };
+
+    namespace onnx_wire
+    {
+        inline void Varint(std::string *out, std::uint64_t v)
+        {
+            while (v >= 0x80)
+            {
+                out->push_back(static_cast<char>((v & 0x7f) | 0x80));
+                v >>= 7;
+            }
+            out->push_back(static_cast<char>(v));
+        }
+
+        inline void Int(std::string *out, int field, std::int64_t v)
+        {
+            Varint(out, static_cast<std::uint64_t>(field) << 3);
+            Varint(out, static_cast<std::uint64_t>(v));
+        }
+
+        inline void Bytes(std::string *out, int field, const std::string &bytes)
+        {
+            Varint(out, (static_cast<std::uint64_t>(field) << 3) | 2);
+            Varint(out, bytes.size());
+            out->append(bytes);
+        }
+
+        // ValueInfoProto of a float tensor.
+        inline std::string Value(const OnnxValue &value)
+        {
+            std::string shape;
+            for (std::int64_t d : value.dims)
+            {
+                std::string dim;
+                if (d < 0)
+                {
+                    Bytes(&dim, 2, "N"); // dim_param
+                }
+                else
+                {
+                    Int(&dim, 1, d); // dim_value
+                }
+                Bytes(&shape, 1, dim);
+            }
+            std::string tensor;
+            Int(&tensor, 1, 1); // elem_type FLOAT
+            Bytes(&tensor, 2, shape);
+            std::string type;
+            Bytes(&type, 1, tensor); // tensor_type
+            std::string info;
+            Bytes(&info, 1, value.name);
+            Bytes(&info, 2, type);
+            return info;
+        }
+    } // namespace onnx_wire
+
+    inline std::string EncodeModel(const OnnxModel &model)
+    {
+        using namespace onnx_wire;
+        std::string graph;
+        for (const OnnxNode &node : model.nodes)
+        {
+            std::string n;
+            for (const std::string &input : node.inputs)
+            {
+                Bytes(&n, 1, input);
+            }
+            for (const std::string &output : node.outputs)
+            {
+                Bytes(&n, 2, output);
+            }
+            Bytes(&n, 4, node.op_type);
+            Bytes(&graph, 1, n);
+        }
+        Bytes(&graph, 2, "test");
+        for (const OnnxValue &input : model.inputs)
+        {
+            Bytes(&graph, 11, Value(input));
+        }
+        for (const OnnxValue &output : model.outputs)
+        {
+            Bytes(&graph, 12, Value(output));
+        }
+
+        std::string opset;
+        Bytes(&opset, 1, ""); // default domain
+        Int(&opset, 2, 13);
+        std::string out;
+        Int(&out, 1, 8); // ir_version
+        Bytes(&out, 7, graph);
+        Bytes(&out, 8, opset);
+        return out;
+    }
+
+    inline bool WriteModel(const OnnxModel &model, const std::string &path)
+    {
+        const std::string bytes = EncodeModel(model);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(file);
+    }
+
+    // Two inputs x and b of shape dims, two outputs: sum = x + b and
+    // neg = -x, on independent branches so a parallel executor can split
+    // them.
+    inline OnnxModel AddNegModel(const std::vector<std::int64_t> &dims)
+    {
+        OnnxModel model;
+        model.inputs = {{"x", dims}, {"b", dims}};
+        model.outputs = {{"sum", dims}, {"neg", dims}};
+        model.nodes = {{"Add", {"x", "b"}, {"sum"}}, {"Neg", {"x"}, {"neg"}}};
+        return model;
+    }
+} // namespace ptk::test
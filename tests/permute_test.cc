@@ -0,0 +1,167 @@
+// PermuteChannels against a per-pixel reference for every order of 1 to 4
+// output channels over 1 to 4 source channels, uint8 and float32, into a
+// separate buffer and in place; plus the RGBA/BGRA/BGR wrappers and the
+// aliasing rules.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "operators/bgr_to_rgb.h"
+#include "operators/permute_channels.h"
+#include "operators/rgb_to_bgr.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    template <typename T>
+    std::vector<T> Reference(const std::vector<T> &src, std::int64_t in_channels, const std::vector<int> &order)
+    {
+        const std::size_t pixels = src.size() / static_cast<std::size_t>(in_channels);
+        std::vector<T> out;
+        for (std::size_t p = 0; p < pixels; ++p)
+        {
+            for (int c : order)
+            {
+                out.push_back(src[p * static_cast<std::size_t>(in_channels) + static_cast<std::size_t>(c)]);
+            }
+        }
+        return out;
+    }
+
+    // Every order of out_channels entries drawn from [0, in_channels).
+    std::vector<std::vector<int>> Orders(int in_channels, int out_channels)
+    {
+        std::vector<std::vector<int>> orders(1);
+        for (int c = 0; c < out_channels; ++c)
+        {
+            std::vector<std::vector<int>> next;
+            for (const std::vector<int> &order : orders)
+            {
+                for (int i = 0; i < in_channels; ++i)
+                {
+                    next.push_back(order);
+                    next.back().push_back(i);
+                }
+            }
+            orders.swap(next);
+        }
+        return orders;
+    }
+
+    template <typename T>
+    void TestOrders(std::int64_t H, std::int64_t W)
+    {
+        int bad = 0;
+        for (int in_channels = 1; in_channels <= 4; ++in_channels)
+        {
+            const std::vector<std::uint8_t> bytes = test::Pattern(static_cast<std::size_t>(H * W * in_channels),
+                                                                  static_cast<std::uint32_t>(W + in_channels));
+            const std::vector<T> src(bytes.begin(), bytes.end());
+            for (int out_channels = 1; out_channels <= 4; ++out_channels)
+            {
+                // Large frames only need to show the row split, so they keep
+                // the channel count.
+                if (H * W > 10000 && out_channels != in_channels)
+                {
+                    continue;
+                }
+                for (const std::vector<int> &order : Orders(in_channels, out_channels))
+                {
+                    const std::vector<T> want = Reference(src, in_channels, order);
+                    std::vector<T> in = src;
+                    std::vector<T> out(want.size());
+                    data::TensorView dst = test::View(out, {H, W, out_channels});
+                    if (!PTK_CHECK_OK(operators::PermuteChannels(test::View(in, {H, W, in_channels}), order, &dst)))
+                    {
+                        return;
+                    }
+                    bad += out != want;
+
+                    // In place when the pixel does not grow.
+                    if (out_channels <= in_channels)
+                    {
+                        data::TensorView same = test::View(in, {H, W, out_channels});
+                        if (!PTK_CHECK_OK(operators::PermuteChannels(test::View(in, {H, W, in_channels}), order, &same)))
+                        {
+                            return;
+                        }
+                        bad += !std::equal(want.begin(), want.end(), in.begin());
+                    }
+                }
+            }
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  %s H=%lld W=%lld: %d orders differ\n", sizeof(T) == 1 ? "uint8" : "float32",
+                        static_cast<long long>(H), static_cast<long long>(W), bad);
+        }
+    }
+
+    void TestWrappers()
+    {
+        const std::int64_t H = 64;
+        const std::int64_t W = 600;
+        const std::vector<std::uint8_t> rgba = test::Pattern(static_cast<std::size_t>(H * W * 4), 7);
+        std::vector<std::uint8_t> in = rgba;
+        std::vector<std::uint8_t> rgb(static_cast<std::size_t>(H * W * 3));
+        data::TensorView dst = test::View(rgb, {H, W, 3});
+        PTK_CHECK_OK(operators::RgbaToRgb(test::View(in, {H, W, 4}), &dst));
+        PTK_CHECK(rgb == Reference(rgba, 4, {0, 1, 2}));
+        PTK_CHECK_OK(operators::BgraToRgb(test::View(in, {H, W, 4}), &dst));
+        PTK_CHECK(rgb == Reference(rgba, 4, {2, 1, 0}));
+
+        // RgbToBgr swaps in place and keeps alpha last.
+        data::TensorView same = test::View(in, {H, W, 4});
+        PTK_CHECK_OK(operators::RgbToBgr(same, &same));
+        PTK_CHECK(in == Reference(rgba, 4, {2, 1, 0, 3}));
+        std::vector<float> f(rgb.begin(), rgb.end());
+        std::vector<float> g(f.size());
+        data::TensorView g_view = test::View(g, {H, W, 3});
+        PTK_CHECK_OK(operators::BgrToRgb(test::View(f, {H, W, 3}), &g_view));
+        PTK_CHECK(g == Reference(f, 3, {2, 1, 0}));
+    }
+
+    void TestInvalid()
+    {
+        std::vector<std::uint8_t> buffer(4 * 4 * 4 + 4);
+        data::TensorView four = test::View(buffer, {4, 4, 4});
+        data::TensorView three = test::View(buffer, {4, 4, 3});
+        // Growing a pixel in place, and overlapping at an offset.
+        PTK_CHECK(!operators::PermuteChannels(three, {0, 1, 2, 2}, &four).ok());
+        data::TensorView shifted(data::BufferView(buffer.data() + 4, 4 * 4 * 4, core::DeviceType::kCpu),
+                                 core::DataType::kUint8, data::TensorShape({4, 4, 4}));
+        PTK_CHECK(!operators::PermuteChannels(four, {3, 2, 1, 0}, &shifted).ok());
+
+        std::vector<std::uint8_t> out(4 * 4 * 4);
+        data::TensorView dst = test::View(out, {4, 4, 2});
+        PTK_CHECK(!operators::PermuteChannels(four, {0, 4}, &dst).ok());
+        PTK_CHECK(!operators::PermuteChannels(four, {0, 1, 2}, &dst).ok());
+        data::TensorView other_rows = test::View(out, {2, 4, 2});
+        PTK_CHECK(!operators::PermuteChannels(four, {0, 1}, &other_rows).ok());
+        std::vector<float> floats(4 * 4 * 2);
+        data::TensorView float_dst = test::View(floats, {4, 4, 2});
+        PTK_CHECK(!operators::PermuteChannels(four, {0, 1}, &float_dst).ok());
+        std::vector<std::uint8_t> five(4 * 5);
+        PTK_CHECK(!operators::PermuteChannels(test::View(five, {4, 5}), {0, 1}, &dst).ok());
+    }
+} // namespace
+
+int main()
+{
+    // Widths around the 16-byte shuffle and rows spread over threads.
+    const std::int64_t sizes[][2] = {{1, 1}, {3, 5}, {2, 16}, {3, 17}, {2, 67}, {96, 701}};
+    for (const auto &size : sizes)
+    {
+        TestOrders<std::uint8_t>(size[0], size[1]);
+        if (size[0] * size[1] < 10000)
+        {
+            TestOrders<float>(size[0], size[1]);
+        }
+    }
+    TestWrappers();
+    TestInvalid();
+    return ptk::test::Finish("permute_test");
+}
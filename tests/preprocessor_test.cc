@@ -0,0 +1,574 @@
+// Preprocessor end to end on small frames: each case runs one tick and
+// compares the model tensor with the expected pixels.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "operators/demosaic.h"
+#include "operators/preprocessor.h"
+#include "operators/remap.h"
+#include "operators/rgb_to_gray.h"
+#include "operators/yuv_to_rgb.h"
+#include "runtime/core/port.h"
+#include "runtime/core/runtime_context.h"
+#include "runtime/data/half.h"
+#include "runtime/data/tensor_spec.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    // One Preprocessor tick from in to out. Errors the tick logs go to a
+    // scratch stream and fail the run.
+    bool Run(const PreprocessorConfig &config, data::Frame &in, data::Frame *out)
+    {
+        std::FILE *log = std::tmpfile();
+        core::RuntimeContextOptions options;
+        options.error_stream = log;
+        core::RuntimeContext context;
+        context.Init(options);
+
+        Preprocessor preprocessor(config);
+        core::InputPort<data::Frame> input;
+        core::OutputPort<data::Frame> output;
+        input.Bind(&in);
+        output.Bind(out);
+        preprocessor.BindInput(&input);
+        preprocessor.BindOutput(&output);
+        if (!PTK_CHECK_OK(preprocessor.Init(&context)) || !PTK_CHECK_OK(preprocessor.Start()))
+        {
+            std::fclose(log);
+            return false;
+        }
+        preprocessor.Tick();
+
+        const bool ok = std::ftell(log) == 0;
+        if (!ok)
+        {
+            char line[256];
+            std::rewind(log);
+            while (std::fgets(line, sizeof(line), log) != nullptr)
+            {
+                std::printf("  %s", line);
+            }
+        }
+        std::fclose(log);
+        return PTK_CHECK(ok);
+    }
+
+    PreprocessorConfig BaseConfig()
+    {
+        PreprocessorConfig config{};
+        config.input_layout = core::TensorLayout::kHwc;
+        config.input_format = core::PixelFormat::kRgb8;
+        config.input_type = core::DataType::kUint8;
+        config.output_layout = core::TensorLayout::kChw;
+        config.output_format = core::PixelFormat::kRgb8;
+        config.output_type = core::DataType::kFloat32;
+        for (int c = 0; c < 4; ++c)
+        {
+            config.norm.mean[c] = 10.0f * static_cast<float>(c + 1);
+            config.norm.std[c] = 2.0f * static_cast<float>(c + 1);
+        }
+        config.norm.num_channels = 3;
+        return config;
+    }
+
+    // A uint8 CHW frame center-cropped to the target: the crop is a strided
+    // view whose rows are not packed, read directly by the cast and the
+    // normalization, with and without a batch dim.
+    void TestChwCrop(bool normalize, bool batch)
+    {
+        const std::int64_t C = 3;
+        const std::int64_t H = 8;
+        const std::int64_t W = 8;
+        const int T = 4;
+        std::vector<std::uint8_t> pixels = test::Pattern(C * H * W, 3);
+        data::Frame in;
+        in.pixel_format = core::PixelFormat::kRgb8;
+        in.layout = core::TensorLayout::kChw;
+        in.image = test::View(pixels, {C, H, W});
+
+        PreprocessorConfig config = BaseConfig();
+        config.input_layout = core::TensorLayout::kChw;
+        config.output_layout = batch ? core::TensorLayout::kNchw : core::TensorLayout::kChw;
+        config.add_batch_dimension = batch;
+        config.normalize = normalize;
+        config.target_height = T;
+        config.target_width = T;
+
+        std::vector<float> tensor(C * T * T, -1000.0f);
+        data::Frame out;
+        out.image = test::View(tensor, batch ? std::vector<std::int64_t>{1, C, T, T} : std::vector<std::int64_t>{C, T, T});
+        if (!Run(config, in, &out))
+        {
+            return;
+        }
+
+        int bad = 0;
+        for (std::int64_t c = 0; c < C; ++c)
+        {
+            for (std::int64_t y = 0; y < T; ++y)
+            {
+                for (std::int64_t x = 0; x < T; ++x)
+                {
+                    float want = pixels[(c * H + y + (H - T) / 2) * W + x + (W - T) / 2];
+                    if (normalize)
+                    {
+                        want = (want - config.norm.mean[c]) / config.norm.std[c];
+                    }
+                    bad += std::fabs(tensor[(c * T + y) * T + x] - want) > 1e-4f;
+                }
+            }
+        }
+        PTK_CHECK(bad == 0);
+        PTK_CHECK_NEAR(out.to_source.m[2], (W - T) / 2, 0.0);
+        PTK_CHECK_NEAR(out.to_source.m[5], (H - T) / 2, 0.0);
+    }
+
+    // HWC uint8 to a normalized NCHW model input in a 16-bit float type,
+    // narrowed in the same pass as the layout change.
+    void TestHalfOutput(core::DataType type)
+    {
+        const std::int64_t H = 6;
+        const std::int64_t W = 21;
+        std::vector<std::uint8_t> pixels = test::Pattern(H * W * 3, 5);
+        data::Frame in;
+        in.pixel_format = core::PixelFormat::kRgb8;
+        in.layout = core::TensorLayout::kHwc;
+        in.image = test::View(pixels, {H, W, 3});
+
+        PreprocessorConfig config = BaseConfig();
+        config.output_layout = core::TensorLayout::kNchw;
+        config.output_type = type;
+        config.add_batch_dimension = true;
+        config.normalize = true;
+
+        std::vector<std::uint16_t> tensor(3 * H * W);
+        data::Frame out;
+        out.image = test::View(tensor, type, {1, 3, H, W});
+        if (!Run(config, in, &out))
+        {
+            return;
+        }
+
+        // One 16-bit rounding of the normalized value.
+        const float tolerance = type == core::DataType::kFloat16 ? 1.0f / 1024 : 1.0f / 128;
+        int bad = 0;
+        for (std::int64_t c = 0; c < 3; ++c)
+        {
+            for (std::int64_t i = 0; i < H * W; ++i)
+            {
+                const float want = (pixels[i * 3 + c] - config.norm.mean[c]) / config.norm.std[c];
+                const std::uint16_t bits = tensor[c * H * W + i];
+                const float got = type == core::DataType::kFloat16 ? data::HalfToFloat(bits)
+                                                                   : data::BFloat16ToFloat(bits);
+                bad += std::fabs(got - want) > tolerance * (1.0f + std::fabs(want));
+            }
+        }
+        PTK_CHECK(bad == 0);
+    }
+
+    // HWC uint8 to an NCHW int8 model input through the quantizer's tables,
+    // with the channel swap folded in. Without normalization the channel
+    // count comes from the frame, so norm.num_channels may be left unset.
+    void TestInt8Output(bool normalize, bool swap)
+    {
+        const std::int64_t H = 5;
+        const std::int64_t W = 17;
+        std::vector<std::uint8_t> pixels = test::Pattern(H * W * 3, 9);
+        data::Frame in;
+        in.pixel_format = core::PixelFormat::kRgb8;
+        in.layout = core::TensorLayout::kHwc;
+        in.image = test::View(pixels, {H, W, 3});
+
+        PreprocessorConfig config = BaseConfig();
+        config.output_layout = core::TensorLayout::kNchw;
+        config.output_type = core::DataType::kInt8;
+        config.add_batch_dimension = true;
+        config.normalize = normalize;
+        config.convert_rgb_to_bgr = swap;
+        if (!normalize)
+        {
+            config.norm.num_channels = 0;
+        }
+        config.quant.scales = {normalize ? 0.05f : 1.0f};
+        config.quant.zero_points = {normalize ? 0 : -128};
+
+        std::vector<std::int8_t> tensor(3 * H * W);
+        data::Frame out;
+        out.image = test::View(tensor, {1, 3, H, W});
+        if (!Run(config, in, &out))
+        {
+            return;
+        }
+
+        int bad = 0;
+        for (std::int64_t c = 0; c < 3; ++c)
+        {
+            const std::int64_t sc = swap ? 2 - c : c;
+            for (std::int64_t i = 0; i < H * W; ++i)
+            {
+                float x = pixels[i * 3 + sc];
+                if (normalize)
+                {
+                    x = (x - config.norm.mean[c]) / config.norm.std[c];
+                }
+                float want = std::nearbyint(x / config.quant.scales[0]) + config.quant.zero_points[0];
+                want = std::fmin(std::fmax(want, -128.0f), 127.0f);
+                bad += tensor[c * H * W + i] != static_cast<std::int8_t>(want);
+            }
+        }
+        PTK_CHECK(bad == 0);
+    }
+
+    // A camera YUV frame is decoded once and then takes the HWC path to the
+    // CHW float tensor, matching YuvToRgb pixel for pixel.
+    void TestYuvInput(core::PixelFormat format)
+    {
+        const std::int64_t H = 8;
+        const std::int64_t W = 34;
+        const bool yuyv = format == core::PixelFormat::kYuyv;
+        const std::vector<std::int64_t> dims = yuyv ? std::vector<std::int64_t>{H, W, 2}
+                                                    : std::vector<std::int64_t>{H * 3 / 2, W, 1};
+        std::vector<std::uint8_t> yuv = test::Pattern(static_cast<std::size_t>(H * W * 2), 11);
+        yuv.resize(static_cast<std::size_t>(dims[0] * dims[1] * dims[2]));
+        data::Frame in;
+        in.pixel_format = format;
+        in.layout = core::TensorLayout::kHwc;
+        in.image = test::View(yuv, dims);
+
+        PreprocessorConfig config = BaseConfig();
+        config.input_format = format;
+        config.output_format = core::PixelFormat::kBgr8;
+
+        std::vector<float> tensor(3 * H * W);
+        data::Frame out;
+        out.image = test::View(tensor, {3, H, W});
+        if (!Run(config, in, &out))
+        {
+            return;
+        }
+
+        std::vector<std::uint8_t> bgr(static_cast<std::size_t>(H * W * 3));
+        data::TensorView bgr_view = test::View(bgr, {H, W, 3});
+        if (!PTK_CHECK_OK(operators::YuvToRgb(test::View(yuv, dims), format, &bgr_view, core::PixelFormat::kBgr8)))
+        {
+            return;
+        }
+        int bad = 0;
+        for (std::int64_t c = 0; c < 3; ++c)
+        {
+            for (std::int64_t i = 0; i < H * W; ++i)
+            {
+                bad += tensor[c * H * W + i] != static_cast<float>(bgr[i * 3 + c]);
+            }
+        }
+        PTK_CHECK(bad == 0);
+        PTK_CHECK(out.pixel_format == core::PixelFormat::kBgr8);
+    }
+
+    // Raw Bayer frames are demosaiced at full size, or binned by
+    // bayer_downscale, before the layout change.
+    void TestBayerInput(int downscale)
+    {
+        const std::int64_t H = 8;
+        const std::int64_t W = 36;
+        std::vector<std::uint8_t> mosaic = test::Pattern(static_cast<std::size_t>(H * W), 17);
+        data::Frame in;
+        in.pixel_format = core::PixelFormat::kBayerGrbg;
+        in.layout = core::TensorLayout::kHwc;
+        in.image = test::View(mosaic, {H, W, 1});
+
+        PreprocessorConfig config = BaseConfig();
+        config.input_format = in.pixel_format;
+        config.bayer.method = operators::DemosaicMethod::kEdgeAware;
+        config.bayer_downscale = downscale;
+        const std::int64_t f = downscale > 1 ? downscale : 1;
+        const std::int64_t OH = H / f;
+        const std::int64_t OW = W / f;
+
+        std::vector<float> tensor(static_cast<std::size_t>(3 * OH * OW));
+        data::Frame out;
+        out.image = test::View(tensor, {3, OH, OW});
+        if (!Run(config, in, &out))
+        {
+            return;
+        }
+
+        std::vector<std::uint8_t> rgb(tensor.size());
+        data::TensorView rgb_view = test::View(rgb, {OH, OW, 3});
+        const data::TensorView src = test::View(mosaic, {H, W, 1});
+        if (!PTK_CHECK_OK(f > 1 ? operators::DemosaicBinned(src, in.pixel_format, &rgb_view, core::PixelFormat::kRgb8,
+                                                            config.bayer)
+                                : operators::Demosaic(src, in.pixel_format, &rgb_view, core::PixelFormat::kRgb8,
+                                                      config.bayer)))
+        {
+            return;
+        }
+        int bad = 0;
+        for (std::int64_t c = 0; c < 3; ++c)
+        {
+            for (std::int64_t i = 0; i < OH * OW; ++i)
+            {
+                bad += tensor[c * OH * OW + i] != static_cast<float>(rgb[i * 3 + c]);
+            }
+        }
+        PTK_CHECK(bad == 0);
+        PTK_CHECK(out.pixel_format == core::PixelFormat::kRgb8);
+    }
+
+    // Undistortion resamples the frame at its own size through the camera
+    // model before the layout change.
+    void TestUndistort()
+    {
+        const std::int64_t H = 24;
+        const std::int64_t W = 40;
+        std::vector<std::uint8_t> pixels = test::Pattern(static_cast<std::size_t>(H * W * 3), 19);
+        data::Frame in;
+        in.pixel_format = core::PixelFormat::kRgb8;
+        in.layout = core::TensorLayout::kHwc;
+        in.image = test::View(pixels, {H, W, 3});
+
+        PreprocessorConfig config = BaseConfig();
+        config.undistort = true;
+        config.camera.fx = 36.0f;
+        config.camera.fy = 36.0f;
+        config.camera.cx = 19.5f;
+        config.camera.cy = 11.5f;
+        config.distortion.k1 = -0.2f;
+        config.distortion.p2 = 0.002f;
+
+        std::vector<float> tensor(static_cast<std::size_t>(3 * H * W));
+        data::Frame out;
+        out.image = test::View(tensor, {3, H, W});
+        if (!Run(config, in, &out))
+        {
+            return;
+        }
+
+        operators::Remapper remapper;
+        std::vector<std::uint8_t> rgb(tensor.size());
+        data::TensorView rgb_view = test::View(rgb, {H, W, 3});
+        if (!PTK_CHECK_OK(remapper.InitUndistort(config.camera, config.distortion, H, W, H, W)) ||
+            !PTK_CHECK_OK(remapper.Apply(test::View(pixels, {H, W, 3}), &rgb_view)))
+        {
+            return;
+        }
+        int bad = 0;
+        for (std::int64_t c = 0; c < 3; ++c)
+        {
+            for (std::int64_t i = 0; i < H * W; ++i)
+            {
+                bad += tensor[c * H * W + i] != static_cast<float>(rgb[i * 3 + c]);
+            }
+        }
+        PTK_CHECK(bad == 0);
+        PTK_CHECK(rgb != pixels);
+    }
+
+    // A flipped and rotated frame: every output pixel holds the source pixel
+    // that out.to_source maps its centre into.
+    void TestOrientation(operators::FlipMode flip, operators::Rotation rotation)
+    {
+        const std::int64_t H = 6;
+        const std::int64_t W = 10;
+        std::vector<std::uint8_t> pixels = test::Pattern(static_cast<std::size_t>(H * W * 3), 23);
+        data::Frame in;
+        in.pixel_format = core::PixelFormat::kRgb8;
+        in.layout = core::TensorLayout::kHwc;
+        in.image = test::View(pixels, {H, W, 3});
+
+        PreprocessorConfig config = BaseConfig();
+        config.flip = flip;
+        config.rotation = rotation;
+        const bool turned = rotation == operators::Rotation::k90 || rotation == operators::Rotation::k270;
+        const std::int64_t OH = turned ? W : H;
+        const std::int64_t OW = turned ? H : W;
+
+        std::vector<float> tensor(static_cast<std::size_t>(3 * OH * OW));
+        data::Frame out;
+        out.image = test::View(tensor, {3, OH, OW});
+        if (!Run(config, in, &out))
+        {
+            return;
+        }
+
+        int bad = 0;
+        for (std::int64_t y = 0; y < OH; ++y)
+        {
+            for (std::int64_t x = 0; x < OW; ++x)
+            {
+                double sx;
+                double sy;
+                out.to_source.Apply(static_cast<double>(x) + 0.5, static_cast<double>(y) + 0.5, &sx, &sy);
+                const std::int64_t px = static_cast<std::int64_t>(std::floor(sx));
+                const std::int64_t py = static_cast<std::int64_t>(std::floor(sy));
+                if (px < 0 || px >= W || py < 0 || py >= H)
+                {
+                    ++bad;
+                    continue;
+                }
+                for (std::int64_t c = 0; c < 3; ++c)
+                {
+                    bad += tensor[(c * OH + y) * OW + x] != static_cast<float>(pixels[(py * W + px) * 3 + c]);
+                }
+            }
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  flip=%d rotation=%d\n", static_cast<int>(flip), static_cast<int>(rotation));
+        }
+    }
+
+    // RGB or BGR frames for a one-channel model are reduced to luma before
+    // the layout change, with the weights in the frame's channel order.
+    void TestGrayInput(bool bgr)
+    {
+        const std::int64_t H = 7;
+        const std::int64_t W = 40;
+        std::vector<std::uint8_t> pixels = test::Pattern(H * W * 3, 13);
+        data::Frame in;
+        in.pixel_format = bgr ? core::PixelFormat::kBgr8 : core::PixelFormat::kRgb8;
+        in.layout = core::TensorLayout::kHwc;
+        in.image = test::View(pixels, {H, W, 3});
+
+        PreprocessorConfig config = BaseConfig();
+        config.input_format = in.pixel_format;
+        config.to_grayscale = true;
+        config.output_format = core::PixelFormat::kGray8;
+
+        std::vector<float> tensor(H * W);
+        data::Frame out;
+        out.image = test::View(tensor, {1, H, W});
+        if (!Run(config, in, &out))
+        {
+            return;
+        }
+
+        std::vector<std::uint8_t> gray(static_cast<std::size_t>(H * W));
+        data::TensorView gray_view = test::View(gray, {H, W, 1});
+        const data::TensorView src = test::View(pixels, {H, W, 3});
+        if (!PTK_CHECK_OK(bgr ? operators::BgrToGray(src, &gray_view) : operators::RgbToGray(src, &gray_view)))
+        {
+            return;
+        }
+        PTK_CHECK(std::vector<float>(gray.begin(), gray.end()) == tensor);
+        PTK_CHECK(out.pixel_format == core::PixelFormat::kGray8);
+    }
+
+    data::TensorSpec Spec(core::DataType dtype, std::vector<std::int64_t> dims)
+    {
+        data::TensorSpec spec;
+        spec.name = "images";
+        spec.dtype = dtype;
+        spec.dims = std::move(dims);
+        return spec;
+    }
+
+    // The output side follows the model input: layout from rank and channel
+    // position, target size from static dims only, gray for one channel. An
+    // int8 NCHW input configures a pipeline that runs; inputs no tick can
+    // fill are rejected and leave the config alone.
+    void TestConfigureFromModelInput()
+    {
+        PreprocessorConfig config = BaseConfig();
+        if (PTK_CHECK_OK(ConfigureFromModelInput(Spec(core::DataType::kFloat16, {1, 3, 32, 48}), &config)))
+        {
+            PTK_CHECK(config.output_type == core::DataType::kFloat16);
+            PTK_CHECK(config.output_layout == core::TensorLayout::kNchw && config.add_batch_dimension);
+            PTK_CHECK(config.target_height == 32 && config.target_width == 48);
+            PTK_CHECK(!config.to_grayscale);
+        }
+
+        config = BaseConfig();
+        if (PTK_CHECK_OK(ConfigureFromModelInput(Spec(core::DataType::kFloat32, {-1, 24, 16, 3}), &config)))
+        {
+            PTK_CHECK(config.output_layout == core::TensorLayout::kNhwc && config.add_batch_dimension);
+            PTK_CHECK(config.target_height == 24 && config.target_width == 16);
+        }
+
+        config = BaseConfig();
+        if (PTK_CHECK_OK(ConfigureFromModelInput(Spec(core::DataType::kFloat32, {1, -1, -1}), &config)))
+        {
+            PTK_CHECK(config.output_layout == core::TensorLayout::kChw && !config.add_batch_dimension);
+            PTK_CHECK(config.target_height == 0 && config.target_width == 0);
+            PTK_CHECK(config.to_grayscale && config.output_format == core::PixelFormat::kGray8);
+        }
+
+        const std::int64_t H = 6;
+        const std::int64_t W = 19;
+        std::vector<std::uint8_t> pixels = test::Pattern(H * W * 3, 21);
+        data::Frame in;
+        in.pixel_format = core::PixelFormat::kRgb8;
+        in.layout = core::TensorLayout::kHwc;
+        in.image = test::View(pixels, {H, W, 3});
+        config = BaseConfig();
+        config.normalize = true;
+        config.quant.scales = {0.05f};
+        config.quant.zero_points = {0};
+        if (PTK_CHECK_OK(ConfigureFromModelInput(Spec(core::DataType::kInt8, {1, 3, H, W}), &config)))
+        {
+            std::vector<std::int8_t> tensor(3 * H * W);
+            data::Frame out;
+            out.image = test::View(tensor, {1, 3, H, W});
+            if (Run(config, in, &out))
+            {
+                float x = (pixels[(3 * W + 5) * 3] - config.norm.mean[0]) / config.norm.std[0];
+                float want = std::fmin(std::fmax(std::nearbyint(x / 0.05f), -128.0f), 127.0f);
+                PTK_CHECK(tensor[3 * W + 5] == static_cast<std::int8_t>(want));
+            }
+        }
+
+        PTK_CHECK(ConfigureFromModelInput(Spec(core::DataType::kFloat32, {1, 3, 8, 8}), nullptr).code() ==
+                  core::StatusCode::kInvalidArgument);
+        const data::TensorSpec rejected[] = {
+            Spec(core::DataType::kUnknown, {1, 3, 8, 8}),
+            Spec(core::DataType::kUint8, {1, 3, 8, 8}),
+            Spec(core::DataType::kFloat32, {8, 8}),
+            Spec(core::DataType::kFloat32, {2, 3, 8, 8}),
+            Spec(core::DataType::kFloat32, {1, 8, 8, 2}),
+            Spec(core::DataType::kFloat32, {8, 8, -1}),
+        };
+        for (const data::TensorSpec &spec : rejected)
+        {
+            config = BaseConfig();
+            const core::Status status = ConfigureFromModelInput(spec, &config);
+            if (!PTK_CHECK(status.code() == core::StatusCode::kInvalidArgument))
+            {
+                std::printf("  accepted rank %zu spec\n", spec.dims.size());
+            }
+            PTK_CHECK(config.output_type == core::DataType::kFloat32 && config.target_height == 0);
+        }
+    }
+} // namespace
+
+int main()
+{
+    TestChwCrop(false, false);
+    TestChwCrop(true, false);
+    TestChwCrop(true, true);
+    TestHalfOutput(ptk::core::DataType::kFloat16);
+    TestHalfOutput(ptk::core::DataType::kBFloat16);
+    TestInt8Output(true, false);
+    TestInt8Output(true, true);
+    TestInt8Output(false, true);
+    TestYuvInput(ptk::core::PixelFormat::kYuyv);
+    TestYuvInput(ptk::core::PixelFormat::kNv12);
+    TestYuvInput(ptk::core::PixelFormat::kI420);
+    TestBayerInput(0);
+    TestBayerInput(2);
+    TestUndistort();
+    TestOrientation(ptk::operators::FlipMode::kVertical, ptk::operators::Rotation::kNone);
+    TestOrientation(ptk::operators::FlipMode::kHorizontal, ptk::operators::Rotation::k90);
+    TestOrientation(ptk::operators::FlipMode::kNone, ptk::operators::Rotation::k270);
+    TestOrientation(ptk::operators::FlipMode::kBoth, ptk::operators::Rotation::k180);
+    TestGrayInput(false);
+    TestGrayInput(true);
+    TestConfigureFromModelInput();
+    return ptk::test::Finish("preprocessor_test");
+}
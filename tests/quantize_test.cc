@@ -0,0 +1,267 @@
+// Quantize and Dequantize against the element formulas, per tensor and per
+// channel on either side of the data, and ImageQuantizer against normalize
+// then quantize for every layout pair, channel count, channel swap, batch dim
+// and crop view.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "operators/center_crop.h"
+#include "operators/dequantize.h"
+#include "operators/quantize.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    template <typename Q>
+    Q Reference(float x, float scale, std::int32_t zero_point)
+    {
+        const float lo = std::is_signed<Q>::value ? -128.0f : 0.0f;
+        const float hi = std::is_signed<Q>::value ? 127.0f : 255.0f;
+        const float v = std::nearbyint(x / scale) + static_cast<float>(zero_point);
+        return static_cast<Q>(v < lo ? lo : v > hi ? hi : v);
+    }
+
+    operators::QuantizationParams Params(std::size_t channels, int axis)
+    {
+        operators::QuantizationParams params;
+        for (std::size_t c = 0; c < channels; ++c)
+        {
+            params.scales.push_back(0.02f + 0.015f * static_cast<float>(c));
+            params.zero_points.push_back(static_cast<std::int32_t>(c * 7) - 5);
+        }
+        params.axis = axis;
+        return params;
+    }
+
+    // Scale and zero point index of element i of a [outer, channels, inner] tensor.
+    std::size_t ParamIndex(std::size_t i, const operators::QuantizationParams &params, std::int64_t inner)
+    {
+        const std::size_t channels = params.scales.size();
+        return channels == 1 ? 0 : (i / static_cast<std::size_t>(inner)) % channels;
+    }
+
+    // dims with the quantization axis at axis; odd sizes leave scalar tails.
+    template <typename Q>
+    void TestRoundTrip(const std::vector<std::int64_t> &dims, std::size_t channels, int axis)
+    {
+        std::int64_t n = 1;
+        std::int64_t inner = 1;
+        for (std::size_t d = 0; d < dims.size(); ++d)
+        {
+            n *= dims[d];
+            if (static_cast<int>(d) > axis)
+            {
+                inner *= dims[d];
+            }
+        }
+        const operators::QuantizationParams params = Params(channels, axis);
+        const std::vector<std::uint8_t> bytes = test::Pattern(static_cast<std::size_t>(n), static_cast<std::uint32_t>(n));
+        std::vector<float> x(bytes.size());
+        for (std::size_t i = 0; i < x.size(); ++i)
+        {
+            // Beyond the 8-bit range on both sides, with exact half steps.
+            x[i] = (static_cast<float>(bytes[i]) - 128.0f) * (i % 3 == 0 ? 0.05f : 0.01f);
+        }
+        x[0] = 1e9f;
+        x[1] = -1e9f;
+
+        std::vector<Q> q(x.size());
+        data::TensorView q_view = test::View(q, dims);
+        if (!PTK_CHECK_OK(operators::Quantize(test::View(x, dims), params, &q_view)))
+        {
+            return;
+        }
+        int bad = 0;
+        for (std::size_t i = 0; i < x.size(); ++i)
+        {
+            const std::size_t c = ParamIndex(i, params, inner);
+            bad += q[i] != Reference<Q>(x[i], params.scales[c], params.zero_points[c]);
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  Quantize n=%lld channels=%zu axis=%d\n", static_cast<long long>(n), channels, axis);
+        }
+
+        std::vector<float> back(q.size());
+        data::TensorView back_view = test::View(back, dims);
+        if (!PTK_CHECK_OK(operators::Dequantize(test::View(q, dims), params, &back_view)))
+        {
+            return;
+        }
+        bad = 0;
+        for (std::size_t i = 0; i < q.size(); ++i)
+        {
+            const std::size_t c = ParamIndex(i, params, inner);
+            bad += back[i] != static_cast<float>(static_cast<std::int32_t>(q[i]) - params.zero_points[c]) *
+                                  params.scales[c];
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  Dequantize n=%lld channels=%zu axis=%d\n", static_cast<long long>(n), channels, axis);
+        }
+    }
+
+    template <typename Q>
+    void TestTensors()
+    {
+        TestRoundTrip<Q>({3, 37, 3}, 1, 0);
+        TestRoundTrip<Q>({3, 37, 3}, 3, 2);
+        TestRoundTrip<Q>({5, 4}, 4, 1);
+        TestRoundTrip<Q>({3, 37, 5}, 3, 0);
+        TestRoundTrip<Q>({2, 3, 19}, 3, 1);
+        TestRoundTrip<Q>({300, 301}, 1, 0);
+    }
+
+    operators::NormalizationParams Norm(int channels)
+    {
+        operators::NormalizationParams norm{};
+        const float mean[4] = {123.675f, 116.28f, 103.53f, 127.5f};
+        const float std[4] = {58.395f, 57.12f, 57.375f, 64.0f};
+        for (int c = 0; c < 4; ++c)
+        {
+            norm.mean[c] = mean[c];
+            norm.std[c] = std[c];
+        }
+        norm.num_channels = channels;
+        return norm;
+    }
+
+    // A C-channel image of size H x W read through a centered crop of the
+    // given size, from src_layout into dst_layout.
+    void TestImage(core::TensorLayout src_layout, core::TensorLayout dst_layout, std::int64_t C, std::int64_t H,
+                   std::int64_t W, std::int64_t crop, bool swap_rb, bool batch, bool per_channel)
+    {
+        const bool src_hwc = src_layout == core::TensorLayout::kHwc;
+        const bool dst_hwc = dst_layout == core::TensorLayout::kHwc;
+        const operators::NormalizationParams norm = Norm(static_cast<int>(C));
+        const operators::QuantizationParams params = Params(per_channel ? static_cast<std::size_t>(C) : 1, 0);
+
+        std::vector<std::uint8_t> pixels = test::Pattern(static_cast<std::size_t>(C * H * W),
+                                                         static_cast<std::uint32_t>(C * 100 + W));
+        data::TensorView src = test::View(pixels, src_hwc ? std::vector<std::int64_t>{H, W, C}
+                                                          : std::vector<std::int64_t>{C, H, W});
+        const std::int64_t TH = crop > 0 ? crop : H;
+        const std::int64_t TW = crop > 0 ? crop : W;
+        if (crop > 0 && !PTK_CHECK_OK(operators::CenterCropView(src, static_cast<int>(TH), static_cast<int>(TW), &src,
+                                                                src_layout)))
+        {
+            return;
+        }
+        const std::int64_t y0 = (H - TH) / 2;
+        const std::int64_t x0 = (W - TW) / 2;
+
+        operators::ImageQuantizer quantizer;
+        if (!PTK_CHECK_OK(quantizer.Init(norm, params, core::DataType::kInt8, swap_rb)))
+        {
+            return;
+        }
+        std::vector<std::int8_t> out(static_cast<std::size_t>(C * TH * TW));
+        std::vector<std::int64_t> dims = dst_hwc ? std::vector<std::int64_t>{TH, TW, C}
+                                                 : std::vector<std::int64_t>{C, TH, TW};
+        if (batch)
+        {
+            dims.insert(dims.begin(), 1);
+        }
+        data::TensorView dst = test::View(out, dims);
+        if (!PTK_CHECK_OK(quantizer.Apply(src, &dst, src_layout, dst_layout)))
+        {
+            return;
+        }
+
+        int bad = 0;
+        for (std::int64_t c = 0; c < C; ++c)
+        {
+            const std::int64_t sc = swap_rb && c != 1 && c != 3 ? 2 - c : c;
+            const std::size_t qc = per_channel ? static_cast<std::size_t>(c) : 0;
+            for (std::int64_t y = 0; y < TH; ++y)
+            {
+                for (std::int64_t x = 0; x < TW; ++x)
+                {
+                    const std::int64_t sy = y + y0;
+                    const std::int64_t sx = x + x0;
+                    const std::uint8_t v = pixels[src_hwc ? (sy * W + sx) * C + sc : (sc * H + sy) * W + sx];
+                    const float normalized = (static_cast<float>(v) - norm.mean[c]) / norm.std[c];
+                    const std::int8_t want = Reference<std::int8_t>(normalized, params.scales[qc], params.zero_points[qc]);
+                    bad += out[dst_hwc ? (y * TW + x) * C + c : (c * TH + y) * TW + x] != want;
+                }
+            }
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  %s -> %s C=%lld H=%lld W=%lld crop=%lld swap=%d batch=%d\n", src_hwc ? "HWC" : "CHW",
+                        dst_hwc ? "HWC" : "CHW", static_cast<long long>(C), static_cast<long long>(H),
+                        static_cast<long long>(W), static_cast<long long>(crop), swap_rb, batch);
+        }
+    }
+
+    void TestImages()
+    {
+        const core::TensorLayout layouts[] = {core::TensorLayout::kHwc, core::TensorLayout::kChw};
+        for (core::TensorLayout from : layouts)
+        {
+            for (core::TensorLayout to : layouts)
+            {
+                for (std::int64_t C = 1; C <= 4; ++C)
+                {
+                    TestImage(from, to, C, 5, 19, 0, false, false, C > 1);
+                    TestImage(from, to, C, 9, 21, 4, false, true, false);
+                    TestImage(from, to, C, 300, 257, 0, false, false, false);
+                    if (C >= 3)
+                    {
+                        TestImage(from, to, C, 7, 13, 5, true, true, true);
+                    }
+                }
+            }
+        }
+    }
+
+    void TestInvalid()
+    {
+        std::vector<float> x(12);
+        std::vector<std::int8_t> q(12);
+        data::TensorView q_view = test::View(q, {3, 4});
+        PTK_CHECK(!operators::Quantize(test::View(x, {3, 4}), Params(3, 1), &q_view).ok());
+        PTK_CHECK(!operators::Quantize(test::View(x, {3, 4}), Params(3, 2), &q_view).ok());
+        operators::QuantizationParams zero = Params(1, 0);
+        zero.scales[0] = 0.0f;
+        PTK_CHECK(!operators::Quantize(test::View(x, {3, 4}), zero, &q_view).ok());
+        data::TensorView short_view = test::View(q, {2, 4});
+        PTK_CHECK(!operators::Quantize(test::View(x, {3, 4}), Params(1, 0), &short_view).ok());
+
+        operators::ImageQuantizer quantizer;
+        std::vector<std::uint8_t> pixels(2 * 3 * 3);
+        data::TensorView image = test::View(pixels, {2, 3, 3});
+        std::vector<std::int8_t> out(pixels.size());
+        data::TensorView hwc = test::View(out, {2, 3, 3});
+        PTK_CHECK(!quantizer.Apply(image, &hwc, core::TensorLayout::kHwc, core::TensorLayout::kHwc).ok());
+        PTK_CHECK(!quantizer.Init(Norm(2), Params(1, 0), core::DataType::kInt8, true).ok());
+        PTK_CHECK(!quantizer.Init(Norm(3), Params(2, 0), core::DataType::kInt8).ok());
+        PTK_CHECK(!quantizer.Init(Norm(3), Params(1, 0), core::DataType::kFloat32).ok());
+        PTK_CHECK_OK(quantizer.Init(Norm(3), Params(1, 0), core::DataType::kInt8));
+        PTK_CHECK_OK(quantizer.Apply(image, &hwc, core::TensorLayout::kHwc, core::TensorLayout::kHwc));
+        data::TensorView chw = test::View(out, {3, 2, 3});
+        PTK_CHECK_OK(quantizer.Apply(image, &chw, core::TensorLayout::kHwc, core::TensorLayout::kChw));
+        PTK_CHECK(!quantizer.Apply(image, &hwc, core::TensorLayout::kHwc, core::TensorLayout::kChw).ok());
+        data::TensorView batched = test::View(out, {2, 3, 3, 1});
+        PTK_CHECK(!quantizer.Apply(image, &batched, core::TensorLayout::kHwc, core::TensorLayout::kHwc).ok());
+        PTK_CHECK(!quantizer.Apply(image, &hwc, core::TensorLayout::kHwc, core::TensorLayout::kNhwc).ok());
+        std::vector<std::uint8_t> unsigned_out(pixels.size());
+        data::TensorView wrong_type = test::View(unsigned_out, {2, 3, 3});
+        PTK_CHECK(!quantizer.Apply(image, &wrong_type, core::TensorLayout::kHwc, core::TensorLayout::kHwc).ok());
+    }
+} // namespace
+
+int main()
+{
+    TestTensors<std::int8_t>();
+    TestTensors<std::uint8_t>();
+    TestImages();
+    TestInvalid();
+    return ptk::test::Finish("quantize_test");
+}
@@ -0,0 +1,223 @@
+// Remapper against its documented fixed-point sampling (source coordinates
+// snapped to 1/32 pixel, Q14 bilinear weights, edges replicated within half a
+// pixel and black beyond) for 1 to 4 channels, on maps that reach the last
+// row and column where the vector loads give way to scalar ones; plus
+// identity and undistortion maps built by InitUndistort.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "operators/remap.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+
+    // Output pixel at (x, y) of an H x W x C source, sampled the way the
+    // Remapper documents.
+    void Sample(const std::vector<std::uint8_t> &src, std::int64_t H, std::int64_t W, std::int64_t C, float x,
+                float y, std::uint8_t *out)
+    {
+        if (!(x >= -0.5f && x <= W - 0.5f && y >= -0.5f && y <= H - 0.5f))
+        {
+            std::fill(out, out + C, 0);
+            return;
+        }
+        x = std::min(std::max(x, 0.0f), static_cast<float>(W - 1));
+        y = std::min(std::max(y, 0.0f), static_cast<float>(H - 1));
+        const std::int64_t x0 = std::min<std::int64_t>(static_cast<std::int64_t>(x), W - 2);
+        const std::int64_t y0 = std::min<std::int64_t>(static_cast<std::int64_t>(y), H - 2);
+        const std::uint32_t fx = static_cast<std::uint32_t>(std::lround((x - static_cast<float>(x0)) * 32));
+        const std::uint32_t fy = static_cast<std::uint32_t>(std::lround((y - static_cast<float>(y0)) * 32));
+        for (std::int64_t c = 0; c < C; ++c)
+        {
+            auto at = [&](std::int64_t dy, std::int64_t dx) -> std::uint32_t {
+                return src[((y0 + dy) * W + x0 + dx) * C + c];
+            };
+            const std::uint32_t sum = at(0, 0) * (32 - fx) * (32 - fy) + at(0, 1) * fx * (32 - fy) +
+                                      at(1, 0) * (32 - fx) * fy + at(1, 1) * fx * fy;
+            out[c] = static_cast<std::uint8_t>((sum * 16 + (1 << 13)) >> 14);
+        }
+    }
+
+    // Remaps a pattern through (map_x, map_y) and compares every pixel with
+    // Sample.
+    void Check(const operators::Remapper &remapper, const std::vector<float> &map_x,
+               const std::vector<float> &map_y, std::int64_t C, std::int64_t OH, std::int64_t OW, const char *what)
+    {
+        const std::int64_t H = remapper.src_height();
+        const std::int64_t W = remapper.src_width();
+        std::vector<std::uint8_t> src = test::Pattern(static_cast<std::size_t>(H * W * C),
+                                                      static_cast<std::uint32_t>(W * C + H));
+        std::vector<std::uint8_t> out(static_cast<std::size_t>(OH * OW * C), 77);
+        data::TensorView dst = test::View(out, {OH, OW, C});
+        if (!PTK_CHECK_OK(remapper.Apply(test::View(src, {H, W, C}), &dst)))
+        {
+            return;
+        }
+        int bad = 0;
+        for (std::int64_t i = 0; i < OH * OW; ++i)
+        {
+            std::uint8_t want[4];
+            Sample(src, H, W, C, map_x[i], map_y[i], want);
+            bad += !std::equal(want, want + C, out.begin() + i * C);
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  %s C=%lld %lldx%lld -> %lldx%lld: %d pixels differ\n", what, static_cast<long long>(C),
+                        static_cast<long long>(H), static_cast<long long>(W), static_cast<long long>(OH),
+                        static_cast<long long>(OW), bad);
+        }
+    }
+
+    // Coordinates spread over the source and half a pixel beyond it, with
+    // every output row ending on the bottom-right corner.
+    void TestMap(std::int64_t C, int H, int W, int OH, int OW)
+    {
+        const std::vector<std::uint8_t> bytes = test::Pattern(static_cast<std::size_t>(OH * OW * 2),
+                                                              static_cast<std::uint32_t>(OW + C));
+        std::vector<float> map_x(static_cast<std::size_t>(OH * OW));
+        std::vector<float> map_y(map_x.size());
+        for (std::size_t i = 0; i < map_x.size(); ++i)
+        {
+            map_x[i] = bytes[2 * i] / 255.0f * (W + 1.5f) - 1.0f;
+            map_y[i] = bytes[2 * i + 1] / 255.0f * (H + 1.5f) - 1.0f;
+            if (i % static_cast<std::size_t>(OW) == static_cast<std::size_t>(OW - 1))
+            {
+                map_x[i] = static_cast<float>(W - 1);
+                map_y[i] = static_cast<float>(H - 1);
+            }
+        }
+        map_x[0] = std::numeric_limits<float>::quiet_NaN();
+        operators::Remapper remapper;
+        if (PTK_CHECK_OK(remapper.Init(map_x, map_y, H, W, OH, OW)))
+        {
+            Check(remapper, map_x, map_y, C, OH, OW, "map");
+        }
+    }
+
+    // Without distortion and at the source size the map is the identity.
+    void TestIdentity(std::int64_t C, int H, int W)
+    {
+        operators::CameraIntrinsics camera;
+        camera.fx = 300.0f;
+        camera.fy = 310.0f;
+        camera.cx = W * 0.5f - 0.3f;
+        camera.cy = H * 0.5f + 0.7f;
+        operators::Remapper remapper;
+        if (!PTK_CHECK_OK(remapper.InitUndistort(camera, operators::DistortionCoefficients(), H, W, H, W)))
+        {
+            return;
+        }
+        std::vector<std::uint8_t> src = test::Pattern(static_cast<std::size_t>(H * W * C),
+                                                      static_cast<std::uint32_t>(C));
+        std::vector<std::uint8_t> out(src.size());
+        data::TensorView dst = test::View(out, {H, W, C});
+        if (PTK_CHECK_OK(remapper.Apply(test::View(src, {H, W, C}), &dst)) && !PTK_CHECK(out == src))
+        {
+            std::printf("  identity C=%lld %dx%d\n", static_cast<long long>(C), H, W);
+        }
+    }
+
+    // The undistortion map follows the five-coefficient model through the
+    // output camera, which defaults to the source camera rescaled.
+    void TestUndistort(std::int64_t C, int H, int W, int OH, int OW, bool new_camera)
+    {
+        operators::CameraIntrinsics camera;
+        camera.fx = 0.9f * W;
+        camera.fy = 0.9f * W;
+        camera.cx = W * 0.5f + 1.25f;
+        camera.cy = H * 0.5f - 0.75f;
+        operators::DistortionCoefficients d;
+        d.k1 = -0.28f;
+        d.k2 = 0.07f;
+        d.p1 = 0.001f;
+        d.p2 = -0.0015f;
+        d.k3 = -0.01f;
+        operators::CameraIntrinsics target = camera;
+        if (new_camera)
+        {
+            target.fx = 0.6f * OW;
+            target.fy = 0.6f * OW;
+            target.cx = OW * 0.5f;
+            target.cy = OH * 0.5f;
+        }
+        else
+        {
+            const float sx = static_cast<float>(OW) / static_cast<float>(W);
+            const float sy = static_cast<float>(OH) / static_cast<float>(H);
+            target.fx = camera.fx * sx;
+            target.fy = camera.fy * sy;
+            target.cx = (camera.cx + 0.5f) * sx - 0.5f;
+            target.cy = (camera.cy + 0.5f) * sy - 0.5f;
+        }
+
+        std::vector<float> map_x(static_cast<std::size_t>(OH * OW));
+        std::vector<float> map_y(map_x.size());
+        for (int v = 0; v < OH; ++v)
+        {
+            for (int u = 0; u < OW; ++u)
+            {
+                const double x = (u - target.cx) / target.fx;
+                const double y = (v - target.cy) / target.fy;
+                const double r2 = x * x + y * y;
+                const double radial = 1.0 + r2 * (d.k1 + r2 * (d.k2 + r2 * d.k3));
+                const double xd = x * radial + 2.0 * d.p1 * x * y + d.p2 * (r2 + 2.0 * x * x);
+                const double yd = y * radial + d.p1 * (r2 + 2.0 * y * y) + 2.0 * d.p2 * x * y;
+                map_x[v * OW + u] = static_cast<float>(camera.fx * xd + camera.cx);
+                map_y[v * OW + u] = static_cast<float>(camera.fy * yd + camera.cy);
+            }
+        }
+        operators::Remapper remapper;
+        if (PTK_CHECK_OK(remapper.InitUndistort(camera, d, H, W, OH, OW, new_camera ? &target : nullptr)))
+        {
+            Check(remapper, map_x, map_y, C, OH, OW, new_camera ? "undistort, new camera" : "undistort");
+        }
+    }
+
+    void TestInvalid()
+    {
+        operators::Remapper remapper;
+        std::vector<std::uint8_t> src(4 * 4 * 4);
+        std::vector<std::uint8_t> out(4 * 4 * 4);
+        data::TensorView dst = test::View(out, {4, 4, 3});
+        PTK_CHECK(!remapper.Apply(test::View(src, {4, 4, 3}), &dst).ok());
+
+        const std::vector<float> map(16, 1.0f);
+        PTK_CHECK(!remapper.Init(map, map, 1, 4, 4, 4).ok());
+        PTK_CHECK(!remapper.Init(map, std::vector<float>(15), 4, 4, 4, 4).ok());
+        PTK_CHECK(!remapper.InitUndistort(operators::CameraIntrinsics(), operators::DistortionCoefficients(), 4, 4, 4,
+                                          4)
+                       .ok());
+        PTK_CHECK(!remapper.initialized());
+
+        PTK_CHECK_OK(remapper.Init(map, map, 4, 4, 4, 4));
+        data::TensorView wide = test::View(out, {4, 4, 4});
+        PTK_CHECK(!remapper.Apply(test::View(src, {4, 4, 3}), &wide).ok());
+        PTK_CHECK(!remapper.Apply(test::View(src, {4, 2, 3}), &dst).ok());
+        data::TensorView five = test::View(out, {2, 2, 5});
+        PTK_CHECK(!remapper.Apply(test::View(src, {4, 4, 5}), &five).ok());
+        std::vector<float> floats(4 * 4 * 3);
+        PTK_CHECK(!remapper.Apply(test::View(floats, {4, 4, 3}), &dst).ok());
+        PTK_CHECK(!remapper.Apply(test::View(src, {4, 4, 3}), nullptr).ok());
+    }
+} // namespace
+
+int main()
+{
+    for (std::int64_t C = 1; C <= 4; ++C)
+    {
+        TestMap(C, 2, 2, 3, 5);
+        TestMap(C, 5, 7, 9, 17);
+        TestMap(C, 64, 90, 200, 181);
+        TestIdentity(C, 6, 33);
+        TestUndistort(C, 48, 64, 48, 64, false);
+        TestUndistort(C, 120, 160, 60, 80, true);
+    }
+    TestInvalid();
+    return ptk::test::Finish("remap_test");
+}
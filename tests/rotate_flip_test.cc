@@ -0,0 +1,221 @@
+// Flip and Rotate against per-pixel index maps for every mode, uint8 and
+// float32, 1 to 4 channels, packed and cropped sources, on sizes around the
+// 4x4 shuffle blocks and the 32 pixel tiles; plus FlipView/RotateView
+// compositions packed by Flip(kNone) and the argument checks.
+
+#include <cstdint>
+#include <vector>
+
+#include "operators/rotate_flip.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+    using operators::FlipMode;
+    using operators::Rotation;
+
+    // Source pixel (row, col) that an output pixel of a flip or rotation of
+    // an H x W image reads.
+    void Flipped(FlipMode mode, std::int64_t H, std::int64_t W, std::int64_t r, std::int64_t c, std::int64_t *sr,
+                 std::int64_t *sc)
+    {
+        const bool v = mode == FlipMode::kVertical || mode == FlipMode::kBoth;
+        const bool h = mode == FlipMode::kHorizontal || mode == FlipMode::kBoth;
+        *sr = v ? H - 1 - r : r;
+        *sc = h ? W - 1 - c : c;
+    }
+
+    void Rotated(Rotation rotation, std::int64_t H, std::int64_t W, std::int64_t r, std::int64_t c, std::int64_t *sr,
+                 std::int64_t *sc)
+    {
+        switch (rotation)
+        {
+        case Rotation::k90:
+            *sr = H - 1 - c;
+            *sc = r;
+            break;
+        case Rotation::k180:
+            *sr = H - 1 - r;
+            *sc = W - 1 - c;
+            break;
+        case Rotation::k270:
+            *sr = c;
+            *sc = W - 1 - r;
+            break;
+        default:
+            *sr = r;
+            *sc = c;
+            break;
+        }
+    }
+
+    bool Transposes(Rotation rotation) { return rotation == Rotation::k90 || rotation == Rotation::k270; }
+
+    // An H x W x C pattern; with a border the image is a view into a larger
+    // frame, so its rows are not contiguous.
+    template <typename T>
+    struct Image
+    {
+        std::vector<T> pixels;
+        std::int64_t channels;
+        std::int64_t border;
+        std::int64_t stride;
+        data::TensorView view;
+
+        Image(std::int64_t H, std::int64_t W, std::int64_t C, std::int64_t b)
+            : channels(C), border(b), stride((W + 2 * b) * C)
+        {
+            const std::vector<std::uint8_t> bytes = test::Pattern(static_cast<std::size_t>((H + 2 * b) * stride),
+                                                                  static_cast<std::uint32_t>(W * C + H));
+            pixels.assign(bytes.begin(), bytes.end());
+            const std::int64_t offset = b * stride + b * C;
+            view = data::TensorView(data::BufferView(pixels.data() + offset, (pixels.size() - offset) * sizeof(T),
+                                                     core::DeviceType::kCpu),
+                                    operators::DataTypeOf<T>::value, data::TensorShape({H, W, C}), {stride, C, 1});
+        }
+
+        T at(std::int64_t r, std::int64_t c, std::int64_t k) const
+        {
+            return pixels[(r + border) * stride + (c + border) * channels + k];
+        }
+    };
+
+    template <typename T>
+    void TestCase(std::int64_t H, std::int64_t W, std::int64_t C, bool crop, bool rotate, int mode)
+    {
+        const Image<T> src(H, W, C, crop ? 3 : 0);
+        const bool swap = rotate && Transposes(static_cast<Rotation>(mode));
+        const std::int64_t OH = swap ? W : H;
+        const std::int64_t OW = swap ? H : W;
+        std::vector<T> out(static_cast<std::size_t>(OH * OW * C));
+        data::TensorView dst = test::View(out, {OH, OW, C});
+        if (!PTK_CHECK_OK(rotate ? operators::Rotate(src.view, static_cast<Rotation>(mode), &dst)
+                                 : operators::Flip(src.view, static_cast<FlipMode>(mode), &dst)))
+        {
+            return;
+        }
+        int bad = 0;
+        for (std::int64_t r = 0; r < OH; ++r)
+        {
+            for (std::int64_t c = 0; c < OW; ++c)
+            {
+                std::int64_t sr;
+                std::int64_t sc;
+                if (rotate)
+                {
+                    Rotated(static_cast<Rotation>(mode), H, W, r, c, &sr, &sc);
+                }
+                else
+                {
+                    Flipped(static_cast<FlipMode>(mode), H, W, r, c, &sr, &sc);
+                }
+                for (std::int64_t k = 0; k < C; ++k)
+                {
+                    bad += out[(r * OW + c) * C + k] != src.at(sr, sc, k);
+                }
+            }
+        }
+        if (!PTK_CHECK(bad == 0))
+        {
+            std::printf("  %s %s %d %s H=%lld W=%lld C=%lld\n", sizeof(T) == 1 ? "uint8" : "float32",
+                        rotate ? "rotate" : "flip", mode, crop ? "crop" : "packed", static_cast<long long>(H),
+                        static_cast<long long>(W), static_cast<long long>(C));
+        }
+    }
+
+    // Every flip followed by every rotation, as views packed by one copy.
+    void TestComposed(std::int64_t H, std::int64_t W, std::int64_t C)
+    {
+        const Image<std::uint8_t> src(H, W, C, 2);
+        for (int f = 0; f < 4; ++f)
+        {
+            for (int r = 0; r < 4; ++r)
+            {
+                const Rotation rotation = static_cast<Rotation>(r);
+                data::TensorView view;
+                if (!PTK_CHECK_OK(operators::FlipView(src.view, static_cast<FlipMode>(f), &view)) ||
+                    !PTK_CHECK_OK(operators::RotateView(view, rotation, &view)))
+                {
+                    return;
+                }
+                const std::int64_t OH = Transposes(rotation) ? W : H;
+                const std::int64_t OW = Transposes(rotation) ? H : W;
+                std::vector<std::uint8_t> out(static_cast<std::size_t>(OH * OW * C));
+                data::TensorView dst = test::View(out, {OH, OW, C});
+                if (!PTK_CHECK_OK(operators::Flip(view, FlipMode::kNone, &dst)))
+                {
+                    return;
+                }
+                int bad = 0;
+                for (std::int64_t y = 0; y < OH; ++y)
+                {
+                    for (std::int64_t x = 0; x < OW; ++x)
+                    {
+                        std::int64_t fy;
+                        std::int64_t fx;
+                        Rotated(rotation, H, W, y, x, &fy, &fx);
+                        std::int64_t sy;
+                        std::int64_t sx;
+                        Flipped(static_cast<FlipMode>(f), H, W, fy, fx, &sy, &sx);
+                        for (std::int64_t k = 0; k < C; ++k)
+                        {
+                            bad += out[(y * OW + x) * C + k] != src.at(sy, sx, k);
+                        }
+                    }
+                }
+                if (!PTK_CHECK(bad == 0))
+                {
+                    std::printf("  flip %d then rotate %d, H=%lld W=%lld C=%lld\n", f, r, static_cast<long long>(H),
+                                static_cast<long long>(W), static_cast<long long>(C));
+                }
+            }
+        }
+    }
+
+    void TestInvalid()
+    {
+        std::vector<std::uint8_t> src(4 * 6 * 3);
+        std::vector<std::uint8_t> out(4 * 6 * 5);
+        data::TensorView same = test::View(out, {4, 6, 3});
+        PTK_CHECK(!operators::Rotate(test::View(src, {4, 6, 3}), Rotation::k90, &same).ok());
+        PTK_CHECK(!operators::Flip(test::View(src, {4, 6, 3}), FlipMode::kBoth, nullptr).ok());
+        PTK_CHECK(!operators::FlipView(test::View(src, {72}), FlipMode::kVertical, &same).ok());
+        data::TensorView five = test::View(out, {4, 6, 5});
+        PTK_CHECK(!operators::Flip(test::View(out, {4, 6, 5}), FlipMode::kHorizontal, &five).ok());
+        std::vector<float> floats(4 * 6 * 3);
+        data::TensorView float_dst = test::View(floats, {4, 6, 3});
+        PTK_CHECK(!operators::Flip(test::View(src, {4, 6, 3}), FlipMode::kVertical, &float_dst).ok());
+        std::vector<std::int8_t> signed_src(4 * 6 * 3);
+        std::vector<std::int8_t> signed_out(4 * 6 * 3);
+        data::TensorView signed_dst = test::View(signed_out, {4, 6, 3});
+        PTK_CHECK(!operators::Flip(test::View(signed_src, {4, 6, 3}), FlipMode::kNone, &signed_dst).ok());
+    }
+} // namespace
+
+int main()
+{
+    // Single pixels, 4x4 blocks with tails, tile edges and frames split
+    // over threads.
+    const std::int64_t sizes[][2] = {{1, 1}, {1, 7}, {5, 3}, {8, 12}, {33, 31}, {65, 97}, {130, 301}};
+    for (const auto &size : sizes)
+    {
+        for (std::int64_t C = 1; C <= 4; ++C)
+        {
+            for (int mode = 0; mode < 4; ++mode)
+            {
+                for (bool crop : {false, true})
+                {
+                    TestCase<std::uint8_t>(size[0], size[1], C, crop, false, mode);
+                    TestCase<std::uint8_t>(size[0], size[1], C, crop, true, mode);
+                }
+                TestCase<float>(size[0], size[1], C, false, false, mode);
+                TestCase<float>(size[0], size[1], C, true, true, mode);
+            }
+        }
+    }
+    TestComposed(9, 14, 3);
+    TestComposed(37, 20, 4);
+    TestInvalid();
+    return ptk::test::Finish("rotate_flip_test");
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "operators/kernel_dispatch.h"
+#include "runtime/core/status.h"
+#include "runtime/core/types.h"
+#include "runtime/data/buffer.h"
+#include "runtime/data/tensor.h"
+
+// Shared checks for the tests under tests/. Each test is a plain executable
+// that prints every failed check and returns nonzero if any failed.
+namespace ptk::test
+{
+    inline int &Failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline bool Check(bool ok, const char *expr, const char *file, int line)
+    {
+        if (!ok)
+        {
+            std::printf("%s:%d: check failed: %s\n", file, line, expr);
+            ++Failures();
+        }
+        return ok;
+    }
+
+    inline bool CheckOk(const core::Status &s, const char *expr, const char *file, int line)
+    {
+        if (!s.ok())
+        {
+            std::printf("%s:%d: %s failed: %s\n", file, line, expr, s.message().c_str());
+            ++Failures();
+        }
+        return s.ok();
+    }
+
+    inline bool CheckNear(double a, double b, double tolerance, const char *expr, const char *file, int line)
+    {
+        if (!(std::fabs(a - b) <= tolerance))
+        {
+            std::printf("%s:%d: check failed: %s (%g vs %g)\n", file, line, expr, a, b);
+            ++Failures();
+            return false;
+        }
+        return true;
+    }
+
+    // Dense view over a vector's storage, typed explicitly for element types
+    // that carry another dtype (fp16/bf16 bits in uint16).
+    template <typename T>
+    data::TensorView View(std::vector<T> &v, core::DataType dtype, const std::vector<std::int64_t> &dims)
+    {
+        return data::TensorView(data::BufferView(v.data(), v.size() * sizeof(T), core::DeviceType::kCpu), dtype,
+                                data::TensorShape(dims));
+    }
+
+    template <typename T>
+    data::TensorView View(std::vector<T> &v, const std::vector<std::int64_t> &dims)
+    {
+        return View(v, operators::DataTypeOf<T>::value, dims);
+    }
+
+    // Deterministic pseudo-random bytes, so failures reproduce.
+    inline std::vector<std::uint8_t> Pattern(std::size_t n, std::uint32_t seed = 1)
+    {
+        std::vector<std::uint8_t> v(n);
+        std::uint32_t x = seed * 2654435761u + 1;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            x = x * 1664525u + 1013904223u;
+            v[i] = static_cast<std::uint8_t>(x >> 24);
+        }
+        return v;
+    }
+
+    // Exit code for main, after a one-line summary.
+    inline int Finish(const char *name)
+    {
+        if (Failures() == 0)
+        {
+            std::printf("%s passed\n", name);
+            return 0;
+        }
+        std::printf("%s FAILED (%d checks)\n", name, Failures());
+        return 1;
+    }
+} // namespace ptk::test
+
+#define PTK_CHECK(cond) ::ptk::test::Check((cond), #cond, __FILE__, __LINE__)
+#define PTK_CHECK_OK(expr) ::ptk::test::CheckOk((expr), #expr, __FILE__, __LINE__)
+#define PTK_CHECK_NEAR(a, b, tolerance) \
+    ::ptk::test::CheckNear((a), (b), (tolerance), #a " ~ " #b, __FILE__, __LINE__)
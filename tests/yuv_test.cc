@@ -0,0 +1,345 @@
+// YuvToRgb against the fixed-point formula per pixel (bit exact, so the SIMD
+// bodies match their scalar tails) and against the float matrix within one
+// step, for every source format, output format and matrix; YuvToRgbResized
+// against float bilinear sampling of the same planes.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "operators/yuv_to_rgb.h"
+#include "test_util.h"
+
+namespace
+{
+    using namespace ptk;
+    using operators::YuvConversionParams;
+    using operators::YuvMatrix;
+
+    // Planes of a test image: full resolution Y, chroma at half width and
+    // c_rows rows (H for 4:2:2, H / 2 for 4:2:0).
+    struct Planes
+    {
+        std::int64_t H;
+        std::int64_t W;
+        std::int64_t c_rows;
+        std::vector<std::uint8_t> y;
+        std::vector<std::uint8_t> u;
+        std::vector<std::uint8_t> v;
+
+        int Y(std::int64_t h, std::int64_t w) const { return y[h * W + w]; }
+        int U(std::int64_t h, std::int64_t w) const { return u[(c_rows == H ? h : h / 2) * (W / 2) + w / 2]; }
+        int V(std::int64_t h, std::int64_t w) const { return v[(c_rows == H ? h : h / 2) * (W / 2) + w / 2]; }
+    };
+
+    Planes MakePlanes(std::int64_t H, std::int64_t W, bool subsampled_rows, std::uint32_t seed)
+    {
+        Planes p;
+        p.H = H;
+        p.W = W;
+        p.c_rows = subsampled_rows ? H / 2 : H;
+        p.y = test::Pattern(static_cast<std::size_t>(H * W), seed);
+        p.u = test::Pattern(static_cast<std::size_t>(p.c_rows * W / 2), seed + 1);
+        p.v = test::Pattern(static_cast<std::size_t>(p.c_rows * W / 2), seed + 2);
+        // Include the range ends, where clamping and the 16-bit terms peak.
+        p.y[0] = 0;
+        p.y[1] = 255;
+        p.u[0] = 0;
+        p.v[0] = 255;
+        return p;
+    }
+
+    // The planes packed as src_format.
+    std::vector<std::uint8_t> Pack(const Planes &p, core::PixelFormat format, std::vector<std::int64_t> *dims)
+    {
+        const std::int64_t H = p.H;
+        const std::int64_t W = p.W;
+        std::vector<std::uint8_t> out;
+        if (format == core::PixelFormat::kYuyv)
+        {
+            out.resize(static_cast<std::size_t>(H * W * 2));
+            for (std::int64_t h = 0; h < H; ++h)
+            {
+                for (std::int64_t w = 0; w < W; w += 2)
+                {
+                    std::uint8_t *px = &out[(h * W + w) * 2];
+                    px[0] = static_cast<std::uint8_t>(p.Y(h, w));
+                    px[1] = static_cast<std::uint8_t>(p.U(h, w));
+                    px[2] = static_cast<std::uint8_t>(p.Y(h, w + 1));
+                    px[3] = static_cast<std::uint8_t>(p.V(h, w));
+                }
+            }
+            *dims = {H, W, 2};
+            return out;
+        }
+        out = p.y;
+        if (format == core::PixelFormat::kNv12)
+        {
+            for (std::size_t i = 0; i < p.u.size(); ++i)
+            {
+                out.push_back(p.u[i]);
+                out.push_back(p.v[i]);
+            }
+        }
+        else
+        {
+            out.insert(out.end(), p.u.begin(), p.u.end());
+            out.insert(out.end(), p.v.begin(), p.v.end());
+        }
+        *dims = {H * 3 / 2, W, 1};
+        return out;
+    }
+
+    struct Matrix
+    {
+        double kr;
+        double kb;
+        double y_scale;
+        double c_scale;
+        int y_offset;
+    };
+
+    Matrix MakeMatrix(const YuvConversionParams &params)
+    {
+        const bool bt709 = params.matrix == YuvMatrix::kBt709;
+        Matrix m;
+        m.kr = bt709 ? 0.2126 : 0.299;
+        m.kb = bt709 ? 0.0722 : 0.114;
+        m.y_scale = params.full_range ? 1.0 : 255.0 / 219.0;
+        m.c_scale = params.full_range ? 1.0 : 255.0 / 224.0;
+        m.y_offset = params.full_range ? 0 : 16;
+        return m;
+    }
+
+    // The documented fixed-point evaluation: Q13 coefficients, each term as
+    // ((x << 7) * k) >> 16, then a rounding shift out of Q4 and a clamp.
+    void FixedPoint(const Matrix &m, int y, int u, int v, int rgb[3])
+    {
+        const double kg = 1.0 - m.kr - m.kb;
+        auto q13 = [](double x) { return static_cast<int>(std::lround(x * 8192.0)); };
+        auto term = [](int x, int k) { return (x * 128 * k) >> 16; };
+        auto clamp = [](int x) {
+            x = (x + 8) >> 4;
+            return x < 0 ? 0 : x > 255 ? 255 : x;
+        };
+        const int yt = term(y - m.y_offset, q13(m.y_scale));
+        const int du = u - 128;
+        const int dv = v - 128;
+        rgb[0] = clamp(yt + term(dv, q13(2.0 * (1.0 - m.kr) * m.c_scale)));
+        rgb[1] = clamp(yt - term(du, q13(2.0 * m.kb * (1.0 - m.kb) / kg * m.c_scale)) -
+                       term(dv, q13(2.0 * m.kr * (1.0 - m.kr) / kg * m.c_scale)));
+        rgb[2] = clamp(yt + term(du, q13(2.0 * (1.0 - m.kb) * m.c_scale)));
+    }
+
+    // The same matrix in double precision, unrounded.
+    void Exact(const Matrix &m, double y, double u, double v, double rgb[3])
+    {
+        const double kg = 1.0 - m.kr - m.kb;
+        const double yt = (y - m.y_offset) * m.y_scale;
+        const double du = (u - 128.0) * m.c_scale;
+        const double dv = (v - 128.0) * m.c_scale;
+        rgb[0] = yt + 2.0 * (1.0 - m.kr) * dv;
+        rgb[1] = yt - 2.0 * m.kb * (1.0 - m.kb) / kg * du - 2.0 * m.kr * (1.0 - m.kr) / kg * dv;
+        rgb[2] = yt + 2.0 * (1.0 - m.kb) * du;
+    }
+
+    double Clamp255(double x) { return x < 0.0 ? 0.0 : x > 255.0 ? 255.0 : x; }
+
+    const char *Name(core::PixelFormat format)
+    {
+        switch (format)
+        {
+        case core::PixelFormat::kYuyv:
+            return "YUYV";
+        case core::PixelFormat::kNv12:
+            return "NV12";
+        case core::PixelFormat::kI420:
+            return "I420";
+        case core::PixelFormat::kBgr8:
+            return "BGR";
+        case core::PixelFormat::kGray8:
+            return "Gray";
+        default:
+            return "RGB";
+        }
+    }
+
+    void TestConvert(core::PixelFormat src_format, core::PixelFormat dst_format, const YuvConversionParams &params,
+                     std::int64_t H, std::int64_t W)
+    {
+        const Planes p = MakePlanes(H, W, src_format != core::PixelFormat::kYuyv, static_cast<std::uint32_t>(H * W));
+        std::vector<std::int64_t> dims;
+        std::vector<std::uint8_t> src = Pack(p, src_format, &dims);
+        const std::int64_t C = dst_format == core::PixelFormat::kGray8 ? 1 : 3;
+        std::vector<std::uint8_t> out(static_cast<std::size_t>(H * W * C));
+        data::TensorView dst = test::View(out, {H, W, C});
+        if (!PTK_CHECK_OK(operators::YuvToRgb(test::View(src, dims), src_format, &dst, dst_format, params)))
+        {
+            return;
+        }
+
+        const Matrix m = MakeMatrix(params);
+        const bool bgr = dst_format == core::PixelFormat::kBgr8;
+        int bad = 0;
+        int far = 0;
+        for (std::int64_t h = 0; h < H; ++h)
+        {
+            for (std::int64_t w = 0; w < W; ++w)
+            {
+                int want[3];
+                double exact[3];
+                FixedPoint(m, p.Y(h, w), p.U(h, w), p.V(h, w), want);
+                Exact(m, p.Y(h, w), p.U(h, w), p.V(h, w), exact);
+                const std::uint8_t *px = &out[(h * W + w) * C];
+                if (C == 1)
+                {
+                    // Gray is the scaled luma alone.
+                    int luma[3];
+                    FixedPoint(m, p.Y(h, w), 128, 128, luma);
+                    bad += px[0] != luma[0];
+                    far += std::fabs(px[0] - Clamp255((p.Y(h, w) - m.y_offset) * m.y_scale)) > 1.0;
+                    continue;
+                }
+                for (int c = 0; c < 3; ++c)
+                {
+                    const int got = px[bgr ? 2 - c : c];
+                    bad += got != want[c];
+                    far += std::fabs(got - Clamp255(exact[c])) > 1.5;
+                }
+            }
+        }
+        if (!PTK_CHECK(bad == 0) || !PTK_CHECK(far == 0))
+        {
+            std::printf("  %s -> %s %s %s H=%lld W=%lld\n", Name(src_format), Name(dst_format),
+                        params.matrix == YuvMatrix::kBt709 ? "BT.709" : "BT.601",
+                        params.full_range ? "full" : "limited", static_cast<long long>(H), static_cast<long long>(W));
+        }
+    }
+
+    // Float bilinear sample of a plane of the given size at pixel-center
+    // aligned output coordinate (oy, ox) of an OH x OW grid.
+    double Sample(const Planes &p, int plane, std::int64_t rows, std::int64_t cols, std::int64_t OH, std::int64_t OW,
+                  std::int64_t oy, std::int64_t ox)
+    {
+        auto coordinate = [](std::int64_t o, std::int64_t out_len, std::int64_t len) {
+            const double s = (static_cast<double>(o) + 0.5) * static_cast<double>(len) / static_cast<double>(out_len) - 0.5;
+            return s < 0.0 ? 0.0 : s > static_cast<double>(len - 1) ? static_cast<double>(len - 1) : s;
+        };
+        const double sy = coordinate(oy, OH, rows);
+        const double sx = coordinate(ox, OW, cols);
+        const std::int64_t y0 = static_cast<std::int64_t>(sy);
+        const std::int64_t x0 = static_cast<std::int64_t>(sx);
+        const std::int64_t y1 = std::min(y0 + 1, rows - 1);
+        const std::int64_t x1 = std::min(x0 + 1, cols - 1);
+        const std::vector<std::uint8_t> &v = plane == 0 ? p.y : plane == 1 ? p.u : p.v;
+        auto at = [&](std::int64_t y, std::int64_t x) { return static_cast<double>(v[y * cols + x]); };
+        const double fy = sy - static_cast<double>(y0);
+        const double fx = sx - static_cast<double>(x0);
+        return (at(y0, x0) * (1.0 - fx) + at(y0, x1) * fx) * (1.0 - fy) +
+               (at(y1, x0) * (1.0 - fx) + at(y1, x1) * fx) * fy;
+    }
+
+    void TestResized(core::PixelFormat src_format, core::PixelFormat dst_format, std::int64_t H, std::int64_t W,
+                     std::int64_t OH, std::int64_t OW)
+    {
+        const Planes p = MakePlanes(H, W, src_format != core::PixelFormat::kYuyv, static_cast<std::uint32_t>(OH * OW));
+        std::vector<std::int64_t> dims;
+        std::vector<std::uint8_t> src = Pack(p, src_format, &dims);
+        const std::int64_t C = dst_format == core::PixelFormat::kGray8 ? 1 : 3;
+        std::vector<std::uint8_t> out(static_cast<std::size_t>(OH * OW * C));
+        data::TensorView dst = test::View(out, {OH, OW, C});
+        const YuvConversionParams params;
+        if (!PTK_CHECK_OK(operators::YuvToRgbResized(test::View(src, dims), src_format, &dst, dst_format, params)))
+        {
+            return;
+        }
+
+        const Matrix m = MakeMatrix(params);
+        int far = 0;
+        for (std::int64_t h = 0; h < OH; ++h)
+        {
+            for (std::int64_t w = 0; w < OW; ++w)
+            {
+                const double y = Sample(p, 0, H, W, OH, OW, h, w);
+                const double u = Sample(p, 1, p.c_rows, W / 2, OH, OW, h, w);
+                const double v = Sample(p, 2, p.c_rows, W / 2, OH, OW, h, w);
+                double exact[3];
+                Exact(m, y, C == 1 ? 128.0 : u, C == 1 ? 128.0 : v, exact);
+                for (std::int64_t c = 0; c < C; ++c)
+                {
+                    // Q8 weights and an integer sample before the matrix.
+                    const std::int64_t at = dst_format == core::PixelFormat::kBgr8 ? 2 - c : c;
+                    far += std::fabs(out[(h * OW + w) * C + at] - Clamp255(exact[c])) > 3.0;
+                }
+            }
+        }
+        if (!PTK_CHECK(far == 0))
+        {
+            std::printf("  resized %s -> %s %lldx%lld -> %lldx%lld\n", Name(src_format), Name(dst_format),
+                        static_cast<long long>(H), static_cast<long long>(W), static_cast<long long>(OH),
+                        static_cast<long long>(OW));
+        }
+
+        // At the source size the resized path is the plain conversion.
+        std::vector<std::uint8_t> same(static_cast<std::size_t>(H * W * C));
+        std::vector<std::uint8_t> plain(same.size());
+        data::TensorView same_view = test::View(same, {H, W, C});
+        data::TensorView plain_view = test::View(plain, {H, W, C});
+        PTK_CHECK_OK(operators::YuvToRgbResized(test::View(src, dims), src_format, &same_view, dst_format, params));
+        PTK_CHECK_OK(operators::YuvToRgb(test::View(src, dims), src_format, &plain_view, dst_format, params));
+        PTK_CHECK(same == plain);
+    }
+
+    void TestInvalid()
+    {
+        std::vector<std::uint8_t> src(6 * 4 * 2);
+        std::vector<std::uint8_t> out(6 * 4 * 3);
+        data::TensorView rgb = test::View(out, {6, 4, 3});
+        PTK_CHECK(!operators::YuvToRgb(test::View(src, {6, 4, 2}), core::PixelFormat::kRgb8, &rgb,
+                                       core::PixelFormat::kRgb8)
+                       .ok());
+        PTK_CHECK(!operators::YuvToRgb(test::View(src, {6, 4, 2}), core::PixelFormat::kYuyv, &rgb,
+                                       core::PixelFormat::kRgba8)
+                       .ok());
+        data::TensorView wrong = test::View(out, {4, 6, 3});
+        PTK_CHECK(!operators::YuvToRgb(test::View(src, {6, 4, 2}), core::PixelFormat::kYuyv, &wrong,
+                                       core::PixelFormat::kRgb8)
+                       .ok());
+        data::TensorView odd = test::View(out, {8, 3, 3});
+        PTK_CHECK(!operators::YuvToRgb(test::View(src, {8, 3, 2}), core::PixelFormat::kYuyv, &odd,
+                                       core::PixelFormat::kRgb8)
+                       .ok());
+        PTK_CHECK(!operators::YuvToRgb(test::View(src, {7, 4, 1}), core::PixelFormat::kNv12, &rgb,
+                                       core::PixelFormat::kRgb8)
+                       .ok());
+    }
+} // namespace
+
+int main()
+{
+    using ptk::core::PixelFormat;
+    const PixelFormat sources[] = {PixelFormat::kYuyv, PixelFormat::kNv12, PixelFormat::kI420};
+    const PixelFormat outputs[] = {PixelFormat::kRgb8, PixelFormat::kBgr8, PixelFormat::kGray8};
+    const std::int64_t sizes[][2] = {{2, 2}, {4, 18}, {2, 32}, {6, 50}, {64, 302}};
+    for (PixelFormat src : sources)
+    {
+        for (PixelFormat dst : outputs)
+        {
+            for (int matrix = 0; matrix < 4; ++matrix)
+            {
+                ptk::operators::YuvConversionParams params;
+                params.matrix = matrix & 1 ? ptk::operators::YuvMatrix::kBt709 : ptk::operators::YuvMatrix::kBt601;
+                params.full_range = (matrix & 2) != 0;
+                for (const auto &size : sizes)
+                {
+                    TestConvert(src, dst, params, size[0], size[1]);
+                }
+            }
+            TestResized(src, dst, 8, 20, 5, 7);
+            TestResized(src, dst, 6, 10, 13, 31);
+        }
+    }
+    TestInvalid();
+    return ptk::test::Finish("yuv_test");
+}